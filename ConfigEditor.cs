@@ -29,6 +29,8 @@ namespace ContextLauncherConfig
         private CheckBox checkMouseHoverCheckBox;
         private CheckBox checkFocusedWindowCheckBox;
         private ComboBox priorityComboBox;
+        private List<string> extraSettingLines = new List<string>(); // Settings without a control, kept as written
+        private List<string> extraSectionLines = new List<string>(); // Sections the editor doesn't show, e.g. [Contexts]
         private string configFilePath;
         private StatusStrip statusStrip;
         private ToolStripStatusLabel statusLabel;
@@ -291,12 +293,20 @@ namespace ContextLauncherConfig
                     if (trimmed.StartsWith("[") && trimmed.EndsWith("]"))
                     {
                         currentSection = trimmed.Substring(1, trimmed.Length - 2);
+                        if (currentSection != "Settings" && currentSection != "Apps")
+                            extraSectionLines.Add(trimmed);
                         continue;
                     }
 
                     if (!trimmed.Contains("="))
                         continue;
 
+                    if (currentSection != "Settings" && currentSection != "Apps")
+                    {
+                        extraSectionLines.Add(trimmed);
+                        continue;
+                    }
+
                     int equalsIndex = trimmed.IndexOf('=');
                     string key = trimmed.Substring(0, equalsIndex).Trim();
                     string value = trimmed.Substring(equalsIndex + 1).Trim();
@@ -309,6 +319,8 @@ namespace ContextLauncherConfig
                             checkFocusedWindowCheckBox.Checked = value.ToLower() == "true";
                         else if (key == "priorityWhenBothAvailable")
                             priorityComboBox.SelectedItem = char.ToUpper(value[0]) + value.Substring(1).ToLower();
+                        else
+                            extraSettingLines.Add($"{key}={value}");
                     }
                     else if (currentSection == "Apps")
                     {
@@ -324,6 +336,7 @@ namespace ContextLauncherConfig
                             
                             bool enabled = parts.Length >= 5 ? parts[4].ToLower() == "true" : true;
                             item.Checked = enabled;
+                            item.Tag = parts.Length >= 6 ? parts[5].Trim() : ""; // Options, kept as written
 
                             appListView.Items.Add(item);
                         }
@@ -433,12 +446,24 @@ namespace ContextLauncherConfig
                     writer.WriteLine("; focus = Focused window takes precedence");
                     writer.WriteLine($"priorityWhenBothAvailable={priorityComboBox.SelectedItem.ToString().ToLower()}");
                     writer.WriteLine();
+
+                    if (extraSettingLines.Count > 0)
+                    {
+                        writer.WriteLine("; Advanced settings");
+                        foreach (string line in extraSettingLines)
+                            writer.WriteLine(line);
+                        writer.WriteLine();
+                    }
+
                     writer.WriteLine("[Apps]");
-                    writer.WriteLine("; Format: name=executable|runAsAdmin|args|hotkey|enabled");
+                    writer.WriteLine("; Format: name=executable|runAsAdmin|args|hotkey|enabled|options");
                     writer.WriteLine("; runAsAdmin: true or false");
-                    writer.WriteLine("; args: additional command line arguments (use empty string if none)");
-                    writer.WriteLine("; hotkey: e.g., Ctrl+Alt+P, Ctrl+Shift+C, etc.");
+                    writer.WriteLine("; args: additional command line arguments (use empty string if none);");
+                    writer.WriteLine("; {dir}, {item} and {title} are replaced by the folder, selected item and foreground window title");
+                    writer.WriteLine("; hotkey: e.g., Ctrl+Alt+P, Ctrl+Shift+C, or a sequence such as Ctrl+Alt+L, P");
                     writer.WriteLine("; enabled: true or false (allows disabling apps without deleting them)");
+                    writer.WriteLine("; options: optional, e.g. prewarm (keep a hidden PowerShell/cmd ready),");
+                    writer.WriteLine("; perFolder (once per selected Explorer folder) or allItems (once, with the selection as arguments)");
                     writer.WriteLine();
 
                     foreach (ListViewItem item in appListView.Items)
@@ -449,8 +474,17 @@ namespace ContextLauncherConfig
                         string hotkey = item.SubItems[4].Text;
                         bool admin = item.SubItems[5].Text == "Yes";
                         bool enabled = item.Checked;
+                        string options = item.Tag as string;
+                        string optionsField = string.IsNullOrEmpty(options) ? "" : $"|{options}";
 
-                        writer.WriteLine($"{name}={exe}|{admin.ToString().ToLower()}|{args}|{hotkey}|{enabled.ToString().ToLower()}");
+                        writer.WriteLine($"{name}={exe}|{admin.ToString().ToLower()}|{args}|{hotkey}|{enabled.ToString().ToLower()}{optionsField}");
+                    }
+
+                    foreach (string line in extraSectionLines)
+                    {
+                        if (line.StartsWith("["))
+                            writer.WriteLine();
+                        writer.WriteLine(line);
                     }
                 }
 
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Tiny self-registering micro-benchmark harness. A benchmark body runs the
+// requested number of iterations; the runner calibrates the count and reports
+// the mean cost per iteration.
+struct Benchmark {
+    const char* name;
+    void (*body)(size_t iterations);
+};
+
+std::vector<Benchmark>& BenchmarkRegistry();
+
+struct BenchmarkRegistrar {
+    BenchmarkRegistrar(const char* name, void (*body)(size_t));
+};
+
+#define BENCHMARK(fn) \
+    static void fn(size_t iterations); \
+    static BenchmarkRegistrar fn##_registrar(#fn, fn); \
+    static void fn(size_t iterations)
+
+// Keeps results observable so the optimizer cannot drop the measured work
+extern volatile size_t g_benchSink;
+
+inline void Consume(size_t value) {
+    g_benchSink = g_benchSink + value;
+}
@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "arg_template.h"
+#include "command_line.h"
+#include <cstring>
+#include <utility>
+
+namespace {
+
+const char kArgs[] = "-w new --title \"{title}\" -d {dir} --profile \"Dev Shell\" -- code.exe {item}";
+
+ArgValues MakeValues() {
+    ArgValues values;
+    values.dir = "C:\\Users\\me\\Source Code\\launcher\\";
+    values.item = "C:\\Users\\me\\Source Code\\launcher\\README.md";
+    values.title = "launcher - \"notes\" - Visual Studio Code";
+    return values;
+}
+
+// What a launch without compiled templates has to do: split the args into
+// arguments, substitute in each and quote them again
+std::string ReparseAndExpand(const std::string& args, const ArgValues& values) {
+    std::vector<std::string> arguments;
+    std::string current;
+    bool inQuotes = false;
+    bool pending = false;
+    for (char c : args) {
+        if (c == '"') {
+            inQuotes = !inQuotes;
+            pending = true;
+        }
+        else if (c == ' ' && !inQuotes) {
+            if (pending) {
+                arguments.push_back(current);
+            }
+            current.clear();
+            pending = false;
+        }
+        else {
+            current += c;
+            pending = true;
+        }
+    }
+    if (pending) {
+        arguments.push_back(current);
+    }
+
+    const std::pair<const char*, const std::string*> fields[] = {
+        { "{dir}", &values.dir }, { "{item}", &values.item }, { "{title}", &values.title }
+    };
+    std::string out;
+    for (std::string& argument : arguments) {
+        for (const auto& field : fields) {
+            size_t at;
+            while ((at = argument.find(field.first)) != std::string::npos) {
+                argument.replace(at, strlen(field.first), *field.second);
+            }
+        }
+        if (!out.empty()) {
+            out += ' ';
+        }
+        out += QuoteArgument(argument);
+    }
+    return out;
+}
+
+} // namespace
+
+BENCHMARK(ArgTemplateCompile) {
+    for (size_t i = 0; i < iterations; i++) {
+        ArgTemplate compiled = ArgTemplate::Compile(kArgs);
+        Consume(compiled.HasPlaceholders());
+    }
+}
+
+// Before: the args string parsed again on every launch
+BENCHMARK(ArgTemplateReparsePerLaunch) {
+    std::string args = kArgs;
+    ArgValues values = MakeValues();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(ReparseAndExpand(args, values).size());
+    }
+}
+
+// Compiled once at load; a launch only concatenates and escapes values
+BENCHMARK(ArgTemplateExpand) {
+    ArgTemplate compiled = ArgTemplate::Compile(kArgs);
+    ArgValues values = MakeValues();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(compiled.Expand(values).size());
+    }
+}
@@ -0,0 +1,103 @@
+#include "bench.h"
+#include "batch_launch.h"
+#include "directory_cache.h"
+#include "directory_resolver.h"
+#include "fake_shell_windows.h"
+#include "fake_spawn_backend.h"
+
+namespace {
+
+const size_t kSelectedFolders = 8;
+const size_t kSelectedFiles = 24;
+const std::chrono::microseconds kSpawnCost(2000);
+const WindowHandle kExplorerWindow = 0x4000;
+
+std::vector<SelectedItem> MakeSelection() {
+    std::vector<SelectedItem> selection;
+    for (size_t i = 0; i < kSelectedFolders + kSelectedFiles; i++) {
+        bool folder = i % 4 == 0;
+        std::string name = folder ? "module" + std::to_string(i) : "notes " + std::to_string(i) + ".txt";
+        selection.push_back(SelectedItem("C:\\Projects\\repo\\" + name, folder));
+    }
+    return selection;
+}
+
+ArgValues RepoValues() {
+    ArgValues values;
+    values.dir = "C:\\Projects\\repo";
+    return values;
+}
+
+AppConfig MakeApp(SelectionMode mode) {
+    AppConfig app;
+    app.name = "Terminal";
+    app.executable = "wt.exe";
+    app.args = "-w new";
+    app.selection = mode;
+    return app;
+}
+
+} // namespace
+
+BENCHMARK(ExpandSelectionPerFolder_32Items) {
+    AppConfig app = MakeApp(SelectionMode::PerFolder);
+    std::vector<SelectedItem> selection = MakeSelection();
+    for (size_t i = 0; i < iterations; i++) {
+        std::vector<SpawnJob> jobs = ExpandSelection(app, RepoValues(), selection, 8);
+        Consume(jobs.size());
+    }
+}
+
+BENCHMARK(ExpandSelectionAllItems_32Items) {
+    AppConfig app = MakeApp(SelectionMode::AllItems);
+    std::vector<SelectedItem> selection = MakeSelection();
+    for (size_t i = 0; i < iterations; i++) {
+        std::vector<SpawnJob> jobs = ExpandSelection(app, RepoValues(), selection, 8);
+        Consume(jobs[0].args.size());
+    }
+}
+
+// Before: one blocking spawn after another, so a press costs the sum
+BENCHMARK(BatchLaunchSerial_8Folders) {
+    AppConfig app = MakeApp(SelectionMode::PerFolder);
+    std::vector<SpawnJob> jobs = ExpandSelection(app, RepoValues(), MakeSelection(), 8);
+    FakeSpawnBackend backend(kSpawnCost);
+    SpawnScheduler scheduler(backend, 3);
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(scheduler.Run(jobs));
+    }
+}
+
+// Three workers plus the caller: about two spawn costs for eight folders
+BENCHMARK(BatchLaunchConcurrent_8Folders) {
+    AppConfig app = MakeApp(SelectionMode::PerFolder);
+    std::vector<SpawnJob> jobs = ExpandSelection(app, RepoValues(), MakeSelection(), 8);
+    FakeSpawnBackend backend(kSpawnCost);
+    SpawnScheduler scheduler(backend, 3);
+    scheduler.Start();
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(scheduler.Run(jobs));
+    }
+    scheduler.Stop();
+    Consume(backend.MaxRunning());
+}
+
+// Selection read on the resolver's helper thread, as for a perFolder press
+BENCHMARK(SelectionResolve_32Items) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorerWindow, "C:\\Projects\\repo");
+    provider.SetSelection(kExplorerWindow, MakeSelection());
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache);
+    resolver.Start();
+
+    std::vector<SelectedItem> items;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    for (size_t i = 0; i < iterations; i++) {
+        resolver.ResolveSelection(kExplorerWindow, deadline, items);
+        Consume(items.size());
+    }
+    resolver.Stop();
+}
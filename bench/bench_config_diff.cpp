@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "config_diff.h"
+#include "fake_hotkey_registrar.h"
+
+namespace {
+
+const int kAppCount = 300;
+
+// Roughly the cost of a RegisterHotKey round trip into win32k
+const unsigned kSpinPerCall = 2000;
+
+// Every app gets a distinct Ctrl+Alt(+Shift) binding
+std::vector<AppConfig> MakeApps() {
+    std::vector<AppConfig> apps;
+    for (int i = 0; i < kAppCount; i++) {
+        AppConfig app;
+        app.name = "App " + std::to_string(i);
+        app.executable = "app" + std::to_string(i) + ".exe";
+        app.hotkeyId = i + 1;
+        app.modifiers = 0x0003 | (i / 26 % 2 ? 0x0004 : 0);
+        app.vkCode = 0x41 + (i % 26) + (i / 52) * 0x100;
+        apps.push_back(app);
+    }
+    return apps;
+}
+
+// The same file after one binding was edited and one app was inserted,
+// which shifts the file-order hotkey ids of every later entry
+std::vector<AppConfig> MakeEditedApps() {
+    std::vector<AppConfig> apps = MakeApps();
+    apps[kAppCount / 2].vkCode = 0xFF00;
+
+    AppConfig inserted;
+    inserted.name = "App 0 inserted";
+    inserted.executable = "inserted.exe";
+    inserted.modifiers = 0x0008;
+    inserted.vkCode = 0x41;
+    apps.insert(apps.begin() + 1, inserted);
+    for (size_t i = 0; i < apps.size(); i++) {
+        apps[i].hotkeyId = (int)i + 1;
+    }
+    return apps;
+}
+
+} // namespace
+
+// Previous reload: unregister everything, publish, register everything
+BENCHMARK(ReloadFullReregister_300Apps) {
+    std::shared_ptr<const ConfigSnapshot> before = ConfigSnapshot::Compile(MakeApps(), Settings());
+    std::shared_ptr<const ConfigSnapshot> after = ConfigSnapshot::Compile(MakeEditedApps(), Settings());
+    FakeHotkeyRegistrar registrar(kSpinPerCall);
+    ApplyHotkeyPlan(DiffConfig(nullptr, before).hotkeys, registrar);
+
+    for (size_t i = 0; i < iterations; i++) {
+        const ConfigSnapshot& from = (i % 2 == 0) ? *before : *after;
+        const ConfigSnapshot& to = (i % 2 == 0) ? *after : *before;
+        for (const AppConfig& app : from.Apps()) {
+            registrar.Unregister(app.hotkeyId);
+        }
+        for (const AppConfig& app : to.Apps()) {
+            if (app.enabled) {
+                registrar.Register(app.hotkeyId, app.modifiers, app.vkCode);
+            }
+        }
+    }
+    Consume(registrar.RegisterCalls() + registrar.UnregisterCalls());
+}
+
+// Incremental reload: diff against the live snapshot, touch only changed bindings
+BENCHMARK(ReloadIncrementalDiff_300Apps) {
+    std::shared_ptr<const ConfigSnapshot> before = ConfigSnapshot::Compile(MakeApps(), Settings());
+    std::shared_ptr<const ConfigSnapshot> after = ConfigSnapshot::Compile(MakeEditedApps(), Settings());
+    FakeHotkeyRegistrar registrar(kSpinPerCall);
+    ConfigDiff live = DiffConfig(nullptr, before);
+    ApplyHotkeyPlan(live.hotkeys, registrar);
+
+    for (size_t i = 0; i < iterations; i++) {
+        const std::shared_ptr<const ConfigSnapshot>& next = (i % 2 == 0) ? after : before;
+        ConfigDiff diff = DiffConfig(live.config.get(), next);
+        ApplyHotkeyPlan(diff.hotkeys, registrar);
+        live = diff;
+    }
+    Consume(registrar.RegisterCalls() + registrar.UnregisterCalls());
+}
@@ -0,0 +1,75 @@
+#include "bench.h"
+#include "config_parser.h"
+#include "hotkey.h"
+#include "legacy_config_parser.h"
+
+namespace {
+
+const int kEntryCount = 5000;
+const int kSequenceCount = 2000;
+
+std::string GenerateConfig(int entries) {
+    std::string text =
+        "; Launcher Configuration File\n\n"
+        "[Settings]\n"
+        "checkMouseHover=true\n"
+        "checkFocusedWindow=true\n"
+        "priorityWhenBothAvailable=hover\n\n"
+        "[Apps]\n"
+        "; Format: name=executable|runAsAdmin|args|hotkey|enabled\n";
+    for (int i = 0; i < entries; i++) {
+        text += "Tool " + std::to_string(i) + "=C:\\Program Files\\Tool" + std::to_string(i) +
+            "\\tool.exe|false|--profile dev" + std::to_string(i % 7) + "|Ctrl+Alt+" +
+            (char)('A' + i % 26) + "|" + (i % 3 == 0 ? "false" : "true") + "\n";
+    }
+    return text;
+}
+
+// Every entry a distinct three-step sequence, with a plain hotkey taken twice
+// every 100 entries, so conflict checks see many bindings and few clashes
+std::string GenerateSequenceConfig(int entries) {
+    std::string text = "[Apps]\n";
+    for (int i = 0; i < entries; i++) {
+        std::string hotkey = std::string("Ctrl+Alt+") + (char)('A' + i % 26) + ", " + (char)('A' + i / 26 % 26) +
+            ", " + (char)('0' + i / 676 % 10);
+        if (i % 100 == 0) {
+            hotkey = "Ctrl+Shift+F" + std::to_string(i / 200 % 12 + 1);
+        }
+        text += "Tool " + std::to_string(i) + "=tool.exe|false||" + hotkey + "|true\n";
+    }
+    return text;
+}
+
+const std::string& GeneratedConfig() {
+    static const std::string text = GenerateConfig(kEntryCount);
+    return text;
+}
+
+} // namespace
+
+BENCHMARK(ConfigParseLegacy_5000Entries) {
+    const std::string& text = GeneratedConfig();
+    for (size_t i = 0; i < iterations; i++) {
+        std::vector<AppConfig> apps = LegacyParseConfig(text,
+            [](const std::string& hotkey, unsigned int& modifiers, unsigned int& vkCode) {
+                return ParseHotkeyUsLayout(hotkey, modifiers, vkCode);
+            });
+        Consume(apps.size());
+    }
+}
+
+BENCHMARK(ConfigParseSinglePass_5000Entries) {
+    const std::string& text = GeneratedConfig();
+    for (size_t i = 0; i < iterations; i++) {
+        ConfigParseResult result = ParseConfig(text, ParseHotkeyUsLayout);
+        Consume(result.config->Apps().size() + result.diagnostics.size());
+    }
+}
+
+BENCHMARK(ConfigParseHotkeyConflicts_2000Sequences) {
+    static const std::string text = GenerateSequenceConfig(kSequenceCount);
+    for (size_t i = 0; i < iterations; i++) {
+        ConfigParseResult result = ParseConfig(text, ParseHotkeyUsLayout);
+        Consume(result.config->Apps().size() + result.diagnostics.size());
+    }
+}
@@ -0,0 +1,66 @@
+#include "bench.h"
+#include "config_persister.h"
+#include "config_writer.h"
+#include "fake_file_ops.h"
+
+namespace {
+
+const int kAppCount = 60;
+const char kPath[] = "launcher.ini";
+
+// Roughly the cost of creating, writing and closing a small file
+const unsigned kSpinPerWrite = 200000;
+
+std::string MakeConfigText() {
+    std::string text = "; Launcher Configuration File\n\n[Settings]\ncheckMouseHover=true\n\n[Apps]\n";
+    for (int i = 0; i < kAppCount; i++) {
+        text += "; my tool number " + std::to_string(i) + "\n";
+        text += "App " + std::to_string(i) + " = app" + std::to_string(i) + ".exe|false||Ctrl+Alt+F" +
+            std::to_string(i % 24 + 1) + "|true\n";
+    }
+    return text;
+}
+
+} // namespace
+
+// Previous tray toggle: regenerate and rewrite the whole file on the UI thread
+BENCHMARK(ToggleSyncRewrite_60Apps) {
+    FakeFileOps files(kSpinPerWrite);
+    for (size_t i = 0; i < iterations; i++) {
+        std::string text = "; Launcher Configuration File\n\n[Settings]\ncheckMouseHover=true\n\n[Apps]\n";
+        for (int app = 0; app < kAppCount; app++) {
+            bool enabled = app != (int)(i % kAppCount) || i % 2 == 0;
+            text += "App " + std::to_string(app) + "=app" + std::to_string(app) + ".exe|false||Ctrl+Alt+F" +
+                std::to_string(app % 24 + 1) + "|" + (enabled ? "true" : "false") + "\n";
+        }
+        files.WriteFile(kPath, text);
+    }
+    Consume(files.Writes());
+}
+
+// UI-thread cost of a toggle now: queue a field edit for the persister. The
+// writer thread is not started, so only the enqueue is measured.
+BENCHMARK(ToggleEnqueueEdit_60Apps) {
+    FakeFileOps files(kSpinPerWrite);
+    files.SetFile(kPath, MakeConfigText());
+    ConfigPersister persister(files, std::chrono::milliseconds(250));
+
+    for (size_t i = 0; i < iterations; i++) {
+        std::string name = "App " + std::to_string(i % kAppCount);
+        bool enabled = i % 2 == 0;
+        persister.Enqueue([name, enabled](IniDocument& document) {
+            SetAppEnabled(document, name, enabled);
+        });
+    }
+    Consume((size_t)persister.GetStats().edits);
+}
+
+// Background side of a toggle: parse, patch one field, serialize
+BENCHMARK(IniDocumentSetAppEnabled_60Apps) {
+    std::string text = MakeConfigText();
+    for (size_t i = 0; i < iterations; i++) {
+        IniDocument document(text);
+        SetAppEnabled(document, "App " + std::to_string(i % kAppCount), i % 2 == 0);
+        Consume(document.Text().size());
+    }
+}
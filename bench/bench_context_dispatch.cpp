@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "config.h"
+#include "fake_process_table.h"
+#include "process_image_cache.h"
+
+namespace {
+
+const int kWindowCount = 64;
+const unsigned kQuerySpin = 20000;  // Roughly a cross-process image query
+
+const char* const kImages[] = { "Code.exe", "WindowsTerminal.exe", "explorer.exe", "devenv.exe" };
+
+void AddWindows(FakeProcessTable& table) {
+    for (int i = 0; i < kWindowCount; i++) {
+        table.AddWindow((WindowHandle)(0x1000 + i), (uint32_t)(100 + i), kImages[i % 4]);
+    }
+}
+
+std::shared_ptr<const ConfigSnapshot> CompileWithContexts() {
+    std::vector<AppConfig> apps;
+    std::vector<AppConfig> contextApps;
+    for (int i = 0; i < 10; i++) {
+        AppConfig app;
+        app.name = "App " + std::to_string(i);
+        app.executable = "app" + std::to_string(i) + ".exe";
+        app.hotkeyId = i + 1;
+        apps.push_back(app);
+
+        AppConfig codeVariant = app;
+        codeVariant.contextImage = "code.exe";
+        codeVariant.args = "--from-editor";
+        contextApps.push_back(codeVariant);
+
+        AppConfig terminalVariant = app;
+        terminalVariant.contextImage = "windowsterminal.exe";
+        terminalVariant.args = "--from-terminal";
+        contextApps.push_back(terminalVariant);
+    }
+    return ConfigSnapshot::Compile(apps, Settings(), contextApps);
+}
+
+} // namespace
+
+// Every press queries the foreground window's process
+BENCHMARK(ContextImageUncached_64Windows) {
+    FakeProcessTable table(kQuerySpin);
+    AddWindows(table);
+
+    for (size_t i = 0; i < iterations; i++) {
+        WindowHandle window = (WindowHandle)(0x1000 + i % kWindowCount);
+        std::string image;
+        table.GetProcessImageName(table.GetWindowProcessId(window), image);
+        Consume(image.size());
+    }
+}
+
+// HWND -> image cache; entries live until the window is destroyed
+BENCHMARK(ContextImageCached_64Windows) {
+    FakeProcessTable table(kQuerySpin);
+    AddWindows(table);
+    ProcessImageCache cache(table);
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(cache.Lookup((WindowHandle)(0x1000 + i % kWindowCount)).size());
+    }
+}
+
+// Hotkey id -> app -> foreground variant, with a warm image cache
+BENCHMARK(ContextDispatch_10Apps_20Variants) {
+    FakeProcessTable table(kQuerySpin);
+    AddWindows(table);
+    ProcessImageCache cache(table);
+    ConfigStore store;
+    store.Publish(CompileWithContexts());
+
+    for (size_t i = 0; i < iterations; i++) {
+        std::shared_ptr<const ConfigSnapshot> config = store.Current();
+        const AppConfig* app = config->FindByHotkey((int)(i % 10) + 1);
+        if (app != nullptr && config->HasContexts(*app)) {
+            app = config->SelectContext(*app, cache.Lookup((WindowHandle)(0x1000 + i % kWindowCount)));
+        }
+        Consume(app->args.size());
+    }
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "fake_context_provider.h"
+#include "fake_directory_probe.h"
+#include "fake_process_table.h"
+#include "launch_directory.h"
+
+namespace {
+
+// Reading another process's working directory
+const unsigned kTerminalSpin = 20000;
+
+const WindowHandle kExplorer = 0x1000;
+const WindowHandle kTerminal = 0x2000;
+const WindowHandle kEditor = 0x3000;
+const WindowHandle kDesktop = 0x4000;
+
+// One window per built-in provider, in the default order
+struct Session {
+    FakeProcessTable processes;
+    FakeContextProvider explorer;
+    FakeContextProvider terminal;
+    FakeContextProvider editor;
+    FakeContextProvider desktop;
+    ContextProviderRegistry providers;
+    FakeDirectoryProbe directories;
+    DirectoryReachability reachability;
+
+    explicit Session(int terminalCacheTtlMs)
+        : explorer(500), terminal(kTerminalSpin), editor(500), desktop(0),
+          providers(processes, []() { return std::string("C:\\Users\\me"); }),
+          reachability(directories, std::chrono::seconds(30), std::chrono::seconds(10)) {
+        directories.AddDirectory("C:\\src\\project\\build");
+        processes.AddWindow(kTerminal, 4200, "WindowsTerminal.exe");
+        explorer.AddWindow(kExplorer, "C:\\src\\project");
+        terminal.AddWindow(kTerminal, "C:\\src\\project\\build");
+        editor.AddWindow(kEditor, "C:\\src\\project\\core");
+        desktop.AddWindow(kDesktop, "C:\\Users\\me\\Desktop");
+        providers.Add("explorer", explorer, ContextProviderOptions());
+        providers.Add("terminal", terminal, ContextProviderOptions(50, terminalCacheTtlMs));
+        providers.Add("editor", editor, ContextProviderOptions(100));
+        providers.Add("desktop", desktop, ContextProviderOptions());
+    }
+};
+
+} // namespace
+
+// Focused terminal, working directory read on every press
+BENCHMARK(ContextProviderTerminalUncached) {
+    Session session(0);
+    Settings settings;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kNoWindow, kTerminal, session.providers, session.reachability, trace).size());
+    }
+}
+
+// Same, answered from the per-process cache within its TTL
+BENCHMARK(ContextProviderTerminalCached) {
+    Session session(1000);
+    Settings settings;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kNoWindow, kTerminal, session.providers, session.reachability, trace).size());
+    }
+}
+
+// Desktop under the cursor: every provider before it is asked first
+BENCHMARK(ContextProviderClaimLast_4Providers) {
+    Session session(1000);
+    std::vector<std::string> order = DefaultContextProviders();
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(session.providers.Claim(kDesktop, order).window);
+    }
+}
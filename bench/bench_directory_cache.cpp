@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "directory_cache.h"
+#include "fake_shell_windows.h"
+
+namespace {
+
+const size_t kWindowCount = 32;
+const unsigned kSpinPerItem = 200;
+
+void PopulateWindows(FakeShellWindowProvider& provider) {
+    for (size_t i = 0; i < kWindowCount; i++) {
+        provider.AddWindow(0x1000 + i * 0x10, "C:\\Projects\\repo" + std::to_string(i));
+    }
+}
+
+} // namespace
+
+// Baseline: every press walks all shell windows (the last one matches)
+BENCHMARK(DirectoryWalk_32Windows) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateWindows(provider);
+
+    std::string directory;
+    WindowHandle target = 0x1000 + (kWindowCount - 1) * 0x10;
+    for (size_t i = 0; i < iterations; i++) {
+        provider.QueryDirectory(target, directory);
+        Consume(directory.size());
+    }
+}
+
+// Event-maintained cache: every press is a hash lookup
+BENCHMARK(DirectoryCacheHit_32Windows) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateWindows(provider);
+    DirectoryCache cache(provider);
+    for (size_t i = 0; i < kWindowCount; i++) {
+        cache.OnNavigated(0x1000 + i * 0x10, "C:\\Projects\\repo" + std::to_string(i));
+    }
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        cache.Lookup(0x1000 + (i % kWindowCount) * 0x10, directory);
+        Consume(directory.size());
+    }
+}
+
+// Worst case for the cache: the window was invalidated before every press
+BENCHMARK(DirectoryCacheColdMiss_32Windows) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateWindows(provider);
+    DirectoryCache cache(provider);
+
+    std::string directory;
+    WindowHandle target = 0x1000 + (kWindowCount - 1) * 0x10;
+    for (size_t i = 0; i < iterations; i++) {
+        cache.Invalidate(target);
+        cache.Lookup(target, directory);
+        Consume(directory.size());
+    }
+}
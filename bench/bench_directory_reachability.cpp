@@ -0,0 +1,88 @@
+#include "bench.h"
+#include "directory_reachability.h"
+#include "fake_directory_probe.h"
+#include "virtual_folders.h"
+
+namespace {
+
+const char* const kOfflineDirectory = "\\\\nas\\projects\\repo";
+const char* const kOnlineDirectory = "\\\\fileserver\\team\\docs";
+
+std::chrono::steady_clock::time_point DeadlineIn(std::chrono::milliseconds budget) {
+    return std::chrono::steady_clock::now() + budget;
+}
+
+// Known folders and libraries; each shell lookup costs a COM round trip
+class FakeVirtualFolderSource : public IVirtualFolderSource {
+public:
+    bool ResolveVirtualFolder(const std::string& parsingName, std::string& path) override {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < 20000; i++) {
+            counter = counter + 1;
+        }
+        if (parsingName.find("Documents.library-ms") != std::string::npos) {
+            path = "C:\\Users\\me\\Documents";
+            return true;
+        }
+        return false;
+    }
+
+    std::string GetHomeDirectory() override {
+        return "C:\\Users\\me";
+    }
+};
+
+} // namespace
+
+// Before: the spawn itself touched the offline share and stalled (20 ms here,
+// tens of seconds for a real SMB timeout) before the retry from home
+BENCHMARK(ReachabilityOfflineShareBlocking) {
+    FakeDirectoryProbe probe(std::chrono::milliseconds(20));
+    probe.SetOffline("\\\\nas\\projects\\", true);
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(probe.DirectoryExists(kOfflineDirectory));
+    }
+}
+
+// Offline share known from an earlier press: refused without touching it
+BENCHMARK(ReachabilityOfflineShareCached) {
+    FakeDirectoryProbe probe(std::chrono::milliseconds(20));
+    probe.SetOffline("\\\\nas\\projects\\", true);
+    DirectoryReachability reachability(probe, std::chrono::seconds(30), std::chrono::seconds(10));
+    reachability.Start();
+    reachability.IsUsable(kOfflineDirectory, DeadlineIn(std::chrono::milliseconds(100)));
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(reachability.IsUsable(kOfflineDirectory, DeadlineIn(std::chrono::milliseconds(2))));
+    }
+    reachability.Stop();
+}
+
+// Online share: one cached share state plus the directory check
+BENCHMARK(ReachabilityOnlineShareCached) {
+    FakeDirectoryProbe probe;
+    probe.AddDirectory(kOnlineDirectory);
+    DirectoryReachability reachability(probe, std::chrono::seconds(30), std::chrono::seconds(10));
+    reachability.Start();
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(reachability.IsUsable(kOnlineDirectory, DeadlineIn(std::chrono::milliseconds(100))));
+    }
+    reachability.Stop();
+}
+
+// Library and This PC parsing names, resolved once and then from the map
+BENCHMARK(VirtualFolderMapHit) {
+    FakeVirtualFolderSource source;
+    VirtualFolderMap folders(source);
+    const std::string names[] = {
+        "::{031E4825-7B94-4dc3-B131-E946B44C8DD5}\\Documents.library-ms",
+        "::{20D04FE0-3AEA-1069-A2D8-08002B30309D}",
+    };
+
+    std::string path;
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(folders.Resolve(names[i % 2], path));
+    }
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "directory_resolver.h"
+#include "fake_shell_windows.h"
+
+namespace {
+
+const WindowHandle kExplorer = 0x1000;
+
+std::chrono::steady_clock::time_point DeadlineIn(std::chrono::milliseconds budget) {
+    return std::chrono::steady_clock::now() + budget;
+}
+
+} // namespace
+
+// Warm cache: the resolver adds one extra lock over DirectoryCache::Lookup
+BENCHMARK(DirectoryResolverHit) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "C:\\Projects\\repo");
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache);
+    resolver.Start();
+    cache.OnNavigated(kExplorer, "C:\\Projects\\repo");
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        resolver.Resolve(kExplorer, DeadlineIn(std::chrono::milliseconds(500)), directory);
+        Consume(directory.size());
+    }
+    resolver.Stop();
+}
+
+// Cold miss answered by the helper thread well within the budget
+BENCHMARK(DirectoryResolverColdMiss) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "C:\\Projects\\repo");
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache);
+    resolver.Start();
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        cache.Invalidate(kExplorer);
+        resolver.Resolve(kExplorer, DeadlineIn(std::chrono::milliseconds(500)), directory);
+        Consume(directory.size());
+    }
+    resolver.Stop();
+}
+
+// Explorer stalls for 50 ms on every query: each press is capped at the 2 ms
+// budget and answered from the last known directory
+BENCHMARK(DirectoryResolverStalledExplorer) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "C:\\Projects\\repo");
+    provider.SetDelay(std::chrono::milliseconds(50));
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache);
+    resolver.Start();
+    cache.OnNavigated(kExplorer, "C:\\Projects\\repo");
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        cache.Invalidate(kExplorer);
+        resolver.Resolve(kExplorer, DeadlineIn(std::chrono::milliseconds(2)), directory);
+        Consume(directory.size());
+    }
+    resolver.Stop();
+}
@@ -0,0 +1,55 @@
+#include "bench.h"
+#include "config.h"
+#include <map>
+
+namespace {
+
+const int kAppCount = 300;
+
+std::vector<AppConfig> MakeApps() {
+    std::vector<AppConfig> apps;
+    for (int i = 0; i < kAppCount; i++) {
+        AppConfig app;
+        app.name = "App " + std::to_string(i);
+        app.executable = "app" + std::to_string(i) + ".exe";
+        app.hotkeyId = i + 1;
+        app.modifiers = 0x0003;
+        app.vkCode = 0x41 + (i % 26);
+        apps.push_back(app);
+    }
+    return apps;
+}
+
+} // namespace
+
+// Previous dispatch: linear scan of a name-keyed map for the hotkey id
+BENCHMARK(DispatchLinearMapScan_300Apps) {
+    std::map<std::string, AppConfig> byName;
+    for (const AppConfig& app : MakeApps()) {
+        byName[app.name] = app;
+    }
+
+    for (size_t i = 0; i < iterations; i++) {
+        int hotkeyId = (int)(i % kAppCount) + 1;
+        for (const auto& pair : byName) {
+            if (pair.second.hotkeyId == hotkeyId && pair.second.enabled) {
+                Consume(pair.second.vkCode);
+                break;
+            }
+        }
+    }
+}
+
+// Compiled snapshot: dense hotkey id -> app index
+BENCHMARK(DispatchSnapshotIndex_300Apps) {
+    ConfigStore store;
+    store.Publish(ConfigSnapshot::Compile(MakeApps(), Settings()));
+
+    for (size_t i = 0; i < iterations; i++) {
+        std::shared_ptr<const ConfigSnapshot> config = store.Current();
+        const AppConfig* app = config->FindByHotkey((int)(i % kAppCount) + 1);
+        if (app != nullptr && app->enabled) {
+            Consume(app->vkCode);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "executable_resolver.h"
+#include "fake_executable_environment.h"
+
+namespace {
+
+// A GetFileAttributes probe on a warm file system cache
+const unsigned kSpinPerProbe = 1000;
+
+// A typical developer machine: a long PATH, wt.exe near the end as an
+// app execution alias, code.exe only registered under App Paths
+void SetUpMachine(FakeExecutableEnvironment& environment) {
+    std::string path = "C:\\Windows\\system32;C:\\Windows;C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\";
+    for (int i = 0; i < 20; i++) {
+        path += ";C:\\Program Files\\Tool" + std::to_string(i) + "\\bin";
+    }
+    path += ";C:\\Users\\me\\AppData\\Local\\Microsoft\\WindowsApps";
+    environment.SetVariable("PATH", path);
+    environment.SetVariable("PATHEXT", ".COM;.EXE;.BAT;.CMD;.VBS;.VBE;.JS;.JSE;.WSF;.WSH;.MSC");
+
+    environment.AddFile("C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe");
+    environment.AddFile("C:\\Users\\me\\AppData\\Local\\Microsoft\\WindowsApps\\wt.exe");
+    environment.AddFile("C:\\Program Files\\Microsoft VS Code\\Code.exe");
+    environment.SetAppPath("code.exe", "\"C:\\Program Files\\Microsoft VS Code\\Code.exe\"");
+}
+
+const char* const kTargets[] = { "powershell.exe", "wt.exe", "code" };
+
+} // namespace
+
+// Every launch repeats the PATH / PATHEXT / App Paths search
+BENCHMARK(ResolveExecutableUncached) {
+    FakeExecutableEnvironment environment(kSpinPerProbe);
+    SetUpMachine(environment);
+    ExecutableResolver resolver(environment);
+
+    std::string path;
+    for (size_t i = 0; i < iterations; i++) {
+        resolver.Invalidate();
+        Consume(resolver.Resolve(kTargets[i % 3], path));
+    }
+}
+
+// Resolved once, then served from the cache until a settings change
+BENCHMARK(ResolveExecutableCached) {
+    FakeExecutableEnvironment environment(kSpinPerProbe);
+    SetUpMachine(environment);
+    ExecutableResolver resolver(environment);
+
+    std::string path;
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(resolver.Resolve(kTargets[i % 3], path));
+    }
+}
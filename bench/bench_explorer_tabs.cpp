@@ -0,0 +1,81 @@
+#include "bench.h"
+#include "directory_cache.h"
+#include "directory_resolver.h"
+#include "fake_shell_windows.h"
+
+namespace {
+
+const size_t kWindowCount = 8;
+const size_t kTabsPerWindow = 4;
+const unsigned kSpinPerItem = 200;
+
+WindowHandle WindowAt(size_t window) {
+    return 0x1000 + window * 0x100;
+}
+
+WindowHandle TabAt(size_t window, size_t tab) {
+    return WindowAt(window) + 1 + tab;
+}
+
+std::string DirectoryAt(size_t window, size_t tab) {
+    return "C:\\Projects\\repo" + std::to_string(window) + "\\tab" + std::to_string(tab);
+}
+
+// Every window ends up showing its last tab, the one added last
+void PopulateTabs(FakeShellWindowProvider& provider) {
+    for (size_t w = 0; w < kWindowCount; w++) {
+        for (size_t t = 0; t < kTabsPerWindow; t++) {
+            provider.AddTab(WindowAt(w), TabAt(w, t), DirectoryAt(w, t));
+        }
+    }
+}
+
+} // namespace
+
+// Before tab support: the walk stops at the window's first tab, which is
+// the wrong folder whenever another tab is showing
+BENCHMARK(ExplorerTabsFirstItemWalk_8Windows4Tabs) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateTabs(provider);
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        provider.QueryFirstItemOfWindow(WindowAt(kWindowCount - 1), directory);
+        Consume(directory.size());
+    }
+}
+
+// Cold miss: active tab, then a walk that matches the tab itself
+BENCHMARK(ExplorerTabsActiveTabWalk_8Windows4Tabs) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateTabs(provider);
+
+    std::string directory;
+    for (size_t i = 0; i < iterations; i++) {
+        provider.QueryDirectory(provider.GetActiveTab(WindowAt(kWindowCount - 1)), directory);
+        Consume(directory.size());
+    }
+}
+
+// Per-tab cache kept by navigation events; the user switches tabs between
+// presses, which only changes which entry is read
+BENCHMARK(ExplorerTabsResolverHitWithTabSwitch_8Windows4Tabs) {
+    FakeShellWindowProvider provider(kSpinPerItem);
+    PopulateTabs(provider);
+    DirectoryCache cache(provider);
+    for (size_t w = 0; w < kWindowCount; w++) {
+        for (size_t t = 0; t < kTabsPerWindow; t++) {
+            cache.OnNavigated(TabAt(w, t), DirectoryAt(w, t));
+        }
+    }
+    DirectoryResolver resolver(provider, cache);
+
+    std::string directory;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    for (size_t i = 0; i < iterations; i++) {
+        size_t w = i % kWindowCount;
+        provider.SelectTab(WindowAt(w), TabAt(w, i % kTabsPerWindow));
+        resolver.Resolve(WindowAt(w), deadline, directory);
+        Consume(directory.size());
+    }
+}
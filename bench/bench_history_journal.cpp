@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "fake_journal_file.h"
+#include "history_journal.h"
+
+namespace {
+
+const char* const kApps[] = { "PowerShell", "Terminal", "VS Code", "Git Bash", "cmd" };
+const size_t kAppCount = sizeof(kApps) / sizeof(kApps[0]);
+
+std::string DirectoryOf(size_t i) {
+    return "C:\\Users\\dev\\src\\project" + std::to_string(i % 1500) + "\\module" + std::to_string(i % 7);
+}
+
+// A journal of uses, as appended between two compactions
+std::string MakeUseJournal(size_t uses) {
+    std::string journal = EncodeHistoryHeader();
+    for (size_t i = 0; i < uses; i++) {
+        journal += EncodeHistoryUse(kApps[i % kAppCount], DirectoryOf(i), 1700000000 + (int64_t)i * 60);
+    }
+    return journal;
+}
+
+} // namespace
+
+// One launch: table update plus an appended record
+BENCHMARK(HistoryJournalRecord) {
+    FakeJournalFile file;
+    FrecencyTable table;
+    HistoryJournal journal(file, table);
+    journal.Open("history.journal");
+    for (size_t i = 0; i < iterations; i++) {
+        journal.Record(kApps[i % kAppCount], DirectoryOf(i), 1700000000 + (int64_t)i);
+    }
+    Consume((size_t)journal.FileSize());
+}
+
+// Startup: replaying 2000 uses straight from the mapped view
+BENCHMARK(HistoryJournalReplay_2000Uses) {
+    std::string journal = MakeUseJournal(2000);
+    for (size_t i = 0; i < iterations; i++) {
+        FrecencyTable table;
+        Consume(ReplayHistoryJournal(journal, table).uses);
+    }
+}
+
+// Startup after a compaction: one entry per table entry
+BENCHMARK(HistoryJournalReplay_Compacted) {
+    FrecencyTable source;
+    for (size_t i = 0; i < 20000; i++) {
+        source.Record(kApps[i % kAppCount], DirectoryOf(i), 1700000000 + (int64_t)i * 60);
+    }
+    std::string journal = EncodeHistoryHeader();
+    for (const FrecencyEntry& entry : source.Snapshot()) {
+        journal += EncodeHistoryEntry(entry);
+    }
+    for (size_t i = 0; i < iterations; i++) {
+        FrecencyTable table;
+        Consume(ReplayHistoryJournal(journal, table).entries);
+    }
+}
+
+BENCHMARK(HistoryJournalCompact) {
+    FakeJournalFile file;
+    file.SetFile("history.journal", MakeUseJournal(20000));
+    FrecencyTable table;
+    HistoryJournal journal(file, table, 1 << 30);
+    journal.Open("history.journal");
+    for (size_t i = 0; i < iterations; i++) {
+        journal.Compact();
+    }
+    Consume((size_t)journal.FileSize());
+}
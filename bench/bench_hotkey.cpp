@@ -0,0 +1,27 @@
+#include "bench.h"
+#include "hotkey.h"
+
+namespace {
+
+const char* const kHotkeys[] = {
+    "Ctrl+Alt+P", "Ctrl+Alt+Shift+P", "Win+F12", "Ctrl+Shift+PageDown",
+    "Numpad5", "ctrl + alt + ;", "Alt+Escape", "F24"
+};
+const size_t kHotkeyCount = sizeof(kHotkeys) / sizeof(kHotkeys[0]);
+
+} // namespace
+
+BENCHMARK(HotkeyParse) {
+    for (size_t i = 0; i < iterations; i++) {
+        unsigned int modifiers = 0;
+        unsigned int vkCode = 0;
+        ParseHotkeyUsLayout(kHotkeys[i % kHotkeyCount], modifiers, vkCode);
+        Consume(modifiers + vkCode);
+    }
+}
+
+BENCHMARK(HotkeyFormat) {
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(FormatHotkey(kModifierControl | kModifierAlt, 0x70 + (unsigned int)(i % 24)).size());
+    }
+}
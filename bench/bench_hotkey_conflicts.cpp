@@ -0,0 +1,81 @@
+#include "bench.h"
+#include "config_diff.h"
+#include "fake_hotkey_registrar.h"
+#include "hotkey_conflicts.h"
+
+namespace {
+
+const int kAppCount = 300;
+
+// Bindings another program holds; every 30th app's
+const int kHeldEvery = 30;
+
+// Roughly the cost of a RegisterHotKey round trip into win32k
+const unsigned kSpinPerCall = 2000;
+
+std::vector<AppConfig> MakeApps() {
+    std::vector<AppConfig> apps;
+    for (int i = 0; i < kAppCount; i++) {
+        AppConfig app;
+        app.name = "App " + std::to_string(i);
+        app.executable = "app" + std::to_string(i) + ".exe";
+        app.hotkeyId = i + 1;
+        app.modifiers = 0x0003 | (i / 26 % 2 ? 0x0004 : 0);
+        app.vkCode = 0x41 + (i % 26) + (i / 52) * 0x100;
+        apps.push_back(app);
+    }
+    return apps;
+}
+
+void HoldEvery(FakeHotkeyRegistrar& registrar, const ConfigSnapshot& config, bool hold) {
+    for (size_t i = 0; i < config.Apps().size(); i += kHeldEvery) {
+        const AppConfig& app = config.Apps()[i];
+        if (hold) {
+            registrar.Hold(app.modifiers, app.vkCode);
+        }
+        else {
+            registrar.Release(app.modifiers, app.vkCode);
+        }
+    }
+}
+
+} // namespace
+
+// Startup with some bindings taken: register what can be, record the rest
+// and build the one notification
+BENCHMARK(HotkeyStartupPartial_300Apps) {
+    std::shared_ptr<const ConfigSnapshot> config = ConfigSnapshot::Compile(MakeApps(), Settings());
+    for (size_t i = 0; i < iterations; i++) {
+        FakeHotkeyRegistrar registrar(kSpinPerCall);
+        HoldEvery(registrar, *config, true);
+        ConfigDiff diff = DiffConfig(nullptr, config);
+        std::vector<const AppConfig*> failed = ApplyHotkeyPlan(diff.hotkeys, registrar);
+        HotkeyStatus status;
+        status.Record(diff.hotkeys, failed);
+        Consume(FormatHotkeyFailures(failed, nullptr, 5).size() + status.FailedCount());
+    }
+}
+
+// Startup with bindings held, then a reload of the unchanged file once the
+// other program let go; the reload registers only the apps that failed
+BENCHMARK(HotkeyReloadRetry_300Apps) {
+    std::shared_ptr<const ConfigSnapshot> config = ConfigSnapshot::Compile(MakeApps(), Settings());
+    FakeHotkeyRegistrar registrar(kSpinPerCall);
+    HotkeyStatus status;
+    ConfigDiff live = DiffConfig(nullptr, config);
+    for (size_t i = 0; i < iterations; i++) {
+        for (const AppConfig& app : live.config->Apps()) {
+            registrar.Unregister(app.hotkeyId);
+        }
+        HoldEvery(registrar, *live.config, true);
+        ConfigDiff start = DiffConfig(nullptr, live.config);
+        status.Clear();
+        status.Record(start.hotkeys, ApplyHotkeyPlan(start.hotkeys, registrar));
+
+        HoldEvery(registrar, *live.config, false);
+        ConfigDiff reload = DiffConfig(live.config.get(), config);
+        status.AddRetries(*reload.config, reload.hotkeys);
+        status.Record(reload.hotkeys, ApplyHotkeyPlan(reload.hotkeys, registrar));
+        Consume(status.FailedCount() + registrar.Registered());
+    }
+}
@@ -0,0 +1,71 @@
+#include "bench.h"
+#include "fake_ipc_stream.h"
+
+namespace {
+
+// Answers like the running instance would, without launching anything
+class FakeInstanceCommands : public IInstanceCommands {
+public:
+    FakeInstanceCommands() : launches(0) {}
+
+    IpcResponse Launch(const std::string& appName) override {
+        launches++;
+        return appName == "PowerShell" ? IpcResponse(true, "") : IpcResponse(false, "no app named '" + appName + "'");
+    }
+
+    IpcResponse LaunchDefault() override {
+        launches++;
+        return IpcResponse(true, "");
+    }
+
+    IpcResponse PrintContext() override {
+        return IpcResponse(true, FormatLaunchContextJson("C:\\Projects\\repo", 0x1000, 0x2000) + "\n");
+    }
+
+    IpcResponse History(size_t) override {
+        return IpcResponse(true, FormatHistoryJson(std::vector<FrecencyEntry>(), 0) + "\n");
+    }
+
+    size_t launches;
+};
+
+} // namespace
+
+// Encode, frame, dispatch and decode one --launch request
+BENCHMARK(InstanceIpcLaunchRoundTrip) {
+    FakeInstanceCommands commands;
+    IpcDispatcher dispatcher(commands);
+    IpcRequest request(IpcCommand::Launch, "PowerShell");
+
+    for (size_t i = 0; i < iterations; i++) {
+        LoopbackIpcPair connection;
+        WriteIpcMessage(connection.client, EncodeIpcRequest(request));
+        dispatcher.Serve(connection.server);
+
+        std::string payload;
+        IpcResponse response;
+        ReadIpcMessage(connection.client, payload);
+        DecodeIpcResponse(payload, response);
+        Consume(response.ok ? 1 : 0);
+    }
+    Consume(commands.launches);
+}
+
+// --print-context, including JSON formatting of the directory
+BENCHMARK(InstanceIpcPrintContextRoundTrip) {
+    FakeInstanceCommands commands;
+    IpcDispatcher dispatcher(commands);
+    IpcRequest request(IpcCommand::PrintContext, "");
+
+    for (size_t i = 0; i < iterations; i++) {
+        LoopbackIpcPair connection;
+        WriteIpcMessage(connection.client, EncodeIpcRequest(request));
+        dispatcher.Serve(connection.server);
+
+        std::string payload;
+        IpcResponse response;
+        ReadIpcMessage(connection.client, payload);
+        DecodeIpcResponse(payload, response);
+        Consume(response.body.size());
+    }
+}
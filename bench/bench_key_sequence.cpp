@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "key_sequence.h"
+#include <chrono>
+
+namespace {
+
+const size_t kSequenceCount = 300;
+const unsigned int kCtrlAlt = kModifierControl | kModifierAlt;
+
+// Ctrl+Alt+<letter>, <letter>[, <digit>]: 26 leaders with up to 26 second
+// steps each, some with a third
+std::vector<SequenceTrie::Binding> MakeBindings() {
+    std::vector<SequenceTrie::Binding> bindings;
+    for (size_t i = 0; i < kSequenceCount; i++) {
+        SequenceTrie::Binding binding;
+        binding.steps.push_back(KeyStroke(kCtrlAlt, 'A' + (unsigned int)(i % 26)));
+        binding.steps.push_back(KeyStroke(0, 'A' + (unsigned int)(i / 26 % 26)));
+        if (i % 3 == 0) {
+            binding.steps.push_back(KeyStroke(0, '0' + (unsigned int)(i % 10)));
+        }
+        binding.hotkeyId = (int)i + 1;
+        bindings.push_back(binding);
+    }
+    return bindings;
+}
+
+// Key-down/key-up pairs 30 ms apart: mostly plain typing, with a sequence
+// from the bindings every tenth word
+std::vector<KeyEvent> MakeStream(const std::vector<SequenceTrie::Binding>& bindings) {
+    std::vector<KeyEvent> events;
+    std::chrono::steady_clock::time_point at;
+    const char text[] = "the quick brown fox jumps over the lazy dog ";
+    for (size_t word = 0; word < 200; word++) {
+        if (word % 10 == 9) {
+            for (const KeyStroke& step : bindings[word % bindings.size()].steps) {
+                events.push_back(KeyEvent(step.vkCode, step.modifiers, true, at += std::chrono::milliseconds(30)));
+                events.push_back(KeyEvent(step.vkCode, 0, false, at += std::chrono::milliseconds(30)));
+            }
+            continue;
+        }
+        for (size_t i = word % 9 * 5; i < word % 9 * 5 + 5; i++) {
+            unsigned int vkCode = text[i] == ' ' ? 0x20 : (unsigned int)(text[i] - 'a' + 'A');
+            events.push_back(KeyEvent(vkCode, 0, true, at += std::chrono::milliseconds(30)));
+            events.push_back(KeyEvent(vkCode, 0, false, at += std::chrono::milliseconds(30)));
+        }
+    }
+    return events;
+}
+
+// Before a trie: each key compared against every binding's next step
+class LinearSequenceMatcher {
+public:
+    explicit LinearSequenceMatcher(const std::vector<SequenceTrie::Binding>& bindings)
+        : m_bindings(bindings), m_depth(0) {}
+
+    int OnKey(const KeyEvent& event) {
+        if (!event.down) {
+            return 0;
+        }
+        KeyStroke stroke(event.modifiers, event.vkCode);
+        for (size_t attempt = 0; attempt < 2; attempt++) {
+            for (const SequenceTrie::Binding& binding : m_bindings) {
+                if (binding.steps.size() <= m_depth || !(binding.steps[m_depth] == stroke) ||
+                    !std::equal(m_prefix.begin(), m_prefix.end(), binding.steps.begin())) {
+                    continue;
+                }
+                if (binding.steps.size() == m_depth + 1) {
+                    m_prefix.clear();
+                    m_depth = 0;
+                    return binding.hotkeyId;
+                }
+                m_prefix.push_back(stroke);
+                m_depth++;
+                return 0;
+            }
+            if (m_depth == 0) {
+                break;
+            }
+            m_prefix.clear();
+            m_depth = 0;
+        }
+        return 0;
+    }
+
+private:
+    const std::vector<SequenceTrie::Binding>& m_bindings;
+    std::vector<KeyStroke> m_prefix;
+    size_t m_depth;
+};
+
+} // namespace
+
+BENCHMARK(SequenceTrieBuild_300) {
+    std::vector<SequenceTrie::Binding> bindings = MakeBindings();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(SequenceTrie::Build(bindings, std::chrono::milliseconds(1500))->NodeCount());
+    }
+}
+
+// Per key event, as the hook would see it
+BENCHMARK(SequenceMatchLinear_300_PerEvent) {
+    std::vector<SequenceTrie::Binding> bindings = MakeBindings();
+    std::vector<KeyEvent> events = MakeStream(bindings);
+    LinearSequenceMatcher matcher(bindings);
+    for (size_t i = 0; i < iterations; i++) {
+        Consume((size_t)matcher.OnKey(events[i % events.size()]));
+    }
+}
+
+BENCHMARK(SequenceMatchTrie_300_PerEvent) {
+    std::vector<SequenceTrie::Binding> bindings = MakeBindings();
+    std::vector<KeyEvent> events = MakeStream(bindings);
+    SequenceMatcher matcher;
+    matcher.SetTrie(SequenceTrie::Build(bindings, std::chrono::milliseconds(1500)));
+
+    // The stream's clock restarts with each pass, like a new session
+    for (size_t i = 0; i < iterations; i++) {
+        if (i % events.size() == 0) {
+            matcher.SetTrie(SequenceTrie::Build(bindings, std::chrono::milliseconds(1500)));
+        }
+        int hotkeyId = 0;
+        matcher.OnKey(events[i % events.size()], hotkeyId);
+        Consume((size_t)hotkeyId);
+    }
+    Consume(matcher.GetStats().matches);
+}
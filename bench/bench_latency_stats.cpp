@@ -0,0 +1,32 @@
+#include "bench.h"
+#include "latency_stats.h"
+
+namespace {
+
+const char* const kApps[] = { "PowerShell", "Windows Terminal", "VS Code", "Git Bash" };
+
+} // namespace
+
+// Hot-path cost of recording one stage for an app that already has a slot
+BENCHMARK(LatencyRecordStage) {
+    LatencyRecorder recorder;
+    std::string apps[4] = { kApps[0], kApps[1], kApps[2], kApps[3] };
+    for (size_t i = 0; i < iterations; i++) {
+        recorder.Record(apps[i % 4], (LaunchStage)(i % (size_t)LaunchStage::Count),
+            std::chrono::microseconds((i * 2654435761u) % 200000));
+    }
+    recorder.ForEachApp([](const std::string&, const LatencyHistogram* stages) {
+        Consume((size_t)stages[(size_t)LaunchStage::Total].Count());
+    });
+}
+
+// Reading p99 out of a populated histogram
+BENCHMARK(LatencyHistogramPercentile) {
+    LatencyHistogram histogram;
+    for (uint64_t i = 0; i < 10000; i++) {
+        histogram.Record((i * 2654435761u) % 200000);
+    }
+    for (size_t i = 0; i < iterations; i++) {
+        Consume((size_t)histogram.Percentile(99));
+    }
+}
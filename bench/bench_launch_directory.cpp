@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "fake_context_provider.h"
+#include "fake_directory_probe.h"
+#include "fake_process_table.h"
+#include "launch_directory.h"
+
+namespace {
+
+// A DirectoryCache hit
+const unsigned kSpinPerQuery = 500;
+
+const WindowHandle kHoverExplorer = 0x1000;
+const WindowHandle kFocusExplorer = 0x2000;
+const WindowHandle kHoverListView = 0x1001;
+const WindowHandle kEditor = 0x3000;
+
+// Explorer windows only; the editor is claimed by nobody
+struct Desktop {
+    FakeProcessTable processes;
+    FakeContextProvider explorer;
+    ContextProviderRegistry providers;
+    FakeDirectoryProbe directories;
+    DirectoryReachability reachability;
+
+    Desktop()
+        : explorer(kSpinPerQuery), providers(processes, []() { return std::string("C:\\Users\\me"); }),
+          reachability(directories, std::chrono::seconds(30), std::chrono::seconds(10)) {
+        explorer.AddWindow(kHoverExplorer, "C:\\src\\project");
+        explorer.AddWindow(kFocusExplorer, "D:\\downloads");
+        directories.AddDirectory("C:\\src\\project");
+        directories.AddDirectory("D:\\downloads");
+        explorer.AddChild(kHoverListView, kHoverExplorer);
+        providers.Add("explorer", explorer, ContextProviderOptions());
+    }
+};
+
+} // namespace
+
+// Cursor over one Explorer window while another has focus
+BENCHMARK(LaunchDirectoryHoverAndFocus) {
+    Desktop desktop;
+    Settings settings;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kHoverExplorer, kFocusExplorer, desktop.providers, desktop.reachability, trace).size());
+    }
+}
+
+// Cursor over the file list of the focused Explorer window
+BENCHMARK(LaunchDirectorySameWindow) {
+    Desktop desktop;
+    Settings settings;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kHoverListView, kHoverExplorer, desktop.providers, desktop.reachability, trace).size());
+    }
+}
+
+// Focus wins but the focused window is not Explorer: hover is tried second
+BENCHMARK(LaunchDirectoryFocusMiss) {
+    Desktop desktop;
+    Settings settings;
+    settings.priorityWhenBothAvailable = DirectoryPriority::Focus;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kHoverExplorer, kEditor, desktop.providers, desktop.reachability, trace).size());
+    }
+}
+
+// No Explorer involved: falls back to the home directory
+BENCHMARK(LaunchDirectoryHomeFallback) {
+    Desktop desktop;
+    Settings settings;
+    LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(GetLaunchDirectory(settings, kEditor, kNoWindow, desktop.providers, desktop.reachability, trace).size());
+    }
+}
@@ -0,0 +1,112 @@
+#include "bench.h"
+#include "batch_launch.h"
+#include "config_parser.h"
+#include "fake_context_provider.h"
+#include "fake_directory_probe.h"
+#include "fake_process_table.h"
+#include "fake_spawn_backend.h"
+#include "hotkey.h"
+#include "launch_directory.h"
+
+namespace {
+
+// A DirectoryCache hit, and a GUI app's CreateProcess
+const unsigned kSpinPerQuery = 500;
+const std::chrono::microseconds kSpawnCost(2000);
+
+const WindowHandle kExplorer = 0x1000;
+
+const char kGroupConfig[] =
+    "[Apps]\n"
+    "Terminal=wt.exe|false|-w new|Ctrl+Alt+T\n"
+    "Editor=code.exe|false|.|Ctrl+Alt+E\n"
+    "Git=GitHubDesktop.exe|false||Ctrl+Alt+G\n"
+    "Server=npm.cmd|false|run dev|Ctrl+Alt+S\n"
+    "\n"
+    "[Groups]\n"
+    "Dev=Terminal, Editor(--new-window .), Git|Ctrl+Alt+D\n"
+    "Web=Server > Terminal, Editor|Ctrl+Alt+W\n";
+
+struct Workstation {
+    FakeProcessTable processes;
+    FakeContextProvider explorer;
+    ContextProviderRegistry providers;
+    FakeDirectoryProbe directories;
+    DirectoryReachability reachability;
+    FakeSpawnBackend spawner;
+    SpawnScheduler scheduler;
+    std::shared_ptr<const ConfigSnapshot> config;
+
+    Workstation()
+        : explorer(kSpinPerQuery), providers(processes, []() { return std::string("C:\\Users\\me"); }),
+          reachability(directories, std::chrono::seconds(30), std::chrono::seconds(10)),
+          spawner(kSpawnCost), scheduler(spawner, 3) {
+        explorer.AddWindow(kExplorer, "C:\\src\\project");
+        directories.AddDirectory("C:\\src\\project");
+        providers.Add("explorer", explorer, ContextProviderOptions());
+        config = ParseConfig(kGroupConfig, ParseHotkeyUsLayout).config;
+        scheduler.Start();
+    }
+
+    std::string Resolve() {
+        LaunchTrace trace(nullptr, "bench", std::chrono::steady_clock::now());
+        return GetLaunchDirectory(config->GetSettings(), kExplorer, kExplorer, providers, reachability, trace);
+    }
+
+    ArgValues ResolveValues() {
+        ArgValues values;
+        values.dir = Resolve();
+        return values;
+    }
+};
+
+} // namespace
+
+BENCHMARK(ParseGroupsConfig) {
+    for (size_t i = 0; i < iterations; i++) {
+        ConfigParseResult result = ParseConfig(kGroupConfig, ParseHotkeyUsLayout);
+        Consume(result.config->Apps().size());
+    }
+}
+
+BENCHMARK(PlanGroupLaunch_3Members) {
+    Workstation workstation;
+    const AppConfig& group = *workstation.config->FindByName("Dev");
+    ArgValues values = workstation.ResolveValues();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(PlanGroupLaunch(*workstation.config, group, values).size());
+    }
+}
+
+// Before: three hotkeys in a row, each resolving the folder and spawning
+BENCHMARK(GroupAsSeparatePresses_3Apps) {
+    Workstation workstation;
+    const char* const names[] = { "Terminal", "Editor", "Git" };
+    for (size_t i = 0; i < iterations; i++) {
+        for (const char* name : names) {
+            const AppConfig* app = workstation.config->FindByName(name);
+            std::vector<SpawnJob> jobs(1, SpawnJob(app, workstation.Resolve(), app->args));
+            Consume(workstation.scheduler.Run(jobs));
+        }
+    }
+}
+
+// One press: one resolution, members spawned side by side
+BENCHMARK(GroupPress_3Apps) {
+    Workstation workstation;
+    const AppConfig& group = *workstation.config->FindByName("Dev");
+    for (size_t i = 0; i < iterations; i++) {
+        std::vector<std::vector<SpawnJob>> stages = PlanGroupLaunch(*workstation.config, group, workstation.ResolveValues());
+        Consume(workstation.scheduler.RunInOrder(stages));
+    }
+}
+
+// The server stage starts first; the other two follow together
+BENCHMARK(GroupPressTwoStages_3Apps) {
+    Workstation workstation;
+    const AppConfig& group = *workstation.config->FindByName("Web");
+    for (size_t i = 0; i < iterations; i++) {
+        std::vector<std::vector<SpawnJob>> stages = PlanGroupLaunch(*workstation.config, group, workstation.ResolveValues());
+        Consume(workstation.scheduler.RunInOrder(stages));
+    }
+}
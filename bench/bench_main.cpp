@@ -0,0 +1,50 @@
+#include "bench.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+volatile size_t g_benchSink = 0;
+
+std::vector<Benchmark>& BenchmarkRegistry() {
+    static std::vector<Benchmark> registry;
+    return registry;
+}
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char* name, void (*body)(size_t)) {
+    BenchmarkRegistry().push_back({ name, body });
+}
+
+// Runs a benchmark with a growing iteration count until one batch takes long
+// enough to be measured reliably, then returns nanoseconds per iteration
+static double MeasureNsPerIteration(const Benchmark& bench) {
+    typedef std::chrono::steady_clock Clock;
+    const auto minBatch = std::chrono::milliseconds(100);
+
+    size_t iterations = 1;
+    for (;;) {
+        auto start = Clock::now();
+        bench.body(iterations);
+        auto elapsed = Clock::now() - start;
+
+        if (elapsed >= minBatch || iterations >= (size_t(1) << 30)) {
+            double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            return ns / (double)iterations;
+        }
+        iterations *= 2;
+    }
+}
+
+// Usage: launcher_bench [name-filter]
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    std::printf("%-48s %14s\n", "benchmark", "ns/op");
+    for (const Benchmark& bench : BenchmarkRegistry()) {
+        if (filter != nullptr && std::strstr(bench.name, filter) == nullptr) {
+            continue;
+        }
+        std::printf("%-48s %14.1f\n", bench.name, MeasureNsPerIteration(bench));
+        std::fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "palette.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+
+const size_t kCandidateCount = 50000;
+
+const char* const kWords[] = {
+    "src", "Projects", "launcher", "build", "Release", "docs", "client", "server", "tools", "scripts",
+    "PowerShell", "Terminal", "backup", "assets", "vendor", "tests", "archive", "reports", "design", "infra"
+};
+const size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+// Apps and recent folders, shaped like the palette's: "App  C:\Users\dev\..."
+std::vector<PaletteItem> MakeItems() {
+    std::vector<PaletteItem> items;
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < kCandidateCount; i++) {
+        PaletteItem item;
+        item.app = kWords[i % kWordCount];
+        item.directory = "C:\\Users\\dev";
+        for (size_t depth = 0; depth < 3 + i % 3; depth++) {
+            seed = seed * 1103515245 + 12345;
+            item.directory += "\\" + std::string(kWords[(seed >> 16) % kWordCount]) + std::to_string(seed % 97);
+        }
+        item.kind = PaletteKind::RecentDirectory;
+        item.text = item.app + "  " + item.directory;
+        item.boost = (int)(i % 33);
+        items.push_back(item);
+    }
+    return items;
+}
+
+// Keystrokes of a few queries, each typed from an empty box
+std::vector<std::string> MakeKeystrokes() {
+    const char* const queries[] = { "pslaunch", "termsrc", "bldrel", "docsdesign" };
+    std::vector<std::string> keystrokes;
+    for (const char* query : queries) {
+        std::string typed;
+        keystrokes.push_back(typed);
+        for (const char* c = query; *c != '\0'; c++) {
+            typed += *c;
+            keystrokes.push_back(typed);
+        }
+    }
+    return keystrokes;
+}
+
+bool IsSubsequence(const std::string& pattern, const std::string& text) {
+    size_t position = 0;
+    for (char c : pattern) {
+        position = text.find(c, position);
+        if (position == std::string::npos) {
+            return false;
+        }
+        position++;
+    }
+    return true;
+}
+
+// Before the index: lowercase each candidate, test it, sort every match
+size_t NaiveQuery(const std::vector<PaletteItem>& items, const std::string& query, size_t limit) {
+    std::vector<std::pair<int, size_t>> matches;
+    for (size_t i = 0; i < items.size(); i++) {
+        std::string text = items[i].text;
+        std::transform(text.begin(), text.end(), text.begin(), [](char c) {
+            return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+        });
+        if (IsSubsequence(query, text)) {
+            matches.push_back(std::make_pair(items[i].boost - (int)text.size(), i));
+        }
+    }
+    std::sort(matches.begin(), matches.end(), std::greater<std::pair<int, size_t>>());
+    return std::min(limit, matches.size());
+}
+
+} // namespace
+
+BENCHMARK(PaletteSetItems_50k) {
+    std::vector<PaletteItem> items = MakeItems();
+    PaletteSearch search;
+    for (size_t i = 0; i < iterations; i++) {
+        search.SetItems(items);
+        Consume(search.Items().size());
+    }
+}
+
+// Per keystroke, each one a full scan of the candidates
+BENCHMARK(PaletteQueryNaive_50k) {
+    std::vector<PaletteItem> items = MakeItems();
+    std::vector<std::string> keystrokes = MakeKeystrokes();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(NaiveQuery(items, keystrokes[i % keystrokes.size()], 12));
+    }
+}
+
+BENCHMARK(PaletteQueryFullScan_50k) {
+    PaletteSearch search;
+    search.SetItems(MakeItems());
+    std::vector<std::string> keystrokes = MakeKeystrokes();
+    for (size_t i = 0; i < iterations; i++) {
+        // Forgetting the previous query forces a scan of every candidate
+        search.Query("~", 12);
+        Consume(search.Query(keystrokes[i % keystrokes.size()], 12).size());
+    }
+}
+
+// Per keystroke as typed, narrowing from the previous query's matches
+BENCHMARK(PaletteQueryTyping_50k) {
+    PaletteSearch search;
+    search.SetItems(MakeItems());
+    std::vector<std::string> keystrokes = MakeKeystrokes();
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(search.Query(keystrokes[i % keystrokes.size()], 12).size());
+    }
+}
+
+BENCHMARK(FrecencyRecord) {
+    FrecencyTable table;
+    for (size_t i = 0; i < iterations; i++) {
+        table.Record(kWords[i % kWordCount], "C:\\src\\" + std::to_string(i % 3000), (int64_t)i);
+    }
+    Consume(table.Size());
+}
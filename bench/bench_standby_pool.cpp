@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "fake_process_backend.h"
+
+namespace {
+
+// Roughly what PowerShell takes to become interactive, scaled down 100x
+const std::chrono::microseconds kShellStartCost(3000);
+
+const StandbySpec kPowerShell = { "PowerShell", "powershell.exe", "" };
+
+void WaitUntilReady(const StandbyPool& pool, size_t count) {
+    while (pool.ReadyCount() < count) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace
+
+// Baseline: every press pays the shell's start-up
+BENCHMARK(StandbyColdStart) {
+    FakeProcessBackend backend(kShellStartCost);
+    for (size_t i = 0; i < iterations; i++) {
+        StandbyProcess process = backend.StartHidden(kPowerShell);
+        Consume(backend.Reveal(process, kPowerShell, "C:\\Projects\\repo") ? 1 : 0);
+    }
+}
+
+// Press with a standby ready: the press only pays for the hand-off. The
+// fake's start is free here so the loop is not dominated by replenishing,
+// which happens between presses in real use.
+BENCHMARK(StandbyWarmHandoff) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, std::chrono::minutes(30));
+    pool.Configure(std::vector<StandbySpec>(1, kPowerShell));
+    pool.Start();
+
+    for (size_t i = 0; i < iterations; i++) {
+        WaitUntilReady(pool, 1);
+        Consume(pool.TryActivate(kPowerShell.appName, "C:\\Projects\\repo") ? 1 : 0);
+    }
+    pool.Stop();
+}
+
+// Config reload that leaves the prewarmed app untouched must not restart it
+BENCHMARK(StandbyConfigureUnchanged) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, std::chrono::minutes(30));
+    std::vector<StandbySpec> specs(1, kPowerShell);
+    pool.Configure(specs);
+    pool.Start();
+    WaitUntilReady(pool, 1);
+
+    for (size_t i = 0; i < iterations; i++) {
+        pool.Configure(specs);
+    }
+    pool.Stop();
+    Consume(backend.Starts());
+}
@@ -0,0 +1,81 @@
+#include "bench.h"
+#include "startup_profile.h"
+
+namespace {
+
+// Stand-ins for CoInitialize and subscribing to shell window events, which
+// cost milliseconds on a cold logon
+const unsigned kComSpin = 200000;
+const unsigned kShellEventsSpin = 400000;
+
+void Spin(unsigned count) {
+    volatile unsigned counter = 0;
+    for (unsigned i = 0; i < count; i++) {
+        counter = counter + 1;
+    }
+}
+
+struct Components {
+    LazyComponents lazy;
+    int com;
+    int shellEvents;
+
+    Components() {
+        com = lazy.Add("COM", []() {
+            Spin(kComSpin);
+            return true;
+        }, []() {}, {});
+        shellEvents = lazy.Add("shell window events", []() {
+            Spin(kShellEventsSpin);
+            return true;
+        }, []() {}, { com });
+    }
+};
+
+const char* const kPhases[] = { "config path", "first run and instance checks", "config load", "windows",
+    "hotkeys", "tray icon", "history", "shell window events", "workers and watchers" };
+
+} // namespace
+
+// Previous --create-config run: COM came up before the config was written,
+// though nothing in that path uses it
+BENCHMARK(StartupEagerCom_CreateConfig) {
+    for (size_t i = 0; i < iterations; i++) {
+        Components components;
+        components.lazy.Ensure(components.com);
+        components.lazy.Shutdown();
+        Consume(components.lazy.Starts().size());
+    }
+}
+
+// Lazy start: nothing asks for COM, so it never starts
+BENCHMARK(StartupLazyCom_CreateConfig) {
+    for (size_t i = 0; i < iterations; i++) {
+        Components components;
+        components.lazy.Shutdown();
+        Consume(components.lazy.Starts().size());
+    }
+}
+
+// EnsureCOM on a path that runs after COM is up
+BENCHMARK(LazyComponentsEnsureStarted) {
+    Components components;
+    components.lazy.Ensure(components.shellEvents);
+    for (size_t i = 0; i < iterations; i++) {
+        Consume(components.lazy.Ensure(components.com) ? 1 : 0);
+    }
+}
+
+// What the profile adds to every start: the marks and the report
+BENCHMARK(StartupProfileMarkAndFormat) {
+    Components components;
+    components.lazy.Ensure(components.com);
+    for (size_t i = 0; i < iterations; i++) {
+        PhaseTimer timer(PhaseTimer::Clock::now());
+        timer.AddLeadIn("process start", std::chrono::milliseconds(12));
+        for (const char* phase : kPhases) {
+            timer.Mark(phase);
+        }
+        Consume(FormatStartupProfile(timer, components.lazy).size());
+    }
+}
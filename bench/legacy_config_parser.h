@@ -0,0 +1,63 @@
+#pragma once
+#include "config.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The getline/stringstream parser LoadConfig used before the single-pass
+// reader, kept as a baseline for the parser benchmark.
+template <class HotkeyFn>
+std::vector<AppConfig> LegacyParseConfig(const std::string& text, HotkeyFn parseHotkey) {
+    auto trim = [](const std::string& str) -> std::string {
+        size_t first = str.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return "";
+        size_t last = str.find_last_not_of(" \t\r\n");
+        return str.substr(first, last - first + 1);
+    };
+
+    std::vector<AppConfig> apps;
+    std::istringstream file(text);
+    std::string line;
+    std::string currentSection;
+    int hotkeyCounter = 1;
+
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[' && line[line.length() - 1] == ']') {
+            currentSection = trim(line.substr(1, line.length() - 2));
+            continue;
+        }
+
+        size_t equalsPos = line.find('=');
+        if (equalsPos == std::string::npos || currentSection != "Apps") {
+            continue;
+        }
+
+        std::string key = trim(line.substr(0, equalsPos));
+        std::string value = trim(line.substr(equalsPos + 1));
+
+        std::vector<std::string> parts;
+        std::stringstream ss(value);
+        std::string part;
+        while (std::getline(ss, part, '|')) {
+            parts.push_back(trim(part));
+        }
+
+        if (parts.size() >= 4) {
+            AppConfig config;
+            config.name = key;
+            config.executable = parts[0];
+            config.runAsAdmin = (parts[1] == "true" || parts[1] == "1");
+            config.args = parts[2];
+            config.enabled = parts.size() >= 5 ? (parts[4] == "true" || parts[4] == "1") : true;
+            if (parseHotkey(parts[3], config.modifiers, config.vkCode)) {
+                config.hotkeyId = hotkeyCounter++;
+                apps.push_back(config);
+            }
+        }
+    }
+    return apps;
+}
@@ -64,7 +64,8 @@ exit /b 1
 echo.
 REM Compile
 echo Compiling launcher.cpp...
-cl /EHsc /O2 /Fe:context-launcher.exe launcher.cpp ole32.lib oleaut32.lib shlwapi.lib shell32.lib user32.lib
+REM COM and shell libraries are delay-loaded; see CMakeLists.txt
+cl /EHsc /O2 /std:c++17 /Icore /Iwin32 /Fe:context-launcher.exe launcher.cpp core\*.cpp win32\*.cpp advapi32.lib gdi32.lib ole32.lib oleaut32.lib shlwapi.lib shell32.lib user32.lib uuid.lib delayimp.lib /link /DELAYLOAD:ole32.dll /DELAYLOAD:oleaut32.dll /DELAYLOAD:shell32.dll /DELAYLOAD:shlwapi.dll
 
 if %errorlevel% equ 0 (
     echo.
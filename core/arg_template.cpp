@@ -0,0 +1,188 @@
+#include "arg_template.h"
+#include "command_line.h"
+
+namespace {
+
+bool ParseField(std::string_view name, ArgField& field) {
+    if (name == "dir") {
+        field = ArgField::Dir;
+    }
+    else if (name == "item") {
+        field = ArgField::Item;
+    }
+    else if (name == "title") {
+        field = ArgField::Title;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool IsWord(std::string_view text) {
+    if (text.empty()) {
+        return false;
+    }
+    for (char c : text) {
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsBlank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const std::string& FieldValue(const ArgValues& values, ArgField field) {
+    switch (field) {
+    case ArgField::Dir:
+        return values.dir;
+    case ArgField::Item:
+        return values.item;
+    default:
+        return values.title;
+    }
+}
+
+// Length of the brace escape or placeholder at text[i], 0 if there is none
+size_t MatchBrace(std::string_view text, size_t i, ArgField& field, bool& placeholder) {
+    placeholder = false;
+    if (i + 1 < text.size() && (text[i] == '{' || text[i] == '}') && text[i + 1] == text[i]) {
+        return 2;
+    }
+    size_t close = text[i] == '{' ? text.find('}', i + 1) : std::string_view::npos;
+    if (close != std::string_view::npos && ParseField(text.substr(i + 1, close - i - 1), field)) {
+        placeholder = true;
+        return close - i + 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+ArgTemplate ArgTemplate::Compile(std::string_view text, std::vector<size_t>* unknown) {
+    ArgTemplate compiled;
+    compiled.m_segments.emplace_back();
+    size_t i = 0;
+    while (i < text.size()) {
+        if (IsBlank(text[i])) {
+            compiled.m_segments.back().raw += text[i++];
+            continue;
+        }
+
+        // One argument, decoded as CommandLineToArgvW would into parts
+        size_t start = i;
+        std::vector<Part> parts(1, Part { false, ArgField::Dir, std::string() });
+        bool inQuotes = false;
+        while (i < text.size() && (inQuotes || !IsBlank(text[i]))) {
+            char c = text[i];
+            ArgField field = ArgField::Dir;
+            bool placeholder = false;
+            size_t length = (c == '{' || c == '}') ? MatchBrace(text, i, field, placeholder) : 0;
+            if (placeholder) {
+                parts.push_back(Part { true, field, std::string() });
+                parts.push_back(Part { false, ArgField::Dir, std::string() });
+                compiled.m_fields |= 1u << (unsigned)field;
+                i += length;
+                continue;
+            }
+            if (length == 2) {
+                parts.back().text += c;
+                i += 2;
+                continue;
+            }
+            if (unknown != nullptr && c == '{') {
+                size_t close = text.find('}', i + 1);
+                if (close != std::string_view::npos && IsWord(text.substr(i + 1, close - i - 1))) {
+                    unknown->push_back(i);
+                }
+            }
+
+            if (c == '\\') {
+                size_t count = 0;
+                while (i < text.size() && text[i] == '\\') {
+                    count++;
+                    i++;
+                }
+                bool quote = i < text.size() && text[i] == '"';
+                parts.back().text.append(quote ? count / 2 : count, '\\');
+                if (quote && count % 2 == 1) {
+                    parts.back().text += '"';
+                    i++;
+                }
+                continue;
+            }
+            if (c == '"') {
+                // "" inside quotes is a literal quote
+                if (inQuotes && i + 1 < text.size() && text[i + 1] == '"') {
+                    parts.back().text += '"';
+                    i += 2;
+                    continue;
+                }
+                inQuotes = !inQuotes;
+                i++;
+                continue;
+            }
+            parts.back().text += c;
+            i++;
+        }
+
+        if (parts.size() == 1) {
+            // No placeholders: as written, but with brace escapes collapsed
+            std::string_view written = text.substr(start, i - start);
+            for (size_t j = 0; j < written.size(); j++) {
+                compiled.m_segments.back().raw += written[j];
+                if ((written[j] == '{' || written[j] == '}') && j + 1 < written.size() && written[j + 1] == written[j]) {
+                    j++;
+                }
+            }
+            continue;
+        }
+
+        compiled.m_segments.back().parts = std::move(parts);
+        compiled.m_segments.emplace_back();
+    }
+
+    for (const Segment& segment : compiled.m_segments) {
+        compiled.m_length += segment.raw.size();
+        for (const Part& part : segment.parts) {
+            compiled.m_length += part.text.size();
+        }
+    }
+    return compiled;
+}
+
+std::string ArgTemplate::Expand(const ArgValues& values) const {
+    // Quoting adds two quotes per argument and an escape per quote or
+    // backslash; a little slack covers the common case in one allocation
+    size_t valueLength = values.dir.size() + values.item.size() + values.title.size();
+    std::string out;
+    out.reserve(m_length + valueLength * 2 + 16);
+    std::string argument;
+    argument.reserve(out.capacity());
+    for (const Segment& segment : m_segments) {
+        out += segment.raw;
+        if (segment.parts.empty()) {
+            continue;
+        }
+        argument.clear();
+        for (const Part& part : segment.parts) {
+            argument += part.placeholder ? FieldValue(values, part.field) : part.text;
+        }
+        if (NeedsQuoting(argument)) {
+            out += '"';
+            AppendQuotedContent(out, argument, true);
+            out += '"';
+        }
+        else {
+            out += argument;
+        }
+    }
+    return out;
+}
+
+std::string ExpandArgs(const std::string& args, const ArgTemplate& compiled, const ArgValues& values) {
+    return compiled.IsCompiled() ? compiled.Expand(values) : args;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Values an args template can refer to, gathered once per launch
+struct ArgValues {
+    std::string dir;    // {dir}: the directory the app starts in
+    std::string item;   // {item}: the selected item the launch is for
+    std::string title;  // {title}: title of the foreground window at the press
+};
+
+enum class ArgField {
+    Dir,
+    Item,
+    Title
+};
+
+// An args field compiled into command-line arguments, so a launch only
+// concatenates. The field is split the way CommandLineToArgvW splits it;
+// arguments without placeholders are copied as written, and each one with
+// placeholders is rebuilt from its text and values and quoted as a whole,
+// so "C:\My Dir\" or a title with quotes always arrives as one argument.
+// "{{" and "}}" stand for literal braces; any other brace text
+// ("& {Get-Date}") is kept as written.
+class ArgTemplate {
+public:
+    ArgTemplate() : m_length(0), m_fields(0) {}
+
+    // unknown, if given, receives the offset of each "{word}" that looks
+    // like a misspelt placeholder, e.g. for a config diagnostic
+    static ArgTemplate Compile(std::string_view text, std::vector<size_t>* unknown = nullptr);
+
+    // False for a default-constructed template
+    bool IsCompiled() const {
+        return !m_segments.empty();
+    }
+
+    bool HasPlaceholders() const {
+        return m_fields != 0;
+    }
+
+    bool Uses(ArgField field) const {
+        return (m_fields & (1u << (unsigned)field)) != 0;
+    }
+
+    std::string Expand(const ArgValues& values) const;
+
+private:
+    // Argument text between placeholders, or one placeholder
+    struct Part {
+        bool placeholder;
+        ArgField field;
+        std::string text;  // Unquoted text, as the app will see it
+    };
+
+    // Text copied as is, followed by an argument to build (if parts is set)
+    struct Segment {
+        std::string raw;
+        std::vector<Part> parts;
+    };
+
+    std::vector<Segment> m_segments;
+    size_t m_length;    // Raw and argument text, without values
+    unsigned m_fields;  // Bit per ArgField used
+};
+
+// The args a launch passes: the compiled template expanded, or args as
+// they are if they were never compiled (AppConfigs not built by the parser)
+std::string ExpandArgs(const std::string& args, const ArgTemplate& compiled, const ArgValues& values);
@@ -0,0 +1,194 @@
+#include "batch_launch.h"
+#include "command_line.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace {
+
+std::string ToLower(std::string text) {
+    for (char& c : text) {
+        c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    return text;
+}
+
+} // namespace
+
+std::vector<SpawnJob> ExpandSelection(const AppConfig& app, const ArgValues& values,
+    const std::vector<SelectedItem>& selection, size_t maxFanOut, size_t* skipped) {
+    std::vector<SpawnJob> jobs;
+    size_t left = 0;
+
+    if (app.selection == SelectionMode::PerFolder) {
+        std::unordered_set<std::string> seen;
+        for (const SelectedItem& item : selection) {
+            // Paths compare case-insensitively
+            if (!item.folder || item.path.empty() || !seen.insert(ToLower(item.path)).second) {
+                continue;
+            }
+            if (jobs.size() < maxFanOut) {
+                ArgValues folderValues = values;
+                folderValues.dir = item.path;
+                folderValues.item = item.path;
+                jobs.push_back(SpawnJob(&app, item.path, ExpandArgs(app.args, app.argsTemplate, folderValues)));
+            }
+            else {
+                left++;
+            }
+        }
+    }
+    else if (app.selection == SelectionMode::AllItems && !selection.empty()) {
+        ArgValues itemValues = values;
+        itemValues.item = selection.front().path;
+        SpawnJob job(&app, values.dir, ExpandArgs(app.args, app.argsTemplate, itemValues));
+        for (const SelectedItem& item : selection) {
+            std::string quoted = QuoteArgument(item.path);
+            size_t separator = job.args.empty() ? 0 : 1;
+            if (item.path.empty() || job.args.size() + separator + quoted.size() > kMaxBatchArgsLength) {
+                left++;
+                continue;
+            }
+            if (separator != 0) {
+                job.args += ' ';
+            }
+            job.args += quoted;
+        }
+        if (left < selection.size()) {
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    if (skipped != nullptr) {
+        *skipped = left;
+    }
+    return jobs;
+}
+
+std::vector<std::vector<SpawnJob>> PlanGroupLaunch(const ConfigSnapshot& config, const AppConfig& group,
+    const ArgValues& values) {
+    std::vector<std::vector<SpawnJob>> stages;
+    int lastStage = -1;
+    for (const GroupMember& member : group.members) {
+        const AppConfig* app = config.FindByName(member.app);
+        if (app == nullptr || !app->members.empty()) {
+            continue;
+        }
+        // Members are listed in stage order
+        if (member.stage != lastStage) {
+            stages.emplace_back();
+            lastStage = member.stage;
+        }
+        std::string args = member.hasArgs ? ExpandArgs(member.args, member.argsTemplate, values) :
+            ExpandArgs(app->args, app->argsTemplate, values);
+        stages.back().push_back(SpawnJob(app, values.dir, std::move(args)));
+    }
+    return stages;
+}
+
+SpawnScheduler::SpawnScheduler(ISpawnBackend& backend, size_t workerCount)
+    : m_backend(backend), m_workerCount(workerCount), m_stopping(false) {
+}
+
+SpawnScheduler::~SpawnScheduler() {
+    Stop();
+}
+
+void SpawnScheduler::Start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_workers.empty()) {
+        return;
+    }
+    m_stopping = false;
+    for (size_t i = 0; i < m_workerCount; i++) {
+        m_workers.emplace_back(&SpawnScheduler::WorkerLoop, this);
+    }
+}
+
+void SpawnScheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+size_t SpawnScheduler::Run(const std::vector<SpawnJob>& jobs) {
+    if (jobs.empty()) {
+        return 0;
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>(&jobs);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stats.batches++;
+    if (jobs.size() > 1 && !m_workers.empty() && !m_stopping) {
+        m_batches.push_back(batch);
+        m_wake.notify_all();
+    }
+
+    while (batch->next < jobs.size()) {
+        RunNextLocked(batch, lock);
+    }
+    m_done.wait(lock, [&batch, &jobs] { return batch->finished == jobs.size(); });
+    return batch->started;
+}
+
+size_t SpawnScheduler::RunInOrder(const std::vector<std::vector<SpawnJob>>& batches) {
+    size_t started = 0;
+    for (const std::vector<SpawnJob>& jobs : batches) {
+        started += Run(jobs);
+    }
+    return started;
+}
+
+SpawnScheduler::Stats SpawnScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void SpawnScheduler::RunNextLocked(const std::shared_ptr<Batch>& batch, std::unique_lock<std::mutex>& lock) {
+    size_t index = batch->next++;
+    if (batch->next == batch->jobs->size()) {
+        auto it = std::find(m_batches.begin(), m_batches.end(), batch);
+        if (it != m_batches.end()) {
+            m_batches.erase(it);
+        }
+    }
+
+    lock.unlock();
+    bool started = m_backend.Spawn((*batch->jobs)[index]);
+    lock.lock();
+
+    m_stats.spawns++;
+    if (started) {
+        batch->started++;
+    }
+    else {
+        m_stats.failures++;
+    }
+    if (++batch->finished == batch->jobs->size()) {
+        m_done.notify_all();
+    }
+}
+
+void SpawnScheduler::WorkerLoop() {
+    m_backend.OnWorkerStarted();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_batches.empty(); });
+        if (m_stopping) {
+            break;
+        }
+        // A copy: RunNextLocked may drop the batch from the queue
+        std::shared_ptr<Batch> batch = m_batches.front();
+        RunNextLocked(batch, lock);
+    }
+    lock.unlock();
+
+    m_backend.OnWorkerStopped();
+}
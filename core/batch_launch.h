@@ -0,0 +1,115 @@
+#pragma once
+#include "config.h"
+#include "shell_window_provider.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CreateProcess takes at most 32767 characters, executable included
+const size_t kMaxBatchArgsLength = 32000;
+
+// One process of a batch launch
+struct SpawnJob {
+    const AppConfig* app;  // Points into the snapshot the launch holds
+    std::string directory;
+    std::string args;      // Complete argument string, the app's own args included
+
+    SpawnJob() : app(nullptr) {}
+    SpawnJob(const AppConfig* a, const std::string& d, const std::string& r) : app(a), directory(d), args(r) {}
+};
+
+// The launches a perFolder or allItems app makes for a selection:
+//  - PerFolder: one job per distinct selected folder, in selection order,
+//    at most maxFanOut; files in the selection are ignored. {dir} and
+//    {item} are the job's folder.
+//  - AllItems: a single job in values.dir with every selected path quoted
+//    after the app's args, as many as fit in kMaxBatchArgsLength. {item}
+//    is the first selected path.
+// Empty when the mode is None or the selection has nothing it applies to,
+// so the caller launches once as usual. skipped, if given, counts the
+// selected items that were left out for the caps.
+std::vector<SpawnJob> ExpandSelection(const AppConfig& app, const ArgValues& values,
+    const std::vector<SelectedItem>& selection, size_t maxFanOut, size_t* skipped = nullptr);
+
+// Spawn plan for a [Groups] press: one batch per stage, in stage order,
+// every member starting in the directory resolved once for the press
+// (values.dir) and expanding its args from the same values. Members whose
+// app is no longer in config are left out, as are stages left with no
+// members.
+std::vector<std::vector<SpawnJob>> PlanGroupLaunch(const ConfigSnapshot& config, const AppConfig& group,
+    const ArgValues& values);
+
+// Starts processes for the scheduler's workers. On Windows this is
+// CreateProcess/ShellExecute; elsewhere a fake.
+class ISpawnBackend {
+public:
+    virtual ~ISpawnBackend() {}
+
+    // Called once on each worker thread, e.g. to enter a COM apartment
+    virtual void OnWorkerStarted() {}
+    virtual void OnWorkerStopped() {}
+
+    virtual bool Spawn(const SpawnJob& job) = 0;
+};
+
+// Runs the jobs of a batch side by side instead of one blocking spawn after
+// another. The calling thread takes jobs as well, so a batch always makes
+// progress, and several batches (one per launch worker) share the pool.
+class SpawnScheduler {
+public:
+    struct Stats {
+        uint64_t batches;
+        uint64_t spawns;
+        uint64_t failures;
+
+        Stats() : batches(0), spawns(0), failures(0) {}
+    };
+
+    SpawnScheduler(ISpawnBackend& backend, size_t workerCount);
+    ~SpawnScheduler();
+
+    void Start();
+
+    // Workers finish the job in hand; callers run whatever is left
+    void Stop();
+
+    // Blocks until every job has been tried and returns how many started.
+    // Before Start (or after Stop) the caller runs the jobs one by one.
+    size_t Run(const std::vector<SpawnJob>& jobs);
+
+    // Runs batches one after another, e.g. the stages of a group, so each
+    // starts only once the one before it has. Returns how many started.
+    size_t RunInOrder(const std::vector<std::vector<SpawnJob>>& batches);
+
+    Stats GetStats() const;
+
+private:
+    struct Batch {
+        const std::vector<SpawnJob>* jobs;
+        size_t next;      // First job nobody has taken
+        size_t finished;
+        size_t started;
+
+        explicit Batch(const std::vector<SpawnJob>* j) : jobs(j), next(0), finished(0), started(0) {}
+    };
+
+    // Takes the batch's next job and runs it with the lock released
+    void RunNextLocked(const std::shared_ptr<Batch>& batch, std::unique_lock<std::mutex>& lock);
+    void WorkerLoop();
+
+    ISpawnBackend& m_backend;
+    size_t m_workerCount;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::deque<std::shared_ptr<Batch>> m_batches;  // Batches with jobs left to take
+    std::vector<std::thread> m_workers;
+    bool m_stopping;
+    Stats m_stats;
+};
@@ -0,0 +1,101 @@
+#include "command_line.h"
+
+std::string QuoteArgument(const std::string& argument) {
+    if (!NeedsQuoting(argument)) {
+        return argument;
+    }
+
+    std::string quoted = "\"";
+    AppendQuotedContent(quoted, argument, true);
+    quoted += '"';
+    return quoted;
+}
+
+bool NeedsQuoting(const std::string& argument) {
+    if (argument.empty()) {
+        return true;
+    }
+    for (char c : argument) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '"') {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AppendQuotedContent(std::string& out, const std::string& text, bool closingQuoteFollows) {
+    size_t start = 0;
+    for (;;) {
+        // Copy up to the next backslash or quote in one go
+        size_t special = start;
+        while (special < text.size() && text[special] != '\\' && text[special] != '"') {
+            special++;
+        }
+        out.append(text, start, special - start);
+        if (special == text.size()) {
+            return;
+        }
+
+        // Backslashes are literal unless a quote follows them
+        size_t end = text.find_first_not_of('\\', special);
+        size_t backslashes = (end == std::string::npos ? text.size() : end) - special;
+        if (end == std::string::npos) {
+            out.append(closingQuoteFollows ? backslashes * 2 : backslashes, '\\');
+            return;
+        }
+        if (text[end] == '"') {
+            out.append(backslashes * 2 + 1, '\\');
+            out += '"';
+            start = end + 1;
+        }
+        else {
+            out.append(backslashes, '\\');
+            start = end;
+        }
+    }
+}
+
+std::vector<std::string> SplitCommandLine(const std::string& commandLine) {
+    std::vector<std::string> arguments;
+    size_t i = 0;
+    for (;;) {
+        while (i < commandLine.size() && (commandLine[i] == ' ' || commandLine[i] == '\t')) {
+            i++;
+        }
+        if (i == commandLine.size()) {
+            return arguments;
+        }
+
+        // A quoted empty string is still an argument
+        std::string argument;
+        bool inQuotes = false;
+        while (i < commandLine.size() && (inQuotes || (commandLine[i] != ' ' && commandLine[i] != '\t'))) {
+            char c = commandLine[i];
+            if (c == '\\') {
+                size_t end = commandLine.find_first_not_of('\\', i);
+                size_t count = (end == std::string::npos ? commandLine.size() : end) - i;
+                i += count;
+                bool quote = i < commandLine.size() && commandLine[i] == '"';
+                argument.append(quote ? count / 2 : count, '\\');
+                if (quote && count % 2 == 1) {
+                    argument += '"';
+                    i++;
+                }
+                continue;
+            }
+            if (c == '"') {
+                if (inQuotes && i + 1 < commandLine.size() && commandLine[i + 1] == '"') {
+                    argument += '"';
+                    i += 2;
+                    continue;
+                }
+                inQuotes = !inQuotes;
+                i++;
+                continue;
+            }
+            argument += c;
+            i++;
+        }
+        arguments.push_back(std::move(argument));
+    }
+}
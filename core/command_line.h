@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Quotes one argument so that CommandLineToArgvW and the MSVC runtime parse
+// it back unchanged: spaces and quotes are enclosed, and backslashes are
+// doubled only where they precede a quote, so "C:\My Dir\" survives.
+// Plain arguments are returned as they are.
+std::string QuoteArgument(const std::string& argument);
+
+// Whether QuoteArgument has to enclose argument: it is empty or contains
+// whitespace or quotes
+bool NeedsQuoting(const std::string& argument);
+
+// Appends text for use between quotes the command line already has, e.g.
+// the path in "--cwd=<path>". closingQuoteFollows says whether the next
+// character written is the closing quote, which trailing backslashes must
+// not escape.
+void AppendQuotedContent(std::string& out, const std::string& text, bool closingQuoteFollows);
+
+// Splits arguments the way CommandLineToArgvW splits everything after the
+// program name: spaces and tabs separate arguments outside quotes, 2n
+// backslashes before a quote become n and the quote opens or closes
+// quoting, 2n+1 become n and a literal quote, other backslashes are
+// literal, and "" inside quotes is a literal quote. The inverse of
+// QuoteArgument for arguments joined with spaces.
+std::vector<std::string> SplitCommandLine(const std::string& commandLine);
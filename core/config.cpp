@@ -0,0 +1,136 @@
+#include "config.h"
+#include <algorithm>
+
+const char* DirectoryPriorityName(DirectoryPriority priority) {
+    return priority == DirectoryPriority::Focus ? "focus" : "hover";
+}
+
+std::vector<std::string> DefaultContextProviders() {
+    return { "explorer", "terminal", "editor", "desktop" };
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::Compile(std::vector<AppConfig> apps, const Settings& settings,
+    std::vector<AppConfig> contextApps) {
+    std::shared_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot());
+    snapshot->m_settings = settings;
+
+    // Sort indices rather than whole entries; ties keep file order so the
+    // last definition of a duplicated name wins below
+    std::vector<size_t> order(apps.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&apps](size_t a, size_t b) {
+        int compare = apps[a].name.compare(apps[b].name);
+        return compare != 0 ? compare < 0 : a < b;
+    });
+
+    snapshot->m_apps.reserve(apps.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i + 1 < order.size() && apps[order[i + 1]].name == apps[order[i]].name) {
+            continue;
+        }
+        snapshot->m_apps.push_back(std::move(apps[order[i]]));
+    }
+
+    snapshot->BuildIndex();
+
+    // Variants sorted by (app, image), again keeping the last duplicate
+    std::vector<std::pair<size_t, size_t>> variants;  // (app index, position in contextApps)
+    variants.reserve(contextApps.size());
+    for (size_t i = 0; i < contextApps.size(); i++) {
+        const AppConfig* app = snapshot->FindByName(contextApps[i].name);
+        if (app != nullptr) {
+            variants.push_back(std::make_pair(snapshot->IndexOf(*app), i));
+        }
+    }
+    std::sort(variants.begin(), variants.end(), [&contextApps](const std::pair<size_t, size_t>& a,
+        const std::pair<size_t, size_t>& b) {
+        if (a.first != b.first) {
+            return a.first < b.first;
+        }
+        int compare = contextApps[a.second].contextImage.compare(contextApps[b.second].contextImage);
+        return compare != 0 ? compare < 0 : a.second < b.second;
+    });
+
+    snapshot->m_contextRanges.assign(snapshot->m_apps.size(), std::make_pair((size_t)0, (size_t)0));
+    for (size_t i = 0; i < variants.size(); i++) {
+        if (i + 1 < variants.size() && variants[i + 1].first == variants[i].first &&
+            contextApps[variants[i + 1].second].contextImage == contextApps[variants[i].second].contextImage) {
+            continue;
+        }
+        std::pair<size_t, size_t>& range = snapshot->m_contextRanges[variants[i].first];
+        if (range.first == range.second) {
+            range.first = snapshot->m_contextApps.size();
+        }
+        snapshot->m_contextApps.push_back(std::move(contextApps[variants[i].second]));
+        range.second = snapshot->m_contextApps.size();
+    }
+
+    return snapshot;
+}
+
+const AppConfig* ConfigSnapshot::SelectContext(const AppConfig& app, const std::string& image) const {
+    size_t index = IndexOf(app);
+    if (image.empty() || index >= m_contextRanges.size()) {
+        return &app;
+    }
+    // A handful of variants per app at most; a linear scan beats a lookup structure
+    const std::pair<size_t, size_t>& range = m_contextRanges[index];
+    for (size_t i = range.first; i < range.second; i++) {
+        if (m_contextApps[i].contextImage == image) {
+            return &m_contextApps[i];
+        }
+    }
+    return &app;
+}
+
+void ConfigSnapshot::BuildIndex() {
+    int maxId = 0;
+    for (const AppConfig& app : m_apps) {
+        maxId = std::max(maxId, app.hotkeyId);
+    }
+
+    m_hotkeyIndex.assign(maxId + 1, -1);
+    for (size_t i = 0; i < m_apps.size(); i++) {
+        if (m_apps[i].hotkeyId > 0) {
+            m_hotkeyIndex[m_apps[i].hotkeyId] = (int)i;
+        }
+    }
+}
+
+const AppConfig* ConfigSnapshot::FindByName(const std::string& name) const {
+    auto it = std::lower_bound(m_apps.begin(), m_apps.end(), name, [](const AppConfig& app, const std::string& value) {
+        return app.name < value;
+    });
+    if (it == m_apps.end() || it->name != name) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::WithAppEnabled(int index, bool enabled) const {
+    std::shared_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot(*this));
+    if (index >= 0 && (size_t)index < snapshot->m_apps.size()) {
+        snapshot->m_apps[index].enabled = enabled;
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::WithHotkeyIds(const std::vector<int>& hotkeyIds) const {
+    std::shared_ptr<ConfigSnapshot> snapshot(new ConfigSnapshot(*this));
+    for (size_t i = 0; i < snapshot->m_apps.size() && i < hotkeyIds.size(); i++) {
+        snapshot->m_apps[i].hotkeyId = hotkeyIds[i];
+    }
+
+    // Variants launch under their app's id, which the launch queue
+    // coalesces on
+    for (size_t i = 0; i < snapshot->m_contextRanges.size(); i++) {
+        const std::pair<size_t, size_t>& range = snapshot->m_contextRanges[i];
+        for (size_t j = range.first; j < range.second; j++) {
+            snapshot->m_contextApps[j].hotkeyId = snapshot->m_apps[i].hotkeyId;
+        }
+    }
+    snapshot->BuildIndex();
+    return snapshot;
+}
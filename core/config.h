@@ -0,0 +1,166 @@
+#pragma once
+#include "arg_template.h"
+#include "hotkey.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// What a press does with the items selected in Explorer
+enum class SelectionMode {
+    None,       // Launch once in the folder, ignoring the selection
+    PerFolder,  // Launch once in each selected folder ("perFolder" option)
+    AllItems    // Launch once with the selected paths as arguments ("allItems" option)
+};
+
+// One app of a [Groups] entry
+struct GroupMember {
+    std::string app;   // Name of an [Apps] entry
+    std::string args;  // Replaces the app's args if hasArgs
+    ArgTemplate argsTemplate;
+    bool hasArgs;
+    int stage;         // Members of a stage start together, once the stage before has started
+
+    GroupMember() : hasArgs(false), stage(0) {}
+};
+
+// Structure to hold application configuration
+struct AppConfig {
+    std::string name;
+    std::string executable;
+    bool runAsAdmin;
+    std::string args;
+    ArgTemplate argsTemplate;  // args compiled by the parser; see ExpandArgs
+    int hotkeyId;
+    unsigned int modifiers;  // MOD_* flags
+    unsigned int vkCode;     // Virtual key code
+    std::vector<KeyStroke> sequence;  // All steps of a sequence hotkey ("Ctrl+Alt+L, P"); empty for a plain one
+    bool enabled;  // Whether this app is currently active
+    bool prewarm;  // Keep a hidden instance started ("prewarm" option)
+    std::string contextImage;  // Lowercase foreground image of a [Contexts] variant; empty otherwise
+    SelectionMode selection;
+    std::vector<GroupMember> members;  // Set for a [Groups] entry, which launches these instead of executable
+
+    AppConfig() : runAsAdmin(false), hotkeyId(0), modifiers(0), vkCode(0), enabled(true), prewarm(false),
+        selection(SelectionMode::None) {}
+};
+
+// Which window wins when both hover and focus yield a directory
+enum class DirectoryPriority {
+    Hover,
+    Focus
+};
+
+const char* DirectoryPriorityName(DirectoryPriority priority);
+
+// Built-in context providers in their default order
+std::vector<std::string> DefaultContextProviders();
+
+// Structure to hold settings configuration
+struct Settings {
+    bool checkMouseHover;
+    bool checkFocusedWindow;
+    DirectoryPriority priorityWhenBothAvailable;
+    int resolveTimeoutMs;  // Per-press budget for directory queries, 0 = no limit
+    std::vector<std::string> contextProviders;  // Tried in order for each window
+    int maxFanOut;  // Most launches one perFolder press may start
+    int sequenceTimeoutMs;  // How long a hotkey sequence waits for its next step
+    KeyStroke paletteHotkey;  // Opens the quick-launch palette; vkCode 0 if unset
+
+    Settings() : checkMouseHover(true), checkFocusedWindow(true), priorityWhenBothAvailable(DirectoryPriority::Hover),
+        resolveTimeoutMs(500), contextProviders(DefaultContextProviders()), maxFanOut(8), sequenceTimeoutMs(1500) {}
+};
+
+// Immutable, compiled form of launcher.ini. Apps are stored densely in menu
+// order (sorted by name); a second dense array maps hotkey ids to apps so
+// WM_HOTKEY dispatch is a single index operation.
+class ConfigSnapshot {
+public:
+    // Apps with duplicate names keep the last definition, as in the file.
+    // contextApps are per-foreground-process variants of apps (contextImage
+    // set); variants of unknown apps are dropped, duplicates keep the last.
+    static std::shared_ptr<const ConfigSnapshot> Compile(std::vector<AppConfig> apps, const Settings& settings,
+        std::vector<AppConfig> contextApps = std::vector<AppConfig>());
+
+    const std::vector<AppConfig>& Apps() const {
+        return m_apps;
+    }
+
+    const Settings& GetSettings() const {
+        return m_settings;
+    }
+
+    const AppConfig* FindByHotkey(int hotkeyId) const {
+        if (hotkeyId < 0 || (size_t)hotkeyId >= m_hotkeyIndex.size() || m_hotkeyIndex[hotkeyId] < 0) {
+            return nullptr;
+        }
+        return &m_apps[m_hotkeyIndex[hotkeyId]];
+    }
+
+    const AppConfig* FindByMenuIndex(int index) const {
+        if (index < 0 || (size_t)index >= m_apps.size()) {
+            return nullptr;
+        }
+        return &m_apps[index];
+    }
+
+    const AppConfig* FindByName(const std::string& name) const;
+
+    // Whether app (from this snapshot) has [Contexts] variants, so dispatch
+    // only looks up the foreground process when it matters
+    bool HasContexts(const AppConfig& app) const {
+        size_t index = IndexOf(app);
+        return index < m_contextRanges.size() && m_contextRanges[index].first != m_contextRanges[index].second;
+    }
+
+    // The variant of app for a lowercase foreground image name, or app itself
+    const AppConfig* SelectContext(const AppConfig& app, const std::string& image) const;
+
+    // Copy of this snapshot with one app enabled or disabled
+    std::shared_ptr<const ConfigSnapshot> WithAppEnabled(int index, bool enabled) const;
+
+    // Copy of this snapshot with new hotkey ids, one per app in menu order;
+    // [Contexts] variants take their app's new id
+    std::shared_ptr<const ConfigSnapshot> WithHotkeyIds(const std::vector<int>& hotkeyIds) const;
+
+private:
+    ConfigSnapshot() {}
+    void BuildIndex();
+
+    // Position of app in m_apps, or -1 for an app of another snapshot.
+    // std::less gives a total order even across unrelated arrays.
+    size_t IndexOf(const AppConfig& app) const {
+        std::less<const AppConfig*> before;
+        const AppConfig* first = m_apps.data();
+        if (before(&app, first) || !before(&app, first + m_apps.size())) {
+            return (size_t)-1;
+        }
+        return (size_t)(&app - first);
+    }
+
+    std::vector<AppConfig> m_apps;
+    std::vector<int> m_hotkeyIndex;
+
+    // Variants grouped by app; m_contextRanges[i] is the [first, second)
+    // slice of m_contextApps belonging to m_apps[i]
+    std::vector<AppConfig> m_contextApps;
+    std::vector<std::pair<size_t, size_t>> m_contextRanges;
+    Settings m_settings;
+};
+
+// Holds the live snapshot. Readers take their own reference, so a reload
+// publishing a new snapshot never invalidates a launch that is in flight.
+class ConfigStore {
+public:
+    std::shared_ptr<const ConfigSnapshot> Current() const {
+        return std::atomic_load(&m_current);
+    }
+
+    void Publish(std::shared_ptr<const ConfigSnapshot> snapshot) {
+        std::atomic_store(&m_current, std::move(snapshot));
+    }
+
+private:
+    std::shared_ptr<const ConfigSnapshot> m_current;
+};
@@ -0,0 +1,115 @@
+#include "config_diff.h"
+
+namespace {
+
+bool SameBinding(const AppConfig& a, const AppConfig& b) {
+    return a.modifiers == b.modifiers && a.vkCode == b.vkCode && a.sequence == b.sequence;
+}
+
+// Sequence hotkeys are matched by the keyboard hook instead; an entry
+// whose hotkey did not parse has none
+bool IsRegistered(const AppConfig& app) {
+    return app.enabled && app.sequence.empty() && app.vkCode != 0;
+}
+
+} // namespace
+
+ConfigDiff DiffConfig(const ConfigSnapshot* previous, const std::shared_ptr<const ConfigSnapshot>& next) {
+    const std::vector<AppConfig>& newApps = next->Apps();
+    static const std::vector<AppConfig> kNoApps;
+    const std::vector<AppConfig>& oldApps = previous ? previous->Apps() : kNoApps;
+
+    // Both app lists are sorted by name, so one merge walk pairs them up.
+    // matched[i] is the index of newApps[i] in oldApps, or -1.
+    std::vector<int> matched(newApps.size(), -1);
+    std::vector<bool> oldKept(oldApps.size(), false);
+    size_t o = 0;
+    for (size_t n = 0; n < newApps.size(); n++) {
+        while (o < oldApps.size() && oldApps[o].name < newApps[n].name) {
+            o++;
+        }
+        if (o < oldApps.size() && oldApps[o].name == newApps[n].name) {
+            matched[n] = (int)o;
+            oldKept[o] = true;
+        }
+    }
+
+    ConfigDiff diff;
+    std::vector<int> hotkeyIds(newApps.size(), 0);
+    std::vector<bool> idInUse;
+
+    // Renamed or removed apps give up their registration and their id
+    for (size_t i = 0; i < oldApps.size(); i++) {
+        if (!oldKept[i] && IsRegistered(oldApps[i])) {
+            diff.hotkeys.unregisterIds.push_back(oldApps[i].hotkeyId);
+        }
+    }
+
+    // Apps that survive keep their id; only a changed binding or enabled
+    // state costs a registration call
+    for (size_t n = 0; n < newApps.size(); n++) {
+        if (matched[n] < 0) {
+            continue;
+        }
+        const AppConfig& oldApp = oldApps[matched[n]];
+        hotkeyIds[n] = oldApp.hotkeyId;
+        if ((size_t)oldApp.hotkeyId >= idInUse.size()) {
+            idInUse.resize(oldApp.hotkeyId + 1, false);
+        }
+        idInUse[oldApp.hotkeyId] = true;
+
+        bool rebind = !SameBinding(oldApp, newApps[n]);
+        if (IsRegistered(oldApp) && (!newApps[n].enabled || rebind)) {
+            diff.hotkeys.unregisterIds.push_back(oldApp.hotkeyId);
+        }
+    }
+
+    // New apps take the lowest ids nobody kept
+    int candidate = 1;
+    for (size_t n = 0; n < newApps.size(); n++) {
+        if (matched[n] >= 0) {
+            continue;
+        }
+        while ((size_t)candidate < idInUse.size() && idInUse[candidate]) {
+            candidate++;
+        }
+        hotkeyIds[n] = candidate++;
+    }
+
+    bool idsChanged = false;
+    for (size_t n = 0; n < newApps.size(); n++) {
+        idsChanged = idsChanged || hotkeyIds[n] != newApps[n].hotkeyId;
+    }
+    diff.config = idsChanged ? next->WithHotkeyIds(hotkeyIds) : next;
+
+    // Register against the final snapshot so the plan points at its apps
+    const std::vector<AppConfig>& apps = diff.config->Apps();
+    for (size_t n = 0; n < apps.size(); n++) {
+        if (!IsRegistered(apps[n])) {
+            continue;
+        }
+        if (matched[n] >= 0) {
+            const AppConfig& oldApp = oldApps[matched[n]];
+            if (IsRegistered(oldApp) && SameBinding(oldApp, apps[n])) {
+                continue;
+            }
+        }
+        diff.hotkeys.registerApps.push_back(&apps[n]);
+    }
+
+    return diff;
+}
+
+std::vector<const AppConfig*> ApplyHotkeyPlan(const HotkeyPlan& plan, IHotkeyRegistrar& registrar) {
+    for (int hotkeyId : plan.unregisterIds) {
+        registrar.Unregister(hotkeyId);
+    }
+
+    std::vector<const AppConfig*> failed;
+    for (const AppConfig* app : plan.registerApps) {
+        if (!registrar.Register(app->hotkeyId, app->modifiers, app->vkCode)) {
+            failed.push_back(app);
+        }
+    }
+    return failed;
+}
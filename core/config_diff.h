@@ -0,0 +1,31 @@
+#pragma once
+#include "config.h"
+#include "hotkey_registrar.h"
+#include <memory>
+#include <vector>
+
+// Registration calls needed to move from one snapshot's hotkeys to another's
+struct HotkeyPlan {
+    std::vector<int> unregisterIds;
+    std::vector<const AppConfig*> registerApps;  // Point into ConfigDiff::config
+
+    bool Empty() const {
+        return unregisterIds.empty() && registerApps.empty();
+    }
+};
+
+struct ConfigDiff {
+    std::shared_ptr<const ConfigSnapshot> config;  // next, with hotkey ids carried over
+    HotkeyPlan hotkeys;
+};
+
+// Matches apps by name. An app keeps its hotkey id across reloads and is only
+// unregistered/registered when its binding or enabled state changed; new apps
+// get the lowest free id. previous may be null for the initial registration.
+// Sequence hotkeys are left to the keyboard hook and never registered, and
+// neither are entries without a hotkey.
+ConfigDiff DiffConfig(const ConfigSnapshot* previous, const std::shared_ptr<const ConfigSnapshot>& next);
+
+// Runs all unregistrations before any registration, so a binding can move
+// from one app to another. Returns the apps whose registration failed.
+std::vector<const AppConfig*> ApplyHotkeyPlan(const HotkeyPlan& plan, IHotkeyRegistrar& registrar);
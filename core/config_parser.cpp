@@ -0,0 +1,808 @@
+#include "config_parser.h"
+#include "hotkey_conflicts.h"
+#include "ini_reader.h"
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+
+enum class Section {
+    None,
+    Settings,
+    Apps,
+    Contexts,
+    Groups,
+    Unknown
+};
+
+// Format: name=executable|runAsAdmin|args|hotkey|enabled|options
+const size_t kMinAppFields = 4;
+const size_t kMaxAppFields = 6;
+
+const int kMaxResolveTimeoutMs = 60000;
+const int kMaxFanOut = 64;
+const int kMinSequenceTimeoutMs = 100;
+const int kMaxSequenceTimeoutMs = 10000;
+
+// Format: app@image.exe=executable|runAsAdmin|args
+const size_t kMaxContextFields = 3;
+
+// Format: name=members|hotkey|enabled
+const size_t kMinGroupFields = 2;
+const size_t kMaxGroupFields = 3;
+
+// "true"/"1" and "false"/"0"; anything else is reported and treated as false
+bool ParseBool(std::string_view value, bool& result) {
+    result = (value == "true" || value == "1");
+    return result || value == "false" || value == "0";
+}
+
+// Plain decimal digits no larger than maxValue
+bool ParseMilliseconds(std::string_view value, int maxValue, int& result) {
+    if (value.empty()) {
+        return false;
+    }
+    long long parsed = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        parsed = parsed * 10 + (c - '0');
+        if (parsed > maxValue) {
+            return false;
+        }
+    }
+    result = (int)parsed;
+    return true;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        char ca = a[i] >= 'A' && a[i] <= 'Z' ? (char)(a[i] - 'A' + 'a') : a[i];
+        char cb = b[i] >= 'A' && b[i] <= 'Z' ? (char)(b[i] - 'A' + 'a') : b[i];
+        if (ca != cb) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Quote(std::string_view text) {
+    return "'" + std::string(text) + "'";
+}
+
+class ConfigBuilder {
+public:
+    ConfigBuilder(HotkeyParser parseHotkey, ConfigParseResult& result)
+        : m_parseHotkey(parseHotkey), m_result(result), m_section(Section::None), m_hotkeyCounter(1), m_paletteLine(0) {}
+
+    void OnLine(const IniLine& line) {
+        switch (line.kind) {
+        case IniLine::Kind::Blank:
+        case IniLine::Kind::Comment:
+            break;
+
+        case IniLine::Kind::Section:
+            if (line.name == "Settings") {
+                m_section = Section::Settings;
+            }
+            else if (line.name == "Apps") {
+                m_section = Section::Apps;
+            }
+            else if (line.name == "Contexts") {
+                m_section = Section::Contexts;
+            }
+            else if (line.name == "Groups") {
+                m_section = Section::Groups;
+            }
+            else {
+                m_section = Section::Unknown;
+                Report(line.number, line.nameColumn, "unknown section [" + std::string(line.name) + "]");
+            }
+            break;
+
+        case IniLine::Kind::Malformed:
+            Report(line.number, line.nameColumn, "expected key=value, a [section] header or a comment");
+            break;
+
+        case IniLine::Kind::KeyValue:
+            if (m_section == Section::Settings) {
+                OnSetting(line);
+            }
+            else if (m_section == Section::Apps) {
+                OnApp(line);
+            }
+            else if (m_section == Section::Contexts) {
+                OnContext(line);
+            }
+            else if (m_section == Section::Groups) {
+                OnGroup(line);
+            }
+            else if (m_section == Section::None) {
+                Report(line.number, line.nameColumn, "entry outside of any section");
+            }
+            break;
+        }
+    }
+
+    void Finish() {
+        ReportDuplicates(m_names);
+        ReportDuplicates(m_contextNames);
+        std::vector<AppConfig> contextApps = BuildContextApps();
+        ResolveGroups();
+        ReportHotkeyConflicts();
+        std::stable_sort(m_result.diagnostics.begin(), m_result.diagnostics.end(),
+            [](const ConfigDiagnostic& a, const ConfigDiagnostic& b) {
+                return a.line < b.line;
+            });
+
+        if (!m_apps.empty()) {
+            m_result.config = ConfigSnapshot::Compile(std::move(m_apps), m_settings, std::move(contextApps));
+        }
+    }
+
+private:
+    void Report(int line, int column, const std::string& message) {
+        m_result.diagnostics.push_back(ConfigDiagnostic(line, column, message));
+    }
+
+    void OnSetting(const IniLine& line) {
+        if (line.name == "checkMouseHover" || line.name == "checkFocusedWindow") {
+            bool value = false;
+            if (!ParseBool(line.value, value)) {
+                Report(line.number, line.valueColumn, "expected true or false for " + Quote(line.name));
+            }
+            if (line.name == "checkMouseHover") {
+                m_settings.checkMouseHover = value;
+            }
+            else {
+                m_settings.checkFocusedWindow = value;
+            }
+        }
+        else if (line.name == "priorityWhenBothAvailable") {
+            if (EqualsIgnoreCase(line.value, "hover")) {
+                m_settings.priorityWhenBothAvailable = DirectoryPriority::Hover;
+            }
+            else if (EqualsIgnoreCase(line.value, "focus")) {
+                m_settings.priorityWhenBothAvailable = DirectoryPriority::Focus;
+            }
+            else {
+                Report(line.number, line.valueColumn, "priorityWhenBothAvailable must be hover or focus");
+            }
+        }
+        else if (line.name == "resolveTimeoutMs") {
+            if (!ParseMilliseconds(line.value, kMaxResolveTimeoutMs, m_settings.resolveTimeoutMs)) {
+                Report(line.number, line.valueColumn, "resolveTimeoutMs must be a number of milliseconds from 0 to " +
+                    std::to_string(kMaxResolveTimeoutMs));
+            }
+        }
+        else if (line.name == "contextProviders") {
+            OnContextProviders(line);
+        }
+        else if (line.name == "sequenceTimeoutMs") {
+            if (!ParseMilliseconds(line.value, kMaxSequenceTimeoutMs, m_settings.sequenceTimeoutMs) ||
+                m_settings.sequenceTimeoutMs < kMinSequenceTimeoutMs) {
+                m_settings.sequenceTimeoutMs = Settings().sequenceTimeoutMs;
+                Report(line.number, line.valueColumn, "sequenceTimeoutMs must be a number of milliseconds from " +
+                    std::to_string(kMinSequenceTimeoutMs) + " to " + std::to_string(kMaxSequenceTimeoutMs));
+            }
+        }
+        else if (line.name == "paletteHotkey") {
+            OnPaletteHotkey(line);
+        }
+        else if (line.name == "maxFanOut") {
+            if (!ParseMilliseconds(line.value, kMaxFanOut, m_settings.maxFanOut) || m_settings.maxFanOut == 0) {
+                m_settings.maxFanOut = Settings().maxFanOut;
+                Report(line.number, line.valueColumn, "maxFanOut must be a number from 1 to " + std::to_string(kMaxFanOut));
+            }
+        }
+        else {
+            Report(line.number, line.nameColumn, "unknown setting " + Quote(line.name));
+        }
+    }
+
+    // A plain hotkey; empty leaves the palette to the tray menu
+    void OnPaletteHotkey(const IniLine& line) {
+        m_settings.paletteHotkey = KeyStroke();
+        m_paletteLine = line.number;
+        if (line.value.empty()) {
+            return;
+        }
+        KeyStroke stroke;
+        if (SplitHotkeySequence(line.value).size() > 1) {
+            Report(line.number, line.valueColumn, "paletteHotkey cannot be a sequence");
+        }
+        else if (!m_parseHotkey(line.value, stroke.modifiers, stroke.vkCode)) {
+            Report(line.number, line.valueColumn, "invalid hotkey " + Quote(line.value));
+        }
+        else {
+            m_settings.paletteHotkey = stroke;
+        }
+    }
+
+    // Comma-separated provider names; an empty list leaves only the home directory
+    void OnContextProviders(const IniLine& line) {
+        std::vector<std::string> known = DefaultContextProviders();
+        m_settings.contextProviders.clear();
+        std::string_view names = line.value;
+        while (!names.empty()) {
+            size_t comma = names.find(',');
+            std::string_view name = TrimView(names.substr(0, comma));
+            std::string lowercase(name);
+            for (char& c : lowercase) {
+                c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+            }
+            if (std::find(known.begin(), known.end(), lowercase) == known.end()) {
+                if (!name.empty()) {
+                    Report(line.number, ColumnOf(line.raw, name), "unknown context provider " + Quote(name));
+                }
+            }
+            else if (std::find(m_settings.contextProviders.begin(), m_settings.contextProviders.end(), lowercase) !=
+                m_settings.contextProviders.end()) {
+                Report(line.number, ColumnOf(line.raw, name), Quote(name) + " is listed twice");
+            }
+            else {
+                m_settings.contextProviders.push_back(lowercase);
+            }
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            names = names.substr(comma + 1);
+        }
+    }
+
+    void OnApp(const IniLine& line) {
+        if (line.name.empty()) {
+            Report(line.number, line.nameColumn, "missing app name before '='");
+            return;
+        }
+
+        // Split the pipe-delimited value into views. A single trailing '|'
+        // does not start a new field.
+        std::string_view fields[kMaxAppFields];
+        size_t fieldCount = 0;
+        size_t extraFields = 0;
+        std::string_view rest = line.value;
+        while (!rest.empty()) {
+            size_t pipe = rest.find('|');
+            std::string_view segment = rest.substr(0, pipe);
+            if (fieldCount < kMaxAppFields) {
+                fields[fieldCount++] = TrimView(segment);
+            }
+            else {
+                extraFields++;
+            }
+            if (pipe == std::string_view::npos) {
+                break;
+            }
+            rest = rest.substr(pipe + 1);
+        }
+
+        if (fieldCount < kMinAppFields) {
+            Report(line.number, line.valueColumn, "expected executable|runAsAdmin|args|hotkey[|enabled[|options]] for " + Quote(line.name));
+            return;
+        }
+        if (extraFields > 0) {
+            Report(line.number, ColumnOf(line.raw, fields[kMaxAppFields - 1]), "ignoring extra fields after 'options'");
+        }
+        if (fields[0].empty()) {
+            Report(line.number, line.valueColumn, "missing executable for " + Quote(line.name));
+            return;
+        }
+
+        AppConfig config;
+        if (!ParseBool(fields[1], config.runAsAdmin)) {
+            Report(line.number, ColumnOf(line.raw, fields[1]), "expected true or false for runAsAdmin");
+        }
+
+        // Parse enabled flag (optional, defaults to true)
+        if (fieldCount >= 5 && !ParseBool(fields[4], config.enabled)) {
+            Report(line.number, ColumnOf(line.raw, fields[4]), "expected true or false for enabled");
+        }
+
+        // Comma-separated options (optional)
+        if (fieldCount >= 6) {
+            OnAppOptions(line, fields[5], config);
+        }
+
+        // An entry whose hotkey is unusable still loads, for the palette,
+        // the tray and --launch
+        OnHotkey(line, fields[3], config);
+
+        m_names.push_back(NameRef { line.name, line.number, line.nameColumn });
+
+        config.name = std::string(line.name);
+        config.executable = std::string(fields[0]);
+        config.args = std::string(fields[2]);
+        config.argsTemplate = CompileArgs(line, fields[2]);
+        config.hotkeyId = m_hotkeyCounter++;
+        m_apps.push_back(std::move(config));
+    }
+
+    // A plain hotkey, or a sequence of steps separated by commas. The first
+    // step is kept in modifiers/vkCode either way; on failure both stay 0
+    // and the entry has no hotkey.
+    bool OnHotkey(const IniLine& line, std::string_view text, AppConfig& config) {
+        std::string unbound = "; " + Quote(line.name) + " is loaded without a hotkey";
+        if (text.empty()) {
+            Report(line.number, ColumnOf(line.raw, text), "missing hotkey" + unbound);
+            return false;
+        }
+        std::vector<std::string_view> steps = SplitHotkeySequence(text);
+        if (steps.size() > kMaxSequenceSteps) {
+            Report(line.number, ColumnOf(line.raw, text), "a hotkey sequence has at most " +
+                std::to_string(kMaxSequenceSteps) + " steps" + unbound);
+            return false;
+        }
+        std::vector<KeyStroke> strokes;
+        for (std::string_view step : steps) {
+            KeyStroke stroke;
+            if (!m_parseHotkey(step, stroke.modifiers, stroke.vkCode)) {
+                Report(line.number, ColumnOf(line.raw, steps.size() > 1 && !step.empty() ? step : text),
+                    "invalid hotkey " + Quote(steps.size() > 1 ? step : text) + unbound);
+                return false;
+            }
+            strokes.push_back(stroke);
+        }
+        if (strokes.size() > 1 && !CanStartSequence(strokes[0])) {
+            Report(line.number, ColumnOf(line.raw, steps[0]),
+                "a hotkey sequence must start with Ctrl, Alt or Win held, or with a function key" + unbound);
+            return false;
+        }
+
+        config.modifiers = strokes[0].modifiers;
+        config.vkCode = strokes[0].vkCode;
+        if (strokes.size() > 1) {
+            config.sequence = std::move(strokes);
+        }
+        return true;
+    }
+
+    void OnAppOptions(const IniLine& line, std::string_view options, AppConfig& config) {
+        while (!options.empty()) {
+            size_t comma = options.find(',');
+            std::string_view option = TrimView(options.substr(0, comma));
+            if (option == "prewarm") {
+                config.prewarm = true;
+            }
+            else if (option == "perFolder" || option == "allItems") {
+                if (config.selection != SelectionMode::None) {
+                    Report(line.number, ColumnOf(line.raw, option), "perFolder and allItems cannot be combined");
+                }
+                config.selection = option == "perFolder" ? SelectionMode::PerFolder : SelectionMode::AllItems;
+            }
+            else if (!option.empty()) {
+                Report(line.number, ColumnOf(line.raw, option), "unknown option " + Quote(option));
+            }
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            options = options.substr(comma + 1);
+        }
+    }
+
+    // Placeholders are compiled once here; "{word}" that is not one is
+    // reported but kept, since braces are common in script arguments
+    ArgTemplate CompileArgs(const IniLine& line, std::string_view args) {
+        std::vector<size_t> unknown;
+        ArgTemplate compiled = ArgTemplate::Compile(args, &unknown);
+        for (size_t offset : unknown) {
+            std::string_view word = args.substr(offset, args.find('}', offset) - offset + 1);
+            Report(line.number, ColumnOf(line.raw, word), "unknown placeholder " + Quote(word) +
+                " (expected {dir}, {item} or {title}; write {{ for a literal brace)");
+        }
+        return compiled;
+    }
+
+    void OnContext(const IniLine& line) {
+        size_t at = line.name.rfind('@');
+        std::string_view appName = at == std::string_view::npos ? std::string_view() : TrimView(line.name.substr(0, at));
+        std::string_view image = at == std::string_view::npos ? std::string_view() : TrimView(line.name.substr(at + 1));
+        if (appName.empty() || image.empty()) {
+            Report(line.number, line.nameColumn, "expected app@image.exe before '=' in [Contexts]");
+            return;
+        }
+
+        ContextRef context;
+        context.appName = appName;
+        context.line = line.number;
+        context.column = line.nameColumn;
+        context.image = std::string(image);
+        for (char& c : context.image) {
+            if (c >= 'A' && c <= 'Z') {
+                c = (char)(c - 'A' + 'a');
+            }
+        }
+
+        // Same splitting as [Apps]; fields left off the end come from the app
+        std::string_view rest = line.value;
+        while (!rest.empty()) {
+            size_t pipe = rest.find('|');
+            std::string_view segment = TrimView(rest.substr(0, pipe));
+            if (context.fieldCount < kMaxContextFields) {
+                context.fields[context.fieldCount++] = segment;
+            }
+            else {
+                Report(line.number, ColumnOf(line.raw, segment), "ignoring extra fields after 'args'");
+                break;
+            }
+            if (pipe == std::string_view::npos) {
+                break;
+            }
+            rest = rest.substr(pipe + 1);
+        }
+
+        if (context.fieldCount >= 2 && !ParseBool(context.fields[1], context.runAsAdmin)) {
+            Report(line.number, ColumnOf(line.raw, context.fields[1]), "expected true or false for runAsAdmin");
+        }
+        if (context.fieldCount >= 3) {
+            context.argsTemplate = CompileArgs(line, context.fields[2]);
+        }
+
+        m_contextNames.push_back(NameRef { line.name, line.number, line.nameColumn });
+        m_contexts.push_back(context);
+    }
+
+    // Variants are full copies of their app with the overridden fields, so
+    // a launch never has to merge the two
+    std::vector<AppConfig> BuildContextApps() {
+        std::vector<AppConfig> contextApps;
+        for (const ContextRef& context : m_contexts) {
+            const AppConfig* app = nullptr;
+            for (const AppConfig& candidate : m_apps) {
+                if (candidate.name == context.appName) {
+                    // Last definition wins, as in Compile; groups have no command to vary
+                    app = candidate.members.empty() ? &candidate : nullptr;
+                }
+            }
+            if (app == nullptr) {
+                Report(context.line, context.column, "context for unknown app " + Quote(context.appName));
+                continue;
+            }
+
+            AppConfig variant = *app;
+            variant.contextImage = context.image;
+            variant.prewarm = false;  // The standby is started with the app's own args
+            if (context.fieldCount >= 1 && !context.fields[0].empty()) {
+                variant.executable = std::string(context.fields[0]);
+            }
+            if (context.fieldCount >= 2) {
+                variant.runAsAdmin = context.runAsAdmin;
+            }
+            if (context.fieldCount >= 3) {
+                variant.args = std::string(context.fields[2]);
+                variant.argsTemplate = context.argsTemplate;
+            }
+            contextApps.push_back(std::move(variant));
+        }
+        return contextApps;
+    }
+
+    struct NameRef {
+        std::string_view name;
+        int line;
+        int column;
+    };
+
+    struct ContextRef {
+        std::string_view appName;
+        std::string image;
+        std::string_view fields[kMaxContextFields];
+        size_t fieldCount;
+        bool runAsAdmin;
+        ArgTemplate argsTemplate;
+        int line;
+        int column;
+
+        ContextRef() : fieldCount(0), runAsAdmin(false), line(0), column(0) {}
+    };
+
+    struct GroupRef {
+        size_t appIndex;               // Position of the group in m_apps
+        std::vector<NameRef> members;  // Parallel to the group's members
+
+        GroupRef() : appIndex(0) {}
+    };
+
+    void OnGroup(const IniLine& line) {
+        if (line.name.empty()) {
+            Report(line.number, line.nameColumn, "missing group name before '='");
+            return;
+        }
+
+        // Same splitting as [Apps]; members may not contain '|'
+        std::string_view fields[kMaxGroupFields];
+        size_t fieldCount = 0;
+        std::string_view rest = line.value;
+        while (!rest.empty()) {
+            size_t pipe = rest.find('|');
+            std::string_view segment = TrimView(rest.substr(0, pipe));
+            if (fieldCount < kMaxGroupFields) {
+                fields[fieldCount++] = segment;
+            }
+            else {
+                Report(line.number, ColumnOf(line.raw, segment), "ignoring extra fields after 'enabled'");
+                break;
+            }
+            if (pipe == std::string_view::npos) {
+                break;
+            }
+            rest = rest.substr(pipe + 1);
+        }
+
+        if (fieldCount < kMinGroupFields || fields[0].empty()) {
+            Report(line.number, line.valueColumn, "expected members|hotkey[|enabled] for " + Quote(line.name));
+            return;
+        }
+
+        AppConfig group;
+        if (fieldCount >= 3 && !ParseBool(fields[2], group.enabled)) {
+            Report(line.number, ColumnOf(line.raw, fields[2]), "expected true or false for enabled");
+        }
+        OnHotkey(line, fields[1], group);
+
+        GroupRef ref;
+        ref.appIndex = m_apps.size();
+        if (!OnGroupMembers(line, fields[0], group, ref)) {
+            return;
+        }
+
+        m_names.push_back(NameRef { line.name, line.number, line.nameColumn });
+
+        group.name = std::string(line.name);
+        group.hotkeyId = m_hotkeyCounter++;
+        m_apps.push_back(std::move(group));
+        m_groups.push_back(std::move(ref));
+    }
+
+    // "Terminal, Editor(--new-window) > Git": ',' separates the members of
+    // a stage and '>' starts the next stage. Separators inside parentheses
+    // belong to the args.
+    bool OnGroupMembers(const IniLine& line, std::string_view text, AppConfig& group, GroupRef& ref) {
+        int stage = 0;
+        int depth = 0;
+        size_t start = 0;
+        bool valid = true;
+        for (size_t i = 0; i <= text.size(); i++) {
+            char c = i < text.size() ? text[i] : '\0';
+            if (c == '(') {
+                depth++;
+            }
+            else if (c == ')' && depth > 0) {
+                depth--;
+            }
+            if (i < text.size() && (depth > 0 || (c != ',' && c != '>'))) {
+                continue;
+            }
+
+            std::string_view member = TrimView(text.substr(start, i - start));
+            GroupMember parsed;
+            parsed.stage = stage;
+            std::string_view name = member;
+            size_t open = member.find('(');
+            if (open != std::string_view::npos && member.back() == ')') {
+                name = TrimView(member.substr(0, open));
+                std::string_view args = TrimView(member.substr(open + 1, member.size() - open - 2));
+                parsed.args = std::string(args);
+                parsed.argsTemplate = CompileArgs(line, args);
+                parsed.hasArgs = true;
+            }
+            if (name.empty()) {
+                Report(line.number, member.empty() ? ColumnOf(line.raw, text) + (int)start : ColumnOf(line.raw, member),
+                    "missing app name in group " + Quote(line.name));
+                valid = false;
+            }
+            else {
+                parsed.app = std::string(name);
+                group.members.push_back(std::move(parsed));
+                ref.members.push_back(NameRef { name, line.number, ColumnOf(line.raw, name) });
+            }
+
+            if (c == '>') {
+                stage++;
+            }
+            start = i + 1;
+        }
+        return valid;
+    }
+
+    // Members must name [Apps] entries, which may come after the group.
+    // Unknown members are dropped; a group left with none is dropped too.
+    void ResolveGroups() {
+        std::vector<size_t> emptied;
+        for (const GroupRef& ref : m_groups) {
+            AppConfig& group = m_apps[ref.appIndex];
+            std::vector<GroupMember> members;
+            for (size_t i = 0; i < group.members.size(); i++) {
+                const NameRef& member = ref.members[i];
+                bool isApp = false;
+                bool isGroup = false;
+                for (const AppConfig& candidate : m_apps) {
+                    if (candidate.name == member.name) {
+                        isApp = candidate.members.empty();
+                        isGroup = !isApp;
+                    }
+                }
+                if (isApp) {
+                    members.push_back(std::move(group.members[i]));
+                }
+                else {
+                    Report(member.line, member.column, isGroup ? "groups cannot contain other groups" :
+                        "group member " + Quote(member.name) + " is not in [Apps]");
+                }
+            }
+            group.members.swap(members);
+            if (group.members.empty()) {
+                emptied.push_back(ref.appIndex);
+            }
+        }
+        // Indices ascend with m_groups; erase from the back so they stay valid
+        for (size_t i = emptied.size(); i-- > 0;) {
+            m_apps.erase(m_apps.begin() + emptied[i]);
+            m_names.erase(m_names.begin() + emptied[i]);
+        }
+    }
+
+    // One HotkeyIndex pass in file order finds every clash; m_names still
+    // parallels m_apps here. Entries that a later one of the same name
+    // replaces are left out, as Compile drops them. Of two entries with the
+    // same binding the later one is disabled, since RegisterHotKey would
+    // refuse it anyway. Sequences are matched by the keyboard hook, so
+    // RegisterHotKey cannot report their clashes: a hotkey that starts a
+    // sequence is taken by the sequence, and a sequence that another one
+    // starts with never completes.
+    void ReportHotkeyConflicts() {
+        std::unordered_map<std::string_view, size_t> lastOfName;
+        for (size_t i = 0; i < m_names.size(); i++) {
+            lastOfName[m_names[i].name] = i;
+        }
+
+        HotkeyIndex index;
+        for (size_t i = 0; i < m_apps.size(); i++) {
+            AppConfig& app = m_apps[i];
+            if (!app.enabled || app.vkCode == 0 || lastOfName[m_names[i].name] != i) {
+                continue;
+            }
+            KeyStroke first(app.modifiers, app.vkCode);
+            const KeyStroke* steps = app.sequence.empty() ? &first : app.sequence.data();
+            size_t count = app.sequence.empty() ? 1 : app.sequence.size();
+            int owner = index.Add(steps, count, (int)i);
+            if (owner >= 0) {
+                std::string hotkey = app.sequence.empty() ? FormatHotkey(first.modifiers, first.vkCode) :
+                    FormatHotkeySequence(app.sequence);
+                Report(m_names[i].line, m_names[i].column, "hotkey " + Quote(hotkey) + " is already used by " +
+                    Quote(m_apps[owner].name) + " on line " + std::to_string(m_names[owner].line) + "; " +
+                    Quote(app.name) + " is disabled");
+                app.enabled = false;
+            }
+        }
+
+        for (size_t i = 0; i < m_apps.size(); i++) {
+            const AppConfig& app = m_apps[i];
+            if (app.sequence.empty() || !app.enabled || lastOfName[m_names[i].name] != i) {
+                continue;
+            }
+            int plain = index.Find(app.sequence.data(), 1);
+            if (plain >= 0) {
+                const AppConfig& other = m_apps[plain];
+                Report(m_names[plain].line, m_names[plain].column, "hotkey " +
+                    Quote(FormatHotkey(other.modifiers, other.vkCode)) + " of " + Quote(other.name) +
+                    " starts the sequence of " + Quote(app.name) + " on line " + std::to_string(m_names[i].line) +
+                    ", which takes it");
+                continue;
+            }
+            for (size_t count = 2; count < app.sequence.size(); count++) {
+                int prefix = index.Find(app.sequence.data(), count);
+                if (prefix >= 0) {
+                    Report(m_names[i].line, m_names[i].column, "hotkey " + Quote(FormatHotkeySequence(app.sequence)) +
+                        " of " + Quote(app.name) + " never completes: " +
+                        Quote(FormatHotkeySequence(m_apps[prefix].sequence)) + " on line " +
+                        std::to_string(m_names[prefix].line) + " fires first");
+                    break;
+                }
+            }
+        }
+
+        // Whichever registers second loses the combination; a sequence that
+        // starts with it takes it from the palette
+        const KeyStroke& palette = m_settings.paletteHotkey;
+        int owner = palette.vkCode != 0 ? index.Find(&palette, 1) : -1;
+        if (owner >= 0) {
+            Report(m_names[owner].line, m_names[owner].column, "hotkey " +
+                Quote(FormatHotkey(palette.modifiers, palette.vkCode)) + " of " + Quote(m_apps[owner].name) +
+                " is also the paletteHotkey on line " + std::to_string(m_paletteLine));
+        }
+    }
+
+    // Duplicates are found with one sort at the end instead of a per-line
+    // map. Sorts a copy; m_names has to stay parallel to m_apps.
+    void ReportDuplicates(std::vector<NameRef> names) {
+        std::sort(names.begin(), names.end(), [](const NameRef& a, const NameRef& b) {
+            return a.name != b.name ? a.name < b.name : a.line < b.line;
+        });
+        for (size_t i = 1; i < names.size(); i++) {
+            if (names[i].name == names[i - 1].name) {
+                Report(names[i].line, names[i].column, Quote(names[i].name) +
+                    " is defined again; the entry on line " + std::to_string(names[i - 1].line) + " is ignored");
+            }
+        }
+    }
+
+    HotkeyParser m_parseHotkey;
+    ConfigParseResult& m_result;
+    Section m_section;
+    int m_hotkeyCounter;
+    int m_paletteLine;
+    Settings m_settings;
+    std::vector<AppConfig> m_apps;
+    std::vector<NameRef> m_names;
+    std::vector<NameRef> m_contextNames;
+    std::vector<ContextRef> m_contexts;
+    std::vector<GroupRef> m_groups;
+};
+
+} // namespace
+
+ConfigParseResult ParseConfig(std::string_view text, HotkeyParser parseHotkey) {
+    ConfigParseResult result;
+    ConfigBuilder builder(parseHotkey, result);
+
+    IniReader reader(text);
+    IniLine line;
+    while (reader.Next(line)) {
+        builder.OnLine(line);
+    }
+
+    builder.Finish();
+    return result;
+}
+
+bool ReadFileContents(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::streamoff size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    contents.resize((size_t)size);
+    file.seekg(0, std::ios::beg);
+    return size == 0 || (bool)file.read(&contents[0], size);
+}
+
+std::shared_ptr<const ConfigSnapshot> LoadConfig(const std::string& path, HotkeyParser parseHotkey,
+    std::vector<ConfigDiagnostic>& diagnostics) {
+    diagnostics.clear();
+
+    // One read, then a single pass over the buffer
+    std::string contents;
+    if (!ReadFileContents(path, contents)) {
+        return nullptr;
+    }
+
+    ConfigParseResult result = ParseConfig(contents, parseHotkey);
+    diagnostics = std::move(result.diagnostics);
+    return result.config;
+}
+
+std::string FormatDiagnostic(const ConfigDiagnostic& diagnostic) {
+    return "line " + std::to_string(diagnostic.line) + ", column " + std::to_string(diagnostic.column) +
+        ": " + diagnostic.message;
+}
+
+std::string FormatDiagnostics(const std::vector<ConfigDiagnostic>& diagnostics, size_t maxShown) {
+    std::string text;
+    for (size_t i = 0; i < diagnostics.size() && i < maxShown; i++) {
+        text += "- " + FormatDiagnostic(diagnostics[i]) + "\n";
+    }
+    if (diagnostics.size() > maxShown) {
+        text += "- ... and " + std::to_string(diagnostics.size() - maxShown) + " more\n";
+    }
+    return text;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "config.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A problem found while parsing launcher.ini. Lines and columns are 1-based.
+struct ConfigDiagnostic {
+    int line;
+    int column;
+    std::string message;
+
+    ConfigDiagnostic() : line(0), column(0) {}
+    ConfigDiagnostic(int line, int column, const std::string& message)
+        : line(line), column(column), message(message) {}
+};
+
+// Turns a hotkey string such as "Ctrl+Alt+P" into MOD_* flags and a virtual key
+typedef bool (*HotkeyParser)(std::string_view text, unsigned int& modifiers, unsigned int& vkCode);
+
+struct ConfigParseResult {
+    std::shared_ptr<const ConfigSnapshot> config;  // Null if no app could be loaded
+    std::vector<ConfigDiagnostic> diagnostics;
+};
+
+// Single pass over the whole file buffer. Keys and fields are inspected as
+// views into the buffer; strings are only materialized for the snapshot.
+ConfigParseResult ParseConfig(std::string_view text, HotkeyParser parseHotkey);
+
+// Reads a whole file with one read call
+bool ReadFileContents(const std::string& path, std::string& contents);
+
+// ReadFileContents plus ParseConfig. Returns null if the file cannot be read
+// or yields no usable app; diagnostics are filled either way.
+std::shared_ptr<const ConfigSnapshot> LoadConfig(const std::string& path, HotkeyParser parseHotkey,
+    std::vector<ConfigDiagnostic>& diagnostics);
+
+// "line 3, column 7: unknown key 'foo'"
+std::string FormatDiagnostic(const ConfigDiagnostic& diagnostic);
+
+// Multi-line summary for message boxes, truncated after maxShown entries
+std::string FormatDiagnostics(const std::vector<ConfigDiagnostic>& diagnostics, size_t maxShown);
@@ -0,0 +1,127 @@
+#include "config_persister.h"
+
+ConfigPersister::ConfigPersister(IFileOps& files, std::chrono::milliseconds debounce)
+    : m_files(files),
+      m_debounce(debounce),
+      m_writing(false),
+      m_flushRequested(false),
+      m_stopping(false) {
+}
+
+ConfigPersister::~ConfigPersister() {
+    Stop();
+}
+
+void ConfigPersister::Start(const std::string& path, std::function<void()> onWriteFailed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_path = path;
+    m_onWriteFailed = onWriteFailed;
+    m_stopping = false;
+    m_thread = std::thread(&ConfigPersister::WriterLoop, this);
+}
+
+void ConfigPersister::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void ConfigPersister::Enqueue(Edit edit) {
+    bool first = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        first = m_pending.empty();
+        m_pending.push_back(std::move(edit));
+        m_lastEdit = std::chrono::steady_clock::now();
+        m_stats.edits++;
+    }
+    // A writer already debouncing re-checks m_lastEdit when its wait expires
+    if (first) {
+        m_wake.notify_all();
+    }
+}
+
+void ConfigPersister::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_thread.joinable()) {
+        return;
+    }
+    m_flushRequested = true;
+    m_wake.notify_all();
+    m_idle.wait(lock, [this] { return m_pending.empty() && !m_writing; });
+}
+
+ConfigPersister::Stats ConfigPersister::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool ConfigPersister::WriteEdits(const std::vector<Edit>& edits) {
+    std::string contents;
+    if (!m_files.ReadFile(m_path, contents)) {
+        return false;
+    }
+
+    IniDocument document(contents);
+    for (const Edit& edit : edits) {
+        edit(document);
+    }
+
+    std::string updated = document.Text();
+    if (updated == contents) {
+        return true;
+    }
+    return WriteFileAtomically(m_files, m_path, updated);
+}
+
+void ConfigPersister::WriterLoop() {
+    for (;;) {
+        std::vector<Edit> edits;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+            if (m_pending.empty()) {
+                break;
+            }
+
+            // Let a burst of toggles settle into one write
+            while (!m_stopping && !m_flushRequested &&
+                std::chrono::steady_clock::now() < m_lastEdit + m_debounce) {
+                m_wake.wait_until(lock, m_lastEdit + m_debounce);
+            }
+
+            edits.swap(m_pending);
+            m_writing = true;
+        }
+
+        bool written = WriteEdits(edits);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = false;
+            if (written) {
+                m_stats.writes++;
+            }
+            else {
+                m_stats.failures++;
+            }
+            if (m_pending.empty()) {
+                m_flushRequested = false;
+            }
+        }
+        m_idle.notify_all();
+
+        if (!written && m_onWriteFailed) {
+            m_onWriteFailed();
+        }
+    }
+}
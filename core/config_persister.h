@@ -0,0 +1,64 @@
+#pragma once
+#include "file_ops.h"
+#include "ini_document.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes config edits to launcher.ini off the UI thread. Edits are queued,
+// debounced, and then applied in order to a fresh read of the file, so
+// changes made by the user or the config editor in the meantime are kept.
+// Each flush is one atomic write.
+class ConfigPersister {
+public:
+    typedef std::function<void(IniDocument&)> Edit;
+
+    struct Stats {
+        uint64_t edits;
+        uint64_t writes;
+        uint64_t failures;
+
+        Stats() : edits(0), writes(0), failures(0) {}
+    };
+
+    ConfigPersister(IFileOps& files, std::chrono::milliseconds debounce);
+    ~ConfigPersister();
+
+    // onWriteFailed runs on the persister thread
+    void Start(const std::string& path, std::function<void()> onWriteFailed);
+
+    // Writes anything still pending before returning
+    void Stop();
+
+    void Enqueue(Edit edit);
+
+    // Blocks until every queued edit has been written (or failed)
+    void Flush();
+
+    Stats GetStats() const;
+
+private:
+    void WriterLoop();
+    bool WriteEdits(const std::vector<Edit>& edits);
+
+    IFileOps& m_files;
+    std::chrono::milliseconds m_debounce;
+    std::string m_path;
+    std::function<void()> m_onWriteFailed;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::vector<Edit> m_pending;
+    std::chrono::steady_clock::time_point m_lastEdit;
+    bool m_writing;
+    bool m_flushRequested;
+    bool m_stopping;
+    Stats m_stats;
+    std::thread m_thread;
+};
@@ -0,0 +1,60 @@
+#include "config_writer.h"
+#include "ini_reader.h"
+
+namespace {
+
+// Position of the enabled field in name=executable|runAsAdmin|args|hotkey|enabled
+const size_t kEnabledField = 4;
+
+// ... and in a [Groups] entry, name=members|hotkey|enabled
+const size_t kGroupEnabledField = 2;
+
+// Sets field enabledField of a pipe-delimited value, which may end right
+// before it. Returns false if the value has fewer fields than that.
+bool SetEnabledField(std::string& value, size_t enabledField, bool enabled) {
+    const char* flag = enabled ? "true" : "false";
+
+    // Walk to the start of the enabled field, splitting like the parser does
+    size_t fieldStart = 0;
+    size_t field = 0;
+    while (field < enabledField) {
+        size_t pipe = value.find('|', fieldStart);
+        if (pipe == std::string::npos) {
+            break;
+        }
+        fieldStart = pipe + 1;
+        field++;
+    }
+
+    if (field < enabledField) {
+        // Too few fields to be a valid entry; leave it for the parser to report
+        if (field + 1 < enabledField) {
+            return false;
+        }
+        // "exe|admin|args|hotkey" - append the optional field
+        value += "|";
+        value += flag;
+    }
+    else {
+        size_t fieldEnd = value.find('|', fieldStart);
+        std::string_view current(value.data() + fieldStart,
+            (fieldEnd == std::string::npos ? value.size() : fieldEnd) - fieldStart);
+        std::string_view trimmed = TrimView(current);
+        size_t start = trimmed.empty() ? fieldStart : (size_t)(trimmed.data() - value.data());
+        value.replace(start, trimmed.size(), flag);
+    }
+    return true;
+}
+
+} // namespace
+
+bool SetAppEnabled(IniDocument& document, const std::string& name, bool enabled) {
+    std::string value;
+    if (document.GetValue("Apps", name, value)) {
+        return SetEnabledField(value, kEnabledField, enabled) && document.SetValue("Apps", name, value);
+    }
+    if (document.GetValue("Groups", name, value)) {
+        return SetEnabledField(value, kGroupEnabledField, enabled) && document.SetValue("Groups", name, value);
+    }
+    return false;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "ini_document.h"
+#include <string>
+
+// Field-level edits to launcher.ini. Each edit changes only the field it is
+// about and leaves the rest of the entry exactly as the user wrote it.
+
+// Sets the enabled field of one [Apps] or [Groups] entry, adding it if the
+// entry has only the required fields. Returns false if the entry is not in
+// the file.
+bool SetAppEnabled(IniDocument& document, const std::string& name, bool enabled);
@@ -0,0 +1,180 @@
+#include "context_provider.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// Process results are few (one per terminal or editor); past this many,
+// expired ones are swept on insert
+const size_t kCacheSweepSize = 256;
+
+bool IsDriveLetter(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+// "C:\" or "\\server\"
+bool IsPathStart(const std::string& text, size_t i) {
+    if (i > 0 && (IsDriveLetter(text[i - 1]) || (text[i - 1] >= '0' && text[i - 1] <= '9'))) {
+        return false;
+    }
+    if (i + 2 < text.size() && IsDriveLetter(text[i]) && text[i + 1] == ':' && text[i + 2] == '\\') {
+        return true;
+    }
+    return i + 2 < text.size() && text[i] == '\\' && text[i + 1] == '\\' && text[i + 2] != '\\' && text[i + 2] != ' ';
+}
+
+} // namespace
+
+ContextProviderRegistry::ContextProviderRegistry(IProcessTable& processes,
+    std::function<std::string()> getHomeDirectory)
+    : m_processes(processes), m_getHomeDirectory(getHomeDirectory) {
+}
+
+void ContextProviderRegistry::Add(const std::string& name, IContextProvider& provider,
+    ContextProviderOptions options) {
+    m_providers.push_back(Provider { name, &provider, options });
+}
+
+ContextClaim ContextProviderRegistry::Claim(WindowHandle window, const std::vector<std::string>& order) const {
+    if (window == kNoWindow) {
+        return ContextClaim();
+    }
+    for (const std::string& name : order) {
+        for (size_t i = 0; i < m_providers.size(); i++) {
+            if (m_providers[i].name != name) {
+                continue;
+            }
+            WindowHandle claimed = m_providers[i].provider->Claim(window);
+            if (claimed != kNoWindow) {
+                return ContextClaim((int)i, claimed);
+            }
+            break;
+        }
+    }
+    return ContextClaim();
+}
+
+std::string ContextProviderRegistry::GetDirectory(const ContextClaim& claim,
+    std::chrono::steady_clock::time_point deadline) {
+    if (claim.provider < 0 || (size_t)claim.provider >= m_providers.size()) {
+        return "";
+    }
+    const Provider& provider = m_providers[claim.provider];
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    uint32_t processId = m_processes.GetWindowProcessId(claim.window);
+
+    uint64_t key = CacheKey(claim.provider, processId);
+    bool cacheable = provider.options.cacheTtlMs > 0 && processId != 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.queries++;
+        if (cacheable) {
+            auto it = m_cache.find(key);
+            if (it != m_cache.end() && it->second.expires > now) {
+                m_stats.cacheHits++;
+                return it->second.directory;
+            }
+        }
+    }
+
+    std::chrono::steady_clock::time_point budgetEnd = deadline;
+    if (provider.options.budgetMs > 0) {
+        budgetEnd = std::min(deadline, now + std::chrono::milliseconds(provider.options.budgetMs));
+    }
+    std::string directory = provider.provider->GetDirectory(claim.window, processId, budgetEnd);
+    std::chrono::steady_clock::time_point finished = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (finished > budgetEnd) {
+        m_stats.overBudget++;
+    }
+    // Empty answers are retried: access may be granted or the title change
+    if (cacheable && !directory.empty()) {
+        StoreLocked(key, directory, finished + std::chrono::milliseconds(provider.options.cacheTtlMs));
+    }
+    return directory;
+}
+
+bool ContextProviderRegistry::GetSelection(const ContextClaim& claim, std::chrono::steady_clock::time_point deadline,
+    std::vector<SelectedItem>& items) {
+    items.clear();
+    if (claim.provider < 0 || (size_t)claim.provider >= m_providers.size()) {
+        return false;
+    }
+    const Provider& provider = m_providers[claim.provider];
+    if (provider.options.budgetMs > 0) {
+        deadline = std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(provider.options.budgetMs));
+    }
+    return provider.provider->GetSelection(claim.window, deadline, items);
+}
+
+std::string ContextProviderRegistry::GetHomeDirectory() {
+    return m_getHomeDirectory ? m_getHomeDirectory() : std::string();
+}
+
+void ContextProviderRegistry::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cache.clear();
+}
+
+ContextProviderRegistry::Stats ContextProviderRegistry::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void ContextProviderRegistry::StoreLocked(uint64_t key, const std::string& directory,
+    std::chrono::steady_clock::time_point expires) {
+    // Process ids are recycled; the TTL bounds how long a dead one's entry
+    // can answer, and the sweep bounds the table
+    if (m_cache.size() >= kCacheSweepSize) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (auto it = m_cache.begin(); it != m_cache.end();) {
+            it = it->second.expires <= now ? m_cache.erase(it) : std::next(it);
+        }
+    }
+    CachedResult& entry = m_cache[key];
+    entry.directory = directory;
+    entry.expires = expires;
+}
+
+std::string FindPathInTitle(const std::string& title) {
+    for (size_t start = 0; start < title.size(); start++) {
+        if (!IsPathStart(title, start)) {
+            continue;
+        }
+
+        // "Program Files (x86)" keeps its brackets; an unmatched ')' or ']'
+        // closes one the title opened around the path
+        size_t end = start;
+        int depth = 0;
+        while (end < title.size()) {
+            char c = title[end];
+            if (c == '"' || c == '|' || c == '<' || c == '>' || c == '*' || c == '?') {
+                break;
+            }
+            if (c == '(' || c == '[') {
+                depth++;
+            }
+            else if (c == ')' || c == ']') {
+                if (depth == 0) {
+                    break;
+                }
+                depth--;
+            }
+            // Title separators: " - " and " — " (UTF-8)
+            if (c == ' ' && (title.compare(end, 3, " - ") == 0 || title.compare(end, 4, " \xE2\x80\x94") == 0)) {
+                break;
+            }
+            end++;
+        }
+
+        // Unsaved markers and padding are not part of the path
+        while (end > start && (title[end - 1] == ' ' || title[end - 1] == '.' || title[end - 1] == '\t')) {
+            end--;
+        }
+        if (end - start >= 3) {
+            return title.substr(start, end - start);
+        }
+    }
+    return "";
+}
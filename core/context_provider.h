@@ -0,0 +1,123 @@
+#pragma once
+#include "process_image_cache.h"
+#include "shell_window_provider.h"
+#include "window_handle.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One source of launch directories: Explorer windows, terminals, editors,
+// the desktop. On Windows these are Win32/COM queries; elsewhere fakes.
+class IContextProvider {
+public:
+    virtual ~IContextProvider() {}
+
+    // Window this provider answers for if window (or its owner) is one of
+    // its kind, kNoWindow otherwise. Must be cheap and never block on
+    // another process: it runs for every provider in order.
+    virtual WindowHandle Claim(WindowHandle window) = 0;
+
+    // Directory for a claimed window; empty if it has none. Should give up
+    // by the deadline.
+    virtual std::string GetDirectory(WindowHandle window, uint32_t processId,
+        std::chrono::steady_clock::time_point deadline) = 0;
+
+    // Items selected in a claimed window, for perFolder and allItems apps.
+    // Only shell views have a selection; false if there is none.
+    virtual bool GetSelection(WindowHandle, std::chrono::steady_clock::time_point, std::vector<SelectedItem>& items) {
+        items.clear();
+        return false;
+    }
+};
+
+struct ContextProviderOptions {
+    int budgetMs;    // Cap on one GetDirectory call, 0 = only the per-press resolveTimeoutMs
+    int cacheTtlMs;  // How long a result is reused for the same process, 0 = never
+
+    ContextProviderOptions(int budget = 0, int cacheTtl = 0) : budgetMs(budget), cacheTtlMs(cacheTtl) {}
+};
+
+// The provider that answers for a window
+struct ContextClaim {
+    int provider;         // -1 if none claims the window
+    WindowHandle window;  // Window the provider answers for, e.g. the Explorer frame
+
+    ContextClaim() : provider(-1), window(kNoWindow) {}
+    ContextClaim(int p, WindowHandle w) : provider(p), window(w) {}
+
+    bool operator==(const ContextClaim& other) const {
+        return provider == other.provider && window == other.window;
+    }
+};
+
+// Providers by name, tried in the order given by the contextProviders
+// setting; the first to claim a window answers for it. Results are cached
+// per provider and process for the provider's cacheTtlMs, which spares
+// cross-process reads on repeated presses in the same terminal.
+class ContextProviderRegistry {
+public:
+    struct Stats {
+        uint64_t queries;
+        uint64_t cacheHits;
+        uint64_t overBudget;  // GetDirectory calls that ran past their budget
+
+        Stats() : queries(0), cacheHits(0), overBudget(0) {}
+    };
+
+    ContextProviderRegistry(IProcessTable& processes, std::function<std::string()> getHomeDirectory);
+
+    // Register every provider before the first Claim; names are matched
+    // against the contextProviders setting
+    void Add(const std::string& name, IContextProvider& provider, ContextProviderOptions options);
+
+    // First provider in order that claims window; unknown names are skipped
+    ContextClaim Claim(WindowHandle window, const std::vector<std::string>& order) const;
+
+    std::string GetDirectory(const ContextClaim& claim, std::chrono::steady_clock::time_point deadline);
+
+    // Selection of a claimed window, under the provider's budget; not cached
+    bool GetSelection(const ContextClaim& claim, std::chrono::steady_clock::time_point deadline,
+        std::vector<SelectedItem>& items);
+
+    std::string GetHomeDirectory();
+
+    // Drop cached results, e.g. after WM_SETTINGCHANGE
+    void Invalidate();
+
+    Stats GetStats() const;
+
+private:
+    struct Provider {
+        std::string name;
+        IContextProvider* provider;
+        ContextProviderOptions options;
+    };
+
+    struct CachedResult {
+        std::string directory;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static uint64_t CacheKey(int provider, uint32_t processId) {
+        return ((uint64_t)(uint32_t)provider << 32) | processId;
+    }
+
+    void StoreLocked(uint64_t key, const std::string& directory, std::chrono::steady_clock::time_point expires);
+
+    IProcessTable& m_processes;
+    std::function<std::string()> m_getHomeDirectory;
+    std::vector<Provider> m_providers;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, CachedResult> m_cache;
+    Stats m_stats;
+};
+
+// First absolute path in a window title, e.g. "C:\src\app\main.cpp" from
+// "main.cpp (C:\src\app\main.cpp) - Editor". Ends at a separator such as
+// " - " or a closing bracket; empty if there is none.
+std::string FindPathInTitle(const std::string& title);
@@ -0,0 +1,102 @@
+#include "directory_cache.h"
+
+DirectoryCache::DirectoryCache(IShellWindowProvider& provider)
+    : m_provider(provider) {
+}
+
+bool DirectoryCache::Lookup(WindowHandle window, std::string& directory) {
+    if (Find(window, directory)) {
+        return !directory.empty();
+    }
+
+    // Cold miss - ask the provider without holding the lock, since on Windows
+    // this is a cross-process COM walk
+    std::string resolved;
+    if (!m_provider.QueryDirectory(window, resolved)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.providerFailures++;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    directory = StoreLocked(window, resolved);
+    return !directory.empty();
+}
+
+bool DirectoryCache::Find(WindowHandle window, std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(window);
+    if (it == m_entries.end()) {
+        m_stats.misses++;
+        return false;
+    }
+    m_stats.hits++;
+    directory = it->second;
+    return true;
+}
+
+void DirectoryCache::OnResolved(WindowHandle window, const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    StoreLocked(window, directory);
+}
+
+const std::string& DirectoryCache::StoreLocked(WindowHandle window, const std::string& directory) {
+    // A navigation event that arrived during the query is newer - keep it
+    auto inserted = m_entries.emplace(window, directory);
+    if (inserted.second && !directory.empty()) {
+        m_lastKnown[window] = directory;
+    }
+    return inserted.first->second;
+}
+
+bool DirectoryCache::FindLastKnown(WindowHandle window, std::string& directory) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lastKnown.find(window);
+    if (it == m_lastKnown.end()) {
+        return false;
+    }
+    directory = it->second;
+    return true;
+}
+
+void DirectoryCache::OnWindowRegistered(WindowHandle window) {
+    // Window handles are recycled, so anything cached for this value is stale
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(window);
+    m_lastKnown.erase(window);
+}
+
+void DirectoryCache::OnNavigated(WindowHandle window, const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[window] = directory;
+    if (!directory.empty()) {
+        m_lastKnown[window] = directory;
+    }
+}
+
+void DirectoryCache::OnWindowRevoked(WindowHandle window) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(window);
+    m_lastKnown.erase(window);
+}
+
+void DirectoryCache::Invalidate(WindowHandle window) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(window);
+}
+
+void DirectoryCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_lastKnown.clear();
+}
+
+size_t DirectoryCache::Size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+DirectoryCache::Stats DirectoryCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
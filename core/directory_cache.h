@@ -0,0 +1,58 @@
+#pragma once
+#include "shell_window_provider.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Explorer tab -> current directory cache. Entries are kept current by
+// shell events (window registered, navigated, revoked), so a hotkey press is a
+// hash lookup and the provider is only queried on a cold miss. Keys are the
+// tab windows IShellWindowProvider::GetActiveTab returns, so each tab of a
+// tabbed Explorer window has its own entry and switching tabs needs no event.
+class DirectoryCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t providerFailures;
+
+        Stats() : hits(0), misses(0), providerFailures(0) {}
+    };
+
+    explicit DirectoryCache(IShellWindowProvider& provider);
+
+    // Returns true and fills directory if the window shows a file system folder
+    bool Lookup(WindowHandle window, std::string& directory);
+
+    // Cache-only half of Lookup: true if the window has an entry (which may be
+    // empty for a virtual folder). Counts as a hit or miss.
+    bool Find(WindowHandle window, std::string& directory);
+
+    // Stores a provider result that was fetched outside Lookup. A navigation
+    // event that arrived in the meantime is newer and is kept.
+    void OnResolved(WindowHandle window, const std::string& directory);
+
+    // Last directory seen for a live window, even after Invalidate. Used when
+    // a fresh query cannot be answered in time.
+    bool FindLastKnown(WindowHandle window, std::string& directory) const;
+
+    // Shell event notifications
+    void OnWindowRegistered(WindowHandle window);
+    void OnNavigated(WindowHandle window, const std::string& directory);
+    void OnWindowRevoked(WindowHandle window);
+    void Invalidate(WindowHandle window);
+    void Clear();
+
+    size_t Size() const;
+    Stats GetStats() const;
+
+private:
+    const std::string& StoreLocked(WindowHandle window, const std::string& directory);
+
+    IShellWindowProvider& m_provider;
+    mutable std::mutex m_mutex;
+    std::unordered_map<WindowHandle, std::string> m_entries;
+    std::unordered_map<WindowHandle, std::string> m_lastKnown;
+    Stats m_stats;
+};
@@ -0,0 +1,187 @@
+#include "directory_reachability.h"
+#include <iterator>
+
+namespace {
+
+char ToLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+} // namespace
+
+std::string GetShareRoot(const std::string& path) {
+    if (path.size() >= 2 && ((path[0] >= 'A' && path[0] <= 'Z') || (path[0] >= 'a' && path[0] <= 'z')) &&
+        path[1] == ':') {
+        return std::string(1, path[0]) + ":\\";
+    }
+    if (path.size() < 3 || path[0] != '\\' || path[1] != '\\') {
+        return "";
+    }
+
+    // \\server\share, past any \\?\UNC\ prefix
+    size_t serverStart = path.compare(0, 8, "\\\\?\\UNC\\") == 0 ? 8 : 2;
+    size_t shareStart = path.find('\\', serverStart);
+    if (shareStart == std::string::npos || shareStart == serverStart) {
+        return "";
+    }
+    size_t shareEnd = path.find('\\', shareStart + 1);
+    if (shareEnd == shareStart + 1) {
+        return "";
+    }
+    std::string root = "\\\\" + path.substr(serverStart, (shareEnd == std::string::npos ? path.size() : shareEnd) - serverStart);
+    return root + "\\";
+}
+
+DirectoryReachability::DirectoryReachability(IDirectoryProbe& probe, std::chrono::milliseconds reachableTtl,
+    std::chrono::milliseconds unreachableTtl)
+    : m_probe(probe), m_reachableTtl(reachableTtl), m_unreachableTtl(unreachableTtl),
+      m_running(false), m_stopping(false) {
+}
+
+DirectoryReachability::~DirectoryReachability() {
+    Stop();
+}
+
+void DirectoryReachability::Start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_stopping = false;
+    m_thread = std::thread(&DirectoryReachability::ThreadLoop, this);
+}
+
+void DirectoryReachability::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_stopping = true;
+        for (const std::shared_ptr<Check>& check : m_pending) {
+            if (check->shareRoot) {
+                m_shares[check->path].checking = false;
+            }
+        }
+        m_pending.clear();
+    }
+    m_wake.notify_all();
+    m_done.notify_all();
+
+    m_thread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+}
+
+bool DirectoryReachability::IsUsable(const std::string& directory,
+    std::chrono::steady_clock::time_point deadline) {
+    if (directory.empty()) {
+        return false;
+    }
+    if (!m_probe.IsNetworkPath(directory)) {
+        return m_probe.DirectoryExists(directory);
+    }
+
+    std::string root = GetShareRoot(directory);
+    for (char& c : root) {
+        c = ToLower(c);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_running || m_stopping) {
+        lock.unlock();
+        return m_probe.DirectoryExists(root) && m_probe.DirectoryExists(directory);
+    }
+
+    Share& share = m_shares[root];
+    if (share.known) {
+        m_stats.cacheHits++;
+        if (std::chrono::steady_clock::now() >= share.expires && !share.checking) {
+            QueueCheckLocked(root, share);
+        }
+    }
+    else {
+        if (!share.checking) {
+            QueueCheckLocked(root, share);
+        }
+        // References into m_shares stay valid across rehashing
+        m_done.wait_until(lock, deadline, [this, &share] { return share.known || m_stopping; });
+        if (!share.known) {
+            m_stats.timeouts++;
+            return false;
+        }
+    }
+
+    if (!share.reachable) {
+        return false;
+    }
+
+    // The share answered when last checked, but may have dropped since
+    std::shared_ptr<Check> check = std::make_shared<Check>(directory, false);
+    m_pending.push_back(check);
+    m_wake.notify_one();
+    m_done.wait_until(lock, deadline, [this, &check] { return check->done || m_stopping; });
+    if (!check->done) {
+        m_stats.timeouts++;
+        // Have the share itself checked again on the next press
+        Share& stale = m_shares[root];
+        stale.expires = std::chrono::steady_clock::now();
+        return false;
+    }
+    return check->exists;
+}
+
+void DirectoryReachability::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_shares.begin(); it != m_shares.end();) {
+        // A running check still needs its entry
+        it = it->second.checking ? std::next(it) : m_shares.erase(it);
+    }
+}
+
+DirectoryReachability::Stats DirectoryReachability::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void DirectoryReachability::QueueCheckLocked(const std::string& root, Share& share) {
+    share.checking = true;
+    m_pending.push_back(std::make_shared<Check>(root, true));
+    m_wake.notify_one();
+}
+
+void DirectoryReachability::ThreadLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+        if (m_stopping) {
+            break;
+        }
+
+        std::shared_ptr<Check> check = m_pending.front();
+        m_pending.pop_front();
+        if (check->shareRoot) {
+            m_stats.shareChecks++;
+        }
+        else {
+            m_stats.directoryChecks++;
+        }
+
+        lock.unlock();
+        bool exists = m_probe.DirectoryExists(check->path);
+        lock.lock();
+
+        check->done = true;
+        check->exists = exists;
+        if (check->shareRoot) {
+            Share& share = m_shares[check->path];
+            share.known = true;
+            share.reachable = exists;
+            share.checking = false;
+            share.expires = std::chrono::steady_clock::now() + (exists ? m_reachableTtl : m_unreachableTtl);
+        }
+        m_done.notify_all();
+    }
+}
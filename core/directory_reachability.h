@@ -0,0 +1,101 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// File system checks behind DirectoryReachability. On Windows these are
+// GetDriveType and GetFileAttributes, which can block for tens of seconds
+// on an offline share; elsewhere a fake.
+class IDirectoryProbe {
+public:
+    virtual ~IDirectoryProbe() {}
+
+    // UNC path or mapped network drive; must not touch the network
+    virtual bool IsNetworkPath(const std::string& path) = 0;
+
+    virtual bool DirectoryExists(const std::string& path) = 0;
+};
+
+// "\\server\share\" for a UNC path, "Z:\" for a drive path, empty otherwise
+std::string GetShareRoot(const std::string& path);
+
+// Decides whether a launch can start in a directory before anything is
+// spawned. Local directories are checked in place. Network directories go
+// by their share's cached state: a share seen before answers at once
+// (a stale answer triggers a refresh on the helper thread), and a share
+// never seen is checked on the helper thread for at most the caller's
+// deadline. An offline share therefore costs one deadline per TTL instead
+// of a stall per press. The directory itself is also checked on the helper
+// thread under the deadline, since a share can drop while its cached state
+// still says reachable.
+class DirectoryReachability {
+public:
+    struct Stats {
+        uint64_t shareChecks;      // Share checks run on the helper thread
+        uint64_t directoryChecks;  // Network directory checks run on the helper thread
+        uint64_t cacheHits;
+        uint64_t timeouts;         // Callers that stopped waiting for a check
+
+        Stats() : shareChecks(0), directoryChecks(0), cacheHits(0), timeouts(0) {}
+    };
+
+    DirectoryReachability(IDirectoryProbe& probe, std::chrono::milliseconds reachableTtl,
+        std::chrono::milliseconds unreachableTtl);
+    ~DirectoryReachability();
+
+    void Start();
+    void Stop();
+
+    // False if directory is empty, missing or on a share that is offline
+    // or did not answer by the deadline. Before Start (or after Stop)
+    // share checks run on the caller's thread.
+    bool IsUsable(const std::string& directory, std::chrono::steady_clock::time_point deadline);
+
+    // Forget share states, e.g. after a network change
+    void Invalidate();
+
+    Stats GetStats() const;
+
+private:
+    struct Share {
+        bool known;       // At least one check has finished
+        bool reachable;
+        bool checking;
+        std::chrono::steady_clock::time_point expires;
+
+        Share() : known(false), reachable(false), checking(false) {}
+    };
+
+    // One DirectoryExists call for the helper thread
+    struct Check {
+        std::string path;
+        bool shareRoot;  // Updates the share's state when done
+        bool done;
+        bool exists;
+
+        Check(const std::string& p, bool s) : path(p), shareRoot(s), done(false), exists(false) {}
+    };
+
+    void QueueCheckLocked(const std::string& root, Share& share);
+    void ThreadLoop();
+
+    IDirectoryProbe& m_probe;
+    std::chrono::milliseconds m_reachableTtl;
+    std::chrono::milliseconds m_unreachableTtl;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::unordered_map<std::string, Share> m_shares;
+    std::deque<std::shared_ptr<Check>> m_pending;
+    std::thread m_thread;
+    bool m_running;
+    bool m_stopping;
+    Stats m_stats;
+};
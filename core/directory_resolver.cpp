@@ -0,0 +1,225 @@
+#include "directory_resolver.h"
+
+DirectoryResolver::DirectoryResolver(IShellWindowProvider& provider, DirectoryCache& cache, size_t maxWorkers,
+    std::chrono::milliseconds stopTimeout)
+    : m_provider(provider), m_cache(cache), m_maxWorkers(maxWorkers < 1 ? 1 : maxWorkers),
+      m_stopTimeout(stopTimeout), m_state(std::make_shared<State>(&provider, &cache)) {
+}
+
+DirectoryResolver::~DirectoryResolver() {
+    Stop();
+}
+
+void DirectoryResolver::Start() {
+    std::shared_ptr<State> state = std::atomic_load(&m_state);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->running) {
+            return;
+        }
+    }
+
+    // A stopped state may still have helpers left behind in it, so it is
+    // never reused; only the counters carry over
+    std::shared_ptr<State> fresh = std::make_shared<State>(&m_provider, &m_cache);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        fresh->stats = state->stats;
+    }
+    std::lock_guard<std::mutex> lock(fresh->mutex);
+    fresh->running = true;
+    AddWorkerLocked(fresh);
+    std::atomic_store(&m_state, fresh);
+}
+
+void DirectoryResolver::Stop() {
+    std::shared_ptr<State> state = std::atomic_load(&m_state);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->running || state->stopping) {
+        return;
+    }
+    state->stopping = true;
+
+    // Nobody will answer these any more
+    for (const std::shared_ptr<Query>& query : state->pending) {
+        query->done = true;
+        if (query->selection) {
+            state->selectionQueries.erase(query->window);
+        }
+        else {
+            state->directoryQueries.erase(query->window);
+        }
+    }
+    state->pending.clear();
+    state->wake.notify_all();
+    state->done.notify_all();
+
+    // A helper stuck in a hung window is left to finish on its own; it
+    // holds the state and drops its result
+    if (!state->exited.wait_for(lock, m_stopTimeout, [&state] { return state->workers == 0; })) {
+        state->stats.abandoned += state->workers;
+    }
+    state->running = false;
+}
+
+bool DirectoryResolver::Resolve(WindowHandle explorerWindow, std::chrono::steady_clock::time_point deadline,
+    std::string& directory) {
+    // Everything below is per tab
+    WindowHandle window = m_provider.GetActiveTab(explorerWindow);
+    if (m_cache.Find(window, directory)) {
+        return !directory.empty();
+    }
+
+    std::shared_ptr<State> state = std::atomic_load(&m_state);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->running || state->stopping) {
+        lock.unlock();
+        return m_cache.Lookup(window, directory);
+    }
+
+    std::shared_ptr<Query> query = QueueLocked(*state, window, false, deadline);
+    if (state->pending.size() > state->idleWorkers) {
+        AddWorkerLocked(state);
+    }
+
+    if (state->done.wait_until(lock, deadline, [&query] { return query->done; })) {
+        directory = query->directory;
+        return query->found && !directory.empty();
+    }
+
+    query->abandoned = true;
+    state->stats.timeouts++;
+    lock.unlock();
+
+    if (m_cache.FindLastKnown(window, directory)) {
+        std::lock_guard<std::mutex> statsLock(state->mutex);
+        state->stats.fallbacks++;
+        return true;
+    }
+    return false;
+}
+
+bool DirectoryResolver::ResolveSelection(WindowHandle explorerWindow, std::chrono::steady_clock::time_point deadline,
+    std::vector<SelectedItem>& items) {
+    items.clear();
+    WindowHandle window = m_provider.GetActiveTab(explorerWindow);
+
+    std::shared_ptr<State> state = std::atomic_load(&m_state);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->running || state->stopping) {
+        lock.unlock();
+        return m_provider.QuerySelection(window, items);
+    }
+
+    std::shared_ptr<Query> query = QueueLocked(*state, window, true, deadline);
+    if (state->pending.size() > state->idleWorkers) {
+        AddWorkerLocked(state);
+    }
+
+    if (state->done.wait_until(lock, deadline, [&query] { return query->done; })) {
+        items = query->items;
+        return query->found;
+    }
+
+    query->abandoned = true;
+    state->stats.timeouts++;
+    return false;
+}
+
+DirectoryResolver::Stats DirectoryResolver::GetStats() const {
+    std::shared_ptr<State> state = std::atomic_load(&m_state);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->stats;
+}
+
+std::shared_ptr<DirectoryResolver::Query> DirectoryResolver::QueueLocked(State& state, WindowHandle window,
+    bool selection, std::chrono::steady_clock::time_point deadline) {
+    // A press that arrives while the same tab is still being queried waits
+    // on that query instead of queueing another
+    std::shared_ptr<Query>& slot = selection ? state.selectionQueries[window] : state.directoryQueries[window];
+    if (slot) {
+        if (deadline > slot->deadline) {
+            slot->deadline = deadline;
+        }
+        state.stats.coalesced++;
+        return slot;
+    }
+
+    slot = std::make_shared<Query>(window, selection, deadline);
+    state.pending.push_back(slot);
+    state.stats.queries++;
+    state.wake.notify_one();
+    return slot;
+}
+
+void DirectoryResolver::AddWorkerLocked(const std::shared_ptr<State>& state) {
+    if (state->workers >= m_maxWorkers) {
+        return;
+    }
+    // Counted idle from the start, so a query queued before it first
+    // waits does not start yet another
+    state->workers++;
+    state->idleWorkers++;
+    std::thread(&DirectoryResolver::WorkerLoop, state).detach();
+}
+
+void DirectoryResolver::WorkerLoop(std::shared_ptr<State> state) {
+    state->provider->OnWorkerStarted();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    for (;;) {
+        state->wake.wait(lock, [&state] { return state->stopping || !state->pending.empty(); });
+        if (state->stopping) {
+            state->idleWorkers--;
+            break;
+        }
+
+        std::shared_ptr<Query> query = state->pending.front();
+        state->pending.pop_front();
+        QueryMap& queries = query->selection ? state->selectionQueries : state->directoryQueries;
+
+        // Every caller has already given up; the next press queues afresh
+        if (std::chrono::steady_clock::now() >= query->deadline) {
+            query->done = true;
+            queries.erase(query->window);
+            state->stats.dropped++;
+            state->done.notify_all();
+            continue;
+        }
+        state->idleWorkers--;
+
+        lock.unlock();
+        std::string resolved;
+        std::vector<SelectedItem> items;
+        bool found = false;
+        if (query->selection) {
+            found = state->provider->QuerySelection(query->window, items);
+        }
+        else {
+            found = state->provider->QueryDirectory(query->window, resolved);
+        }
+        lock.lock();
+
+        // After Stop the cache may be gone
+        if (found && !query->selection && !state->stopping) {
+            state->cache->OnResolved(query->window, resolved);
+        }
+        query->done = true;
+        query->found = found;
+        query->directory = resolved;
+        query->items.swap(items);
+        if (query->abandoned) {
+            state->stats.lateResults++;
+        }
+        queries.erase(query->window);
+        state->idleWorkers++;
+        state->done.notify_all();
+    }
+    lock.unlock();
+
+    state->provider->OnWorkerStopped();
+
+    lock.lock();
+    state->workers--;
+    state->exited.notify_all();
+}
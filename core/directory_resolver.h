@@ -0,0 +1,115 @@
+#pragma once
+#include "directory_cache.h"
+#include "shell_window_provider.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Deadline-bounded front end to a DirectoryCache. Cold misses are queried on
+// helper threads so a caller can stop waiting when its time budget runs out
+// (Explorer can block for seconds on a slow network folder) and fall back to
+// the last directory known for the window. A query that finishes late still
+// refreshes the cache for the next press.
+//
+// Queries for the same tab share one query, and queued queries whose
+// callers have all given up are dropped unrun, so a hung window cannot grow
+// the queue. When every helper is busy, for instance stuck in a hung
+// Explorer window, another is started, up to maxWorkers, so one window
+// cannot hold up the others.
+class DirectoryResolver {
+public:
+    struct Stats {
+        uint64_t queries;
+        uint64_t timeouts;
+        uint64_t fallbacks;     // Timeouts answered from the last known directory
+        uint64_t lateResults;   // Queries that finished after their caller gave up
+        uint64_t coalesced;     // Callers that joined a query for the same tab
+        uint64_t dropped;       // Queued queries skipped because every caller had given up
+        uint64_t abandoned;     // Helpers Stop left behind in a query that did not return
+
+        Stats() : queries(0), timeouts(0), fallbacks(0), lateResults(0), coalesced(0), dropped(0), abandoned(0) {}
+    };
+
+    // provider must outlive the helpers: one that Stop left behind finishes
+    // its query on its own, then exits without touching the cache
+    DirectoryResolver(IShellWindowProvider& provider, DirectoryCache& cache, size_t maxWorkers = 3,
+        std::chrono::milliseconds stopTimeout = std::chrono::milliseconds(2000));
+    ~DirectoryResolver();
+
+    // Start and Stop are called from one thread, while nothing resolves
+    void Start();
+
+    // Pending callers give up immediately. Waits up to stopTimeout for
+    // running queries, then leaves their helpers behind.
+    void Stop();
+
+    // Returns true and fills directory if the window's active tab shows a
+    // file system folder. Before Start (or after Stop) the query runs on the
+    // caller's thread.
+    bool Resolve(WindowHandle explorerWindow, std::chrono::steady_clock::time_point deadline, std::string& directory);
+
+    // Items selected in the window's active tab, read on the same helper
+    // threads. Selections change without navigation events, so these are
+    // never cached; false if the query fails or misses the deadline.
+    bool ResolveSelection(WindowHandle explorerWindow, std::chrono::steady_clock::time_point deadline,
+        std::vector<SelectedItem>& items);
+
+    Stats GetStats() const;
+
+private:
+    struct Query {
+        WindowHandle window;
+        bool selection;  // Reads items instead of directory
+        bool done;
+        bool found;
+        bool abandoned;
+        std::chrono::steady_clock::time_point deadline;  // Latest deadline of its callers
+        std::string directory;
+        std::vector<SelectedItem> items;
+
+        Query(WindowHandle w, bool s, std::chrono::steady_clock::time_point d)
+            : window(w), selection(s), done(false), found(false), abandoned(false), deadline(d) {}
+    };
+
+    typedef std::unordered_map<WindowHandle, std::shared_ptr<Query>> QueryMap;
+
+    // Everything the helpers use. They hold their own reference, so a
+    // helper left behind by Stop never touches a destroyed resolver.
+    struct State {
+        IShellWindowProvider* provider;
+        DirectoryCache* cache;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::condition_variable exited;
+        std::deque<std::shared_ptr<Query>> pending;
+        QueryMap directoryQueries;  // Queued or running, by tab
+        QueryMap selectionQueries;
+        size_t workers;
+        size_t idleWorkers;
+        bool running;
+        bool stopping;
+        Stats stats;
+
+        State(IShellWindowProvider* p, DirectoryCache* c)
+            : provider(p), cache(c), workers(0), idleWorkers(0), running(false), stopping(false) {}
+    };
+
+    // Joins the tab's query or queues a new one; called with the lock held
+    std::shared_ptr<Query> QueueLocked(State& state, WindowHandle window, bool selection,
+        std::chrono::steady_clock::time_point deadline);
+    void AddWorkerLocked(const std::shared_ptr<State>& state);
+    static void WorkerLoop(std::shared_ptr<State> state);
+
+    IShellWindowProvider& m_provider;
+    DirectoryCache& m_cache;
+    size_t m_maxWorkers;
+    std::chrono::milliseconds m_stopTimeout;
+    std::shared_ptr<State> m_state;  // Replaced by Start after a Stop
+};
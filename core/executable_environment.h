@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+
+// What executable resolution needs from the OS. On Windows this is the
+// environment, the file system and the App Paths registry key; elsewhere
+// it is a fake.
+class IExecutableEnvironment {
+public:
+    virtual ~IExecutableEnvironment() {}
+
+    // Empty if the variable is not set
+    virtual std::string GetVariable(const std::string& name) = 0;
+
+    // True for an existing file, false for directories
+    virtual bool FileExists(const std::string& path) = 0;
+
+    // Default value of App Paths\<fileName>, e.g. "code.exe"
+    virtual bool QueryAppPath(const std::string& fileName, std::string& path) = 0;
+};
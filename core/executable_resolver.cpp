@@ -0,0 +1,212 @@
+#include "executable_resolver.h"
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Used when PATHEXT is not set, as cmd.exe does
+const char kDefaultPathExt[] = ".COM;.EXE;.BAT;.CMD";
+
+bool IsPathSeparator(char c) {
+    return c == '\\' || c == '/';
+}
+
+char ToLowerAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+std::string ToLowerAscii(std::string_view text) {
+    std::string lower(text);
+    for (char& c : lower) {
+        c = ToLowerAscii(c);
+    }
+    return lower;
+}
+
+std::string_view StripQuotes(std::string_view text) {
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+// ".exe" for "C:\dir.v2\app.exe", empty for "C:\dir.v2\app"
+std::string_view ExtensionOf(std::string_view path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string_view::npos) {
+        return std::string_view();
+    }
+    for (size_t i = dot + 1; i < path.size(); i++) {
+        if (IsPathSeparator(path[i])) {
+            return std::string_view();
+        }
+    }
+    return path.substr(dot);
+}
+
+bool HasDirectory(std::string_view target) {
+    for (char c : target) {
+        if (IsPathSeparator(c)) {
+            return true;
+        }
+    }
+    // "C:app.exe" is relative to a drive
+    return target.size() >= 2 && target[1] == ':';
+}
+
+// URLs and shell namespace names ("ms-settings:", "https://...") never name
+// a file: a scheme of two or more letters, digits, '+', '-' or '.' before the
+// first colon. A drive letter is too short, and "\\?\C:\" has backslashes.
+bool LooksLikeUri(std::string_view target) {
+    size_t colon = target.find(':');
+    if (colon == std::string_view::npos || colon < 2) {
+        return false;
+    }
+    for (size_t i = 0; i < colon; i++) {
+        char c = ToLowerAscii(target[i]);
+        bool letter = c >= 'a' && c <= 'z';
+        if (!letter && (i == 0 || !((c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string_view> SplitList(std::string_view list) {
+    std::vector<std::string_view> items;
+    while (!list.empty()) {
+        size_t semicolon = list.find(';');
+        std::string_view item = StripQuotes(list.substr(0, semicolon));
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+        if (semicolon == std::string_view::npos) {
+            break;
+        }
+        list = list.substr(semicolon + 1);
+    }
+    return items;
+}
+
+std::string JoinPath(std::string_view directory, std::string_view name) {
+    std::string path(directory);
+    if (!path.empty() && !IsPathSeparator(path.back())) {
+        path += '\\';
+    }
+    path.append(name.data(), name.size());
+    return path;
+}
+
+} // namespace
+
+bool IsDirectlySpawnable(const std::string& path) {
+    std::string extension = ToLowerAscii(ExtensionOf(path));
+    return extension == ".exe" || extension == ".com";
+}
+
+ExecutableResolver::ExecutableResolver(IExecutableEnvironment& environment)
+    : m_environment(environment) {
+}
+
+bool ExecutableResolver::Resolve(const std::string& target, std::string& path) {
+    std::string key = ToLowerAscii(target);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_stats.hits++;
+            path = it->second.path;
+            return it->second.found;
+        }
+        m_stats.misses++;
+    }
+
+    // The search touches the file system; do it without holding the lock
+    Entry entry = Search(target);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.emplace(key, entry);
+    }
+    path = entry.path;
+    return entry.found;
+}
+
+void ExecutableResolver::Invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_stats.invalidations++;
+}
+
+void ExecutableResolver::Forget(const std::string& target) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(ToLowerAscii(target));
+}
+
+ExecutableResolver::Stats ExecutableResolver::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool ExecutableResolver::ResolveFile(const std::string& candidate, const std::string& pathExt, std::string& path) {
+    // A name that already has an extension is tried as is first
+    if (!ExtensionOf(candidate).empty() && m_environment.FileExists(candidate)) {
+        path = candidate;
+        return true;
+    }
+    for (std::string_view extension : SplitList(pathExt)) {
+        std::string withExtension = candidate;
+        withExtension.append(extension.data(), extension.size());
+        if (m_environment.FileExists(withExtension)) {
+            path = withExtension;
+            return true;
+        }
+    }
+    return false;
+}
+
+ExecutableResolver::Entry ExecutableResolver::Search(const std::string& target) {
+    Entry entry;
+    std::string name(StripQuotes(target));
+    if (name.empty() || LooksLikeUri(name)) {
+        return entry;
+    }
+
+    std::string pathExt = m_environment.GetVariable("PATHEXT");
+    if (pathExt.empty()) {
+        pathExt = kDefaultPathExt;
+    }
+
+    std::string resolved;
+    bool found = false;
+    if (HasDirectory(name)) {
+        // Explicit paths are not searched for
+        found = ResolveFile(name, pathExt, resolved);
+    }
+    else {
+        std::string searchPath = m_environment.GetVariable("PATH");
+        for (std::string_view directory : SplitList(searchPath)) {
+            if (ResolveFile(JoinPath(directory, name), pathExt, resolved)) {
+                found = true;
+                break;
+            }
+        }
+
+        // Applications that register themselves instead of joining PATH
+        if (!found) {
+            std::string appPath;
+            std::string keyName = ExtensionOf(name).empty() ? name + ".exe" : name;
+            if (m_environment.QueryAppPath(keyName, appPath)) {
+                appPath = std::string(StripQuotes(appPath));
+                found = !appPath.empty() && m_environment.FileExists(appPath);
+                resolved = appPath;
+            }
+        }
+    }
+
+    // Only binaries go to CreateProcess; scripts and documents need the shell
+    entry.found = found && IsDirectlySpawnable(resolved);
+    if (entry.found) {
+        entry.path = resolved;
+    }
+    return entry;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "executable_environment.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Resolves the executable of an app entry ("wt.exe", "code", a full path)
+// the way the shell would: an explicit path as given, otherwise each PATH
+// directory in order, then App Paths. A missing extension is completed from
+// PATHEXT. Results, including misses, are cached until Invalidate().
+class ExecutableResolver {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t invalidations;
+
+        Stats() : hits(0), misses(0), invalidations(0) {}
+    };
+
+    explicit ExecutableResolver(IExecutableEnvironment& environment);
+
+    // Returns true and fills path if target resolves to a file that
+    // CreateProcess can start directly (.exe or .com). Scripts, documents,
+    // URLs and unresolved names return false and are left to ShellExecute.
+    bool Resolve(const std::string& target, std::string& path);
+
+    // After an environment or settings change broadcast
+    void Invalidate();
+
+    // After a cached path failed to start, e.g. the app was uninstalled
+    void Forget(const std::string& target);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        bool found;
+        std::string path;
+
+        Entry() : found(false) {}
+    };
+
+    Entry Search(const std::string& target);
+    bool ResolveFile(const std::string& candidate, const std::string& pathExt, std::string& path);
+
+    IExecutableEnvironment& m_environment;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    Stats m_stats;
+};
+
+// True for extensions CreateProcess can start without a shell (".exe", ".com")
+bool IsDirectlySpawnable(const std::string& path);
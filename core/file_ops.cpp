@@ -0,0 +1,66 @@
+#include "file_ops.h"
+#include "config_parser.h"
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool StdFileOps::ReadFile(const std::string& path, std::string& contents) {
+    return ReadFileContents(path, contents);
+}
+
+bool StdFileOps::WriteFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(contents.data(), (std::streamsize)contents.size());
+    file.flush();
+    return (bool)file;
+}
+
+bool StdFileOps::FlushFile(const std::string& path) {
+#ifdef _WIN32
+    int file = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (file < 0) {
+        return false;
+    }
+    bool flushed = _commit(file) == 0;
+    _close(file);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    bool flushed = fsync(file) == 0;
+    close(file);
+#endif
+    return flushed;
+}
+
+bool StdFileOps::ReplaceFile(const std::string& from, const std::string& to) {
+    std::error_code error;
+    std::filesystem::rename(from, to, error);
+    return !error;
+}
+
+void StdFileOps::RemoveFile(const std::string& path) {
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
+
+bool WriteFileAtomically(IFileOps& files, const std::string& path, const std::string& contents) {
+    std::string temporary = path + ".tmp";
+    if (!files.WriteFile(temporary, contents) || !files.FlushFile(temporary) ||
+        !files.ReplaceFile(temporary, path)) {
+        files.RemoveFile(temporary);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+
+// The few file operations config persistence needs, so tests and benches
+// can substitute an in-memory file system or simulate a failed write.
+class IFileOps {
+public:
+    virtual ~IFileOps() {}
+
+    virtual bool ReadFile(const std::string& path, std::string& contents) = 0;
+
+    // May leave a partial file behind on failure
+    virtual bool WriteFile(const std::string& path, const std::string& contents) = 0;
+
+    // Forces what was written to path out to the disk, so a rename after
+    // it cannot outlive the data after a power loss
+    virtual bool FlushFile(const std::string& path) = 0;
+
+    // Atomically replaces to with from
+    virtual bool ReplaceFile(const std::string& from, const std::string& to) = 0;
+
+    virtual void RemoveFile(const std::string& path) = 0;
+};
+
+// std::fstream and std::filesystem. rename replaces the target in one step
+// on both POSIX and Windows (MoveFileEx with MOVEFILE_REPLACE_EXISTING).
+// The standard library cannot flush to disk, so FlushFile is fsync, or
+// _commit (FlushFileBuffers) on Windows.
+class StdFileOps : public IFileOps {
+public:
+    bool ReadFile(const std::string& path, std::string& contents) override;
+    bool WriteFile(const std::string& path, const std::string& contents) override;
+    bool FlushFile(const std::string& path) override;
+    bool ReplaceFile(const std::string& from, const std::string& to) override;
+    void RemoveFile(const std::string& path) override;
+};
+
+// Writes to path + ".tmp", flushes it and renames it over path, so a crash
+// or power loss mid-write leaves either the old file or the new one, never
+// a truncated mix
+bool WriteFileAtomically(IFileOps& files, const std::string& path, const std::string& contents);
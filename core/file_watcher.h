@@ -0,0 +1,14 @@
+#pragma once
+#include <functional>
+#include <string>
+
+// Reports changes to a single file. On Windows this is ReadDirectoryChangesW
+// on the containing folder; callbacks arrive on the watcher's own thread and
+// may fire several times for one save.
+class IFileWatcher {
+public:
+    virtual ~IFileWatcher() {}
+
+    virtual bool Start(const std::string& path, std::function<void()> onChanged) = 0;
+    virtual void Stop() = 0;
+};
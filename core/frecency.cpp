@@ -0,0 +1,121 @@
+#include "frecency.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+std::string KeyOf(const std::string& app, const std::string& directory) {
+    return app + '\n' + directory;
+}
+
+} // namespace
+
+double FrecencyAt(const FrecencyEntry& entry, int64_t now) {
+    // A clock set back does not make old uses count more
+    if (now <= entry.lastUsed) {
+        return entry.score;
+    }
+    return entry.score * std::exp2(-(double)(now - entry.lastUsed) / (double)kFrecencyHalfLifeSeconds);
+}
+
+std::vector<FrecencyEntry> RankRecentDirectories(const std::vector<FrecencyEntry>& entries, int64_t now, size_t limit) {
+    std::vector<std::pair<double, const FrecencyEntry*>> ranked;
+    for (const FrecencyEntry& entry : entries) {
+        if (!entry.directory.empty()) {
+            ranked.push_back(std::make_pair(FrecencyAt(entry, now), &entry));
+        }
+    }
+    size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+        [](const std::pair<double, const FrecencyEntry*>& a, const std::pair<double, const FrecencyEntry*>& b) {
+            return a.first > b.first;
+        });
+
+    std::vector<FrecencyEntry> result;
+    for (size_t i = 0; i < count; i++) {
+        result.push_back(*ranked[i].second);
+    }
+    return result;
+}
+
+FrecencyTable::FrecencyTable(size_t capacity)
+    : m_capacity(std::max(capacity, (size_t)10)) {}
+
+void FrecencyTable::Record(const std::string& app, const std::string& directory, int64_t now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecordLocked(app, std::string(), now);
+    if (!directory.empty()) {
+        RecordLocked(app, directory, now);
+    }
+    if (m_entries.size() > m_capacity) {
+        PruneLocked(now);
+    }
+}
+
+void FrecencyTable::Restore(const FrecencyEntry& entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto inserted = m_index.emplace(KeyOf(entry.app, entry.directory), m_entries.size());
+    if (inserted.second) {
+        m_entries.push_back(entry);
+    }
+    else {
+        m_entries[inserted.first->second] = entry;
+    }
+    if (m_entries.size() > m_capacity) {
+        PruneLocked(entry.lastUsed);
+    }
+}
+
+void FrecencyTable::RecordLocked(const std::string& app, const std::string& directory, int64_t now) {
+    auto inserted = m_index.emplace(KeyOf(app, directory), m_entries.size());
+    if (inserted.second) {
+        m_entries.push_back(FrecencyEntry());
+        m_entries.back().app = app;
+        m_entries.back().directory = directory;
+    }
+    FrecencyEntry& entry = m_entries[inserted.first->second];
+    entry.score = FrecencyAt(entry, now) + 1;
+    entry.lastUsed = std::max(entry.lastUsed, now);
+    entry.uses++;
+}
+
+void FrecencyTable::PruneLocked(int64_t now) {
+    std::vector<std::pair<double, size_t>> ranked;
+    ranked.reserve(m_entries.size());
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        ranked.push_back(std::make_pair(FrecencyAt(m_entries[i], now), i));
+    }
+    size_t keep = m_capacity - m_capacity / 10;
+    std::nth_element(ranked.begin(), ranked.begin() + keep, ranked.end(),
+        [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.first > b.first; });
+    ranked.resize(keep);
+
+    // Survivors keep their order
+    std::sort(ranked.begin(), ranked.end(),
+        [](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) { return a.second < b.second; });
+    std::vector<FrecencyEntry> entries;
+    entries.reserve(m_capacity + 2);
+    m_index.clear();
+    for (const std::pair<double, size_t>& survivor : ranked) {
+        FrecencyEntry& entry = m_entries[survivor.second];
+        m_index[KeyOf(entry.app, entry.directory)] = entries.size();
+        entries.push_back(std::move(entry));
+    }
+    m_entries.swap(entries);
+}
+
+std::vector<FrecencyEntry> FrecencyTable::Snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries;
+}
+
+size_t FrecencyTable::Size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void FrecencyTable::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+}
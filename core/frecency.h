@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Uses older than this count half as much
+const int64_t kFrecencyHalfLifeSeconds = 7 * 24 * 60 * 60;
+
+// Entries kept before the least used are dropped
+const size_t kFrecencyCapacity = 2000;
+
+// How often and how recently an app was launched, overall (empty directory)
+// or in one directory. The score is kept decayed to lastUsed, so recording a
+// use is O(1) and entries compare by their score at the same moment.
+struct FrecencyEntry {
+    std::string app;
+    std::string directory;
+    double score;
+    int64_t lastUsed;  // Seconds since the epoch
+    uint32_t uses;
+
+    FrecencyEntry() : score(0), lastUsed(0), uses(0) {}
+};
+
+// entry's score decayed to now
+double FrecencyAt(const FrecencyEntry& entry, int64_t now);
+
+// The (app, directory) entries with the highest score at now, best first
+std::vector<FrecencyEntry> RankRecentDirectories(const std::vector<FrecencyEntry>& entries, int64_t now, size_t limit);
+
+// Recent launches for the palette. Launch workers record while the UI
+// thread reads, so all members lock.
+class FrecencyTable {
+public:
+    explicit FrecencyTable(size_t capacity = kFrecencyCapacity);
+
+    // Counts a use of app, and of app in directory if that is not empty.
+    // Past capacity, the tenth of entries with the lowest score is dropped.
+    void Record(const std::string& app, const std::string& directory, int64_t now);
+
+    // Puts back an entry saved by Snapshot, replacing one with the same key
+    void Restore(const FrecencyEntry& entry);
+
+    std::vector<FrecencyEntry> Snapshot() const;
+    size_t Size() const;
+    void Clear();
+
+private:
+    void RecordLocked(const std::string& app, const std::string& directory, int64_t now);
+    void PruneLocked(int64_t now);
+
+    mutable std::mutex m_mutex;
+    std::vector<FrecencyEntry> m_entries;
+    std::unordered_map<std::string, size_t> m_index;  // app + '\n' + directory -> m_entries
+    size_t m_capacity;
+};
@@ -0,0 +1,221 @@
+#include "fuzzy_match.h"
+#include <cstring>
+
+// FUZZY_MATCH_NO_SSE2 forces the memchr search, for builds without SSE2 and
+// for testing the two against each other
+#if !defined(FUZZY_MATCH_NO_SSE2) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define FUZZY_MATCH_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+// Bytes readable past the end of the last candidate
+const size_t kPadding = 16;
+
+const int kScoreMatch = 16;
+const int kBonusBoundary = 8;
+const int kBonusConsecutive = 4;
+const int kPenaltyGapStart = 3;
+const int kPenaltyGapExtension = 1;
+
+char ToLower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+// Letters and digits have a bit each; everything else shares the rest
+uint64_t ClassOf(char lower) {
+    if (lower >= 'a' && lower <= 'z') {
+        return 1ull << (lower - 'a');
+    }
+    if (lower >= '0' && lower <= '9') {
+        return 1ull << (26 + lower - '0');
+    }
+    return 1ull << (36 + (unsigned char)lower % 28);
+}
+
+bool IsSeparator(char c) {
+    return c == ' ' || c == '\\' || c == '/' || c == '-' || c == '_' || c == '.' || c == ':';
+}
+
+enum CharKind : uint8_t {
+    kOther,
+    kSeparator,
+    kLower,
+    kUpper,
+    kDigit
+};
+
+// Per-byte case folding, class and kind, so indexing a candidate is table
+// lookups rather than a chain of comparisons per character
+struct CharTable {
+    char lower[256];
+    uint8_t classBit[256];
+    uint8_t kind[256];
+
+    CharTable() {
+        for (int i = 0; i < 256; i++) {
+            char c = (char)i;
+            lower[i] = ToLower(c);
+            uint64_t bit = ClassOf(lower[i]);
+            classBit[i] = 0;
+            while ((bit >>= 1) != 0) {
+                classBit[i]++;
+            }
+            kind[i] = IsSeparator(c) ? kSeparator : c >= 'a' && c <= 'z' ? kLower : c >= 'A' && c <= 'Z' ? kUpper :
+                c >= '0' && c <= '9' ? kDigit : kOther;
+        }
+    }
+};
+
+const CharTable& GetCharTable() {
+    static const CharTable table;
+    return table;
+}
+
+// Start of the string, after a separator, a lower-to-upper case change
+// ("Shell" in "PowerShell") or the first digit of a number
+bool IsWordStart(uint8_t previous, uint8_t kind) {
+    return previous == kSeparator || (previous == kLower && kind == kUpper) || (previous != kDigit && kind == kDigit);
+}
+
+// First position of c in [from, end), or end. text must be readable up
+// to the 16-byte block that holds end.
+size_t FindByte(const char* text, size_t from, size_t end, char c) {
+#ifdef FUZZY_MATCH_SSE2
+    __m128i needle = _mm_set1_epi8(c);
+    for (size_t i = from; i < end; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        unsigned int bits = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (bits != 0) {
+#ifdef _MSC_VER
+            unsigned long bit;
+            _BitScanForward(&bit, bits);
+#else
+            unsigned int bit = (unsigned int)__builtin_ctz(bits);
+#endif
+            return i + bit < end ? i + bit : end;
+        }
+    }
+    return end;
+#else
+    const void* found = from < end ? std::memchr(text + from, c, end - from) : nullptr;
+    return found != nullptr ? (size_t)(static_cast<const char*>(found) - text) : end;
+#endif
+}
+
+} // namespace
+
+FuzzyPattern::FuzzyPattern(std::string_view query)
+    : m_mask(0) {
+    for (char c : query) {
+        if (c != ' ') {
+            m_text.push_back(ToLower(c));
+            m_mask |= ClassOf(m_text.back());
+        }
+    }
+}
+
+bool FuzzyPattern::IsNarrowedBy(const FuzzyPattern& narrower) const {
+    size_t matched = 0;
+    for (size_t i = 0; i < narrower.m_text.size() && matched < m_text.size(); i++) {
+        if (narrower.m_text[i] == m_text[matched]) {
+            matched++;
+        }
+    }
+    return matched == m_text.size();
+}
+
+FuzzyIndex::FuzzyIndex() {
+    Clear();
+}
+
+void FuzzyIndex::Clear() {
+    m_text.assign(kPadding, '\0');
+    m_boundary.clear();
+    m_offsets.assign(1, 0);
+    m_masks.clear();
+}
+
+void FuzzyIndex::Add(std::string_view text) {
+    // The new text overwrites the padding of the previous one
+    const CharTable& table = GetCharTable();
+    size_t begin = m_offsets.back();
+    m_text.resize(begin + text.size() + kPadding, '\0');
+    m_boundary.resize(begin + text.size());
+    char* lower = &m_text[begin];
+    uint8_t* boundary = m_boundary.data() + begin;
+    uint64_t mask = 0;
+    uint8_t previous = kSeparator;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = (unsigned char)text[i];
+        uint8_t kind = table.kind[c];
+        lower[i] = table.lower[c];
+        boundary[i] = IsWordStart(previous, kind) ? 1 : 0;
+        mask |= 1ull << table.classBit[c];
+        previous = kind;
+    }
+    std::memset(lower + text.size(), 0, kPadding);
+    m_offsets.push_back((uint32_t)(begin + text.size()));
+    m_masks.push_back(mask);
+}
+
+bool FuzzyIndex::Match(const FuzzyPattern& pattern, size_t index, int& score) const {
+    score = 0;
+    const std::string& needle = pattern.Text();
+    if ((pattern.Mask() & ~m_masks[index]) != 0) {
+        return false;
+    }
+    if (needle.empty()) {
+        return true;
+    }
+
+    // Leftmost occurrence of each letter in turn finds where the first
+    // complete match ends...
+    const char* text = m_text.data() + m_offsets[index];
+    const uint8_t* boundary = m_boundary.data() + m_offsets[index];
+    size_t length = m_offsets[index + 1] - m_offsets[index];
+    size_t position = 0;
+    for (char c : needle) {
+        position = FindByte(text, position, length, c);
+        if (position == length) {
+            return false;
+        }
+        position++;
+    }
+
+    // ...and walking back from there finds the latest start, so the letters
+    // are scored in the shortest window that holds them
+    size_t start = position - 1;
+    for (size_t k = needle.size(); k-- > 0;) {
+        while (text[start] != needle[k]) {
+            start--;
+        }
+        if (k > 0) {
+            start--;
+        }
+    }
+
+    size_t previous = start;
+    position = start;
+    for (size_t k = 0; k < needle.size(); k++) {
+        position = FindByte(text, position, length, needle[k]);
+        int bonus = boundary[position] ? kBonusBoundary : 0;
+        if (k == 0) {
+            bonus *= 2;
+        }
+        else if (position == previous + 1) {
+            bonus = bonus > kBonusConsecutive ? bonus : kBonusConsecutive;
+        }
+        else {
+            score -= kPenaltyGapStart + kPenaltyGapExtension * (int)(position - previous - 2);
+        }
+        score += kScoreMatch + bonus;
+        previous = position++;
+    }
+    return true;
+}
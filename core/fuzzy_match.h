@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A palette query, lowercased and without spaces: "ps src" looks for the
+// letters p, s, s, r, c in that order
+class FuzzyPattern {
+public:
+    explicit FuzzyPattern(std::string_view query);
+
+    const std::string& Text() const {
+        return m_text;
+    }
+
+    bool Empty() const {
+        return m_text.empty();
+    }
+
+    uint64_t Mask() const {
+        return m_mask;
+    }
+
+    // Whether every candidate this pattern matches is also matched by
+    // narrower, e.g. after another letter was typed
+    bool IsNarrowedBy(const FuzzyPattern& narrower) const;
+
+private:
+    std::string m_text;
+    uint64_t m_mask;  // Character classes the text uses
+};
+
+// Candidates laid out for matching tens of thousands per keystroke: the
+// lowercased texts share one buffer, padded so 16-byte loads near the end
+// stay in bounds, with word-boundary flags beside it and a character-class
+// mask per candidate that rules most candidates out without reading text.
+// Characters are compared as bytes; only ASCII letters fold case.
+class FuzzyIndex {
+public:
+    FuzzyIndex();
+
+    void Clear();
+    void Add(std::string_view text);
+
+    size_t Size() const {
+        return m_offsets.size() - 1;
+    }
+
+    size_t Length(size_t index) const {
+        return m_offsets[index + 1] - m_offsets[index];
+    }
+
+    // True if the pattern's letters occur in candidate index in order. The
+    // score rewards letters at word starts ("ps" in "PowerShell") and runs
+    // of consecutive letters, and charges for gaps. An empty pattern
+    // matches everything with score 0.
+    bool Match(const FuzzyPattern& pattern, size_t index, int& score) const;
+
+private:
+    std::string m_text;
+    std::vector<uint8_t> m_boundary;  // Parallels m_text: 1 where a word starts
+    std::vector<uint32_t> m_offsets;  // Candidate i is [m_offsets[i], m_offsets[i + 1])
+    std::vector<uint64_t> m_masks;
+};
@@ -0,0 +1,327 @@
+#include "history_journal.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+enum RecordKind : uint8_t {
+    kRecordUse = 1,
+    kRecordEntry = 2
+};
+
+const size_t kRecordHeaderSize = 8;
+
+uint32_t Crc32(std::string_view data) {
+    struct Table {
+        uint32_t values[256];
+
+        Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                }
+                values[i] = crc;
+            }
+        }
+    };
+    static const Table table;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (char c : data) {
+        crc = table.values[(crc ^ (uint8_t)c) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void PutInteger(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out += (char)(value >> (8 * i));
+    }
+}
+
+bool PutString(std::string& out, const std::string& text) {
+    if (text.size() > 0xFFFF) {
+        return false;
+    }
+    PutInteger(out, text.size(), 2);
+    out += text;
+    return true;
+}
+
+// Length and CRC in front of a payload
+std::string Frame(const std::string& payload) {
+    std::string record;
+    record.reserve(kRecordHeaderSize + payload.size());
+    PutInteger(record, payload.size(), 4);
+    PutInteger(record, Crc32(payload), 4);
+    record += payload;
+    return record;
+}
+
+// Reads fields off the front of a payload; any read past the end fails
+// the whole record
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view data) : m_data(data), m_ok(true) {}
+
+    uint64_t Integer(size_t bytes) {
+        if (m_data.size() < bytes) {
+            m_ok = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= (uint64_t)(uint8_t)m_data[i] << (8 * i);
+        }
+        m_data.remove_prefix(bytes);
+        return value;
+    }
+
+    std::string String() {
+        size_t length = (size_t)Integer(2);
+        if (!m_ok || m_data.size() < length) {
+            m_ok = false;
+            return std::string();
+        }
+        std::string text(m_data.substr(0, length));
+        m_data.remove_prefix(length);
+        return text;
+    }
+
+    // Every field read and nothing left over
+    bool Done() const {
+        return m_ok && m_data.empty();
+    }
+
+private:
+    std::string_view m_data;
+    bool m_ok;
+};
+
+} // namespace
+
+std::string EncodeHistoryHeader() {
+    std::string header(kHistoryMagic, 4);
+    header += (char)kHistoryVersion;
+    header.append(3, '\0');
+    return header;
+}
+
+std::string EncodeHistoryUse(const std::string& app, const std::string& directory, int64_t time) {
+    std::string payload;
+    payload += (char)kRecordUse;
+    PutInteger(payload, (uint64_t)time, 8);
+    if (!PutString(payload, app) || !PutString(payload, directory)) {
+        return std::string();
+    }
+    return Frame(payload);
+}
+
+std::string EncodeHistoryEntry(const FrecencyEntry& entry) {
+    std::string payload;
+    payload += (char)kRecordEntry;
+    PutInteger(payload, (uint64_t)entry.lastUsed, 8);
+    PutInteger(payload, entry.uses, 4);
+    uint64_t score = 0;
+    std::memcpy(&score, &entry.score, sizeof(score));
+    PutInteger(payload, score, 8);
+    if (!PutString(payload, entry.app) || !PutString(payload, entry.directory)) {
+        return std::string();
+    }
+    return Frame(payload);
+}
+
+HistoryReplay ReplayHistoryJournal(std::string_view contents, FrecencyTable& table) {
+    HistoryReplay replay;
+    if (contents.size() < kHistoryHeaderSize || contents.substr(0, kHistoryHeaderSize) != EncodeHistoryHeader()) {
+        return replay;
+    }
+    replay.headerValid = true;
+    replay.validBytes = kHistoryHeaderSize;
+    replay.entryBytes = kHistoryHeaderSize;
+
+    size_t offset = kHistoryHeaderSize;
+    bool leadingEntries = true;
+    while (contents.size() - offset >= kRecordHeaderSize) {
+        PayloadReader header(contents.substr(offset, kRecordHeaderSize));
+        uint32_t size = (uint32_t)header.Integer(4);
+        uint32_t crc = (uint32_t)header.Integer(4);
+        if (size == 0 || size > kMaxHistoryRecord || contents.size() - offset - kRecordHeaderSize < size) {
+            break;
+        }
+        std::string_view payload = contents.substr(offset + kRecordHeaderSize, size);
+        if (Crc32(payload) != crc) {
+            break;
+        }
+
+        PayloadReader reader(payload);
+        uint8_t kind = (uint8_t)reader.Integer(1);
+        int64_t time = (int64_t)reader.Integer(8);
+        if (kind == kRecordUse) {
+            std::string app = reader.String();
+            std::string directory = reader.String();
+            if (!reader.Done() || app.empty()) {
+                break;
+            }
+            table.Record(app, directory, time);
+            replay.uses++;
+            leadingEntries = false;
+        }
+        else if (kind == kRecordEntry) {
+            FrecencyEntry entry;
+            entry.lastUsed = time;
+            entry.uses = (uint32_t)reader.Integer(4);
+            uint64_t score = reader.Integer(8);
+            std::memcpy(&entry.score, &score, sizeof(score));
+            entry.app = reader.String();
+            entry.directory = reader.String();
+            if (!reader.Done() || entry.app.empty()) {
+                break;
+            }
+            table.Restore(entry);
+            replay.entries++;
+        }
+        else {
+            break;
+        }
+
+        offset += kRecordHeaderSize + size;
+        replay.validBytes = offset;
+        if (leadingEntries) {
+            replay.entryBytes = offset;
+        }
+    }
+    return replay;
+}
+
+HistoryJournal::HistoryJournal(IJournalFile& file, FrecencyTable& table, size_t compactBytes)
+    : m_file(file), m_table(table), m_compactBytes(compactBytes), m_open(false), m_size(0), m_compactedSize(0) {
+}
+
+bool HistoryJournal::Open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_open = false;
+
+    std::string_view contents;
+    HistoryReplay replay;
+    size_t fileSize = 0;
+    if (m_file.Map(path, contents)) {
+        fileSize = contents.size();
+        replay = ReplayHistoryJournal(contents, m_table);
+        m_file.Unmap();
+    }
+
+    // A missing file is started; a damaged header leaves nothing to keep
+    if (!replay.headerValid) {
+        if (fileSize > 0) {
+            m_stats.repairs++;
+        }
+        if (!m_file.Replace(path, EncodeHistoryHeader())) {
+            m_stats.failures++;
+            return false;
+        }
+        replay.validBytes = kHistoryHeaderSize;
+        replay.entryBytes = kHistoryHeaderSize;
+    }
+    else if (replay.validBytes < fileSize) {
+        m_stats.repairs++;
+        if (!m_file.Truncate(path, replay.validBytes)) {
+            m_stats.failures++;
+            return false;
+        }
+    }
+
+    m_open = true;
+    m_size = replay.validBytes;
+    m_compactedSize = replay.entryBytes;
+    if (m_size > std::max<uint64_t>(m_compactBytes, 2 * m_compactedSize)) {
+        CompactLocked();
+    }
+    return true;
+}
+
+bool HistoryJournal::Load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string_view contents;
+    if (!m_file.Map(path, contents)) {
+        return false;
+    }
+    bool valid = ReplayHistoryJournal(contents, m_table).headerValid;
+    m_file.Unmap();
+    return valid;
+}
+
+void HistoryJournal::Record(const std::string& app, const std::string& directory, int64_t now) {
+    // Under one lock, so the file holds uses in the order the table saw them
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.Record(app, directory, now);
+    if (!m_open) {
+        return;
+    }
+    std::string record = EncodeHistoryUse(app, directory, now);
+    if (record.empty()) {
+        return;
+    }
+    if (!m_file.Append(m_path, record)) {
+        // Part of the record may have been written; later records would
+        // sit behind it, unreadable, so cut it off or stop appending
+        m_stats.failures++;
+        m_open = m_file.Truncate(m_path, m_size);
+        return;
+    }
+    m_stats.appended++;
+    m_size += record.size();
+
+    // Twice the compacted size keeps compactions rare when the table is
+    // large; the file never grows past that plus one record
+    if (m_size > std::max<uint64_t>(m_compactBytes, 2 * m_compactedSize)) {
+        CompactLocked();
+    }
+}
+
+bool HistoryJournal::Compact() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_open && CompactLocked();
+}
+
+bool HistoryJournal::CompactLocked() {
+    std::string contents = EncodeHistoryHeader();
+    for (const FrecencyEntry& entry : m_table.Snapshot()) {
+        contents += EncodeHistoryEntry(entry);
+    }
+    if (!m_file.Replace(m_path, contents)) {
+        m_stats.failures++;
+        return false;
+    }
+    m_stats.compactions++;
+    m_size = contents.size();
+    m_compactedSize = contents.size();
+    return true;
+}
+
+bool HistoryJournal::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.Clear();
+    if (!m_open) {
+        return true;
+    }
+    if (!m_file.Replace(m_path, EncodeHistoryHeader())) {
+        m_stats.failures++;
+        return false;
+    }
+    m_size = kHistoryHeaderSize;
+    m_compactedSize = kHistoryHeaderSize;
+    return true;
+}
+
+uint64_t HistoryJournal::FileSize() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+HistoryJournal::Stats HistoryJournal::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
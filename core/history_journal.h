@@ -0,0 +1,121 @@
+#pragma once
+#include "frecency.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Launch history on disk, so recent folders outlive the launcher. The file
+// is an append-only journal, all integers little-endian:
+//
+//   header   "CLHJ", version byte, three zero bytes
+//   record   u32 payload size, u32 CRC-32 of the payload, payload
+//   payload  u8 kind, i64 seconds since the epoch, then for an entry
+//            u32 uses and f64 score, then u16 length + bytes of the app
+//            name and of the directory
+//
+// A use record is one launch. Compaction rewrites the file as one entry
+// record per FrecencyTable entry, which restores the table as it was.
+
+const char kHistoryMagic[] = "CLHJ";
+const uint8_t kHistoryVersion = 1;
+const size_t kHistoryHeaderSize = 8;
+
+// The journal is compacted once it is this large, or twice its size after
+// the last compaction if that is larger
+const size_t kHistoryCompactBytes = 256 * 1024;
+
+// Longer records are treated as corrupt
+const uint32_t kMaxHistoryRecord = 2 * 65536 + 32;
+
+// The record encoders return an empty string for a name or directory
+// longer than 65535 bytes, which is not journaled
+std::string EncodeHistoryHeader();
+std::string EncodeHistoryUse(const std::string& app, const std::string& directory, int64_t time);
+std::string EncodeHistoryEntry(const FrecencyEntry& entry);
+
+// What replaying a journal found
+struct HistoryReplay {
+    bool headerValid;
+    size_t validBytes;  // Header and records that decoded; anything after is a torn or corrupt tail
+    size_t entryBytes;  // Of those, the header and the compacted entries leading the file
+    size_t uses;
+    size_t entries;
+
+    HistoryReplay() : headerValid(false), validBytes(0), entryBytes(0), uses(0), entries(0) {}
+};
+
+// Applies every record in contents to table, stopping at the first record
+// that is cut short, fails its CRC or does not decode
+HistoryReplay ReplayHistoryJournal(std::string_view contents, FrecencyTable& table);
+
+// Storage under HistoryJournal. On Windows reads map the file and appends
+// go through a handle kept open between launches; elsewhere a fake.
+class IJournalFile {
+public:
+    virtual ~IJournalFile() {}
+
+    // View of the whole file, valid until Unmap or the next write. False
+    // if the file does not exist or cannot be read.
+    virtual bool Map(const std::string& path, std::string_view& contents) = 0;
+    virtual void Unmap() = 0;
+
+    virtual bool Append(const std::string& path, std::string_view data) = 0;
+
+    // Cuts a torn tail off
+    virtual bool Truncate(const std::string& path, uint64_t size) = 0;
+
+    // Replaces the file in one step, as compaction needs
+    virtual bool Replace(const std::string& path, const std::string& contents) = 0;
+};
+
+// FrecencyTable kept in a journal file. Launch workers record uses while
+// the UI thread and the pipe server read, so all members lock.
+class HistoryJournal {
+public:
+    struct Stats {
+        uint64_t appended;
+        uint64_t compactions;
+        uint64_t repairs;      // Opens that cut off a torn or corrupt tail, or started over
+        uint64_t failures;     // Appends and rewrites the file refused
+
+        Stats() : appended(0), compactions(0), repairs(0), failures(0) {}
+    };
+
+    HistoryJournal(IJournalFile& file, FrecencyTable& table, size_t compactBytes = kHistoryCompactBytes);
+
+    // Replays path into the table, cuts off a damaged tail (or starts a new
+    // file if the header is damaged) and compacts it if it is over size.
+    // Later records are appended to it. False if the file cannot be written.
+    bool Open(const std::string& path);
+
+    // Replays path into the table without repairing or appending to it,
+    // for a one-off command while the file may belong to another process
+    bool Load(const std::string& path);
+
+    // Records a use in the table and, once Open succeeded, in the file
+    void Record(const std::string& app, const std::string& directory, int64_t now);
+
+    // Rewrites the file from the table
+    bool Compact();
+
+    // Empties the table and the file
+    bool Clear();
+
+    uint64_t FileSize() const;
+    Stats GetStats() const;
+
+private:
+    bool CompactLocked();
+
+    IJournalFile& m_file;
+    FrecencyTable& m_table;
+    size_t m_compactBytes;
+
+    mutable std::mutex m_mutex;
+    std::string m_path;
+    bool m_open;
+    uint64_t m_size;
+    uint64_t m_compactedSize;
+    Stats m_stats;
+};
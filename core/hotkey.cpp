@@ -0,0 +1,227 @@
+#include "hotkey.h"
+
+namespace {
+
+// Virtual key codes (VK_*) used by the hotkey syntax
+const unsigned int kVkF1 = 0x70;
+const unsigned int kVkF24 = 0x87;
+
+struct NamedKey {
+    const char* name;
+    unsigned int vkCode;
+};
+
+// Accepted names; the first name for a key is the one VirtualKeyToString uses
+const NamedKey kNamedKeys[] = {
+    { "Delete", 0x2E }, { "Del", 0x2E },
+    { "Insert", 0x2D }, { "Ins", 0x2D },
+    { "Home", 0x24 },
+    { "End", 0x23 },
+    { "PageUp", 0x21 }, { "PgUp", 0x21 },
+    { "PageDown", 0x22 }, { "PgDn", 0x22 },
+    { "Up", 0x26 }, { "Down", 0x28 }, { "Left", 0x25 }, { "Right", 0x27 },
+    { "Space", 0x20 },
+    { "Tab", 0x09 },
+    { "Enter", 0x0D }, { "Return", 0x0D },
+    { "Escape", 0x1B }, { "Esc", 0x1B },
+    { "Backspace", 0x08 }, { "Back", 0x08 },
+    { "Numpad0", 0x60 }, { "Numpad1", 0x61 }, { "Numpad2", 0x62 },
+    { "Numpad3", 0x63 }, { "Numpad4", 0x64 }, { "Numpad5", 0x65 },
+    { "Numpad6", 0x66 }, { "Numpad7", 0x67 }, { "Numpad8", 0x68 },
+    { "Numpad9", 0x69 },
+    { "Multiply", 0x6A }, { "Add", 0x6B }, { "Subtract", 0x6D },
+    { "Divide", 0x6F }, { "Decimal", 0x6E }
+};
+
+// US layout punctuation; shifted characters share their key
+struct CharacterKey {
+    char unshifted;
+    char shifted;
+    unsigned int vkCode;
+};
+
+const CharacterKey kUsPunctuation[] = {
+    { ';', ':', 0xBA }, { '=', '+', 0xBB }, { ',', '<', 0xBC }, { '-', '_', 0xBD },
+    { '.', '>', 0xBE }, { '/', '?', 0xBF }, { '`', '~', 0xC0 }, { '[', '{', 0xDB },
+    { '\\', '|', 0xDC }, { ']', '}', 0xDD }, { '\'', '"', 0xDE }
+};
+
+// Shifted digit row: ")!@#$%^&*(" sit on 0-9
+const char kShiftedDigits[] = ")!@#$%^&*(";
+
+char ToUpperAscii(char c) {
+    return c >= 'a' && c <= 'z' ? (char)(c - 'a' + 'A') : c;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (ToUpperAscii(a[i]) != ToUpperAscii(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ContainsIgnoreCase(std::string_view text, std::string_view part) {
+    for (size_t i = 0; i + part.size() <= text.size(); i++) {
+        if (EqualsIgnoreCase(text.substr(i, part.size()), part)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view Trim(std::string_view text) {
+    const char* whitespace = " \t\r\n";
+    size_t first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) {
+        return text.substr(0, 0);
+    }
+    size_t last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace
+
+bool MapUsLayoutCharacter(char c, unsigned int& vkCode) {
+    c = ToUpperAscii(c);
+    if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ' ') {
+        vkCode = (unsigned char)c;
+        return true;
+    }
+    for (size_t i = 0; i < 10; i++) {
+        if (kShiftedDigits[i] == c) {
+            vkCode = '0' + (unsigned int)i;
+            return true;
+        }
+    }
+    for (const CharacterKey& key : kUsPunctuation) {
+        if (key.unshifted == c || key.shifted == c) {
+            vkCode = key.vkCode;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseHotkey(std::string_view text, unsigned int& modifiers, unsigned int& vkCode, CharacterKeyMapper mapCharacter) {
+    modifiers = 0;
+    vkCode = 0;
+
+    if (ContainsIgnoreCase(text, "CTRL")) modifiers |= kModifierControl;
+    if (ContainsIgnoreCase(text, "ALT")) modifiers |= kModifierAlt;
+    if (ContainsIgnoreCase(text, "SHIFT")) modifiers |= kModifierShift;
+    if (ContainsIgnoreCase(text, "WIN")) modifiers |= kModifierWin;
+
+    // The key follows the last '+'; without modifiers the whole string is the key
+    size_t lastPlus = text.find_last_of('+');
+    std::string_view key = text;
+    if (lastPlus != std::string_view::npos && lastPlus + 1 < text.size()) {
+        key = text.substr(lastPlus + 1);
+    }
+    key = Trim(key);
+
+    if (key.empty()) {
+        return false;
+    }
+
+    // F1-F24; "F" followed by something other than a number is not a key
+    if (key.size() >= 2 && ToUpperAscii(key[0]) == 'F') {
+        std::string_view number = Trim(key.substr(1));
+        int fNum = 0;
+        size_t digits = 0;
+        while (digits < number.size() && number[digits] >= '0' && number[digits] <= '9' && fNum < 100) {
+            fNum = fNum * 10 + (number[digits] - '0');
+            digits++;
+        }
+        if (digits == 0) {
+            return false;
+        }
+        if (fNum >= 1 && fNum <= 24) {
+            vkCode = kVkF1 + (fNum - 1);
+            return true;
+        }
+    }
+
+    for (const NamedKey& named : kNamedKeys) {
+        if (EqualsIgnoreCase(key, named.name)) {
+            vkCode = named.vkCode;
+            return true;
+        }
+    }
+
+    // Single character keys (letters, numbers, symbols)
+    if (key.size() == 1) {
+        return mapCharacter(ToUpperAscii(key[0]), vkCode);
+    }
+
+    return false;
+}
+
+bool ParseHotkeyUsLayout(std::string_view text, unsigned int& modifiers, unsigned int& vkCode) {
+    return ParseHotkey(text, modifiers, vkCode, MapUsLayoutCharacter);
+}
+
+std::string VirtualKeyToString(unsigned int vkCode) {
+    if (vkCode >= kVkF1 && vkCode <= kVkF24) {
+        return "F" + std::to_string(vkCode - kVkF1 + 1);
+    }
+
+    for (const NamedKey& named : kNamedKeys) {
+        if (named.vkCode == vkCode) {
+            return named.name;
+        }
+    }
+
+    for (const CharacterKey& key : kUsPunctuation) {
+        if (key.vkCode == vkCode) {
+            return std::string(1, key.unshifted);
+        }
+    }
+
+    // 0-9, A-Z, and anything else as its raw code
+    return std::string(1, (char)vkCode);
+}
+
+std::string FormatHotkey(unsigned int modifiers, unsigned int vkCode) {
+    std::string hotkey;
+    if (modifiers & kModifierControl) hotkey += "Ctrl+";
+    if (modifiers & kModifierAlt) hotkey += "Alt+";
+    if (modifiers & kModifierShift) hotkey += "Shift+";
+    if (modifiers & kModifierWin) hotkey += "Win+";
+    return hotkey + VirtualKeyToString(vkCode);
+}
+
+std::vector<std::string_view> SplitHotkeySequence(std::string_view text) {
+    std::vector<std::string_view> steps;
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        std::string_view step = Trim(text.substr(start, i - start));
+        if (text[i] != ',' || step.empty() || step.back() == '+') {
+            continue;
+        }
+        steps.push_back(step);
+        start = i + 1;
+    }
+    steps.push_back(Trim(text.substr(start)));
+    return steps;
+}
+
+std::string FormatHotkeySequence(const std::vector<KeyStroke>& steps) {
+    std::string text;
+    for (const KeyStroke& step : steps) {
+        if (!text.empty()) {
+            text += ", ";
+        }
+        text += FormatHotkey(step.modifiers, step.vkCode);
+    }
+    return text;
+}
+
+bool CanStartSequence(const KeyStroke& stroke) {
+    return (stroke.modifiers & (kModifierControl | kModifierAlt | kModifierWin)) != 0 ||
+        (stroke.vkCode >= kVkF1 && stroke.vkCode <= kVkF24);
+}
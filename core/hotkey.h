@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// MOD_* flags, with the values RegisterHotKey expects
+const unsigned int kModifierAlt = 0x0001;
+const unsigned int kModifierControl = 0x0002;
+const unsigned int kModifierShift = 0x0004;
+const unsigned int kModifierWin = 0x0008;
+
+// One step of a hotkey: MOD_* flags plus a virtual key code
+struct KeyStroke {
+    unsigned int modifiers;
+    unsigned int vkCode;
+
+    KeyStroke() : modifiers(0), vkCode(0) {}
+    KeyStroke(unsigned int m, unsigned int v) : modifiers(m), vkCode(v) {}
+
+    bool operator==(const KeyStroke& other) const {
+        return modifiers == other.modifiers && vkCode == other.vkCode;
+    }
+};
+
+// Longest hotkey sequence ("Ctrl+Alt+L, P") the config accepts
+const size_t kMaxSequenceSteps = 4;
+
+// Maps a printable character to the virtual key that types it. On Windows
+// this is VkKeyScan for the active keyboard layout.
+typedef bool (*CharacterKeyMapper)(char c, unsigned int& vkCode);
+
+// US keyboard layout, used when no platform mapper is available
+bool MapUsLayoutCharacter(char c, unsigned int& vkCode);
+
+// Parses "Ctrl+Alt+P", "Win+F12", "Numpad5" or a single key into MOD_*
+// flags and a virtual key code. Names are case-insensitive; single
+// characters go through mapCharacter.
+bool ParseHotkey(std::string_view text, unsigned int& modifiers, unsigned int& vkCode, CharacterKeyMapper mapCharacter);
+
+// ParseHotkey with the US layout; matches the HotkeyParser signature
+bool ParseHotkeyUsLayout(std::string_view text, unsigned int& modifiers, unsigned int& vkCode);
+
+// "F5", "PageUp", "Numpad3", "P", ";"
+std::string VirtualKeyToString(unsigned int vkCode);
+
+// "Ctrl+Alt+Shift+Win+P", the form ParseHotkey reads back
+std::string FormatHotkey(unsigned int modifiers, unsigned int vkCode);
+
+// Splits "Ctrl+Alt+L, P" into its steps at commas. A comma that is itself
+// the key of a step ("Ctrl+,") does not split. Steps are trimmed; a plain
+// hotkey is a single step.
+std::vector<std::string_view> SplitHotkeySequence(std::string_view text);
+
+// "Ctrl+Alt+L, P", the form SplitHotkeySequence reads back
+std::string FormatHotkeySequence(const std::vector<KeyStroke>& steps);
+
+// Whether a sequence may start with stroke: only with Ctrl, Alt or Win held,
+// or on a function key, so it never takes a key away from plain typing
+bool CanStartSequence(const KeyStroke& stroke);
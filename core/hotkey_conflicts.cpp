@@ -0,0 +1,97 @@
+#include "hotkey_conflicts.h"
+#include <algorithm>
+
+namespace {
+
+// Each step fits in 12 bits (four MOD_* flags and an 8-bit virtual key),
+// so up to kMaxSequenceSteps steps and the step count fit in one key
+uint64_t BindingKey(const KeyStroke* steps, size_t count) {
+    uint64_t key = count;
+    for (size_t i = 0; i < count; i++) {
+        key = key << 12 | (steps[i].modifiers & 0xF) << 8 | (steps[i].vkCode & 0xFF);
+    }
+    return key;
+}
+
+// Whether RegisterHotKey is asked for the app's hotkey
+bool IsPlainHotkey(const AppConfig& app) {
+    return app.sequence.empty() && app.vkCode != 0;
+}
+
+} // namespace
+
+void HotkeyIndex::Clear() {
+    m_owners.clear();
+}
+
+int HotkeyIndex::Add(const KeyStroke* steps, size_t count, int owner) {
+    auto inserted = m_owners.emplace(BindingKey(steps, count), owner);
+    return inserted.second ? -1 : inserted.first->second;
+}
+
+int HotkeyIndex::Find(const KeyStroke* steps, size_t count) const {
+    auto it = m_owners.find(BindingKey(steps, count));
+    return it == m_owners.end() ? -1 : it->second;
+}
+
+void HotkeyStatus::Record(const HotkeyPlan& plan, const std::vector<const AppConfig*>& failed) {
+    for (int hotkeyId : plan.unregisterIds) {
+        m_failedIds.erase(hotkeyId);
+    }
+    for (const AppConfig* app : plan.registerApps) {
+        m_failedIds.erase(app->hotkeyId);
+    }
+    for (const AppConfig* app : failed) {
+        m_failedIds.insert(app->hotkeyId);
+    }
+}
+
+void HotkeyStatus::AddRetries(const ConfigSnapshot& config, HotkeyPlan& plan) const {
+    for (int hotkeyId : m_failedIds) {
+        const AppConfig* app = config.FindByHotkey(hotkeyId);
+        if (app != nullptr && app->enabled && IsPlainHotkey(*app) &&
+            std::find(plan.registerApps.begin(), plan.registerApps.end(), app) == plan.registerApps.end()) {
+            plan.registerApps.push_back(app);
+        }
+    }
+}
+
+HotkeyState HotkeyStatus::StateOf(const AppConfig& app) const {
+    if (app.vkCode == 0) {
+        return HotkeyState::None;
+    }
+    else if (!app.enabled) {
+        return HotkeyState::Disabled;
+    }
+    else if (!app.sequence.empty()) {
+        return HotkeyState::Sequence;
+    }
+    return m_failedIds.count(app.hotkeyId) != 0 ? HotkeyState::Failed : HotkeyState::Registered;
+}
+
+std::string FormatHotkeyStatus(const AppConfig& app, HotkeyState state) {
+    if (state == HotkeyState::None) {
+        return "no hotkey";
+    }
+    std::string hotkey = app.sequence.empty() ? FormatHotkey(app.modifiers, app.vkCode) : FormatHotkeySequence(app.sequence);
+    return state == HotkeyState::Failed ? hotkey + " (in use)" : hotkey;
+}
+
+std::string FormatHotkeyFailures(const std::vector<const AppConfig*>& failed, const KeyStroke* palette, size_t maxShown) {
+    std::vector<std::string> lines;
+    for (const AppConfig* app : failed) {
+        lines.push_back(FormatHotkey(app->modifiers, app->vkCode) + " for " + app->name);
+    }
+    if (palette != nullptr) {
+        lines.push_back(FormatHotkey(palette->modifiers, palette->vkCode) + " for the palette");
+    }
+
+    std::string text;
+    for (size_t i = 0; i < lines.size() && i < maxShown; i++) {
+        text += "- " + lines[i] + "\n";
+    }
+    if (lines.size() > maxShown) {
+        text += "- ... and " + std::to_string(lines.size() - maxShown) + " more\n";
+    }
+    return text;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "config.h"
+#include "config_diff.h"
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Owners of hotkey bindings, keyed by the whole binding so a clash is one
+// lookup instead of a comparison against every other entry. A plain hotkey
+// is a binding of one step; sequences have two or more, so the two never
+// share a key.
+class HotkeyIndex {
+public:
+    void Clear();
+
+    // Returns the owner already holding steps[0..count), or -1 after
+    // recording owner for it. The first owner keeps the binding.
+    int Add(const KeyStroke* steps, size_t count, int owner);
+
+    // Owner of steps[0..count), or -1
+    int Find(const KeyStroke* steps, size_t count) const;
+
+    size_t Size() const {
+        return m_owners.size();
+    }
+
+private:
+    std::unordered_map<uint64_t, int> m_owners;
+};
+
+// Why an app's hotkey does or does not fire, as shown in the tray menu
+enum class HotkeyState {
+    Registered,  // Held through RegisterHotKey
+    Sequence,    // Matched by the keyboard hook
+    Failed,      // RegisterHotKey refused it, usually because another program holds it
+    Disabled,
+    None         // launcher.ini gives the entry no usable hotkey
+};
+
+// Registration outcome by hotkey id. Reloads only register the apps whose
+// binding changed, so each app keeps the outcome of its last attempt until
+// a plan touches it again. Used from the message loop only.
+class HotkeyStatus {
+public:
+    // Call with a plan ApplyHotkeyPlan ran and the apps it returned
+    void Record(const HotkeyPlan& plan, const std::vector<const AppConfig*>& failed);
+
+    // Adds the apps of config whose last registration failed to plan, so a
+    // reload retries them once the other program has let go
+    void AddRetries(const ConfigSnapshot& config, HotkeyPlan& plan) const;
+
+    HotkeyState StateOf(const AppConfig& app) const;
+
+    size_t FailedCount() const {
+        return m_failedIds.size();
+    }
+
+    void Clear() {
+        m_failedIds.clear();
+    }
+
+private:
+    std::set<int> m_failedIds;
+};
+
+// "Ctrl+Alt+T (in use)", "Ctrl+Alt+L, P" or "no hotkey": the hotkey column
+// of the app's tray menu item
+std::string FormatHotkeyStatus(const AppConfig& app, HotkeyState state);
+
+// One "- Ctrl+Alt+T for Terminal" line per refused hotkey, the palette's
+// last, truncated after maxShown entries like FormatDiagnostics. palette
+// is null unless paletteHotkey was refused too.
+std::string FormatHotkeyFailures(const std::vector<const AppConfig*>& failed, const KeyStroke* palette, size_t maxShown);
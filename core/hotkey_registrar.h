@@ -0,0 +1,12 @@
+#pragma once
+
+// System-wide hotkey registration. On Windows this is RegisterHotKey on the
+// launcher window; elsewhere it is a fake that records calls.
+class IHotkeyRegistrar {
+public:
+    virtual ~IHotkeyRegistrar() {}
+
+    // modifiers are MOD_* flags, vkCode a virtual key code
+    virtual bool Register(int hotkeyId, unsigned int modifiers, unsigned int vkCode) = 0;
+    virtual void Unregister(int hotkeyId) = 0;
+};
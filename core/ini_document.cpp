@@ -0,0 +1,101 @@
+#include "ini_document.h"
+#include "ini_reader.h"
+
+namespace {
+
+const char kByteOrderMark[] = "\xEF\xBB\xBF";
+
+// Reads one stored line on its own, so offsets are relative to that line
+bool ReadLine(const std::string& text, IniLine& line) {
+    IniReader reader(text);
+    return reader.Next(line);
+}
+
+} // namespace
+
+IniDocument::IniDocument(std::string_view text)
+    : m_newline("\n"), m_byteOrderMark(false), m_finalNewline(false) {
+    if (text.size() >= 3 && text.compare(0, 3, kByteOrderMark) == 0) {
+        m_byteOrderMark = true;
+        text.remove_prefix(3);
+    }
+
+    size_t firstBreak = text.find('\n');
+    if (firstBreak != std::string_view::npos && firstBreak > 0 && text[firstBreak - 1] == '\r') {
+        m_newline = "\r\n";
+    }
+    m_finalNewline = !text.empty() && text.back() == '\n';
+
+    size_t offset = 0;
+    while (offset < text.size()) {
+        size_t end = text.find('\n', offset);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view line = text.substr(offset, end - offset);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        m_lines.push_back(std::string(line));
+        offset = end + 1;
+    }
+}
+
+int IniDocument::FindKey(std::string_view section, std::string_view key) const {
+    int found = -1;
+    bool inSection = false;
+    for (size_t i = 0; i < m_lines.size(); i++) {
+        IniLine line;
+        if (!ReadLine(m_lines[i], line)) {
+            continue;
+        }
+        if (line.kind == IniLine::Kind::Section) {
+            inSection = (line.name == section);
+        }
+        else if (inSection && line.kind == IniLine::Kind::KeyValue && line.name == key) {
+            found = (int)i;
+        }
+    }
+    return found;
+}
+
+bool IniDocument::GetValue(std::string_view section, std::string_view key, std::string& value) const {
+    int index = FindKey(section, key);
+    if (index < 0) {
+        return false;
+    }
+    IniLine line;
+    ReadLine(m_lines[index], line);
+    value = std::string(line.value);
+    return true;
+}
+
+bool IniDocument::SetValue(std::string_view section, std::string_view key, std::string_view value) {
+    int index = FindKey(section, key);
+    if (index < 0) {
+        return false;
+    }
+
+    // Splice over the trimmed value only; indentation, the '=' spacing and
+    // anything after the value stay as the user wrote them
+    std::string& text = m_lines[index];
+    IniLine line;
+    ReadLine(text, line);
+    size_t start = line.valueColumn - 1;
+    text.replace(start, line.value.size(), value.data(), value.size());
+    return true;
+}
+
+std::string IniDocument::Text() const {
+    std::string text;
+    if (m_byteOrderMark) {
+        text += kByteOrderMark;
+    }
+    for (size_t i = 0; i < m_lines.size(); i++) {
+        text += m_lines[i];
+        if (i + 1 < m_lines.size() || m_finalNewline) {
+            text += m_newline;
+        }
+    }
+    return text;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Editable INI file that keeps every original line. Edits replace only the
+// value text of one key, so comments, blank lines, ordering and spacing
+// around '=' survive a round trip byte for byte (apart from mixed line
+// endings, which are written back in the file's first style).
+class IniDocument {
+public:
+    explicit IniDocument(std::string_view text);
+
+    // Value of the last definition of key in section, as the parser reads it
+    bool GetValue(std::string_view section, std::string_view key, std::string& value) const;
+
+    // Replaces the value of the last definition of key in section. Returns
+    // false if the key does not exist.
+    bool SetValue(std::string_view section, std::string_view key, std::string_view value);
+
+    std::string Text() const;
+
+private:
+    int FindKey(std::string_view section, std::string_view key) const;
+
+    std::vector<std::string> m_lines;
+    std::string m_newline;
+    bool m_byteOrderMark;
+    bool m_finalNewline;
+};
@@ -0,0 +1,83 @@
+#include "ini_reader.h"
+
+static const char* const kWhitespace = " \t\r\n";
+
+std::string_view TrimView(std::string_view text) {
+    size_t first = text.find_first_not_of(kWhitespace);
+    if (first == std::string_view::npos) {
+        return text.substr(0, 0);
+    }
+    size_t last = text.find_last_not_of(kWhitespace);
+    return text.substr(first, last - first + 1);
+}
+
+int ColumnOf(std::string_view line, std::string_view part) {
+    if (part.data() < line.data() || part.data() > line.data() + line.size()) {
+        return 1;
+    }
+    return (int)(part.data() - line.data()) + 1;
+}
+
+IniReader::IniReader(std::string_view text)
+    : m_text(text), m_offset(0), m_lineNumber(0) {
+    // Skip a UTF-8 byte order mark left by Notepad
+    if (m_text.size() >= 3 && m_text.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        m_offset = 3;
+    }
+}
+
+bool IniReader::Next(IniLine& line) {
+    if (m_offset >= m_text.size()) {
+        return false;
+    }
+
+    size_t end = m_text.find('\n', m_offset);
+    if (end == std::string_view::npos) {
+        end = m_text.size();
+    }
+
+    std::string_view raw = m_text.substr(m_offset, end - m_offset);
+    if (!raw.empty() && raw.back() == '\r') {
+        raw.remove_suffix(1);
+    }
+    m_offset = end + 1;
+
+    line = IniLine();
+    line.number = ++m_lineNumber;
+    line.raw = raw;
+
+    std::string_view trimmed = TrimView(raw);
+
+    // Skip empty lines and comments
+    if (trimmed.empty()) {
+        line.kind = IniLine::Kind::Blank;
+        return true;
+    }
+    if (trimmed[0] == ';' || trimmed[0] == '#') {
+        line.kind = IniLine::Kind::Comment;
+        return true;
+    }
+
+    // Check for section header
+    if (trimmed[0] == '[' && trimmed.back() == ']') {
+        line.kind = IniLine::Kind::Section;
+        line.name = TrimView(trimmed.substr(1, trimmed.size() - 2));
+        line.nameColumn = ColumnOf(raw, line.name);
+        return true;
+    }
+
+    // Parse key=value
+    size_t equalsPos = trimmed.find('=');
+    if (equalsPos == std::string_view::npos) {
+        line.kind = IniLine::Kind::Malformed;
+        line.nameColumn = ColumnOf(raw, trimmed);
+        return true;
+    }
+
+    line.kind = IniLine::Kind::KeyValue;
+    line.name = TrimView(trimmed.substr(0, equalsPos));
+    line.value = TrimView(trimmed.substr(equalsPos + 1));
+    line.nameColumn = ColumnOf(raw, trimmed);
+    line.valueColumn = ColumnOf(raw, line.value);
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <string_view>
+
+// One line of an INI buffer. All views point into the caller's buffer; the
+// reader never allocates.
+struct IniLine {
+    enum class Kind {
+        Blank,
+        Comment,
+        Section,
+        KeyValue,
+        Malformed
+    };
+
+    Kind kind;
+    int number;              // 1-based line number
+    std::string_view raw;    // Whole line without the line terminator
+    std::string_view name;   // Section name, or key for KeyValue
+    std::string_view value;  // Trimmed value for KeyValue
+    int nameColumn;          // 1-based column of name
+    int valueColumn;         // 1-based column of value
+
+    IniLine() : kind(Kind::Blank), number(0), nameColumn(0), valueColumn(0) {}
+};
+
+// Single forward pass over an INI buffer, one line per Next() call
+class IniReader {
+public:
+    explicit IniReader(std::string_view text);
+
+    bool Next(IniLine& line);
+
+private:
+    std::string_view m_text;
+    size_t m_offset;
+    int m_lineNumber;
+};
+
+// Whitespace trimming on views, matching the old Trim() character set
+std::string_view TrimView(std::string_view text);
+
+// Column (1-based) of a view that points into line
+int ColumnOf(std::string_view line, std::string_view part);
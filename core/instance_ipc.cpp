@@ -0,0 +1,258 @@
+#include "instance_ipc.h"
+#include <cstdio>
+
+namespace {
+
+struct CommandName {
+    IpcCommand command;
+    const char* name;
+};
+
+const CommandName kCommandNames[] = {
+    { IpcCommand::Launch, "launch" },
+    { IpcCommand::LaunchDefault, "launch-default" },
+    { IpcCommand::PrintContext, "print-context" },
+    { IpcCommand::History, "history" },
+};
+
+bool ReadExactly(IIpcStream& stream, char* buffer, size_t size) {
+    while (size > 0) {
+        size_t bytesRead = 0;
+        if (!stream.Read(buffer, size, bytesRead) || bytesRead == 0) {
+            return false;
+        }
+        buffer += bytesRead;
+        size -= bytesRead;
+    }
+    return true;
+}
+
+// Length of the UTF-8 sequence starting at text[at], or 0 if it is not a
+// valid one (stray continuation byte, overlong form, surrogate, > U+10FFFF)
+size_t Utf8SequenceLength(const std::string& text, size_t at) {
+    unsigned char lead = (unsigned char)text[at];
+    size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    }
+    if (length == 0 || at + length > text.size()) {
+        return 0;
+    }
+
+    for (size_t i = 1; i < length; i++) {
+        unsigned char byte = (unsigned char)text[at + i];
+        if (byte < (i == 1 ? low : 0x80) || byte > (i == 1 ? high : 0xBF)) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+void AppendJsonString(std::string& out, const std::string& text) {
+    static const char kHex[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        unsigned char byte = (unsigned char)c;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if (byte < 0x20) {
+            out += "\\u00";
+            out += kHex[byte >> 4];
+            out += kHex[byte & 0xF];
+        }
+        else if (byte < 0x80) {
+            out += c;
+        }
+        else {
+            size_t length = Utf8SequenceLength(text, i);
+            if (length == 0) {
+                out += "\\ufffd";
+            }
+            else {
+                out.append(text, i, length);
+                i += length - 1;
+            }
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+std::string EncodeIpcRequest(const IpcRequest& request) {
+    std::string payload;
+    for (const CommandName& entry : kCommandNames) {
+        if (entry.command == request.command) {
+            payload = entry.name;
+        }
+    }
+    payload += '\n';
+    payload += request.argument;
+    return payload;
+}
+
+IpcRequest DecodeIpcRequest(std::string_view payload) {
+    size_t newline = payload.find('\n');
+    std::string_view name = payload.substr(0, newline);
+
+    IpcRequest request;
+    for (const CommandName& entry : kCommandNames) {
+        if (name == entry.name) {
+            request.command = entry.command;
+        }
+    }
+    if (newline != std::string_view::npos) {
+        request.argument = std::string(payload.substr(newline + 1));
+    }
+    return request;
+}
+
+std::string EncodeIpcResponse(const IpcResponse& response) {
+    return (response.ok ? "ok\n" : "error\n") + response.body;
+}
+
+bool DecodeIpcResponse(std::string_view payload, IpcResponse& response) {
+    size_t newline = payload.find('\n');
+    if (newline == std::string_view::npos) {
+        return false;
+    }
+
+    std::string_view status = payload.substr(0, newline);
+    if (status != "ok" && status != "error") {
+        return false;
+    }
+    response.ok = (status == "ok");
+    response.body = std::string(payload.substr(newline + 1));
+    return true;
+}
+
+bool WriteIpcMessage(IIpcStream& stream, std::string_view payload) {
+    if (payload.size() > kMaxIpcMessage) {
+        return false;
+    }
+
+    uint32_t size = (uint32_t)payload.size();
+    std::string frame;
+    frame.reserve(4 + payload.size());
+    for (int i = 0; i < 4; i++) {
+        frame += (char)((size >> (8 * i)) & 0xFF);
+    }
+    frame.append(payload.data(), payload.size());
+    return stream.Write(frame.data(), frame.size());
+}
+
+bool ReadIpcMessage(IIpcStream& stream, std::string& payload) {
+    unsigned char header[4];
+    if (!ReadExactly(stream, reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+
+    uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | ((uint32_t)header[3] << 24);
+    if (size > kMaxIpcMessage) {
+        return false;
+    }
+
+    payload.resize(size);
+    return size == 0 || ReadExactly(stream, &payload[0], size);
+}
+
+IpcDispatcher::IpcDispatcher(IInstanceCommands& commands)
+    : m_commands(commands) {
+}
+
+IpcResponse IpcDispatcher::Dispatch(const IpcRequest& request) {
+    switch (request.command) {
+    case IpcCommand::Launch:
+        if (request.argument.empty()) {
+            return IpcResponse(false, "missing app name");
+        }
+        return m_commands.Launch(request.argument);
+
+    case IpcCommand::LaunchDefault:
+        return m_commands.LaunchDefault();
+
+    case IpcCommand::PrintContext:
+        return m_commands.PrintContext();
+
+    case IpcCommand::History: {
+        size_t count = kDefaultHistoryCount;
+        if (!request.argument.empty()) {
+            count = 0;
+            for (char c : request.argument) {
+                if (c < '0' || c > '9' || count > kMaxHistoryCount) {
+                    return IpcResponse(false, "history count must be a number from 1 to " + std::to_string(kMaxHistoryCount));
+                }
+                count = count * 10 + (c - '0');
+            }
+            if (count == 0 || count > kMaxHistoryCount) {
+                return IpcResponse(false, "history count must be a number from 1 to " + std::to_string(kMaxHistoryCount));
+            }
+        }
+        return m_commands.History(count);
+    }
+
+    case IpcCommand::Unknown:
+        break;
+    }
+    return IpcResponse(false, "unknown command");
+}
+
+void IpcDispatcher::Serve(IIpcStream& stream) {
+    std::string payload;
+    while (ReadIpcMessage(stream, payload)) {
+        IpcResponse response = Dispatch(DecodeIpcRequest(payload));
+        if (!WriteIpcMessage(stream, EncodeIpcResponse(response))) {
+            break;
+        }
+    }
+}
+
+bool CallInstance(IIpcStream& stream, const IpcRequest& request, IpcResponse& response) {
+    std::string payload;
+    return WriteIpcMessage(stream, EncodeIpcRequest(request)) &&
+        ReadIpcMessage(stream, payload) &&
+        DecodeIpcResponse(payload, response);
+}
+
+std::string FormatLaunchContextJson(const std::string& directory, WindowHandle hoverWindow, WindowHandle focusWindow) {
+    std::string json = "{\"directory\": ";
+    AppendJsonString(json, directory);
+    json += ", \"hoverWindow\": " + std::to_string(hoverWindow);
+    json += ", \"focusWindow\": " + std::to_string(focusWindow);
+    json += "}";
+    return json;
+}
+
+std::string FormatHistoryJson(const std::vector<FrecencyEntry>& entries, int64_t now) {
+    std::string json = "[";
+    for (size_t i = 0; i < entries.size(); i++) {
+        const FrecencyEntry& entry = entries[i];
+        char score[32];
+        snprintf(score, sizeof(score), "%.3f", FrecencyAt(entry, now));
+        json += i == 0 ? "\n  {\"app\": " : ",\n  {\"app\": ";
+        AppendJsonString(json, entry.app);
+        json += ", \"directory\": ";
+        AppendJsonString(json, entry.directory);
+        json += ", \"score\": ";
+        json += score;
+        json += ", \"uses\": " + std::to_string(entry.uses);
+        json += ", \"lastUsed\": " + std::to_string(entry.lastUsed) + "}";
+    }
+    json += entries.empty() ? "]" : "\n]";
+    return json;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "frecency.h"
+#include "window_handle.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Protocol between a short-lived launcher process (--oneshot, --launch,
+// --print-context, --history) and the running instance, which answers from its warm
+// config and directory caches. Transport-agnostic: on Windows the stream is
+// a named pipe, anything byte-oriented works.
+//
+// Each message is a 4-byte little-endian length followed by the payload.
+// A request payload is "<command>\n<argument>"; a response payload is
+// "ok\n<body>" or "error\n<body>".
+
+// Larger frames are treated as a broken peer
+const uint32_t kMaxIpcMessage = 64 * 1024;
+
+// Recent directories a history request returns without, and at most with,
+// a count; the most keeps the body well inside one frame
+const size_t kDefaultHistoryCount = 20;
+const size_t kMaxHistoryCount = 100;
+
+enum class IpcCommand {
+    Launch,         // Argument: app name
+    LaunchDefault,  // The first app, as --oneshot always did
+    PrintContext,   // Body: the launch directory as JSON
+    History,        // Argument: optional count; body: recent directories as JSON
+    Unknown
+};
+
+struct IpcRequest {
+    IpcCommand command;
+    std::string argument;
+
+    IpcRequest() : command(IpcCommand::Unknown) {}
+    IpcRequest(IpcCommand c, const std::string& a) : command(c), argument(a) {}
+};
+
+struct IpcResponse {
+    bool ok;
+    std::string body;
+
+    IpcResponse() : ok(false) {}
+    IpcResponse(bool o, const std::string& b) : ok(o), body(b) {}
+};
+
+std::string EncodeIpcRequest(const IpcRequest& request);
+IpcRequest DecodeIpcRequest(std::string_view payload);
+std::string EncodeIpcResponse(const IpcResponse& response);
+bool DecodeIpcResponse(std::string_view payload, IpcResponse& response);
+
+// Blocking byte stream, one per connection
+class IIpcStream {
+public:
+    virtual ~IIpcStream() {}
+
+    // Reads up to size bytes; false on error or end of stream
+    virtual bool Read(char* buffer, size_t size, size_t& bytesRead) = 0;
+    virtual bool Write(const char* data, size_t size) = 0;
+};
+
+bool WriteIpcMessage(IIpcStream& stream, std::string_view payload);
+bool ReadIpcMessage(IIpcStream& stream, std::string& payload);
+
+// What the running instance can do for a client
+class IInstanceCommands {
+public:
+    virtual ~IInstanceCommands() {}
+
+    virtual IpcResponse Launch(const std::string& appName) = 0;
+    virtual IpcResponse LaunchDefault() = 0;
+    virtual IpcResponse PrintContext() = 0;
+    virtual IpcResponse History(size_t count) = 0;
+};
+
+// Server side: decodes requests and routes them to the instance
+class IpcDispatcher {
+public:
+    explicit IpcDispatcher(IInstanceCommands& commands);
+
+    IpcResponse Dispatch(const IpcRequest& request);
+
+    // Serves requests on one connection until the client hangs up
+    void Serve(IIpcStream& stream);
+
+private:
+    IInstanceCommands& m_commands;
+};
+
+// Client side: one request, one response
+bool CallInstance(IIpcStream& stream, const IpcRequest& request, IpcResponse& response);
+
+// Strings are expected in UTF-8; bytes that are not valid UTF-8 come out as
+// U+FFFD, so the output always is.
+
+// {"directory": "...", "hoverWindow": n, "focusWindow": n}
+std::string FormatLaunchContextJson(const std::string& directory, WindowHandle hoverWindow, WindowHandle focusWindow);
+
+// [{"app": "...", "directory": "...", "score": x, "uses": n, "lastUsed": t}, ...]
+// in the order given, with scores decayed to now
+std::string FormatHistoryJson(const std::vector<FrecencyEntry>& entries, int64_t now);
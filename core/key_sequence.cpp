@@ -0,0 +1,177 @@
+#include "key_sequence.h"
+#include <algorithm>
+
+namespace {
+
+const unsigned int kVkEscape = 0x1B;
+
+// A key-down this soon after the last one for the same swallowed key is an
+// auto-repeat. Longer than the slowest keyboard repeat delay, so a key-up
+// lost to the secure desktop only holds on for this long.
+const std::chrono::milliseconds kRepeatWindow(1000);
+
+uint32_t KeyOf(const KeyStroke& stroke) {
+    return (stroke.modifiers & 0xF) << 8 | (stroke.vkCode & 0xFF);
+}
+
+// Shift, Ctrl and Alt in their generic and left/right forms, and both Win keys
+bool IsModifierKey(unsigned int vkCode) {
+    return (vkCode >= 0x10 && vkCode <= 0x12) || (vkCode >= 0xA0 && vkCode <= 0xA5) || vkCode == 0x5B || vkCode == 0x5C;
+}
+
+// Insertion form of the trie, before it is flattened
+struct BuildNode {
+    std::vector<std::pair<uint32_t, uint32_t>> children;  // Key, node
+    int hotkeyId;
+
+    BuildNode() : hotkeyId(0) {}
+};
+
+} // namespace
+
+std::shared_ptr<const SequenceTrie> SequenceTrie::Build(std::vector<Binding> bindings, std::chrono::milliseconds stepTimeout) {
+    // Shorter sequences go in first, so an extension of one finds it in the way
+    std::stable_sort(bindings.begin(), bindings.end(), [](const Binding& a, const Binding& b) {
+        return a.steps.size() < b.steps.size();
+    });
+
+    std::vector<BuildNode> nodes(1);
+    for (const Binding& binding : bindings) {
+        if (binding.steps.empty() || binding.hotkeyId == 0) {
+            continue;
+        }
+        uint32_t node = kSequenceRoot;
+        bool blocked = false;
+        for (const KeyStroke& step : binding.steps) {
+            uint32_t key = KeyOf(step);
+            auto it = std::find_if(nodes[node].children.begin(), nodes[node].children.end(),
+                [key](const std::pair<uint32_t, uint32_t>& child) { return child.first == key; });
+            if (it != nodes[node].children.end()) {
+                node = it->second;
+            }
+            else {
+                nodes[node].children.push_back(std::make_pair(key, (uint32_t)nodes.size()));
+                node = (uint32_t)nodes.size();
+                nodes.emplace_back();
+            }
+            if (nodes[node].hotkeyId != 0) {
+                blocked = true;
+                break;
+            }
+        }
+        if (!blocked) {
+            nodes[node].hotkeyId = binding.hotkeyId;
+        }
+    }
+
+    // Flatten breadth first. A blocked binding stops at a node that already
+    // existed, so every leaf ends a sequence.
+    std::shared_ptr<SequenceTrie> trie(new SequenceTrie());
+    trie->m_stepTimeout = stepTimeout;
+    trie->m_nodes.reserve(nodes.size());
+    trie->m_edges.reserve(nodes.size() - 1);
+    std::vector<uint32_t> order(1, kSequenceRoot);
+    trie->m_nodes.push_back(Node { 0, 0, 0 });
+    for (size_t i = 0; i < order.size(); i++) {
+        BuildNode& source = nodes[order[i]];
+        std::sort(source.children.begin(), source.children.end());
+        trie->m_nodes[i] = Node { (uint32_t)trie->m_edges.size(), (uint32_t)source.children.size(), source.hotkeyId };
+        for (const std::pair<uint32_t, uint32_t>& child : source.children) {
+            trie->m_edges.push_back(Edge { child.first, (uint32_t)order.size() });
+            order.push_back(child.second);
+            trie->m_nodes.push_back(Node { 0, 0, 0 });
+        }
+    }
+    return trie;
+}
+
+uint32_t SequenceTrie::Find(uint32_t node, const KeyStroke& stroke) const {
+    const Node& from = m_nodes[node];
+    uint32_t key = KeyOf(stroke);
+    const Edge* first = m_edges.data() + from.firstEdge;
+    const Edge* last = first + from.edgeCount;
+    const Edge* edge = std::lower_bound(first, last, key, [](const Edge& e, uint32_t k) { return e.key < k; });
+    return edge != last && edge->key == key ? edge->child : kNoSequenceNode;
+}
+
+std::shared_ptr<const SequenceTrie> BuildSequenceTrie(const ConfigSnapshot& config) {
+    std::vector<SequenceTrie::Binding> bindings;
+    for (const AppConfig& app : config.Apps()) {
+        if (app.enabled && !app.sequence.empty()) {
+            bindings.push_back(SequenceTrie::Binding { app.sequence, app.hotkeyId });
+        }
+    }
+    return SequenceTrie::Build(std::move(bindings), std::chrono::milliseconds(config.GetSettings().sequenceTimeoutMs));
+}
+
+SequenceMatcher::SequenceMatcher()
+    : m_node(kSequenceRoot) {
+}
+
+void SequenceMatcher::SetTrie(std::shared_ptr<const SequenceTrie> trie) {
+    m_trie = std::move(trie);
+    m_node = kSequenceRoot;
+    std::fill(m_swallowedAt, m_swallowedAt + kVirtualKeyCount, std::chrono::steady_clock::time_point());
+}
+
+KeyAction SequenceMatcher::OnKey(const KeyEvent& event, int& hotkeyId) {
+    hotkeyId = 0;
+    m_stats.events++;
+    unsigned int vkCode = event.vkCode & 0xFF;
+    std::chrono::steady_clock::time_point& swallowedAt = m_swallowedAt[vkCode];
+    bool held = swallowedAt != std::chrono::steady_clock::time_point();
+
+    if (!event.down) {
+        swallowedAt = std::chrono::steady_clock::time_point();
+        return held ? KeyAction::Swallow : KeyAction::Pass;
+    }
+    if (held && event.at - swallowedAt < kRepeatWindow) {
+        swallowedAt = event.at;
+        return KeyAction::Swallow;
+    }
+    swallowedAt = std::chrono::steady_clock::time_point();
+    if (!m_trie || m_trie->Empty() || IsModifierKey(vkCode)) {
+        return KeyAction::Pass;
+    }
+
+    if (m_node != kSequenceRoot && event.at > m_deadline) {
+        m_stats.timeouts++;
+        m_node = kSequenceRoot;
+    }
+
+    KeyStroke stroke(event.modifiers, vkCode);
+    uint32_t next = m_trie->Find(m_node, stroke);
+    if (next == kNoSequenceNode && m_node != kSequenceRoot && event.modifiers != 0) {
+        // Modifiers still held from the step before: "Ctrl+Alt+L, P" is
+        // usually typed without letting go of Ctrl+Alt
+        next = m_trie->Find(m_node, KeyStroke(0, vkCode));
+    }
+    if (next == kNoSequenceNode && m_node != kSequenceRoot) {
+        m_stats.cancels++;
+        m_node = kSequenceRoot;
+        if (vkCode == kVkEscape && event.modifiers == 0) {
+            swallowedAt = event.at;
+            return KeyAction::Swallow;
+        }
+        // The key may start another sequence
+        next = m_trie->Find(kSequenceRoot, stroke);
+    }
+    if (next == kNoSequenceNode) {
+        return KeyAction::Pass;
+    }
+
+    swallowedAt = event.at;
+    hotkeyId = m_trie->HotkeyIdAt(next);
+    if (hotkeyId != 0) {
+        m_stats.matches++;
+        m_node = kSequenceRoot;
+    }
+    else {
+        if (m_node == kSequenceRoot) {
+            m_stats.sequences++;
+        }
+        m_node = next;
+        m_deadline = event.at + m_trie->StepTimeout();
+    }
+    return KeyAction::Swallow;
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include "config.h"
+#include "hotkey.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Node ids of a SequenceTrie
+const uint32_t kSequenceRoot = 0;
+const uint32_t kNoSequenceNode = 0xFFFFFFFF;
+
+// Virtual key codes fit in a byte
+const size_t kVirtualKeyCount = 256;
+
+// Sequence hotkeys as a trie, flattened into two arrays: each node's edges
+// are contiguous and sorted, so a step is one binary search with no
+// allocation or pointer chasing.
+class SequenceTrie {
+public:
+    struct Binding {
+        std::vector<KeyStroke> steps;
+        int hotkeyId;
+    };
+
+    // A sequence that would never complete is left out: when one is a
+    // prefix of another the shorter fires first, and of two equal ones the
+    // first binding wins.
+    static std::shared_ptr<const SequenceTrie> Build(std::vector<Binding> bindings, std::chrono::milliseconds stepTimeout);
+
+    // Child of node reached by stroke, or kNoSequenceNode
+    uint32_t Find(uint32_t node, const KeyStroke& stroke) const;
+
+    // Hotkey id of the sequence ending at node, 0 for an inner node
+    int HotkeyIdAt(uint32_t node) const {
+        return m_nodes[node].hotkeyId;
+    }
+
+    bool Empty() const {
+        return m_edges.empty();
+    }
+
+    size_t NodeCount() const {
+        return m_nodes.size();
+    }
+
+    std::chrono::milliseconds StepTimeout() const {
+        return m_stepTimeout;
+    }
+
+private:
+    struct Node {
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+        int hotkeyId;
+    };
+
+    struct Edge {
+        uint32_t key;  // Modifiers above the virtual key code, see KeyOf
+        uint32_t child;
+    };
+
+    SequenceTrie() : m_stepTimeout(0) {}
+
+    std::vector<Node> m_nodes;
+    std::vector<Edge> m_edges;
+    std::chrono::milliseconds m_stepTimeout;
+};
+
+// Trie of the sequence hotkeys of config's enabled apps, with its
+// sequenceTimeoutMs
+std::shared_ptr<const SequenceTrie> BuildSequenceTrie(const ConfigSnapshot& config);
+
+// One key transition as a low-level keyboard hook reports it. modifiers are
+// the MOD_* keys held when it happened.
+struct KeyEvent {
+    unsigned int vkCode;
+    unsigned int modifiers;
+    bool down;
+    std::chrono::steady_clock::time_point at;
+
+    KeyEvent() : vkCode(0), modifiers(0), down(false) {}
+    KeyEvent(unsigned int v, unsigned int m, bool d, std::chrono::steady_clock::time_point t)
+        : vkCode(v), modifiers(m), down(d), at(t) {}
+};
+
+enum class KeyAction {
+    Pass,     // Let the key through to the focused app
+    Swallow   // The key belongs to a sequence
+};
+
+// Walks a SequenceTrie with key events. A key that advances a sequence is
+// swallowed, so Ctrl+Alt+L never reaches the focused app, and so are its
+// auto-repeats and key-up. A later step written without modifiers also
+// matches with modifiers held, unless another step names them. A key that
+// fits no sequence starts the walk over and is passed on; Escape cancels a
+// sequence. A sequence whose next step does not come within the trie's step
+// timeout starts over.
+//
+// Runs inside the keyboard hook, where Windows drops hooks that overrun
+// their timeout: an event costs one binary search and never allocates,
+// locks or blocks. Only the hook thread may use a matcher.
+class SequenceMatcher {
+public:
+    struct Stats {
+        uint64_t events;
+        uint64_t sequences;  // Sequences started
+        uint64_t matches;
+        uint64_t timeouts;
+        uint64_t cancels;    // Escape, or a key that fit no sequence
+
+        Stats() : events(0), sequences(0), matches(0), timeouts(0), cancels(0) {}
+    };
+
+    SequenceMatcher();
+
+    // Starts over on the new trie; null or empty passes every key
+    void SetTrie(std::shared_ptr<const SequenceTrie> trie);
+
+    // hotkeyId is set to the hotkey id of the sequence the event completes,
+    // otherwise 0
+    KeyAction OnKey(const KeyEvent& event, int& hotkeyId);
+
+    bool InSequence() const {
+        return m_node != kSequenceRoot;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    std::shared_ptr<const SequenceTrie> m_trie;
+    uint32_t m_node;
+    std::chrono::steady_clock::time_point m_deadline;
+
+    // When each swallowed key last went down, so its repeats and key-up are
+    // swallowed too; epoch for keys not held
+    std::chrono::steady_clock::time_point m_swallowedAt[kVirtualKeyCount];
+    Stats m_stats;
+};
@@ -0,0 +1,217 @@
+#include "latency_stats.h"
+#include <cstdio>
+
+namespace {
+
+const size_t kExactBuckets = 8;
+const size_t kSubBuckets = 4;
+
+const char* const kStageNames[] = {
+    "capture",
+    "dispatch",
+    "hover-lookup",
+    "focus-lookup",
+    "home-directory",
+    "resolve",
+    "spawn",
+    "total"
+};
+
+int HighestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+std::string FormatMillis(uint64_t micros) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.1f", micros / 1000.0);
+    return text;
+}
+
+} // namespace
+
+const char* LaunchStageName(LaunchStage stage) {
+    size_t index = (size_t)stage;
+    return index < (size_t)LaunchStage::Count ? kStageNames[index] : "unknown";
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0), m_max(0) {
+    for (std::atomic<uint32_t>& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::BucketOf(uint64_t micros) {
+    if (micros < kExactBuckets) {
+        return (size_t)micros;
+    }
+    // Four sub-buckets per power of two from 8 upwards
+    int exponent = HighestBit(micros);
+    size_t sub = (size_t)(micros >> (exponent - 2)) & (kSubBuckets - 1);
+    size_t bucket = kExactBuckets + (exponent - 3) * kSubBuckets + sub;
+    return bucket < kBucketCount ? bucket : kBucketCount - 1;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t bucket) {
+    if (bucket < kExactBuckets) {
+        return bucket;
+    }
+    int exponent = 3 + (int)((bucket - kExactBuckets) / kSubBuckets);
+    uint64_t sub = (bucket - kExactBuckets) % kSubBuckets;
+    uint64_t width = (uint64_t)1 << (exponent - 2);
+    return (kSubBuckets + sub) * width + width - 1;
+}
+
+void LatencyHistogram::Record(uint64_t micros) {
+    m_buckets[BucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (micros > max && !m_max.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::Count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Max() const {
+    return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+    // Sum the buckets rather than trusting m_count, which a concurrent
+    // Record may have bumped without its bucket yet
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile / 100.0 * total + 0.5);
+    rank = rank == 0 ? 1 : rank;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            uint64_t bound = BucketUpperBound(i);
+            uint64_t max = Max();
+            return bound < max ? bound : max;
+        }
+    }
+    return Max();
+}
+
+LatencyRecorder::LatencyRecorder()
+    : m_used(0) {
+    for (std::atomic<Slot*>& slot : m_slots) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+    m_other.name = "(other)";
+}
+
+LatencyRecorder::~LatencyRecorder() {
+    for (std::atomic<Slot*>& slot : m_slots) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+LatencyRecorder::Slot* LatencyRecorder::FindOrAdd(const std::string& app) {
+    // Slots are published once and never change, so readers need no lock
+    size_t used = m_used.load(std::memory_order_acquire);
+    for (size_t i = 0; i < used; i++) {
+        Slot* slot = m_slots[i].load(std::memory_order_acquire);
+        if (slot->name == app) {
+            return slot;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_addMutex);
+    size_t current = m_used.load(std::memory_order_relaxed);
+    for (size_t i = used; i < current; i++) {
+        Slot* slot = m_slots[i].load(std::memory_order_relaxed);
+        if (slot->name == app) {
+            return slot;
+        }
+    }
+    if (current == kMaxApps) {
+        return &m_other;
+    }
+
+    Slot* slot = new Slot();
+    slot->name = app;
+    m_slots[current].store(slot, std::memory_order_release);
+    m_used.store(current + 1, std::memory_order_release);
+    return slot;
+}
+
+void LatencyRecorder::Record(const std::string& app, LaunchStage stage, std::chrono::steady_clock::duration elapsed) {
+    if (stage >= LaunchStage::Count) {
+        return;
+    }
+    long long micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    FindOrAdd(app)->stages[(size_t)stage].Record(micros < 0 ? 0 : (uint64_t)micros);
+}
+
+void LatencyRecorder::ForEachApp(const std::function<void(const std::string& app, const LatencyHistogram* stages)>& visit) const {
+    size_t used = m_used.load(std::memory_order_acquire);
+    for (size_t i = 0; i < used; i++) {
+        const Slot* slot = m_slots[i].load(std::memory_order_acquire);
+        visit(slot->name, slot->stages);
+    }
+    for (const LatencyHistogram& stage : m_other.stages) {
+        if (stage.Count() > 0) {
+            visit(m_other.name, m_other.stages);
+            break;
+        }
+    }
+}
+
+LaunchTrace::LaunchTrace(LatencyRecorder* recorder, const std::string& app, std::chrono::steady_clock::time_point start)
+    : m_recorder(recorder), m_app(app), m_last(start) {
+}
+
+void LaunchTrace::Mark(LaunchStage stage) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (m_recorder != nullptr) {
+        m_recorder->Record(m_app, stage, now - m_last);
+    }
+    m_last = now;
+}
+
+void LaunchTrace::RecordSince(LaunchStage stage, std::chrono::steady_clock::time_point since) {
+    if (m_recorder != nullptr) {
+        m_recorder->Record(m_app, stage, std::chrono::steady_clock::now() - since);
+    }
+}
+
+std::string FormatLatencyReport(const LatencyRecorder& recorder) {
+    std::string report = "Launch latency (ms)\n\n";
+    char line[160];
+    snprintf(line, sizeof(line), "%-24s %-15s %8s %8s %8s %8s %8s\n",
+        "app", "stage", "count", "p50", "p95", "p99", "max");
+    report += line;
+
+    recorder.ForEachApp([&](const std::string& app, const LatencyHistogram* stages) {
+        for (size_t i = 0; i < (size_t)LaunchStage::Count; i++) {
+            const LatencyHistogram& histogram = stages[i];
+            if (histogram.Count() == 0) {
+                continue;
+            }
+            snprintf(line, sizeof(line), "%-24.24s %-15s %8llu %8s %8s %8s %8s\n",
+                app.c_str(), LaunchStageName((LaunchStage)i), (unsigned long long)histogram.Count(),
+                FormatMillis(histogram.Percentile(50)).c_str(), FormatMillis(histogram.Percentile(95)).c_str(),
+                FormatMillis(histogram.Percentile(99)).c_str(), FormatMillis(histogram.Max()).c_str());
+            report += line;
+        }
+    });
+    return report;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// Steps between a hotkey press and the child process existing
+enum class LaunchStage {
+    Capture,        // WM_HOTKEY handling on the UI thread
+    Dispatch,       // Press to a worker picking the request up
+    HoverLookup,    // Provider check and directory of the window under the cursor
+    FocusLookup,    // Same for the foreground window
+    HomeDirectory,  // Fallback when no provider found a directory
+    Resolve,        // Executable resolution
+    Spawn,          // CreateProcess or ShellExecute
+    Total,          // Press to spawn returned
+    Count
+};
+
+const char* LaunchStageName(LaunchStage stage);
+
+// Fixed-size histogram of durations in microseconds. Buckets are log-linear
+// (four per power of two, exact below 8 us), so percentiles are within 25%
+// and recording is a handful of relaxed atomic increments.
+class LatencyHistogram {
+public:
+    static const size_t kBucketCount = 128;
+
+    LatencyHistogram();
+
+    void Record(uint64_t micros);
+
+    uint64_t Count() const;
+    uint64_t Max() const;
+
+    // Upper bound of the bucket holding the given percentile (0..100)
+    uint64_t Percentile(double percentile) const;
+
+    static size_t BucketOf(uint64_t micros);
+    static uint64_t BucketUpperBound(size_t bucket);
+
+private:
+    std::atomic<uint32_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_max;
+};
+
+// Per-app, per-stage histograms. Recording never blocks once an app has a
+// slot; the first record for a new app name takes a lock to claim one.
+// Apps beyond kMaxApps share an "(other)" slot.
+class LatencyRecorder {
+public:
+    static const size_t kMaxApps = 64;
+
+    LatencyRecorder();
+    ~LatencyRecorder();
+
+    void Record(const std::string& app, LaunchStage stage, std::chrono::steady_clock::duration elapsed);
+
+    // Visits apps in first-seen order; stages is indexed by LaunchStage
+    void ForEachApp(const std::function<void(const std::string& app, const LatencyHistogram* stages)>& visit) const;
+
+private:
+    struct Slot {
+        std::string name;
+        LatencyHistogram stages[(size_t)LaunchStage::Count];
+    };
+
+    Slot* FindOrAdd(const std::string& app);
+
+    std::atomic<Slot*> m_slots[kMaxApps];
+    std::atomic<size_t> m_used;
+    std::mutex m_addMutex;
+    Slot m_other;
+};
+
+// Times consecutive stages of one launch: each Mark records the time since
+// the previous mark (or since start) under the given stage. Keeps its own
+// copy of the app name, so a temporary may be passed.
+class LaunchTrace {
+public:
+    LaunchTrace(LatencyRecorder* recorder, const std::string& app, std::chrono::steady_clock::time_point start);
+
+    void Mark(LaunchStage stage);
+
+    // Records since an arbitrary point without moving the mark, e.g. Total
+    void RecordSince(LaunchStage stage, std::chrono::steady_clock::time_point since);
+
+private:
+    LatencyRecorder* m_recorder;
+    std::string m_app;
+    std::chrono::steady_clock::time_point m_last;
+};
+
+// Plain-text p50/p95/p99/max table in milliseconds
+std::string FormatLatencyReport(const LatencyRecorder& recorder);
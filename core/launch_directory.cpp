@@ -0,0 +1,65 @@
+#include "launch_directory.h"
+
+namespace {
+
+struct Candidate {
+    bool enabled;
+    WindowHandle window;
+    LaunchStage stage;
+};
+
+} // namespace
+
+std::string GetLaunchDirectory(const Settings& settings, WindowHandle hoverWindow, WindowHandle focusWindow,
+    ContextProviderRegistry& providers, DirectoryReachability& reachability, LaunchTrace& trace,
+    ContextClaim* source) {
+    Candidate hover = { settings.checkMouseHover, hoverWindow, LaunchStage::HoverLookup };
+    Candidate focus = { settings.checkFocusedWindow, focusWindow, LaunchStage::FocusLookup };
+
+    Candidate candidates[2] = { hover, focus };
+    if (settings.priorityWhenBothAvailable == DirectoryPriority::Focus) {
+        candidates[0] = focus;
+        candidates[1] = hover;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    if (settings.resolveTimeoutMs > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.resolveTimeoutMs);
+    }
+
+    ContextClaim resolved;
+    for (const Candidate& candidate : candidates) {
+        if (!candidate.enabled) {
+            continue;
+        }
+
+        std::string directory;
+        ContextClaim claim = providers.Claim(candidate.window, settings.contextProviders);
+        // Hovering over the focused window: its folder was already tried
+        if (claim.provider >= 0 && !(claim == resolved)) {
+            directory = providers.GetDirectory(claim, deadline);
+            resolved = claim;
+
+            // Fall through now rather than after a failed spawn
+            if (!directory.empty() && !reachability.IsUsable(directory, deadline)) {
+                directory.clear();
+            }
+        }
+        trace.Mark(candidate.stage);
+
+        if (!directory.empty()) {
+            if (source != nullptr) {
+                *source = claim;
+            }
+            return directory;
+        }
+    }
+
+    // Nothing found - use home directory
+    if (source != nullptr) {
+        *source = ContextClaim();
+    }
+    std::string homeDir = providers.GetHomeDirectory();
+    trace.Mark(LaunchStage::HomeDirectory);
+    return homeDir;
+}
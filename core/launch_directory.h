@@ -0,0 +1,25 @@
+#pragma once
+#include "config.h"
+#include "context_provider.h"
+#include "directory_reachability.h"
+#include "latency_stats.h"
+#include <string>
+
+// Picks the directory to launch in from the windows captured at hotkey
+// time: the hovered and/or focused window as enabled in settings,
+// priorityWhenBothAvailable breaking ties, the home directory otherwise.
+// Each window is answered by the first provider in settings.contextProviders
+// that claims it (Explorer, terminal, editor, desktop).
+//
+// Candidates are tried in priority order and the first usable folder wins,
+// so the lower-priority window is only resolved when the first yields
+// nothing or a folder that is gone or on an offline share. Each claimed
+// window is resolved at most once, and all queries and reachability checks
+// share the resolveTimeoutMs budget.
+//
+// source, if given, receives the claim that produced the directory (no
+// provider for the home directory), so the same window's selection can be
+// read for perFolder and allItems apps.
+std::string GetLaunchDirectory(const Settings& settings, WindowHandle hoverWindow, WindowHandle focusWindow,
+    ContextProviderRegistry& providers, DirectoryReachability& reachability, LaunchTrace& trace,
+    ContextClaim* source = nullptr);
@@ -0,0 +1,130 @@
+#include "launch_queue.h"
+
+LaunchCoalescer::LaunchCoalescer(std::chrono::milliseconds repeatInterval)
+    : m_repeatInterval(repeatInterval) {
+}
+
+bool LaunchCoalescer::Accept(int key, std::chrono::steady_clock::time_point pressedAt) {
+    auto it = m_lastPress.find(key);
+    if (it == m_lastPress.end()) {
+        m_lastPress[key] = pressedAt;
+        return true;
+    }
+
+    bool repeat = pressedAt - it->second < m_repeatInterval;
+    it->second = pressedAt;
+    return !repeat;
+}
+
+void LaunchCoalescer::Reset() {
+    m_lastPress.clear();
+}
+
+LaunchQueue::LaunchQueue(ILaunchBackend& backend, size_t workerCount, std::chrono::milliseconds repeatInterval)
+    : m_backend(backend),
+      m_workerCount(workerCount == 0 ? 1 : workerCount),
+      m_coalescer(repeatInterval),
+      m_running(0),
+      m_started(false),
+      m_stopping(false) {
+}
+
+LaunchQueue::~LaunchQueue() {
+    Stop();
+}
+
+void LaunchQueue::Start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_workers.empty()) {
+        return;
+    }
+    m_started = true;
+    m_stopping = false;
+    for (size_t i = 0; i < m_workerCount; i++) {
+        m_workers.emplace_back(&LaunchQueue::WorkerLoop, this);
+    }
+}
+
+void LaunchQueue::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started = false;
+    }
+    m_idle.notify_all();
+}
+
+bool LaunchQueue::Enqueue(const LaunchRequest& request) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Record the press even if it is dropped, so a held key keeps
+        // extending the repeat window
+        bool accepted = m_coalescer.Accept(request.key, request.pressedAt);
+        if (!accepted || IsPendingLocked(request.key) || m_stopping) {
+            m_stats.coalesced++;
+            return false;
+        }
+        m_pending.push_back(request);
+        m_stats.enqueued++;
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+void LaunchQueue::WaitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_started || (m_pending.empty() && m_running == 0); });
+}
+
+LaunchQueue::Stats LaunchQueue::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+bool LaunchQueue::IsPendingLocked(int key) const {
+    for (const LaunchRequest& pending : m_pending) {
+        if (pending.key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LaunchQueue::WorkerLoop() {
+    m_backend.OnWorkerStarted();
+
+    for (;;) {
+        LaunchRequest request;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+            if (m_pending.empty()) {
+                break;
+            }
+            request = m_pending.front();
+            m_pending.pop_front();
+            m_running++;
+        }
+
+        m_backend.Launch(request);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+            m_stats.launched++;
+        }
+        m_idle.notify_all();
+    }
+
+    m_backend.OnWorkerStopped();
+}
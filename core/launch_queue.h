@@ -0,0 +1,103 @@
+#pragma once
+#include "config.h"
+#include "window_handle.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Snapshot of one hotkey press, captured on the UI thread. The request keeps
+// the config snapshot alive, so a reload cannot pull the app out from under it.
+struct LaunchRequest {
+    int key;                    // Coalescing key (the hotkey id)
+    std::shared_ptr<const ConfigSnapshot> config;
+    const AppConfig* app;       // Points into config
+    WindowHandle hoverWindow;   // Root window under the cursor at press time
+    WindowHandle focusWindow;   // Foreground window at press time
+    std::string directory;      // Set when the palette chose a recent folder; skips the window lookups
+    std::chrono::steady_clock::time_point pressedAt;
+
+    LaunchRequest() : key(0), app(nullptr), hoverWindow(kNoWindow), focusWindow(kNoWindow) {}
+};
+
+// Carries out launches on the worker threads
+class ILaunchBackend {
+public:
+    virtual ~ILaunchBackend() {}
+
+    // Called once on each worker thread, e.g. to enter a COM apartment
+    virtual void OnWorkerStarted() {}
+    virtual void OnWorkerStopped() {}
+
+    virtual void Launch(const LaunchRequest& request) = 0;
+};
+
+// Drops auto-repeat bursts: a press is a repeat if the same key was pressed
+// within the repeat interval of the previous press, accepted or not, so a held
+// hotkey yields exactly one launch.
+class LaunchCoalescer {
+public:
+    explicit LaunchCoalescer(std::chrono::milliseconds repeatInterval);
+
+    bool Accept(int key, std::chrono::steady_clock::time_point pressedAt);
+    void Reset();
+
+private:
+    std::chrono::milliseconds m_repeatInterval;
+    std::map<int, std::chrono::steady_clock::time_point> m_lastPress;
+};
+
+// Launch pipeline: the UI thread enqueues request snapshots, a small pool of
+// worker threads resolves directories and spawns processes.
+class LaunchQueue {
+public:
+    struct Stats {
+        uint64_t enqueued;
+        uint64_t coalesced;
+        uint64_t launched;
+
+        Stats() : enqueued(0), coalesced(0), launched(0) {}
+    };
+
+    LaunchQueue(ILaunchBackend& backend, size_t workerCount,
+                std::chrono::milliseconds repeatInterval = std::chrono::milliseconds(300));
+    ~LaunchQueue();
+
+    void Start();
+
+    // Finishes queued requests, then joins the workers
+    void Stop();
+
+    // Returns false if the request was coalesced away
+    bool Enqueue(const LaunchRequest& request);
+
+    // Blocks until the queue is empty and no launch is running. Returns at
+    // once while no workers run to drain it, before Start or after Stop.
+    void WaitIdle();
+
+    Stats GetStats() const;
+
+private:
+    void WorkerLoop();
+    bool IsPendingLocked(int key) const;
+
+    ILaunchBackend& m_backend;
+    size_t m_workerCount;
+    LaunchCoalescer m_coalescer;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<LaunchRequest> m_pending;
+    std::vector<std::thread> m_workers;
+    size_t m_running;
+    bool m_started;
+    bool m_stopping;
+    Stats m_stats;
+};
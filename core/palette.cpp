@@ -0,0 +1,120 @@
+#include "palette.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kFrecencyBonusScale = 8;
+const int kMaxFrecencyBonus = 32;
+
+} // namespace
+
+int FrecencyBonus(double frecency) {
+    if (frecency <= 0) {
+        return 0;
+    }
+    return std::min(kMaxFrecencyBonus, (int)(kFrecencyBonusScale * std::log2(1 + frecency)));
+}
+
+std::vector<PaletteItem> BuildPaletteItems(const ConfigSnapshot& config, const std::vector<FrecencyEntry>& history,
+    int64_t now) {
+    std::vector<PaletteItem> items;
+    items.reserve(config.Apps().size() + history.size());
+    for (const AppConfig& app : config.Apps()) {
+        if (app.enabled) {
+            PaletteItem item;
+            item.app = app.name;
+            item.text = app.name;
+            items.push_back(item);
+        }
+    }
+
+    // Apps are sorted by name, so history is matched to them by search
+    size_t appCount = items.size();
+    auto FindApp = [&items, appCount](const std::string& name) -> PaletteItem* {
+        auto it = std::lower_bound(items.begin(), items.begin() + appCount, name,
+            [](const PaletteItem& item, const std::string& n) { return item.app < n; });
+        return it != items.begin() + appCount && it->app == name ? &*it : nullptr;
+    };
+    for (const FrecencyEntry& entry : history) {
+        PaletteItem* app = FindApp(entry.app);
+        if (app == nullptr) {
+            continue;
+        }
+        int bonus = FrecencyBonus(FrecencyAt(entry, now));
+        if (entry.directory.empty()) {
+            app->boost = bonus;
+            continue;
+        }
+        PaletteItem item;
+        item.kind = PaletteKind::RecentDirectory;
+        item.app = entry.app;
+        item.directory = entry.directory;
+        item.text = entry.app + "  " + entry.directory;
+        item.boost = bonus;
+        items.push_back(item);
+    }
+    return items;
+}
+
+PaletteSearch::PaletteSearch()
+    : m_pattern("") {}
+
+void PaletteSearch::SetItems(std::vector<PaletteItem> items) {
+    m_items = std::move(items);
+    m_index.Clear();
+    for (const PaletteItem& item : m_items) {
+        m_index.Add(item.text);
+    }
+
+    // Everything matches the empty query
+    m_pattern = FuzzyPattern("");
+    m_matches.clear();
+    m_matches.reserve(m_items.size());
+    for (size_t i = 0; i < m_items.size(); i++) {
+        m_matches.push_back(PaletteMatch(i, m_items[i].boost));
+    }
+}
+
+const std::vector<PaletteMatch>& PaletteSearch::Query(std::string_view query, size_t limit) {
+    m_stats.queries++;
+    FuzzyPattern pattern(query);
+    if (pattern.Text() != m_pattern.Text()) {
+        int score = 0;
+        if (m_pattern.IsNarrowedBy(pattern)) {
+            m_stats.narrowed++;
+            m_stats.scanned += m_matches.size();
+            size_t kept = 0;
+            for (const PaletteMatch& match : m_matches) {
+                if (m_index.Match(pattern, match.item, score)) {
+                    m_matches[kept++] = PaletteMatch(match.item, score + m_items[match.item].boost);
+                }
+            }
+            m_matches.resize(kept);
+        }
+        else {
+            m_stats.scanned += m_items.size();
+            m_matches.clear();
+            for (size_t i = 0; i < m_items.size(); i++) {
+                if (m_index.Match(pattern, i, score)) {
+                    m_matches.push_back(PaletteMatch(i, score + m_items[i].boost));
+                }
+            }
+        }
+        m_pattern = pattern;
+    }
+
+    // Only the shown rows are ordered; the narrowing pass does not need order
+    size_t count = std::min(limit, m_matches.size());
+    std::partial_sort(m_matches.begin(), m_matches.begin() + count, m_matches.end(),
+        [this](const PaletteMatch& a, const PaletteMatch& b) {
+            if (a.rank != b.rank) {
+                return a.rank > b.rank;
+            }
+            size_t lengthA = m_index.Length(a.item);
+            size_t lengthB = m_index.Length(b.item);
+            return lengthA != lengthB ? lengthA < lengthB : a.item < b.item;
+        });
+    m_results.assign(m_matches.begin(), m_matches.begin() + count);
+    return m_results;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "config.h"
+#include "frecency.h"
+#include "fuzzy_match.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+enum class PaletteKind {
+    App,             // Launches in the folder of the window the palette was opened over
+    RecentDirectory  // Launches in a folder the app was launched in before
+};
+
+// One line of the palette
+struct PaletteItem {
+    PaletteKind kind;
+    std::string app;        // Name of the [Apps] or [Groups] entry
+    std::string directory;  // Set for RecentDirectory
+    std::string text;       // Shown and matched: "PowerShell" or "PowerShell  C:\src"
+    int boost;              // Frecency bonus added to the match score
+
+    PaletteItem() : kind(PaletteKind::App), boost(0) {}
+};
+
+// Bonus for a decayed use count: logarithmic, so a daily app does not bury
+// a better match for what was typed, and capped
+int FrecencyBonus(double frecency);
+
+// Enabled apps in menu order, then each recent (app, directory) pair whose
+// app is still enabled
+std::vector<PaletteItem> BuildPaletteItems(const ConfigSnapshot& config, const std::vector<FrecencyEntry>& history,
+    int64_t now);
+
+struct PaletteMatch {
+    size_t item;  // Index into the items
+    int rank;     // Match score plus frecency bonus
+
+    PaletteMatch() : item(0), rank(0) {}
+    PaletteMatch(size_t item, int rank) : item(item), rank(rank) {}
+};
+
+// The palette's state between keystrokes. Each query is matched against
+// the candidates the previous one matched when it only narrows it (another
+// letter typed), so typing a word rescans the whole list once.
+class PaletteSearch {
+public:
+    struct Stats {
+        uint64_t queries;
+        uint64_t narrowed;  // Queries that only rescanned the previous matches
+        uint64_t scanned;   // Candidates matched
+
+        Stats() : queries(0), narrowed(0), scanned(0) {}
+    };
+
+    PaletteSearch();
+
+    void SetItems(std::vector<PaletteItem> items);
+
+    const std::vector<PaletteItem>& Items() const {
+        return m_items;
+    }
+
+    // At most limit matches, best first; ties go to the shorter text, then
+    // to item order. Valid until the next call.
+    const std::vector<PaletteMatch>& Query(std::string_view query, size_t limit);
+
+    Stats GetStats() const {
+        return m_stats;
+    }
+
+private:
+    std::vector<PaletteItem> m_items;
+    FuzzyIndex m_index;
+    FuzzyPattern m_pattern;               // Last query
+    std::vector<PaletteMatch> m_matches;  // Everything it matched
+    std::vector<PaletteMatch> m_results;
+    Stats m_stats;
+};
@@ -0,0 +1,57 @@
+#include "process_image_cache.h"
+
+ProcessImageCache::ProcessImageCache(IProcessTable& table)
+    : m_table(table) {
+}
+
+std::string ProcessImageCache::Lookup(WindowHandle window) {
+    if (window == kNoWindow) {
+        return "";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_images.find(window);
+        if (it != m_images.end()) {
+            m_stats.hits++;
+            return it->second;
+        }
+        m_stats.misses++;
+    }
+
+    std::string image;
+    uint32_t processId = m_table.GetWindowProcessId(window);
+    if (processId == 0 || !m_table.GetProcessImageName(processId, image)) {
+        // Not cached: the window may be gone, or access denied for now
+        return "";
+    }
+    for (char& c : image) {
+        if (c >= 'A' && c <= 'Z') {
+            c = (char)(c - 'A' + 'a');
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_images[window] = image;
+    return image;
+}
+
+void ProcessImageCache::OnWindowDestroyed(WindowHandle window) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_images.erase(window);
+}
+
+void ProcessImageCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_images.clear();
+}
+
+size_t ProcessImageCache::Size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_images.size();
+}
+
+ProcessImageCache::Stats ProcessImageCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "window_handle.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Window and process queries behind the foreground-process lookup. On
+// Windows this is GetWindowThreadProcessId plus QueryFullProcessImageName;
+// elsewhere it is a fake table.
+class IProcessTable {
+public:
+    virtual ~IProcessTable() {}
+
+    // 0 if the window is gone
+    virtual uint32_t GetWindowProcessId(WindowHandle window) = 0;
+
+    // File name of the process image, e.g. "Code.exe"
+    virtual bool GetProcessImageName(uint32_t processId, std::string& imageName) = 0;
+};
+
+// Top-level window -> lowercase process image name. A window never changes
+// process, so entries stay valid until the window is destroyed and its
+// handle can be recycled; the owner reports destruction.
+class ProcessImageCache {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+
+        Stats() : hits(0), misses(0) {}
+    };
+
+    explicit ProcessImageCache(IProcessTable& table);
+
+    // Empty if the window or its process cannot be queried
+    std::string Lookup(WindowHandle window);
+
+    void OnWindowDestroyed(WindowHandle window);
+    void Clear();
+
+    size_t Size() const;
+    Stats GetStats() const;
+
+private:
+    IProcessTable& m_table;
+    mutable std::mutex m_mutex;
+    std::unordered_map<WindowHandle, std::string> m_images;
+    Stats m_stats;
+};
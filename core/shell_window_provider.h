@@ -0,0 +1,44 @@
+#pragma once
+#include "window_handle.h"
+#include <string>
+#include <vector>
+
+// One item selected in a shell view
+struct SelectedItem {
+    std::string path;
+    bool folder;
+
+    SelectedItem() : folder(false) {}
+    SelectedItem(const std::string& p, bool f) : path(p), folder(f) {}
+};
+
+// Source of truth for "which folder is this shell window showing".
+// On Windows this is the IShellWindows COM walk; elsewhere it is a fake.
+class IShellWindowProvider {
+public:
+    virtual ~IShellWindowProvider() {}
+
+    // Called on the thread that will issue queries, e.g. to enter a COM apartment
+    virtual void OnWorkerStarted() {}
+    virtual void OnWorkerStopped() {}
+
+    // Tab currently shown by a shell window. Tabbed Explorer hosts several
+    // shell views in one top-level window, each with its own tab window;
+    // without tabs this is the window itself. Cheap and callable from any
+    // thread: hotkey presses call it before every lookup.
+    virtual WindowHandle GetActiveTab(WindowHandle window) {
+        return window;
+    }
+
+    // Returns true if the tab (see GetActiveTab) is a known shell view. The
+    // directory is left empty when it shows a virtual folder without a file
+    // system path.
+    virtual bool QueryDirectory(WindowHandle tab, std::string& directory) = 0;
+
+    // File system items selected in the tab, in view order. Returns false if
+    // the tab is not a known shell view; items without a path are skipped.
+    virtual bool QuerySelection(WindowHandle, std::vector<SelectedItem>& items) {
+        items.clear();
+        return false;
+    }
+};
@@ -0,0 +1,334 @@
+#include "standby_pool.h"
+
+namespace {
+
+enum class ShellKind {
+    None,
+    PowerShell,
+    Cmd
+};
+
+ShellKind GetShellKind(const std::string& executable) {
+    size_t slash = executable.find_last_of("\\/");
+    std::string name = executable.substr(slash == std::string::npos ? 0 : slash + 1);
+    for (char& c : name) {
+        if (c >= 'A' && c <= 'Z') {
+            c = (char)(c - 'A' + 'a');
+        }
+    }
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".exe") == 0) {
+        name.resize(name.size() - 4);
+    }
+
+    if (name == "powershell" || name == "pwsh") {
+        return ShellKind::PowerShell;
+    }
+    if (name == "cmd") {
+        return ShellKind::Cmd;
+    }
+    return ShellKind::None;
+}
+
+} // namespace
+
+bool IsPrewarmSupported(const std::string& executable) {
+    return GetShellKind(executable) != ShellKind::None;
+}
+
+bool FormatDirectoryHandoff(const std::string& executable, const std::string& directory, std::string& command) {
+    switch (GetShellKind(executable)) {
+    case ShellKind::PowerShell: {
+        // Single quotes are literal in PowerShell; a quote inside is doubled
+        std::string quoted;
+        for (char c : directory) {
+            quoted += c;
+            if (c == '\'') {
+                quoted += '\'';
+            }
+        }
+        command = "Set-Location -LiteralPath '" + quoted + "'; Clear-Host";
+        return true;
+    }
+
+    case ShellKind::Cmd:
+        // Windows paths cannot contain '"'
+        command = "cd /d \"" + directory + "\" & cls";
+        return true;
+
+    case ShellKind::None:
+        break;
+    }
+    return false;
+}
+
+std::vector<StandbySpec> CollectStandbySpecs(const ConfigSnapshot& config) {
+    std::vector<StandbySpec> specs;
+    for (const AppConfig& app : config.Apps()) {
+        // A standby cannot know the directory or selection placeholders stand for
+        if (app.prewarm && app.enabled && !app.runAsAdmin && !app.argsTemplate.HasPlaceholders() &&
+            IsPrewarmSupported(app.executable)) {
+            specs.push_back(StandbySpec { app.name, app.executable, app.args });
+        }
+    }
+    return specs;
+}
+
+StandbyPool::StandbyPool(IProcessBackend& backend, std::chrono::milliseconds maxAge,
+                         std::chrono::milliseconds checkInterval, std::chrono::milliseconds retryDelay)
+    : m_backend(backend), m_maxAge(maxAge), m_checkInterval(checkInterval), m_retryDelay(retryDelay),
+      m_nextGeneration(1), m_running(false), m_stopping(false), m_dirty(false) {
+}
+
+StandbyPool::~StandbyPool() {
+    Stop();
+}
+
+void StandbyPool::Start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+    m_stopping = false;
+    m_thread = std::thread(&StandbyPool::ThreadLoop, this);
+}
+
+void StandbyPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running) {
+            return;
+        }
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+
+    std::vector<StandbyProcess> processes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        processes.swap(m_retired);
+        for (auto& entry : m_slots) {
+            if (entry.second.process != 0) {
+                processes.push_back(entry.second.process);
+                entry.second.process = 0;
+            }
+        }
+        m_running = false;
+    }
+    for (StandbyProcess process : processes) {
+        m_backend.Terminate(process);
+    }
+}
+
+void StandbyPool::Configure(const std::vector<StandbySpec>& specs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<std::string, Slot> slots;
+        for (const StandbySpec& spec : specs) {
+            auto it = m_slots.find(spec.appName);
+            if (it != m_slots.end() && it->second.spec == spec) {
+                slots[spec.appName] = it->second;
+                m_slots.erase(it);
+            }
+            else {
+                Slot& slot = slots[spec.appName];
+                slot.spec = spec;
+                slot.generation = m_nextGeneration++;
+            }
+        }
+
+        // Whatever is left was removed or changed
+        for (const auto& entry : m_slots) {
+            if (entry.second.process != 0) {
+                m_retired.push_back(entry.second.process);
+            }
+        }
+        m_slots.swap(slots);
+        m_dirty = true;
+    }
+    m_wake.notify_one();
+}
+
+void StandbyPool::RetireAll() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& entry : m_slots) {
+            Slot& slot = entry.second;
+            if (slot.process != 0) {
+                m_retired.push_back(slot.process);
+                slot.process = 0;
+            }
+            // A start in progress now produces a stale process
+            slot.generation = m_nextGeneration++;
+            slot.retryAt = std::chrono::steady_clock::time_point();
+        }
+        m_dirty = true;
+    }
+    m_wake.notify_one();
+}
+
+bool StandbyPool::TryActivate(const std::string& appName, const std::string& directory) {
+    StandbyProcess process = 0;
+    StandbySpec spec;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_slots.find(appName);
+        if (it == m_slots.end() || it->second.process == 0) {
+            m_stats.misses++;
+            return false;
+        }
+        process = it->second.process;
+        spec = it->second.spec;
+        it->second.process = 0;
+        m_dirty = true;
+    }
+    // Start the replacement while this one is being revealed
+    m_wake.notify_one();
+
+    bool revealed = m_backend.Reveal(process, spec, directory);
+    if (!revealed) {
+        m_backend.Terminate(process);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (revealed) {
+        m_stats.handedOut++;
+    }
+    else {
+        m_stats.misses++;
+    }
+    return revealed;
+}
+
+size_t StandbyPool::ReadyCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t ready = 0;
+    for (const auto& entry : m_slots) {
+        if (entry.second.process != 0) {
+            ready++;
+        }
+    }
+    return ready;
+}
+
+StandbyPool::Stats StandbyPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void StandbyPool::ThreadLoop() {
+    m_backend.OnWorkerStarted();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        MaintainLocked(lock);
+        m_wake.wait_for(lock, m_checkInterval, [this] { return m_stopping || m_dirty; });
+    }
+    lock.unlock();
+
+    m_backend.OnWorkerStopped();
+}
+
+void StandbyPool::MaintainLocked(std::unique_lock<std::mutex>& lock) {
+    m_dirty = false;
+
+    struct Check {
+        std::string appName;
+        StandbyProcess process;
+        bool running;
+        bool expired;
+    };
+
+    std::vector<StandbyProcess> terminate;
+    terminate.swap(m_retired);
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::vector<Check> checks;
+    for (const auto& entry : m_slots) {
+        if (entry.second.process != 0) {
+            bool expired = now - entry.second.startedAt >= m_maxAge;
+            checks.push_back(Check { entry.first, entry.second.process, true, expired });
+        }
+    }
+
+    // Health checks call into the backend without the lock
+    lock.unlock();
+    for (Check& check : checks) {
+        check.running = m_backend.IsRunning(check.process);
+    }
+    lock.lock();
+
+    for (const Check& check : checks) {
+        auto it = m_slots.find(check.appName);
+        // Taken by TryActivate or retired in the meantime
+        if (it == m_slots.end() || it->second.process != check.process) {
+            continue;
+        }
+        if (!check.running) {
+            m_stats.crashed++;
+        }
+        else if (check.expired) {
+            m_stats.expired++;
+        }
+        else {
+            continue;
+        }
+        terminate.push_back(check.process);
+        it->second.process = 0;
+    }
+
+    // Start whatever is missing, one at a time
+    while (!m_stopping) {
+        now = std::chrono::steady_clock::now();
+        auto next = m_slots.end();
+        for (auto it = m_slots.begin(); it != m_slots.end(); ++it) {
+            const Slot& slot = it->second;
+            if (slot.process == 0 && !slot.starting && slot.retryAt <= now) {
+                next = it;
+                break;
+            }
+        }
+        if (next == m_slots.end()) {
+            break;
+        }
+
+        next->second.starting = true;
+        StandbySpec spec = next->second.spec;
+        uint64_t generation = next->second.generation;
+
+        lock.unlock();
+        StandbyProcess process = m_backend.StartHidden(spec);
+        lock.lock();
+
+        auto it = m_slots.find(spec.appName);
+        if (it != m_slots.end()) {
+            it->second.starting = false;
+        }
+        if (process == 0) {
+            m_stats.startFailures++;
+            if (it != m_slots.end() && it->second.generation == generation) {
+                it->second.retryAt = std::chrono::steady_clock::now() + m_retryDelay;
+            }
+            continue;
+        }
+
+        m_stats.started++;
+        if (it != m_slots.end() && it->second.generation == generation) {
+            it->second.process = process;
+            it->second.startedAt = std::chrono::steady_clock::now();
+        }
+        else {
+            // Configured away or retired while it was starting
+            terminate.push_back(process);
+        }
+    }
+
+    if (!terminate.empty()) {
+        lock.unlock();
+        for (StandbyProcess process : terminate) {
+            m_backend.Terminate(process);
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include "config.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One app kept warm: what its standby is started from
+struct StandbySpec {
+    std::string appName;
+    std::string executable;
+    std::string args;
+
+    bool operator==(const StandbySpec& other) const {
+        return appName == other.appName && executable == other.executable && args == other.args;
+    }
+    bool operator!=(const StandbySpec& other) const {
+        return !(*this == other);
+    }
+};
+
+// Opaque id the backend hands out for a standby process; 0 is never valid
+typedef uint64_t StandbyProcess;
+
+// Starts and hands over hidden processes. On Windows these are consoles
+// started with SW_HIDE; elsewhere it is a fake.
+class IProcessBackend {
+public:
+    virtual ~IProcessBackend() {}
+
+    // Called on the pool thread, e.g. to enter a COM apartment
+    virtual void OnWorkerStarted() {}
+    virtual void OnWorkerStopped() {}
+
+    // Starts a hidden instance in a neutral directory; 0 on failure
+    virtual StandbyProcess StartHidden(const StandbySpec& spec) = 0;
+
+    virtual bool IsRunning(StandbyProcess process) = 0;
+
+    // Moves the standby to directory and shows it. On success the backend
+    // lets go of the process; on failure the pool terminates it.
+    virtual bool Reveal(StandbyProcess process, const StandbySpec& spec, const std::string& directory) = 0;
+
+    virtual void Terminate(StandbyProcess process) = 0;
+};
+
+// Shells whose working directory can be changed after start by typing a
+// command into them. Only these can be prewarmed.
+bool IsPrewarmSupported(const std::string& executable);
+
+// The line to type into a standby shell to move it to directory (without the
+// trailing Enter). False if the shell is not supported.
+bool FormatDirectoryHandoff(const std::string& executable, const std::string& directory, std::string& command);
+
+// Apps with the prewarm option that can actually be kept warm: enabled, not
+// elevated, args without placeholders and a supported shell
+std::vector<StandbySpec> CollectStandbySpecs(const ConfigSnapshot& config);
+
+// Keeps one hidden, already-started instance per opted-in app. A hotkey
+// takes the standby, if one is ready, instead of spawning, and a background
+// thread starts the replacement. The same thread replaces standbys that
+// crashed or outlived maxAge (their environment goes stale).
+class StandbyPool {
+public:
+    struct Stats {
+        uint64_t started;
+        uint64_t handedOut;
+        uint64_t misses;         // TryActivate without a ready standby
+        uint64_t expired;
+        uint64_t crashed;
+        uint64_t startFailures;
+
+        Stats() : started(0), handedOut(0), misses(0), expired(0), crashed(0), startFailures(0) {}
+    };
+
+    StandbyPool(IProcessBackend& backend, std::chrono::milliseconds maxAge,
+                std::chrono::milliseconds checkInterval = std::chrono::milliseconds(5000),
+                std::chrono::milliseconds retryDelay = std::chrono::milliseconds(30000));
+    ~StandbyPool();
+
+    void Start();
+
+    // Terminates every standby, then joins the thread
+    void Stop();
+
+    // Sets the apps to keep warm. Standbys of apps that were removed or whose
+    // executable or args changed are terminated; the rest are kept.
+    void Configure(const std::vector<StandbySpec>& specs);
+
+    // Replaces every standby, e.g. after the environment changed
+    void RetireAll();
+
+    // Reveals the app's standby in directory. False if none was ready, in
+    // which case the caller spawns as usual.
+    bool TryActivate(const std::string& appName, const std::string& directory);
+
+    size_t ReadyCount() const;
+    Stats GetStats() const;
+
+private:
+    struct Slot {
+        StandbySpec spec;
+        StandbyProcess process;
+        uint64_t generation;     // Bumped when the spec changes or the slot is retired
+        bool starting;
+        std::chrono::steady_clock::time_point startedAt;
+        std::chrono::steady_clock::time_point retryAt;
+
+        Slot() : process(0), generation(0), starting(false) {}
+    };
+
+    void ThreadLoop();
+
+    // One maintenance pass; called with the lock held, drops it around backend calls
+    void MaintainLocked(std::unique_lock<std::mutex>& lock);
+
+    IProcessBackend& m_backend;
+    std::chrono::milliseconds m_maxAge;
+    std::chrono::milliseconds m_checkInterval;
+    std::chrono::milliseconds m_retryDelay;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::map<std::string, Slot> m_slots;
+    std::vector<StandbyProcess> m_retired;
+    uint64_t m_nextGeneration;
+    std::thread m_thread;
+    bool m_running;
+    bool m_stopping;
+    bool m_dirty;
+    Stats m_stats;
+};
@@ -0,0 +1,139 @@
+#include "startup_profile.h"
+#include <cstdio>
+
+namespace {
+
+double ToMilliseconds(PhaseTimer::Clock::duration elapsed) {
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+} // namespace
+
+PhaseTimer::PhaseTimer(Clock::time_point start)
+    : m_leadIns(0), m_start(start), m_last(start) {
+}
+
+void PhaseTimer::Mark(const std::string& name) {
+    Mark(name, Clock::now());
+}
+
+void PhaseTimer::Mark(const std::string& name, Clock::time_point now) {
+    m_phases.push_back(Phase { name, now - m_last });
+    m_last = now;
+}
+
+void PhaseTimer::AddLeadIn(const std::string& name, Clock::duration elapsed) {
+    m_phases.insert(m_phases.begin() + m_leadIns, Phase { name, elapsed });
+    m_leadIns++;
+}
+
+PhaseTimer::Clock::duration PhaseTimer::Total() const {
+    Clock::duration total(0);
+    for (const Phase& phase : m_phases) {
+        total += phase.elapsed;
+    }
+    return total;
+}
+
+int PhaseTimer::PhaseAt(Clock::time_point time) const {
+    Clock::time_point end = m_start;
+    for (size_t i = m_leadIns; i < m_phases.size(); i++) {
+        end += m_phases[i].elapsed;
+        if (time >= m_start && time < end) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+LazyComponents::LazyComponents() {
+}
+
+LazyComponents::~LazyComponents() {
+    Shutdown();
+}
+
+int LazyComponents::Add(const std::string& name, StartFunction start, StopFunction stop, const std::vector<int>& dependencies) {
+    int id = (int)m_components.size();
+    Component component;
+    component.name = name;
+    component.start = start;
+    component.stop = stop;
+    for (int dependency : dependencies) {
+        if (dependency >= 0 && dependency < id) {
+            component.dependencies.push_back(dependency);
+        }
+    }
+    component.started = false;
+    m_components.push_back(component);
+    return id;
+}
+
+bool LazyComponents::Ensure(int id) {
+    if (id < 0 || (size_t)id >= m_components.size()) {
+        return false;
+    }
+    if (m_components[id].started) {
+        return true;
+    }
+    // Dependencies have lower ids, so this recursion always ends
+    for (int dependency : m_components[id].dependencies) {
+        if (!Ensure(dependency)) {
+            return false;
+        }
+    }
+
+    Component& component = m_components[id];
+    PhaseTimer::Clock::time_point at = PhaseTimer::Clock::now();
+    if (component.start && !component.start()) {
+        return false;
+    }
+    component.started = true;
+    m_starts.push_back(StartRecord { id, at, PhaseTimer::Clock::now() - at });
+    return true;
+}
+
+bool LazyComponents::IsStarted(int id) const {
+    return id >= 0 && (size_t)id < m_components.size() && m_components[id].started;
+}
+
+const std::string& LazyComponents::Name(int id) const {
+    return m_components[id].name;
+}
+
+void LazyComponents::Shutdown() {
+    for (size_t i = m_starts.size(); i-- > 0;) {
+        Component& component = m_components[m_starts[i].id];
+        if (component.stop) {
+            component.stop();
+        }
+        component.started = false;
+    }
+    m_starts.clear();
+}
+
+std::string FormatStartupProfile(const PhaseTimer& timer, const LazyComponents& components) {
+    std::string report = "Startup profile (ms)\n\n";
+    char line[160];
+    snprintf(line, sizeof(line), "%-32s %10s\n", "phase", "ms");
+    report += line;
+    for (const PhaseTimer::Phase& phase : timer.Phases()) {
+        snprintf(line, sizeof(line), "%-32s %10.3f\n", phase.name.c_str(), ToMilliseconds(phase.elapsed));
+        report += line;
+    }
+    snprintf(line, sizeof(line), "%-32s %10.3f\n", "total", ToMilliseconds(timer.Total()));
+    report += line;
+
+    if (!components.Starts().empty()) {
+        report += "\n";
+        snprintf(line, sizeof(line), "%-32s %10s  %s\n", "started on first use", "ms", "during");
+        report += line;
+        for (const LazyComponents::StartRecord& start : components.Starts()) {
+            int phase = timer.PhaseAt(start.at);
+            snprintf(line, sizeof(line), "%-32s %10.3f  %s\n", components.Name(start.id).c_str(),
+                ToMilliseconds(start.elapsed), phase < 0 ? "(after the last phase)" : timer.Phases()[phase].name.c_str());
+            report += line;
+        }
+    }
+    return report;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Times consecutive phases of startup for --startup-profile, the way
+// LaunchTrace times the stages of a launch: each Mark records the time
+// since the previous mark (or since start) under the given name
+class PhaseTimer {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Phase {
+        std::string name;
+        Clock::duration elapsed;
+    };
+
+    explicit PhaseTimer(Clock::time_point start);
+
+    void Mark(const std::string& name);
+    void Mark(const std::string& name, Clock::time_point now);
+
+    // Time that passed before start, such as process creation to main.
+    // Listed ahead of the marked phases and counted in Total.
+    void AddLeadIn(const std::string& name, Clock::duration elapsed);
+
+    const std::vector<Phase>& Phases() const {
+        return m_phases;
+    }
+
+    Clock::duration Total() const;
+
+    // The marked phase that contains time, or -1 before start and after
+    // the last mark
+    int PhaseAt(Clock::time_point time) const;
+
+private:
+    std::vector<Phase> m_phases;
+    size_t m_leadIns;
+    Clock::time_point m_start;
+    Clock::time_point m_last;
+};
+
+// Parts of the process that start on first use instead of at process start,
+// such as COM on the UI thread. Ensure starts a component's dependencies,
+// then the component, each at most once; a start that fails is tried again
+// by the next Ensure. Shutdown stops what did start, newest first. Used from
+// one thread only.
+class LazyComponents {
+public:
+    typedef std::function<bool()> StartFunction;
+    typedef std::function<void()> StopFunction;
+
+    // When a component started and how long its own start took, not
+    // counting its dependencies
+    struct StartRecord {
+        int id;
+        PhaseTimer::Clock::time_point at;
+        PhaseTimer::Clock::duration elapsed;
+    };
+
+    LazyComponents();
+    ~LazyComponents();
+
+    // Returns the new component's id. Dependencies are ids returned by
+    // earlier calls, so the graph cannot have a cycle; stop may be empty.
+    int Add(const std::string& name, StartFunction start, StopFunction stop, const std::vector<int>& dependencies);
+
+    // Whether the component is running when the call returns
+    bool Ensure(int id);
+
+    bool IsStarted(int id) const;
+
+    const std::string& Name(int id) const;
+
+    // Started components in the order they started
+    const std::vector<StartRecord>& Starts() const {
+        return m_starts;
+    }
+
+    void Shutdown();
+
+private:
+    struct Component {
+        std::string name;
+        StartFunction start;
+        StopFunction stop;
+        std::vector<int> dependencies;
+        bool started;
+    };
+
+    std::vector<Component> m_components;
+    std::vector<StartRecord> m_starts;
+};
+
+// Plain-text table of the phases in milliseconds, followed by the lazy
+// components that started and the phase each started in
+std::string FormatStartupProfile(const PhaseTimer& timer, const LazyComponents& components);
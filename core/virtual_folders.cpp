@@ -0,0 +1,74 @@
+#include "virtual_folders.h"
+
+namespace {
+
+// Namespace roots that list the user's own folders rather than being one;
+// they launch in the home directory
+const char* const kHomeLikeFolders[] = {
+    "::{20d04fe0-3aea-1069-a2d8-08002b30309d}",  // This PC
+    "::{679f85cb-0220-4080-b197-cb1f3df0a2b8}",  // Quick Access
+    "::{f874310e-b6b7-47dc-bc84-b9e6b38f5903}",  // Home (Windows 11)
+};
+
+std::string ToLower(std::string text) {
+    for (char& c : text) {
+        c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+    return text;
+}
+
+bool IsHomeLikeFolder(const std::string& lowercaseName) {
+    for (const char* name : kHomeLikeFolders) {
+        if (lowercaseName == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+VirtualFolderMap::VirtualFolderMap(IVirtualFolderSource& source)
+    : m_source(source) {
+}
+
+bool VirtualFolderMap::Resolve(const std::string& parsingName, std::string& path) {
+    // Parsing names are case-insensitive, GUIDs in particular
+    std::string key = ToLower(parsingName);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            m_stats.hits++;
+            path = it->second.path;
+            return it->second.found;
+        }
+        m_stats.misses++;
+    }
+
+    // Shell lookups run without the lock
+    Entry entry;
+    entry.found = m_source.ResolveVirtualFolder(parsingName, entry.path);
+    if (!entry.found && IsHomeLikeFolder(key)) {
+        entry.path = m_source.GetHomeDirectory();
+        entry.found = !entry.path.empty();
+    }
+    if (!entry.found) {
+        entry.path.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[key] = entry;
+    path = entry.path;
+    return entry.found;
+}
+
+void VirtualFolderMap::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+VirtualFolderMap::Stats VirtualFolderMap::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Shell namespace lookups for folders without a file system path. On
+// Windows these go through IKnownFolderManager and IShellLibrary.
+class IVirtualFolderSource {
+public:
+    virtual ~IVirtualFolderSource() {}
+
+    // Real folder behind a virtual one, named by its desktop-absolute parsing
+    // name: the known folder "This PC\Documents" stands for, a library's
+    // default save folder, and so on
+    virtual bool ResolveVirtualFolder(const std::string& parsingName, std::string& path) = 0;
+
+    virtual std::string GetHomeDirectory() = 0;
+};
+
+// Parsing name -> file system path for virtual folders such as This PC,
+// Quick Access and libraries, so a press on one of them launches in a real
+// folder. Resolutions, including "no path" (Network, Recycle Bin), are
+// cached until Clear(), e.g. after a known folder is moved.
+class VirtualFolderMap {
+public:
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+
+        Stats() : hits(0), misses(0) {}
+    };
+
+    explicit VirtualFolderMap(IVirtualFolderSource& source);
+
+    // False if the folder has no file system location
+    bool Resolve(const std::string& parsingName, std::string& path);
+
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        bool found;
+        std::string path;
+    };
+
+    IVirtualFolderSource& m_source;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    Stats m_stats;
+};
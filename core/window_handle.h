@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+// Portable stand-in for an HWND so the core logic can be built and exercised
+// without <windows.h>. The Win32 shell converts with reinterpret_cast.
+typedef std::uintptr_t WindowHandle;
+
+const WindowHandle kNoWindow = 0;
@@ -4,48 +4,131 @@
 #include <shellapi.h>
 #include <shlobj.h>
 #include <shlwapi.h>
-#include <atlbase.h>
-#include <sstream>
 #include <iostream>
 #include <fstream>
-#include <map>
 #include <string>
+#include <string_view>
+#include <cstdlib>
 #include <vector>
-#include <algorithm>
-#include <cctype>
+#include <chrono>
+#include "batch_launch.h"
+#include "config.h"
+#include "config_diff.h"
+#include "config_parser.h"
+#include "config_persister.h"
+#include "config_watcher.h"
+#include "config_writer.h"
+#include "context_providers.h"
+#include "directory_cache.h"
+#include "directory_reachability.h"
+#include "executable_resolver.h"
+#include "frecency.h"
+#include "history_journal.h"
+#include "hotkey.h"
+#include "hotkey_conflicts.h"
+#include "instance_pipe.h"
+#include "key_sequence.h"
+#include "journal_file.h"
+#include "keyboard_hook.h"
+#include "launch_directory.h"
+#include "latency_stats.h"
+#include "launch_queue.h"
+#include "palette_window.h"
+#include "shell_windows.h"
+#include "standby_console.h"
+#include "startup_profile.h"
+#include "system_environment.h"
+#include "virtual_folders.h"
+#include "window_process_table.h"
 
 #pragma comment(lib, "shlwapi.lib")
 
-// Structure to hold application configuration
-struct AppConfig {
-    std::string executable;
-    bool runAsAdmin;
-    std::string args;
-    int hotkeyId;
-    UINT modifiers;
-    UINT vkCode;
-    bool enabled;  // Whether this app is currently active
-
-    AppConfig() : runAsAdmin(false), hotkeyId(0), modifiers(0), vkCode(0), enabled(true) {}
-};
-
-// Structure to hold settings configuration
-struct Settings {
-    bool checkMouseHover;
-    bool checkFocusedWindow;
-    std::string priorityWhenBothAvailable; // "hover" or "focus"
-
-    Settings() : checkMouseHover(true), checkFocusedWindow(true), priorityWhenBothAvailable("hover") {}
-};
-
-// Global configuration
-std::map<std::string, AppConfig> g_appConfigs;
-Settings g_settings;
+// Global configuration - the live snapshot is swapped atomically on reload
+ConfigStore g_config;
 std::string g_configPath;
 
+// This PC, Quick Access and libraries -> the real folder they stand for
+ShellVirtualFolderSource g_virtualFolderSource;
+VirtualFolderMap g_virtualFolders(g_virtualFolderSource);
+
+// Explorer directory cache, kept current by shell window events
+ComShellWindowProvider g_shellWindowProvider(g_virtualFolders);
+DirectoryCache g_directoryCache(g_shellWindowProvider);
+ShellWindowEvents g_shellWindowEvents(g_directoryCache, g_virtualFolders);
+
+// Cold misses are queried on a helper STA so a hung Explorer costs at most
+// resolveTimeoutMs per press
+DirectoryResolver g_directoryResolver(g_shellWindowProvider, g_directoryCache);
+
+// Foreground window -> process image for [Contexts] bindings; entries are
+// dropped when their window is destroyed
+SystemProcessTable g_processTable;
+ProcessImageCache g_processImages(g_processTable);
+WindowDestroyHook g_windowDestroyHook;
+
+// Directory sources for hovered/focused windows, tried in the order of the
+// contextProviders setting
+ExplorerContextProvider g_explorerProvider(g_directoryResolver);
+TerminalContextProvider g_terminalProvider;
+EditorContextProvider g_editorProvider(g_processImages);
+DesktopContextProvider g_desktopProvider;
+ContextProviderRegistry g_contextProviders(g_processTable, GetUserHomeDirectory);
+
+// Launch directories are checked before spawning; a share that is offline
+// is remembered for 10 seconds, one that answered for 30
+SystemDirectoryProbe g_directoryProbe;
+DirectoryReachability g_reachability(g_directoryProbe, std::chrono::seconds(30), std::chrono::seconds(10));
+
+// PATH / App Paths lookups, cached until the next WM_SETTINGCHANGE
+SystemExecutableEnvironment g_executableEnvironment;
+ExecutableResolver g_executableResolver(g_executableEnvironment);
+
+// Hidden, already-started shells for apps with the prewarm option. Standbys
+// are recycled after 30 minutes and on WM_SETTINGCHANGE, so a hand-out is
+// never much older than a fresh spawn would be.
+ConsoleStandbyBackend g_standbyBackend(g_executableResolver);
+StandbyPool g_standbyPool(g_standbyBackend, std::chrono::minutes(30));
+
+// Per-app, per-stage hotkey-to-spawn latency
+LatencyRecorder g_latency;
+
+// Apps and the folders they were launched in, ranked for the palette and
+// the tray's recent folders and kept in history.journal across restarts
+FrecencyTable g_recentLaunches;
+MappedJournalFile g_historyFile;
+HistoryJournal g_history(g_historyFile, g_recentLaunches);
+
+// Recent folders listed in the tray menu
+const size_t kTrayRecentFolders = 10;
+
+// Which hotkeys RegisterHotKey refused, shown per app in the tray menu.
+// Only touched on the message loop.
+HotkeyStatus g_hotkeyStatus;
+bool g_paletteHotkeyFailed = false;
+
+// Refused hotkeys listed in a balloon before the rest are counted
+const size_t kBalloonHotkeyFailures = 3;
+
+// Window messages
+const UINT WM_TRAY_ICON = WM_USER + 1;
+const UINT WM_CONFIG_FILE_CHANGED = WM_USER + 2;  // Posted by the config watcher thread
+const UINT WM_CONFIG_SAVE_FAILED = WM_USER + 3;   // Posted by the config persister thread
+const UINT WM_DUMP_STATS = WM_USER + 4;           // Sent by "launcher --stats"; returns 1 on success
+const UINT WM_RELOAD_CONFIG = WM_USER + 100;      // Posted by ConfigEditor.exe after a save
+
+// Hotkey id of the palette, above any app's
+const int kPaletteHotkeyId = 0xBFFF;
+
+// Saves arrive as bursts of change notifications; reload once they settle
+const UINT_PTR kReloadTimerId = 1;
+const UINT kReloadDebounceMs = 300;
+
 // Forward declarations
-bool RegisterHotkeys();
-void UnregisterHotkeys();
+std::vector<const AppConfig*> ApplyConfig(const std::shared_ptr<const ConfigSnapshot>& next, bool retryFailed,
+    bool& paletteFailed);
+std::string DescribeHotkeyFailures(const std::vector<const AppConfig*>& failed, bool paletteFailed, size_t maxShown);
+void UnregisterHotkeys(const ConfigSnapshot& config);
+void ShowTrayBalloon(const std::string& title, const std::string& text, DWORD iconFlags);
 
 // Function to get the executable directory
 std::string GetExeDirectory() {
@@ -68,222 +151,23 @@ std::string GetConfigDirectory() {
     return GetExeDirectory();
 }
 
-// Function to trim whitespace from string
-std::string Trim(const std::string& str) {
-    size_t first = str.find_first_not_of(" \t\r\n");
-    if (first == std::string::npos) return "";
-    size_t last = str.find_last_not_of(" \t\r\n");
-    return str.substr(first, last - first + 1);
-}
-
-// FIXED: Helper function to convert virtual key code to string representation
-std::string VirtualKeyToString(UINT vkCode) {
-    // Handle F-keys
-    if (vkCode >= VK_F1 && vkCode <= VK_F24) {
-        int fNum = (vkCode - VK_F1) + 1;
-        return "F" + std::to_string(fNum);
-    }
-
-    // Handle special keys
-    static const std::map<UINT, std::string> vkToString = {
-        {VK_DELETE, "Delete"}, {VK_INSERT, "Insert"},
-        {VK_HOME, "Home"}, {VK_END, "End"},
-        {VK_PRIOR, "PageUp"}, {VK_NEXT, "PageDown"},
-        {VK_UP, "Up"}, {VK_DOWN, "Down"}, {VK_LEFT, "Left"}, {VK_RIGHT, "Right"},
-        {VK_SPACE, "Space"}, {VK_TAB, "Tab"},
-        {VK_RETURN, "Enter"}, {VK_ESCAPE, "Escape"},
-        {VK_BACK, "Backspace"},
-        {VK_NUMPAD0, "Numpad0"}, {VK_NUMPAD1, "Numpad1"}, {VK_NUMPAD2, "Numpad2"},
-        {VK_NUMPAD3, "Numpad3"}, {VK_NUMPAD4, "Numpad4"}, {VK_NUMPAD5, "Numpad5"},
-        {VK_NUMPAD6, "Numpad6"}, {VK_NUMPAD7, "Numpad7"}, {VK_NUMPAD8, "Numpad8"},
-        {VK_NUMPAD9, "Numpad9"},
-        {VK_MULTIPLY, "Multiply"}, {VK_ADD, "Add"}, {VK_SUBTRACT, "Subtract"},
-        {VK_DIVIDE, "Divide"}, {VK_DECIMAL, "Decimal"}
-    };
-
-    auto it = vkToString.find(vkCode);
-    if (it != vkToString.end()) {
-        return it->second;
-    }
-
-    // For regular character keys
-    if (vkCode >= 0x30 && vkCode <= 0x5A) { // 0-9, A-Z
-        return std::string(1, (char)vkCode);
-    }
-
-    // Fallback
-    return std::string(1, (char)vkCode);
-}
-
-// FIXED: Function to parse hotkey string - now supports single keys without modifiers
-bool ParseHotkey(const std::string& hotkeyStr, UINT& modifiers, UINT& vkCode) {
-    modifiers = 0;
-    vkCode = 0;
-
-    std::string str = hotkeyStr;
-    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
-
-    if (str.find("CTRL") != std::string::npos) modifiers |= MOD_CONTROL;
-    if (str.find("ALT") != std::string::npos) modifiers |= MOD_ALT;
-    if (str.find("SHIFT") != std::string::npos) modifiers |= MOD_SHIFT;
-    if (str.find("WIN") != std::string::npos) modifiers |= MOD_WIN;
-
-    // Extract the final key
-    size_t lastPlus = str.find_last_of('+');
-    std::string key;
-
-    // FIXED: Handle both cases - with and without modifiers
-    if (lastPlus != std::string::npos && lastPlus < str.length() - 1) {
-        key = str.substr(lastPlus + 1);
-    }
-    else {
-        // No modifiers found - entire string is the key
-        key = str;
-    }
-    key = Trim(key);
-
-    if (key.empty()) {
+// Function to parse a hotkey with the active keyboard layout
+bool MapLayoutCharacter(char c, unsigned int& vkCode) {
+    SHORT scan = VkKeyScan(c);
+    if (scan == -1) {
         return false;
     }
-
-    // Handle F-keys (F1-F24)
-    if (key.length() >= 2 && key[0] == 'F') {
-        std::string numStr = key.substr(1);
-        try {
-            int fNum = std::stoi(numStr);
-            if (fNum >= 1 && fNum <= 24) {
-                vkCode = VK_F1 + (fNum - 1);
-                return true;
-            }
-        }
-        catch (...) {
-            return false;
-        }
-    }
-
-    // Handle special keys
-    static const std::map<std::string, UINT> specialKeys = {
-        {"DELETE", VK_DELETE}, {"DEL", VK_DELETE},
-        {"INSERT", VK_INSERT}, {"INS", VK_INSERT},
-        {"HOME", VK_HOME},
-        {"END", VK_END},
-        {"PAGEUP", VK_PRIOR}, {"PGUP", VK_PRIOR},
-        {"PAGEDOWN", VK_NEXT}, {"PGDN", VK_NEXT},
-        {"UP", VK_UP}, {"DOWN", VK_DOWN}, {"LEFT", VK_LEFT}, {"RIGHT", VK_RIGHT},
-        {"SPACE", VK_SPACE},
-        {"TAB", VK_TAB},
-        {"ENTER", VK_RETURN}, {"RETURN", VK_RETURN},
-        {"ESCAPE", VK_ESCAPE}, {"ESC", VK_ESCAPE},
-        {"BACKSPACE", VK_BACK}, {"BACK", VK_BACK},
-        {"NUMPAD0", VK_NUMPAD0}, {"NUMPAD1", VK_NUMPAD1}, {"NUMPAD2", VK_NUMPAD2},
-        {"NUMPAD3", VK_NUMPAD3}, {"NUMPAD4", VK_NUMPAD4}, {"NUMPAD5", VK_NUMPAD5},
-        {"NUMPAD6", VK_NUMPAD6}, {"NUMPAD7", VK_NUMPAD7}, {"NUMPAD8", VK_NUMPAD8},
-        {"NUMPAD9", VK_NUMPAD9},
-        {"MULTIPLY", VK_MULTIPLY}, {"ADD", VK_ADD}, {"SUBTRACT", VK_SUBTRACT},
-        {"DIVIDE", VK_DIVIDE}, {"DECIMAL", VK_DECIMAL}
-    };
-
-    auto it = specialKeys.find(key);
-    if (it != specialKeys.end()) {
-        vkCode = it->second;
-        return true;
-    }
-
-    // Handle single character keys (letters, numbers, symbols)
-    if (key.length() == 1) {
-        vkCode = VkKeyScan(key[0]) & 0xFF;
-        return true;
-    }
-
-    return false;
+    vkCode = scan & 0xFF;
+    return true;
 }
 
-// Function to load configuration from INI file
-bool LoadConfig(const std::string& configPath) {
-    std::ifstream file(configPath);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    std::string line;
-    std::string currentSection;
-    int hotkeyCounter = 1;
-
-    while (std::getline(file, line)) {
-        line = Trim(line);
-
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == ';' || line[0] == '#') {
-            continue;
-        }
-
-        // Check for section header
-        if (line[0] == '[' && line[line.length() - 1] == ']') {
-            currentSection = line.substr(1, line.length() - 2);
-            currentSection = Trim(currentSection);
-            continue;
-        }
-
-        // Parse key=value
-        size_t equalsPos = line.find('=');
-        if (equalsPos != std::string::npos) {
-            std::string key = Trim(line.substr(0, equalsPos));
-            std::string value = Trim(line.substr(equalsPos + 1));
-
-            if (currentSection == "Settings") {
-                // Parse settings
-                if (key == "checkMouseHover") {
-                    g_settings.checkMouseHover = (value == "true" || value == "1");
-                }
-                else if (key == "checkFocusedWindow") {
-                    g_settings.checkFocusedWindow = (value == "true" || value == "1");
-                }
-                else if (key == "priorityWhenBothAvailable") {
-                    std::string lowerValue = value;
-                    std::transform(lowerValue.begin(), lowerValue.end(), lowerValue.begin(), ::tolower);
-                    if (lowerValue == "hover" || lowerValue == "focus") {
-                        g_settings.priorityWhenBothAvailable = lowerValue;
-                    }
-                }
-            }
-            else if (currentSection == "Apps") {
-                // Format: name=executable|admin|args|hotkey|enabled
-                std::string name = key;
-                AppConfig config;
-
-                // Parse pipe-delimited values
-                std::vector<std::string> parts;
-                std::stringstream ss(value);
-                std::string part;
-                while (std::getline(ss, part, '|')) {
-                    parts.push_back(Trim(part));
-                }
-
-                if (parts.size() >= 4) {
-                    config.executable = parts[0];
-                    config.runAsAdmin = (parts[1] == "true" || parts[1] == "1");
-                    config.args = parts[2];
-
-                    // Parse enabled flag (optional, defaults to true)
-                    if (parts.size() >= 5) {
-                        config.enabled = (parts[4] == "true" || parts[4] == "1");
-                    }
-                    else {
-                        config.enabled = true; // Default to enabled for backward compatibility
-                    }
-
-                    // Parse hotkey
-                    if (ParseHotkey(parts[3], config.modifiers, config.vkCode)) {
-                        config.hotkeyId = hotkeyCounter++;
-                        g_appConfigs[name] = config;
-                    }
-                }
-            }
-        }
-    }
+bool ParseLayoutHotkey(std::string_view text, unsigned int& modifiers, unsigned int& vkCode) {
+    return ParseHotkey(text, modifiers, vkCode, MapLayoutCharacter);
+}
 
-    file.close();
-    return !g_appConfigs.empty();
+// Function to load configuration from INI file into a compiled snapshot
+std::shared_ptr<const ConfigSnapshot> LoadConfig(const std::string& configPath, std::vector<ConfigDiagnostic>& diagnostics) {
+    return LoadConfig(configPath, ParseLayoutHotkey, diagnostics);
 }
 
 // Function to create default config file
@@ -306,11 +190,12 @@ void CreateDefaultConfig(const std::string& configPath) {
     file << "priorityWhenBothAvailable=hover\n";
     file << "\n";
     file << "[Apps]\n";
-    file << "; Format: name=executable|runAsAdmin|args|hotkey|enabled\n";
+    file << "; Format: name=executable|runAsAdmin|args|hotkey|enabled|options\n";
     file << "; runAsAdmin: true or false\n";
     file << "; args: additional command line arguments (use empty string if none)\n";
     file << "; hotkey: e.g., Ctrl+Alt+P, Ctrl+Shift+C, etc.\n";
     file << "; enabled: true or false (allows disabling apps without deleting them)\n";
+    file << "; options: optional, e.g. prewarm (keep a hidden PowerShell/cmd ready)\n";
     file << "\n";
     file << "PowerShell=powershell.exe|false||Ctrl+Alt+P|true\n";
     file << "PowerShell Admin=powershell.exe|true||Ctrl+Alt+Shift+P|true\n";
@@ -322,18 +207,56 @@ void CreateDefaultConfig(const std::string& configPath) {
     file.close();
 }
 
-// Function to initialize COM
-void InitializeCOM() {
-    HRESULT hr = CoInitialize(NULL);
-    if (FAILED(hr)) {
-        std::cerr << "Failed to initialize COM." << std::endl;
-        exit(EXIT_FAILURE);
-    }
+// Started on first use rather than at process start, so --create-config
+// or a command forwarded to the running instance never initializes COM.
+// Shut down on every exit path.
+LazyComponents g_components;
+int g_comComponent = -1;
+int g_shellEventsComponent = -1;
+
+// Phases of this start, reported by --startup-profile
+PhaseTimer g_startupPhases(PhaseTimer::Clock::now());
+
+// Function to register what starts on first use. The UI thread needs COM
+// for ShellExecute and for directory queries made before the resolver
+// thread runs; workers and the shell event thread initialize their own.
+void RegisterLazyComponents() {
+    g_comComponent = g_components.Add("COM", []() {
+        return SUCCEEDED(CoInitialize(NULL));
+    }, []() {
+        CoUninitialize();
+    }, {});
+    g_shellEventsComponent = g_components.Add("shell window events", []() {
+        return g_shellWindowEvents.Start();
+    }, []() {
+        g_shellWindowEvents.Stop();
+    }, {});
 }
 
-// Function to uninitialize COM
-void UninitializeCOM() {
-    CoUninitialize();
+// Function to initialize COM on the UI thread if it is not yet
+bool EnsureCOM() {
+    return g_components.Ensure(g_comComponent);
+}
+
+// Function to get the time from process creation to now, the part of
+// startup spent in the loader and static initialization
+std::chrono::steady_clock::duration GetTimeSinceProcessCreation() {
+    FILETIME creation, exitTime, kernel, user, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return std::chrono::steady_clock::duration(0);
+    }
+    GetSystemTimeAsFileTime(&now);
+    ULARGE_INTEGER from, to;
+    from.LowPart = creation.dwLowDateTime;
+    from.HighPart = creation.dwHighDateTime;
+    to.LowPart = now.dwLowDateTime;
+    to.HighPart = now.dwHighDateTime;
+    if (to.QuadPart <= from.QuadPart) {
+        return std::chrono::steady_clock::duration(0);
+    }
+    // FILETIME counts 100 ns intervals
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds((to.QuadPart - from.QuadPart) * 100));
 }
 
 // Function to get the window under the cursor
@@ -359,211 +282,559 @@ HWND GetFocusedWindow() {
     return GetForegroundWindow();
 }
 
-// Function to get the relevant File Explorer window
-HWND GetFileExplorerWindow(HWND hwnd) {
-    char className[256];
-    while (hwnd != NULL) {
-        GetClassName(hwnd, className, sizeof(className));
-        if (strcmp(className, "CabinetWClass") == 0 ||
-            strcmp(className, "WorkerW") == 0 ||
-            strcmp(className, "SysTreeView32") == 0) {
-            return hwnd;
-        }
-        hwnd = GetParent(hwnd);
+// Function to register the built-in context providers under the names
+// DefaultContextProviders() lists
+void RegisterContextProviders() {
+    g_contextProviders.Add("explorer", g_explorerProvider, ContextProviderOptions());
+    // Repeated presses in one terminal within a second reuse its directory
+    g_contextProviders.Add("terminal", g_terminalProvider, ContextProviderOptions(50, 1000));
+    g_contextProviders.Add("editor", g_editorProvider, ContextProviderOptions(100, 0));
+    g_contextProviders.Add("desktop", g_desktopProvider, ContextProviderOptions(0, 60000));
+}
+
+// Function to pick the [Contexts] variant of an app for the foreground process
+const AppConfig& SelectForegroundContext(const ConfigSnapshot& config, const AppConfig& app, HWND foreground) {
+    if (!config.HasContexts(app)) {
+        return app;
     }
-    return NULL;
+    return *config.SelectContext(app, g_processImages.Lookup(ToWindowHandle(foreground)));
 }
 
-// Function to check if the window is a File Explorer window
-bool IsFileExplorerWindow(HWND hwnd) {
-    hwnd = GetFileExplorerWindow(hwnd);
-    if (hwnd != NULL) {
-        char className[256];
-        GetClassName(hwnd, className, sizeof(className));
-        return strcmp(className, "CabinetWClass") == 0 ||
-            strcmp(className, "WorkerW") == 0 ||
-            strcmp(className, "SysTreeView32") == 0;
+// Function to snapshot a hotkey press; cheap enough for the UI thread
+LaunchRequest CaptureLaunchRequest(const std::shared_ptr<const ConfigSnapshot>& config, const AppConfig& app) {
+    LaunchRequest request;
+    request.key = app.hotkeyId;
+    request.config = config;
+    request.app = &app;
+    request.pressedAt = std::chrono::steady_clock::now();
+
+    // The cursor and focus may move before a worker gets to the request
+    const Settings& settings = config->GetSettings();
+    if (settings.checkMouseHover) {
+        request.hoverWindow = ToWindowHandle(GetWindowUnderCursor());
     }
-    return false;
+    if (settings.checkFocusedWindow) {
+        request.focusWindow = ToWindowHandle(GetFocusedWindow());
+    }
+    return request;
 }
 
-// Function to retrieve the directory of the File Explorer window
-std::string GetExplorerWindowDirectory(HWND hwnd) {
-    std::string directory = "";
+// Function to start a resolved executable directly, skipping the shell's
+// association and search work
+bool SpawnProcess(const std::string& path, const std::string& args, const std::string& directory) {
+    std::string commandLine = "\"" + path + "\"";
+    if (!args.empty()) {
+        commandLine += " " + args;
+    }
 
-    if (hwnd == NULL) {
-        return "";
+    STARTUPINFO startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    startupInfo.dwFlags = STARTF_USESHOWWINDOW;
+    startupInfo.wShowWindow = SW_SHOWNORMAL;
+    PROCESS_INFORMATION processInfo = {};
+
+    // Console apps get their own console, as they would from ShellExecute
+    if (!CreateProcess(path.c_str(), &commandLine[0], NULL, NULL, FALSE,
+        CREATE_NEW_CONSOLE | CREATE_DEFAULT_ERROR_MODE, NULL,
+        directory.empty() ? NULL : directory.c_str(), &startupInfo, &processInfo)) {
+        return false;
     }
 
-    if (!IsWindow(hwnd)) {
-        return "";
+    CloseHandle(processInfo.hThread);
+    CloseHandle(processInfo.hProcess);
+    return true;
+}
+
+// Function to start one instance of an app; marks Resolve and Spawn on trace
+bool SpawnApplication(const AppConfig& config, const std::string& arguments, const std::string& directory,
+    LaunchTrace& trace) {
+    // Plain executables are spawned directly; elevation ("runas"), scripts,
+    // documents and URLs still need the shell
+    std::string executablePath;
+    bool direct = !config.runAsAdmin && g_executableResolver.Resolve(config.executable, executablePath);
+    trace.Mark(LaunchStage::Resolve);
+    if (direct) {
+        // The directory may have gone away since it was checked
+        if (SpawnProcess(executablePath, arguments, directory) ||
+            (GetLastError() == ERROR_DIRECTORY && SpawnProcess(executablePath, arguments, GetUserHomeDirectory()))) {
+            trace.Mark(LaunchStage::Spawn);
+            return true;
+        }
+        // Stale cache entry, e.g. the app moved; let the shell have a go
+        g_executableResolver.Forget(config.executable);
     }
 
-    hwnd = GetFileExplorerWindow(hwnd);
-    if (hwnd == NULL) {
-        return "";
+    const char* verb = config.runAsAdmin ? "runas" : "open";
+    const char* args = arguments.empty() ? NULL : arguments.c_str();
+    const char* dir = directory.empty() ? NULL : directory.c_str();
+
+    // The directory was checked before spawning, so a failure here is the
+    // app's own; retrying from home would only repeat it
+    HINSTANCE result = ShellExecute(NULL, verb, config.executable.c_str(), args, dir, SW_SHOWNORMAL);
+    trace.Mark(LaunchStage::Spawn);
+    return (INT_PTR)result > 32;
+}
+
+// Spawn backend for batch launches. Like the launch workers, each thread is
+// an STA so ShellExecute can run there.
+class ShellSpawnBackend : public ISpawnBackend {
+public:
+    void OnWorkerStarted() override {
+        CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
     }
 
-    CComPtr<IShellWindows> spShellWindows;
-    HRESULT hr = spShellWindows.CoCreateInstance(CLSID_ShellWindows);
-    if (FAILED(hr)) {
-        return "";
+    void OnWorkerStopped() override {
+        CoUninitialize();
     }
 
-    SHANDLE_PTR hwndShell;
-    CComPtr<IDispatch> spdisp;
+    bool Spawn(const SpawnJob& job) override {
+        // Standbys are started with the app's own args
+        if (job.app->prewarm && job.args == job.app->args && !job.directory.empty() &&
+            g_standbyPool.TryActivate(job.app->name, job.directory)) {
+            return true;
+        }
+        // Per-job stages would interleave; the batch is traced as a whole
+        LaunchTrace trace(nullptr, std::string(), std::chrono::steady_clock::now());
+        return SpawnApplication(*job.app, job.args, job.directory, trace);
+    }
+};
 
-    for (long i = 0; ; i++) {
-        spdisp.Release();
+// Three workers plus the launch worker that owns the batch; used for
+// perFolder/allItems selections and [Groups]
+ShellSpawnBackend g_spawnBackend;
+SpawnScheduler g_spawnScheduler(g_spawnBackend, 3);
 
-        hr = spShellWindows->Item(CComVariant(i), &spdisp);
-        if (FAILED(hr)) {
-            break;
+// Function to get the deadline for a press's follow-up context queries
+std::chrono::steady_clock::time_point GetQueryDeadline(const Settings& settings) {
+    if (settings.resolveTimeoutMs <= 0) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.resolveTimeoutMs);
+}
+
+// Function to get the time frecency is kept in, which survives restarts
+int64_t GetWallClockSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Function to check whether launching app expands a placeholder; for a
+// group, whether any member's args do
+bool LaunchUses(const ConfigSnapshot& config, const AppConfig& app, ArgField field) {
+    if (app.argsTemplate.Uses(field)) {
+        return true;
+    }
+    for (const GroupMember& member : app.members) {
+        const AppConfig* target = member.hasArgs ? nullptr : config.FindByName(member.app);
+        if ((member.hasArgs && member.argsTemplate.Uses(field)) ||
+            (target != nullptr && target->argsTemplate.Uses(field))) {
+            return true;
         }
+    }
+    return false;
+}
 
-        if (spdisp == nullptr) {
-            break;
+// Function to gather the values args placeholders stand for. Only those
+// the launch uses are read: the title and selection cost a query each.
+ArgValues GetArgValues(const LaunchRequest& request, const std::string& directory, const ContextClaim& source) {
+    ArgValues values;
+    values.dir = directory;
+
+    const ConfigSnapshot& config = *request.config;
+    const AppConfig& app = *request.app;
+    if (request.focusWindow != kNoWindow && LaunchUses(config, app, ArgField::Title)) {
+        char title[512];
+        if (GetWindowText(ToHwnd(request.focusWindow), title, sizeof(title)) > 0) {
+            values.title = title;
         }
+    }
 
-        CComPtr<IWebBrowserApp> spWebBrowserApp;
-        spdisp.QueryInterface(&spWebBrowserApp);
+    // perFolder/allItems launches set {item} per job from their own selection
+    if (app.selection == SelectionMode::None && LaunchUses(config, app, ArgField::Item)) {
+        std::vector<SelectedItem> selection;
+        if (g_contextProviders.GetSelection(source, GetQueryDeadline(config.GetSettings()), selection) &&
+            !selection.empty()) {
+            values.item = selection.front().path;
+        }
+    }
+    return values;
+}
 
-        if (spWebBrowserApp) {
-            spWebBrowserApp->get_HWND(&hwndShell);
+// Function to launch a perFolder or allItems app for the items selected in
+// the window its directory came from. Returns false if there is nothing to
+// launch for, so the app starts once as usual.
+bool LaunchSelection(const LaunchRequest& request, const ArgValues& values, const ContextClaim& source) {
+    const Settings& settings = request.config->GetSettings();
+    std::vector<SelectedItem> selection;
+    if (!g_contextProviders.GetSelection(source, GetQueryDeadline(settings), selection)) {
+        return false;
+    }
+    std::vector<SpawnJob> jobs = ExpandSelection(*request.app, values, selection, (size_t)settings.maxFanOut);
+    if (jobs.empty()) {
+        return false;
+    }
+    g_spawnScheduler.Run(jobs);
+    return true;
+}
 
-            if ((HWND)hwndShell == hwnd) {
-                CComPtr<IDispatch> spDispDoc;
-                hr = spWebBrowserApp->get_Document(&spDispDoc);
-                if (FAILED(hr) || spDispDoc == nullptr) {
-                    continue;
-                }
+// Function to launch application
+void LaunchApplication(const LaunchRequest& request) {
+    const AppConfig& config = *request.app;
+    LaunchTrace trace(&g_latency, config.name, request.pressedAt);
+    trace.Mark(LaunchStage::Dispatch);
+
+    // A folder chosen in the palette is used while it is still reachable
+    const Settings& settings = request.config->GetSettings();
+    ContextClaim source;
+    std::string directory = request.directory;
+    if (directory.empty() || !g_reachability.IsUsable(directory, GetQueryDeadline(settings))) {
+        directory = GetLaunchDirectory(settings, request.hoverWindow, request.focusWindow,
+            g_contextProviders, g_reachability, trace, &source);
+    }
+    g_history.Record(config.name, directory, GetWallClockSeconds());
 
-                CComPtr<IServiceProvider> spServiceProvider;
-                hr = spDispDoc->QueryInterface(IID_PPV_ARGS(&spServiceProvider));
-                if (SUCCEEDED(hr) && spServiceProvider) {
-                    CComPtr<IShellBrowser> spShellBrowser;
-                    hr = spServiceProvider->QueryService(SID_STopLevelBrowser, IID_PPV_ARGS(&spShellBrowser));
-                    if (SUCCEEDED(hr) && spShellBrowser) {
-                        CComPtr<IShellView> spShellView;
-                        hr = spShellBrowser->QueryActiveShellView(&spShellView);
-                        if (SUCCEEDED(hr) && spShellView) {
-                            CComPtr<IFolderView> spFolderView;
-                            hr = spShellView->QueryInterface(IID_PPV_ARGS(&spFolderView));
-                            if (SUCCEEDED(hr) && spFolderView) {
-                                CComPtr<IPersistFolder2> spPersistFolder2;
-                                hr = spFolderView->GetFolder(IID_PPV_ARGS(&spPersistFolder2));
-                                if (SUCCEEDED(hr) && spPersistFolder2) {
-                                    LPITEMIDLIST pidl = nullptr;
-                                    hr = spPersistFolder2->GetCurFolder(&pidl);
-                                    if (SUCCEEDED(hr) && pidl) {
-                                        char path[MAX_PATH];
-                                        if (SHGetPathFromIDList(pidl, path)) {
-                                            directory = std::string(path);
-                                        }
-                                        CoTaskMemFree(pidl);
-                                    }
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    ArgValues values = GetArgValues(request, directory, source);
+
+    // A group shares this press's directory among all its members
+    if (!config.members.empty()) {
+        g_spawnScheduler.RunInOrder(PlanGroupLaunch(*request.config, config, values));
+        trace.Mark(LaunchStage::Spawn);
+        trace.RecordSince(LaunchStage::Total, request.pressedAt);
+        return;
+    }
+
+    if (config.selection != SelectionMode::None && LaunchSelection(request, values, source)) {
+        trace.Mark(LaunchStage::Spawn);
+        trace.RecordSince(LaunchStage::Total, request.pressedAt);
+        return;
     }
 
-    return directory;
+    // A prewarmed shell only has to change directory and show itself
+    if (config.prewarm && !directory.empty() && g_standbyPool.TryActivate(config.name, directory)) {
+        trace.Mark(LaunchStage::Spawn);
+        trace.RecordSince(LaunchStage::Total, request.pressedAt);
+        return;
+    }
+
+    SpawnApplication(config, ExpandArgs(config.args, config.argsTemplate, values), directory, trace);
+    trace.RecordSince(LaunchStage::Total, request.pressedAt);
 }
 
-// Function to get the user's home directory
-std::string GetUserHomeDirectory() {
-    char path[MAX_PATH];
-    if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_PROFILE, NULL, 0, path))) {
-        return std::string(path);
+// Launch backend for the queue workers. Each worker is its own STA, so COM
+// lookups and a UAC prompt for "runas" never block the message loop.
+class ShellLaunchBackend : public ILaunchBackend {
+public:
+    void OnWorkerStarted() override {
+        CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
     }
-    return "";
+
+    void OnWorkerStopped() override {
+        CoUninitialize();
+    }
+
+    void Launch(const LaunchRequest& request) override {
+        LaunchApplication(request);
+    }
+};
+
+// Two workers so an elevated launch waiting on UAC does not hold up the next hotkey
+ShellLaunchBackend g_launchBackend;
+LaunchQueue g_launchQueue(g_launchBackend, 2);
+
+// Hidden window for message processing
+HWND g_hwnd = NULL;
+
+// Posts WM_CONFIG_FILE_CHANGED whenever launcher.ini is written
+DirectoryChangeWatcher g_configWatcher;
+
+// Writes tray edits back to launcher.ini in the background
+StdFileOps g_fileOps;
+ConfigPersister g_configPersister(g_fileOps, std::chrono::milliseconds(250));
+
+// Search box over apps and recent launches, opened by paletteHotkey or the tray
+PaletteWindow g_palette;
+
+// The press that opened the palette; a choice launches against its windows
+LaunchRequest g_paletteRequest;
+HWND g_paletteForeground = NULL;
+
+// Function to open the palette over the current apps and recent launches
+void OpenPalette() {
+    std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+    if (!config || config->Apps().empty()) {
+        return;
+    }
+    g_paletteForeground = GetFocusedWindow();
+    g_paletteRequest = CaptureLaunchRequest(config, config->Apps().front());
+    g_palette.Show(BuildPaletteItems(*config, g_recentLaunches.Snapshot(), GetWallClockSeconds()));
+}
+
+// Function to launch what was chosen in the palette, as if its hotkey had
+// been pressed when the palette opened
+void OnPaletteChoose(const PaletteItem& item) {
+    LaunchRequest request = g_paletteRequest;
+    const AppConfig* app = request.config ? request.config->FindByName(item.app) : nullptr;
+    if (app == nullptr) {
+        return;
+    }
+    request.app = &SelectForegroundContext(*request.config, *app, g_paletteForeground);
+    request.key = request.app->hotkeyId;
+    request.directory = item.directory;
+    request.pressedAt = std::chrono::steady_clock::now();
+    g_launchQueue.Enqueue(request);
+}
+
+// Function to launch an app in a folder from the history, with the windows
+// under the cursor and in the foreground as context
+void LaunchRecent(const FrecencyEntry& entry) {
+    std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+    const AppConfig* app = config ? config->FindByName(entry.app) : nullptr;
+    if (app == nullptr) {
+        return;
+    }
+    LaunchRequest request = CaptureLaunchRequest(config, SelectForegroundContext(*config, *app, GetFocusedWindow()));
+    request.directory = entry.directory;
+    g_launchQueue.Enqueue(request);
+}
+
+// Function to get the file the launch history is kept in
+std::string GetHistoryPath() {
+    return GetConfigDirectory() + "\\history.journal";
+}
+
+// Function to get the file the latency report is written to
+std::string GetStatsPath() {
+    return GetConfigDirectory() + "\\launch-stats.txt";
+}
+
+// Function to write the latency report (p50/p95/p99 per app and stage)
+bool DumpLatencyStats() {
+    return WriteFileAtomically(g_fileOps, GetStatsPath(), FormatLatencyReport(g_latency));
 }
 
-// Function to get the directory to launch in
-std::string GetLaunchDirectory() {
-    std::string hoverDir = "";
-    std::string focusDir = "";
+// Function to convert text in the ANSI code page, as the A-suffixed APIs
+// return paths and names, to the UTF-8 that JSON output requires
+std::string AnsiToUtf8(const std::string& text) {
+    int length = MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0);
+    if (length <= 0) {
+        return "";
+    }
+    std::wstring wide(length, L'\0');
+    MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), &wide[0], length);
+
+    int utf8Length = WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), length, NULL, 0, NULL, NULL);
+    std::string utf8(utf8Length > 0 ? utf8Length : 0, '\0');
+    if (utf8Length > 0) {
+        WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), length, &utf8[0], utf8Length, NULL, NULL);
+    }
+    return utf8;
+}
 
-    // Check mouse hover if enabled
-    if (g_settings.checkMouseHover) {
-        HWND hwndUnderCursor = GetWindowUnderCursor();
-        if (hwndUnderCursor != NULL && IsFileExplorerWindow(hwndUnderCursor)) {
-            hoverDir = GetExplorerWindowDirectory(hwndUnderCursor);
+// Commands a second launcher process forwards to this one (--oneshot,
+// --launch, --print-context). Launches go through the launch queue, so the
+// pipe thread never waits on a spawn.
+class LauncherInstanceCommands : public IInstanceCommands {
+public:
+    IpcResponse Launch(const std::string& appName) override {
+        std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+        const AppConfig* app = config ? config->FindByName(appName) : nullptr;
+        if (app == nullptr) {
+            return IpcResponse(false, "no app named '" + appName + "' in launcher.ini");
         }
+        return Enqueue(CaptureLaunchRequest(config, SelectForegroundContext(*config, *app, GetFocusedWindow())));
     }
 
-    // Check focused window if enabled
-    if (g_settings.checkFocusedWindow) {
-        HWND hwndFocused = GetFocusedWindow();
-        // Make sure it's different from cursor window to avoid redundant checks
-        if (hwndFocused != NULL && IsFileExplorerWindow(hwndFocused)) {
-            focusDir = GetExplorerWindowDirectory(hwndFocused);
+    IpcResponse LaunchDefault() override {
+        std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+        if (!config || config->Apps().empty()) {
+            return IpcResponse(false, "launcher.ini has no apps");
         }
+        return Enqueue(CaptureLaunchRequest(config, config->Apps().front()));
     }
 
-    // Determine which directory to use based on priority
-    if (!hoverDir.empty() && !focusDir.empty()) {
-        // Both found - use priority setting
-        if (g_settings.priorityWhenBothAvailable == "hover") {
-            return hoverDir;
+    IpcResponse PrintContext() override {
+        std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+        Settings settings = config ? config->GetSettings() : Settings();
+
+        WindowHandle hoverWindow = settings.checkMouseHover ? ToWindowHandle(GetWindowUnderCursor()) : kNoWindow;
+        WindowHandle focusWindow = settings.checkFocusedWindow ? ToWindowHandle(GetFocusedWindow()) : kNoWindow;
+        LaunchTrace trace(nullptr, std::string(), std::chrono::steady_clock::now());
+        std::string directory = GetLaunchDirectory(settings, hoverWindow, focusWindow, g_contextProviders, g_reachability, trace);
+        return IpcResponse(true, FormatLaunchContextJson(AnsiToUtf8(directory), hoverWindow, focusWindow) + "\n");
+    }
+
+    IpcResponse History(size_t count) override {
+        int64_t now = GetWallClockSeconds();
+        std::vector<FrecencyEntry> recent = RankRecentDirectories(g_recentLaunches.Snapshot(), now, count);
+        for (FrecencyEntry& entry : recent) {
+            entry.app = AnsiToUtf8(entry.app);
+            entry.directory = AnsiToUtf8(entry.directory);
         }
-        else {
-            return focusDir;
+        return IpcResponse(true, FormatHistoryJson(recent, now) + "\n");
+    }
+
+private:
+    // A request folded into a launch already queued or just made starts
+    // nothing, and the client is told so
+    static IpcResponse Enqueue(const LaunchRequest& request) {
+        if (!g_launchQueue.Enqueue(request)) {
+            return IpcResponse(false, "'" + request.app->name + "' is already launching; request coalesced");
         }
+        return IpcResponse(true, "");
     }
-    else if (!hoverDir.empty()) {
-        // Only hover found
-        return hoverDir;
+};
+
+LauncherInstanceCommands g_instanceCommands;
+
+// Serves forwarded commands from the warm caches of this instance
+InstancePipeServer g_instanceServer(g_instanceCommands);
+
+// How long a client waits for a busy instance pipe, and then for the answer.
+// The answer allows for a slow directory query behind --print-context.
+const DWORD kInstanceCallTimeoutMs = 2000;
+const DWORD kInstanceReplyTimeoutMs = 10000;
+
+// Function to write to the console or file a client was started from. A
+// WIN32-subsystem process only has handles when its output is redirected,
+// so otherwise attach to the parent's console.
+void WriteStandardHandle(DWORD handleId, const std::string& text) {
+    if (text.empty()) {
+        return;
     }
-    else if (!focusDir.empty()) {
-        // Only focus found
-        return focusDir;
+
+    HANDLE handle = GetStdHandle(handleId);
+    HANDLE console = INVALID_HANDLE_VALUE;
+    if ((handle == NULL || handle == INVALID_HANDLE_VALUE) &&
+        (AttachConsole(ATTACH_PARENT_PROCESS) || GetLastError() == ERROR_ACCESS_DENIED)) {
+        console = CreateFile("CONOUT$", GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+        handle = console;
+    }
+    if (handle == NULL || handle == INVALID_HANDLE_VALUE) {
+        return;
     }
 
-    // Nothing found - use home directory
-    return GetUserHomeDirectory();
+    DWORD written = 0;
+    WriteFile(handle, text.data(), (DWORD)text.size(), &written, NULL);
+    if (console != INVALID_HANDLE_VALUE) {
+        CloseHandle(console);
+    }
 }
 
-// Function to launch application
-void LaunchApplication(const AppConfig& config) {
-    std::string directory = GetLaunchDirectory();
-    const char* verb = config.runAsAdmin ? "runas" : "open";
-    const char* args = config.args.empty() ? NULL : config.args.c_str();
-    const char* dir = directory.empty() ? NULL : directory.c_str();
-
-    HINSTANCE result = ShellExecute(NULL, verb, config.executable.c_str(),
-        args, dir, SW_SHOWNORMAL);
+// Function to turn a command response into output and an exit code
+int ReportCommandResponse(const IpcResponse& response) {
+    if (!response.ok) {
+        WriteStandardHandle(STD_ERROR_HANDLE, "launcher: " + response.body + "\n");
+        return 1;
+    }
+    WriteStandardHandle(STD_OUTPUT_HANDLE, response.body);
+    return 0;
+}
 
-    if ((INT_PTR)result <= 32) {
-        // If launch failed, try from home directory
-        std::string homeDir = GetUserHomeDirectory();
-        ShellExecute(NULL, verb, config.executable.c_str(),
-            args, homeDir.empty() ? NULL : homeDir.c_str(), SW_SHOWNORMAL);
+// Function to find the value following a command line flag, e.g. --launch <name>
+std::string GetArgumentValue(const char* flag) {
+    for (int i = 1; i + 1 < __argc; i++) {
+        if (strcmp(__argv[i], flag) == 0) {
+            return __argv[i + 1];
+        }
     }
+    return "";
 }
 
-// Hidden window for message processing
-HWND g_hwnd = NULL;
+// Function to reload the config file and apply only what changed. A reload
+// from the tray menu reports through message boxes; one triggered by the file
+// watcher or the config editor stays quiet unless something went wrong.
+void ReloadConfig(bool fromTray) {
+    std::vector<ConfigDiagnostic> diagnostics;
+    std::shared_ptr<const ConfigSnapshot> reloaded = LoadConfig(g_configPath, diagnostics);
+    std::string problems = diagnostics.empty() ? "" :
+        "\n\nProblems in launcher.ini:\n" + FormatDiagnostics(diagnostics, 10);
+
+    // In-flight launches keep the old snapshot
+    if (!reloaded) {
+        if (fromTray) {
+            std::string message = "Failed to reload configuration file." + problems;
+            MessageBox(NULL, message.c_str(), "Error", MB_OK | MB_ICONERROR);
+        }
+        else {
+            ShowTrayBalloon("Configuration not reloaded", "launcher.ini could not be loaded; the previous configuration stays active.", NIIF_ERROR);
+        }
+        return;
+    }
+
+    // Only a reload the user asked for retries refused hotkeys, so saving
+    // the file does not repeat the same warning
+    bool paletteFailed = false;
+    std::vector<const AppConfig*> failed = ApplyConfig(reloaded, fromTray, paletteFailed);
+    if (!failed.empty() || paletteFailed) {
+        if (fromTray) {
+            std::string message = "Failed to register hotkeys after reload:\n" +
+                DescribeHotkeyFailures(failed, paletteFailed, 10) + problems;
+            MessageBox(NULL, message.c_str(), "Error", MB_OK | MB_ICONERROR);
+        }
+        else {
+            ShowTrayBalloon("Hotkeys not registered", DescribeHotkeyFailures(failed, paletteFailed, kBalloonHotkeyFailures),
+                NIIF_WARNING);
+        }
+    }
+    else if (fromTray) {
+        std::string message = "Configuration reloaded successfully!" + problems;
+        MessageBox(NULL, message.c_str(), "Success", MB_OK | (diagnostics.empty() ? MB_ICONINFORMATION : MB_ICONWARNING));
+    }
+    else if (!diagnostics.empty()) {
+        ShowTrayBalloon("Configuration reloaded with problems", FormatDiagnostics(diagnostics, 3), NIIF_WARNING);
+    }
+}
 
 // Window procedure
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
-    case WM_HOTKEY:
+    case WM_HOTKEY: {
+        if ((int)wParam == kPaletteHotkeyId) {
+            OpenPalette();
+            return 0;
+        }
+
         // Find which app corresponds to this hotkey ID
-        for (const auto& pair : g_appConfigs) {
-            if (pair.second.hotkeyId == (int)wParam && pair.second.enabled) {
-                LaunchApplication(pair.second);
-                break;
-            }
+        std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+        const AppConfig* app = config ? config->FindByHotkey((int)wParam) : nullptr;
+        if (app != nullptr && app->enabled) {
+            LaunchRequest request = CaptureLaunchRequest(config, SelectForegroundContext(*config, *app, GetFocusedWindow()));
+            g_launchQueue.Enqueue(request);
+            g_latency.Record(app->name, LaunchStage::Capture, std::chrono::steady_clock::now() - request.pressedAt);
+        }
+        return 0;
+    }
+
+    case WM_CONFIG_FILE_CHANGED:
+    case WM_RELOAD_CONFIG:
+        // Restarting the timer on every notification debounces the burst
+        SetTimer(hwnd, kReloadTimerId, kReloadDebounceMs, NULL);
+        return 0;
+
+    case WM_SETTINGCHANGE:
+        // PATH or App Paths may have changed (e.g. an installer finished)
+        g_executableResolver.Invalidate();
+        g_standbyPool.RetireAll();
+        g_contextProviders.Invalidate();
+        // Known folders may have moved; mapped drives may have changed
+        g_virtualFolders.Clear();
+        g_reachability.Invalidate();
+        return 0;
+
+    case WM_DUMP_STATS:
+        return DumpLatencyStats() ? 1 : 0;
+
+    case WM_CONFIG_SAVE_FAILED:
+        ShowTrayBalloon("Configuration not saved", "The change is active but could not be written to launcher.ini.", NIIF_WARNING);
+        return 0;
+
+    case WM_TIMER:
+        if (wParam == kReloadTimerId) {
+            KillTimer(hwnd, kReloadTimerId);
+            ReloadConfig(false);
         }
         return 0;
 
-    case WM_USER + 1: // Tray icon message
+    case WM_TRAY_ICON:
         if (lParam == WM_RBUTTONUP) {
             // Right-click on tray icon
             POINT pt;
@@ -571,23 +842,56 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
             HMENU hMenu = CreatePopupMenu();
 
-            // Add app status submenu
+            // The menu ids index into this snapshot
+            std::shared_ptr<const ConfigSnapshot> config = g_config.Current();
+            const std::vector<AppConfig>& apps = config->Apps();
+
+            // Add app status submenu; the hotkey column shows whether
+            // each hotkey is live
             int menuId = 100;
-            for (const auto& pair : g_appConfigs) {
+            for (const AppConfig& app : apps) {
                 UINT flags = MF_STRING;
-                if (pair.second.enabled) {
+                if (app.enabled) {
                     flags |= MF_CHECKED;
                 }
-                AppendMenu(hMenu, flags, menuId++, pair.first.c_str());
+                std::string label = app.name + "\t" + FormatHotkeyStatus(app, g_hotkeyStatus.StateOf(app));
+                AppendMenu(hMenu, flags, menuId++, label.c_str());
             }
 
-            if (!g_appConfigs.empty()) {
+            if (!apps.empty()) {
                 AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
             }
 
+            // Recent folders submenu; its ids index into recent
+            std::vector<FrecencyEntry> recent = RankRecentDirectories(g_recentLaunches.Snapshot(),
+                GetWallClockSeconds(), kTrayRecentFolders);
+            HMENU recentMenu = CreatePopupMenu();
+            for (size_t i = 0; i < recent.size(); i++) {
+                // A lone '&' would underline the next character
+                std::string label = recent[i].app + "  " + recent[i].directory;
+                for (size_t amp = label.find('&'); amp != std::string::npos; amp = label.find('&', amp + 2)) {
+                    label.insert(amp, 1, '&');
+                }
+                AppendMenu(recentMenu, MF_STRING, 200 + i, label.c_str());
+            }
+            if (recent.empty()) {
+                AppendMenu(recentMenu, MF_STRING | MF_GRAYED, 0, "(none yet)");
+            }
+            AppendMenu(recentMenu, MF_SEPARATOR, 0, NULL);
+            AppendMenu(recentMenu, MF_STRING | (recent.empty() ? MF_GRAYED : 0), 6, "Clear History");
+            AppendMenu(hMenu, MF_POPUP, (UINT_PTR)recentMenu, "Recent Folders");
+
+            const KeyStroke& palette = config->GetSettings().paletteHotkey;
+            std::string paletteLabel = "Quick Launch...";
+            if (palette.vkCode != 0) {
+                paletteLabel += "\t" + FormatHotkey(palette.modifiers, palette.vkCode) +
+                    (g_paletteHotkeyFailed ? " (in use)" : "");
+            }
+            AppendMenu(hMenu, MF_STRING, 5, paletteLabel.c_str());
             AppendMenu(hMenu, MF_STRING, 1, "Open Config Editor");
             AppendMenu(hMenu, MF_STRING, 2, "Open Config File");
             AppendMenu(hMenu, MF_STRING, 3, "Reload Config");
+            AppendMenu(hMenu, MF_STRING, 4, "Export Launch Stats");
             AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
             AppendMenu(hMenu, MF_STRING, 99, "Exit");
 
@@ -624,80 +928,47 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 ShellExecute(NULL, "open", g_configPath.c_str(), NULL, NULL, SW_SHOW);
             }
             else if (cmd == 3) {
-                // Reload config
-                UnregisterHotkeys();
-                g_appConfigs.clear();
-                if (LoadConfig(g_configPath)) {
-                    if (RegisterHotkeys()) {
-                        MessageBox(NULL, "Configuration reloaded successfully!", "Success", MB_OK | MB_ICONINFORMATION);
-                    }
-                    else {
-                        MessageBox(NULL, "Failed to register hotkeys after reload.", "Error", MB_OK | MB_ICONERROR);
-                    }
+                ReloadConfig(true);
+            }
+            else if (cmd == 4) {
+                if (DumpLatencyStats()) {
+                    ShellExecute(NULL, "open", GetStatsPath().c_str(), NULL, NULL, SW_SHOW);
                 }
                 else {
-                    MessageBox(NULL, "Failed to reload configuration file.", "Error", MB_OK | MB_ICONERROR);
+                    MessageBox(NULL, "Failed to write launch-stats.txt.", "Error", MB_OK | MB_ICONERROR);
                 }
             }
-            else if (cmd >= 100 && cmd < 100 + (int)g_appConfigs.size()) {
+            else if (cmd == 5) {
+                OpenPalette();
+            }
+            else if (cmd == 6) {
+                if (!g_history.Clear()) {
+                    ShowTrayBalloon("History not cleared", "history.journal could not be rewritten.", NIIF_WARNING);
+                }
+            }
+            else if (cmd >= 200 && cmd < 200 + (int)recent.size()) {
+                LaunchRecent(recent[cmd - 200]);
+            }
+            else if (cmd >= 100 && cmd < 100 + (int)apps.size()) {
                 // Toggle app enabled state
                 int index = cmd - 100;
-                auto it = g_appConfigs.begin();
-                std::advance(it, index);
-
-                // Toggle the enabled state
-                it->second.enabled = !it->second.enabled;
-
-                // Update the config file
-                std::ofstream file(g_configPath);
-                if (file.is_open()) {
-                    file << "; Launcher Configuration File\n\n";
-
-                    // Write Settings section
-                    file << "[Settings]\n";
-                    file << "; Enable/disable detection methods\n";
-                    file << "checkMouseHover=" << (g_settings.checkMouseHover ? "true" : "false") << "\n";
-                    file << "checkFocusedWindow=" << (g_settings.checkFocusedWindow ? "true" : "false") << "\n";
-                    file << "\n";
-                    file << "; Priority when both are available (hover or focus)\n";
-                    file << "; hover = Mouse position takes precedence\n";
-                    file << "; focus = Focused window takes precedence\n";
-                    file << "priorityWhenBothAvailable=" << g_settings.priorityWhenBothAvailable << "\n";
-                    file << "\n";
-
-                    // Write Apps section
-                    file << "[Apps]\n";
-                    file << "; Format: name=executable|runAsAdmin|args|hotkey|enabled\n";
-                    file << "; runAsAdmin: true or false\n";
-                    file << "; args: additional command line arguments (use empty string if none)\n";
-                    file << "; hotkey: e.g., Ctrl+Alt+P, Ctrl+Shift+C, etc.\n";
-                    file << "; enabled: true or false (allows disabling apps without deleting them)\n";
-                    file << "\n";
-
-                    for (const auto& pair : g_appConfigs) {
-                        file << pair.first << "="
-                            << pair.second.executable << "|"
-                            << (pair.second.runAsAdmin ? "true" : "false") << "|"
-                            << pair.second.args << "|";
-
-                        // FIXED: Reconstruct hotkey string using proper helper function
-                        std::string hotkey;
-                        if (pair.second.modifiers & MOD_CONTROL) hotkey += "Ctrl+";
-                        if (pair.second.modifiers & MOD_ALT) hotkey += "Alt+";
-                        if (pair.second.modifiers & MOD_SHIFT) hotkey += "Shift+";
-                        if (pair.second.modifiers & MOD_WIN) hotkey += "Win+";
-                        hotkey += VirtualKeyToString(pair.second.vkCode);
-
-                        file << hotkey << "|"
-                            << (pair.second.enabled ? "true" : "false") << "\n";
-                    }
-
-                    file.close();
-
-                    // Reload hotkeys
-                    UnregisterHotkeys();
-                    RegisterHotkeys();
+                const AppConfig& app = apps[index];
+                bool enabled = !app.enabled;
+
+                // Only the toggled app's hotkey changes
+                bool paletteFailed = false;
+                std::vector<const AppConfig*> failed = ApplyConfig(config->WithAppEnabled(index, enabled), false, paletteFailed);
+                if (!failed.empty()) {
+                    ShowTrayBalloon("Hotkey not registered", DescribeHotkeyFailures(failed, false, kBalloonHotkeyFailures),
+                        NIIF_WARNING);
                 }
+
+                // Patch just this entry's enabled field in the file, off
+                // the UI thread; the watcher's reload of it is then a no-op
+                std::string name = app.name;
+                g_configPersister.Enqueue([name, enabled](IniDocument& document) {
+                    SetAppEnabled(document, name, enabled);
+                });
             }
             else if (cmd == 99) {
                 // Exit
@@ -738,7 +1009,9 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     return DefWindowProc(hwnd, uMsg, wParam, lParam);
 }
 
-// Function to create hidden window for message processing
+// Function to create hidden window for message processing. It is a hidden
+// top-level window rather than a message-only one so that ConfigEditor.exe
+// can find it with FindWindow.
 bool CreateMessageWindow() {
     const char CLASS_NAME[] = "LauncherWindowClass";
 
@@ -750,33 +1023,76 @@ bool CreateMessageWindow() {
     RegisterClass(&wc);
 
     g_hwnd = CreateWindowEx(
-        0, CLASS_NAME, "Launcher", 0,
+        WS_EX_TOOLWINDOW, CLASS_NAME, "Launcher", WS_POPUP,
         0, 0, 0, 0,
-        HWND_MESSAGE, NULL, GetModuleHandle(NULL), NULL
+        NULL, NULL, GetModuleHandle(NULL), NULL
     );
 
     return g_hwnd != NULL;
 }
 
-// Function to register all hotkeys
-bool RegisterHotkeys() {
-    for (const auto& pair : g_appConfigs) {
-        const AppConfig& config = pair.second;
-        // Only register hotkey if the app is enabled
-        if (config.enabled) {
-            if (!RegisterHotKey(g_hwnd, config.hotkeyId, config.modifiers, config.vkCode)) {
-                return false;
-            }
+// RegisterHotKey on the launcher window
+class WindowHotkeyRegistrar : public IHotkeyRegistrar {
+public:
+    bool Register(int hotkeyId, unsigned int modifiers, unsigned int vkCode) override {
+        // MOD_NOREPEAT: a held hotkey should not fire WM_HOTKEY repeatedly
+        return RegisterHotKey(g_hwnd, hotkeyId, modifiers | MOD_NOREPEAT, vkCode) != FALSE;
+    }
+
+    void Unregister(int hotkeyId) override {
+        UnregisterHotKey(g_hwnd, hotkeyId);
+    }
+};
+
+WindowHotkeyRegistrar g_hotkeyRegistrar;
+
+// Matches the hotkeys RegisterHotKey cannot express ("Ctrl+Alt+L, P")
+SequenceKeyboardHook g_sequenceHook;
+
+// Function to publish a new config, re-registering only the hotkeys that
+// changed against the live one. With retryFailed, hotkeys refused earlier
+// are tried again too. Returns the apps whose hotkey was refused, and sets
+// paletteFailed if paletteHotkey was; the rest stay registered.
+std::vector<const AppConfig*> ApplyConfig(const std::shared_ptr<const ConfigSnapshot>& next, bool retryFailed,
+    bool& paletteFailed) {
+    std::shared_ptr<const ConfigSnapshot> current = g_config.Current();
+    ConfigDiff diff = DiffConfig(current.get(), next);
+    if (retryFailed) {
+        g_hotkeyStatus.AddRetries(*diff.config, diff.hotkeys);
+    }
+    g_config.Publish(diff.config);
+    g_standbyPool.Configure(CollectStandbySpecs(*diff.config));
+    g_sequenceHook.SetTrie(BuildSequenceTrie(*diff.config));
+    std::vector<const AppConfig*> failed = ApplyHotkeyPlan(diff.hotkeys, g_hotkeyRegistrar);
+    g_hotkeyStatus.Record(diff.hotkeys, failed);
+
+    // After the apps' unregistrations, so a binding can move to the palette
+    paletteFailed = false;
+    KeyStroke before = current ? current->GetSettings().paletteHotkey : KeyStroke();
+    const KeyStroke& after = diff.config->GetSettings().paletteHotkey;
+    if (!(before == after) || (retryFailed && g_paletteHotkeyFailed)) {
+        if (before.vkCode != 0) {
+            g_hotkeyRegistrar.Unregister(kPaletteHotkeyId);
         }
+        paletteFailed = after.vkCode != 0 && !g_hotkeyRegistrar.Register(kPaletteHotkeyId, after.modifiers, after.vkCode);
+        g_paletteHotkeyFailed = paletteFailed;
     }
-    return true;
+    return failed;
+}
+
+// Function to list refused hotkeys for a message box or balloon
+std::string DescribeHotkeyFailures(const std::vector<const AppConfig*>& failed, bool paletteFailed, size_t maxShown) {
+    const KeyStroke& palette = g_config.Current()->GetSettings().paletteHotkey;
+    return FormatHotkeyFailures(failed, paletteFailed ? &palette : nullptr, maxShown) +
+        "They may already be in use by another application.";
 }
 
 // Function to unregister all hotkeys
-void UnregisterHotkeys() {
-    for (const auto& pair : g_appConfigs) {
-        UnregisterHotKey(g_hwnd, pair.second.hotkeyId);
+void UnregisterHotkeys(const ConfigSnapshot& config) {
+    for (const AppConfig& app : config.Apps()) {
+        g_hotkeyRegistrar.Unregister(app.hotkeyId);
     }
+    g_hotkeyRegistrar.Unregister(kPaletteHotkeyId);
 }
 
 // Function to show tray icon
@@ -787,7 +1103,7 @@ void CreateTrayIcon() {
     g_nid.hWnd = g_hwnd;
     g_nid.uID = 1;
     g_nid.uFlags = NIF_ICON | NIF_MESSAGE | NIF_TIP;
-    g_nid.uCallbackMessage = WM_USER + 1;
+    g_nid.uCallbackMessage = WM_TRAY_ICON;
     g_nid.hIcon = LoadIcon(NULL, IDI_APPLICATION);
     strcpy_s(g_nid.szTip, "Context Launcher");
 
@@ -798,18 +1114,82 @@ void RemoveTrayIcon() {
     Shell_NotifyIcon(NIM_DELETE, &g_nid);
 }
 
+// Non-modal notice for things the user did not ask for, like a watched reload
+void ShowTrayBalloon(const std::string& title, const std::string& text, DWORD iconFlags) {
+    NOTIFYICONDATA nid = g_nid;
+    nid.uFlags = NIF_INFO;
+    nid.dwInfoFlags = iconFlags;
+    strncpy_s(nid.szInfoTitle, title.c_str(), _TRUNCATE);
+    strncpy_s(nid.szInfo, text.c_str(), _TRUNCATE);
+    Shell_NotifyIcon(NIM_MODIFY, &nid);
+}
+
 // Main entry point
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
-    InitializeCOM();
-
-    // Determine config file path in AppData
-    g_configPath = GetConfigDirectory() + "\\launcher.ini";
+    g_startupPhases = PhaseTimer(PhaseTimer::Clock::now());
+    g_startupPhases.AddLeadIn("process start", GetTimeSinceProcessCreation());
+    RegisterLazyComponents();
 
     // Check command line arguments
     bool oneShot = (lpCmdLine != NULL && strstr(lpCmdLine, "--oneshot") != NULL);
+    bool launchByName = (lpCmdLine != NULL && strstr(lpCmdLine, "--launch") != NULL);
+    bool printContext = (lpCmdLine != NULL && strstr(lpCmdLine, "--print-context") != NULL);
     bool createConfig = (lpCmdLine != NULL && strstr(lpCmdLine, "--create-config") != NULL);
     bool skipConfigEditor = (lpCmdLine != NULL && strstr(lpCmdLine, "--skip-config") != NULL);
     bool forceSetup = (lpCmdLine != NULL && strstr(lpCmdLine, "--setup") != NULL);
+    bool dumpStats = (lpCmdLine != NULL && strstr(lpCmdLine, "--stats") != NULL);
+    bool showHistory = (lpCmdLine != NULL && strstr(lpCmdLine, "--history") != NULL);
+    bool startupProfile = (lpCmdLine != NULL && strstr(lpCmdLine, "--startup-profile") != NULL);
+    bool oneOffCommand = oneShot || launchByName || printContext || showHistory;
+
+    IpcRequest command(IpcCommand::LaunchDefault, "");
+    if (printContext) {
+        command = IpcRequest(IpcCommand::PrintContext, "");
+    }
+    else if (launchByName) {
+        command = IpcRequest(IpcCommand::Launch, GetArgumentValue("--launch"));
+    }
+    else if (showHistory) {
+        command = IpcRequest(IpcCommand::History, GetArgumentValue("--history"));
+    }
+
+    // One-off commands go to the running instance first: no COM setup or
+    // config load, and its directory cache is already warm. With the shell
+    // libraries delay-loaded, this path never maps them. Only when no
+    // instance took the request is it served cold; one that got it but did
+    // not answer may already have launched the app.
+    if (oneOffCommand) {
+        IpcResponse response;
+        switch (CallRunningInstance(command, response, kInstanceCallTimeoutMs, kInstanceReplyTimeoutMs)) {
+        case InstanceCallResult::Answered:
+            return ReportCommandResponse(response);
+        case InstanceCallResult::NoReply:
+            return ReportCommandResponse(IpcResponse(false, "the running launcher did not answer"));
+        case InstanceCallResult::NotRunning:
+            break;
+        }
+    }
+
+    RegisterContextProviders();
+
+    // Determine config file path in AppData
+    g_configPath = GetConfigDirectory() + "\\launcher.ini";
+    g_startupPhases.Mark("config path");
+
+    // Stats mode: ask the running instance for its latency report
+    if (dumpStats) {
+        HWND running = FindWindow("LauncherWindowClass", "Launcher");
+        DWORD_PTR written = 0;
+        if (running != NULL && SendMessageTimeout(running, WM_DUMP_STATS, 0, 0, SMTO_ABORTIFHUNG, 5000, &written) && written) {
+            EnsureCOM();
+            ShellExecute(NULL, "open", GetStatsPath().c_str(), NULL, NULL, SW_SHOW);
+        }
+        else {
+            MessageBox(NULL, "The launcher is not running, or could not write its launch statistics.", "Launch Stats", MB_OK | MB_ICONWARNING);
+        }
+        g_components.Shutdown();
+        return 0;
+    }
 
     // Check if this is first run (config doesn't exist)
     bool isFirstRun = !PathFileExists(g_configPath.c_str());
@@ -819,7 +1199,6 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         CreateDefaultConfig(g_configPath);
         if (createConfig) {
             MessageBox(NULL, "Default configuration file created.", "Success", MB_OK | MB_ICONINFORMATION);
-            UninitializeCOM();
             return 0;
         }
     }
@@ -828,77 +1207,157 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     if ((isFirstRun || forceSetup) && !skipConfigEditor) {
         std::string configEditorPath = GetExeDirectory() + "\\ConfigEditor.exe";
         if (PathFileExists(configEditorPath.c_str())) {
+            EnsureCOM();
             ShellExecute(NULL, "open", configEditorPath.c_str(), NULL, NULL, SW_SHOW);
             if (isFirstRun) {
                 MessageBox(NULL, "Welcome to Context Launcher!\n\nThe configuration editor has been opened. Please configure your applications and hotkeys, then restart the launcher.", "First Run", MB_OK | MB_ICONINFORMATION);
             }
-            UninitializeCOM();
+            g_components.Shutdown();
             return 0;
         }
     }
 
-    // Load configuration
-    if (!LoadConfig(g_configPath)) {
-        MessageBox(NULL, "Failed to load configuration file.", "Error", MB_OK | MB_ICONERROR);
-        UninitializeCOM();
-        return 1;
+    // A second listener would only fail to register every hotkey
+    HANDLE instanceMutex = NULL;
+    if (!oneOffCommand) {
+        instanceMutex = CreateMutex(NULL, FALSE, "Local\\ContextLauncher.Instance");
+        if (instanceMutex != NULL && GetLastError() == ERROR_ALREADY_EXISTS) {
+            // A profile has to measure a real start, with every hotkey free
+            if (startupProfile) {
+                WriteStandardHandle(STD_ERROR_HANDLE, "launcher: exit the running launcher before --startup-profile\n");
+                CloseHandle(instanceMutex);
+                return 1;
+            }
+            MessageBox(NULL, "Context Launcher is already running.\n\nUse the tray icon to reload or edit the configuration.",
+                "Context Launcher", MB_OK | MB_ICONINFORMATION);
+            CloseHandle(instanceMutex);
+            return 0;
+        }
     }
+    g_startupPhases.Mark("first run and instance checks");
 
-    // One-shot mode: launch default app (first in config) and exit
-    if (oneShot) {
-        if (!g_appConfigs.empty()) {
-            LaunchApplication(g_appConfigs.begin()->second);
+    // Load configuration
+    std::vector<ConfigDiagnostic> diagnostics;
+    std::shared_ptr<const ConfigSnapshot> config = LoadConfig(g_configPath, diagnostics);
+    if (!config) {
+        std::string errorMsg = "Failed to load configuration file.";
+        if (!diagnostics.empty()) {
+            errorMsg += "\n\nProblems in launcher.ini:\n" + FormatDiagnostics(diagnostics, 10);
         }
-        UninitializeCOM();
-        return 0;
+        MessageBox(NULL, errorMsg.c_str(), "Error", MB_OK | MB_ICONERROR);
+        return 1;
+    }
+    g_startupPhases.Mark("config load");
+
+    // No instance running: serve the one-off command from this cold start.
+    // Explorer and share checks go through the same helper threads as a
+    // hotkey press, so they give up at resolveTimeoutMs here too. Stopping
+    // the queue waits for the launch to finish.
+    if (oneOffCommand) {
+        g_config.Publish(config);
+        g_history.Load(GetHistoryPath());
+        g_directoryResolver.Start();
+        g_reachability.Start();
+        g_launchQueue.Start();
+        IpcResponse response = IpcDispatcher(g_instanceCommands).Dispatch(command);
+        g_launchQueue.Stop();
+        g_reachability.Stop();
+        g_directoryResolver.Stop();
+        g_components.Shutdown();
+        return ReportCommandResponse(response);
     }
 
     // Listener mode: create window and register hotkeys
     if (!CreateMessageWindow()) {
         MessageBox(NULL, "Failed to create message window.", "Error", MB_OK | MB_ICONERROR);
-        UninitializeCOM();
         return 1;
     }
 
-    if (!RegisterHotkeys()) {
-        // Build error message with list of failed hotkeys
-        std::string errorMsg = "Failed to register one or more hotkeys. They may already be in use by another application.\n\nFailed hotkeys:\n";
+    g_palette.Create(OnPaletteChoose);
+    g_startupPhases.Mark("windows");
 
-        // Try to identify which hotkeys failed
-        for (const auto& pair : g_appConfigs) {
-            const AppConfig& config = pair.second;
-            if (config.enabled) {
-                // Test each hotkey individually
-                int testId = 9999;
-                if (!RegisterHotKey(g_hwnd, testId, config.modifiers, config.vkCode)) {
-                    errorMsg += "- " + pair.first + "\n";
-                }
-                UnregisterHotKey(g_hwnd, testId);
-            }
-        }
+    // Everything that can be registered is; a taken hotkey no longer stops
+    // the others from working
+    bool paletteFailed = false;
+    std::vector<const AppConfig*> failed = ApplyConfig(config, false, paletteFailed);
+    g_startupPhases.Mark("hotkeys");
 
-        errorMsg += "\nPlease:\n1. Close other applications that might be using these hotkeys\n2. Open the Configuration Editor to change the hotkeys\n3. Try again";
+    CreateTrayIcon();
 
-        MessageBox(NULL, errorMsg.c_str(), "Hotkey Registration Failed", MB_OK | MB_ICONERROR);
-        DestroyWindow(g_hwnd);
-        UninitializeCOM();
-        return 1;
+    // One balloon for whatever went wrong, rather than message boxes that
+    // hold up startup. The tray menu marks each refused hotkey, and
+    // "Reload Config" lists the problems in launcher.ini and retries.
+    if (!failed.empty() || paletteFailed) {
+        std::string message = DescribeHotkeyFailures(failed, paletteFailed, kBalloonHotkeyFailures);
+        if (!diagnostics.empty()) {
+            message += "\nlauncher.ini also has " + std::to_string(diagnostics.size()) + " problem(s).";
+        }
+        ShowTrayBalloon("Hotkeys not registered", message, NIIF_WARNING);
+    }
+    else if (!diagnostics.empty()) {
+        ShowTrayBalloon("Configuration loaded with problems", FormatDiagnostics(diagnostics, 3), NIIF_WARNING);
     }
 
-    CreateTrayIcon();
-
-    // Message loop
-    MSG msg;
-    while (GetMessage(&msg, NULL, 0, 0)) {
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
+    g_startupPhases.Mark("tray icon");
+
+    // Recent folders from earlier runs; a torn last record is cut off
+    g_history.Open(GetHistoryPath());
+    g_startupPhases.Mark("history");
+
+    // Subscribe to shell window events so hotkey presses hit the directory
+    // cache. The subscription is made on the event thread, so Explorer
+    // cannot hold up the rest of startup.
+    g_components.Ensure(g_shellEventsComponent);
+    g_startupPhases.Mark("shell window events");
+
+    g_directoryResolver.Start();
+    g_reachability.Start();
+    g_windowDestroyHook.Start(g_processImages);
+    g_sequenceHook.Start(g_hwnd);
+    g_spawnScheduler.Start();
+    g_launchQueue.Start();
+    g_standbyPool.Start();
+    g_instanceServer.Start();
+
+    // Pick up edits to launcher.ini without a manual reload
+    g_configWatcher.Start(g_configPath, []() {
+        PostMessage(g_hwnd, WM_CONFIG_FILE_CHANGED, 0, 0);
+    });
+    g_configPersister.Start(g_configPath, []() {
+        PostMessage(g_hwnd, WM_CONFIG_SAVE_FAILED, 0, 0);
+    });
+    g_startupPhases.Mark("workers and watchers");
+
+    // A profile run reports and exits where the message loop would start
+    if (startupProfile) {
+        WriteStandardHandle(STD_OUTPUT_HANDLE, FormatStartupProfile(g_startupPhases, g_components));
+    }
+    else {
+        // Message loop
+        MSG msg;
+        while (GetMessage(&msg, NULL, 0, 0)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
     }
 
-    // Cleanup
+    // Cleanup - pending config writes are flushed before exit
+    g_instanceServer.Stop();
+    g_configPersister.Stop();
+    g_configWatcher.Stop();
+    g_launchQueue.Stop();
+    g_spawnScheduler.Stop();
+    g_standbyPool.Stop();
+    g_reachability.Stop();
+    g_directoryResolver.Stop();
+    g_windowDestroyHook.Stop();
+    g_sequenceHook.Stop();
     RemoveTrayIcon();
-    UnregisterHotkeys();
+    UnregisterHotkeys(*g_config.Current());
+    g_palette.Destroy();
     DestroyWindow(g_hwnd);
-    UninitializeCOM();
+    g_components.Shutdown();  // Shell window events, then COM
+    CloseHandle(instanceMutex);
 
     return 0;
 }
\ No newline at end of file
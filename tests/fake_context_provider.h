@@ -0,0 +1,86 @@
+#pragma once
+#include "context_provider.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// In-memory provider: top-level windows it answers for with their folders,
+// plus child windows that belong to them. Each directory query charges a
+// simulated cost, like a DirectoryCache lookup or a cross-process read, and
+// is counted. A window can be made slow, like a hung Explorer; its query
+// gives up empty at the deadline like the real providers.
+class FakeContextProvider : public IContextProvider {
+public:
+    explicit FakeContextProvider(unsigned spinPerQuery = 0)
+        : m_spinPerQuery(spinPerQuery), m_directoryQueries(0), m_recording(false) {}
+
+    void AddWindow(WindowHandle window, const std::string& directory) {
+        m_directories[window] = directory;
+        m_owners[window] = window;
+    }
+
+    void AddChild(WindowHandle child, WindowHandle owner) {
+        m_owners[child] = owner;
+    }
+
+    void SetDirectory(WindowHandle window, const std::string& directory) {
+        m_directories[window] = directory;
+    }
+
+    void SetDelay(WindowHandle window, std::chrono::milliseconds delay) {
+        m_delays[window] = delay;
+    }
+
+    WindowHandle Claim(WindowHandle window) override {
+        auto it = m_owners.find(window);
+        return it == m_owners.end() ? kNoWindow : it->second;
+    }
+
+    std::string GetDirectory(WindowHandle window, uint32_t, std::chrono::steady_clock::time_point deadline) override {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerQuery; i++) {
+            counter = counter + 1;
+        }
+        m_directoryQueries++;
+        if (m_recording) {
+            m_queried.push_back(window);
+        }
+
+        auto delay = m_delays.find(window);
+        if (delay != m_delays.end()) {
+            std::chrono::steady_clock::time_point ready = std::chrono::steady_clock::now() + delay->second;
+            std::this_thread::sleep_until(std::min(ready, deadline));
+            if (ready > deadline) {
+                return "";
+            }
+        }
+        auto it = m_directories.find(window);
+        return it == m_directories.end() ? std::string() : it->second;
+    }
+
+    size_t DirectoryQueries() const {
+        return m_directoryQueries;
+    }
+
+    // Starts keeping the windows GetDirectory is asked about, in order, for
+    // Queried. Off by default so benches can make millions of queries.
+    void RecordQueries() {
+        m_recording = true;
+        m_queried.clear();
+    }
+
+    const std::vector<WindowHandle>& Queried() const {
+        return m_queried;
+    }
+
+private:
+    std::map<WindowHandle, std::string> m_directories;
+    std::map<WindowHandle, std::chrono::milliseconds> m_delays;
+    std::vector<WindowHandle> m_queried;
+    std::map<WindowHandle, WindowHandle> m_owners;
+    unsigned m_spinPerQuery;
+    size_t m_directoryQueries;
+    bool m_recording;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "directory_reachability.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+// In-memory file system with network shares. A check on an offline share
+// blocks for the configured time, like a Windows SMB timeout, and fails.
+// Paths are compared case-insensitively; anything not added is missing.
+class FakeDirectoryProbe : public IDirectoryProbe {
+public:
+    explicit FakeDirectoryProbe(std::chrono::milliseconds offlineDelay = std::chrono::milliseconds(0))
+        : m_offlineDelay(offlineDelay), m_checks(0) {}
+
+    void AddDirectory(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_directories.insert(Lower(path));
+    }
+
+    void SetOffline(const std::string& shareRoot, bool offline) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (offline) {
+            m_offline.insert(Lower(shareRoot));
+        }
+        else {
+            m_offline.erase(Lower(shareRoot));
+        }
+    }
+
+    bool IsNetworkPath(const std::string& path) override {
+        return path.size() >= 2 && path[0] == '\\' && path[1] == '\\';
+    }
+
+    bool DirectoryExists(const std::string& path) override {
+        m_checks++;
+        std::string key = Lower(path);
+        bool offline = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            offline = IsNetworkPath(key) && m_offline.count(GetShareRoot(key)) != 0;
+        }
+        if (offline) {
+            std::this_thread::sleep_for(m_offlineDelay);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Share roots exist while online
+        return m_directories.count(key) != 0 || (IsNetworkPath(key) && key == GetShareRoot(key));
+    }
+
+    size_t Checks() const {
+        return m_checks;
+    }
+
+private:
+    static std::string Lower(std::string text) {
+        for (char& c : text) {
+            c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+        }
+        return text;
+    }
+
+    std::chrono::milliseconds m_offlineDelay;
+    std::mutex m_mutex;
+    std::set<std::string> m_directories;
+    std::set<std::string> m_offline;
+    std::atomic<size_t> m_checks;
+};
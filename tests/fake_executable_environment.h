@@ -0,0 +1,71 @@
+#pragma once
+#include "executable_environment.h"
+#include <map>
+#include <set>
+#include <string>
+
+// In-memory environment, file system and App Paths. Paths compare without
+// case, as on NTFS. FileExists charges a simulated per-probe cost, like a
+// GetFileAttributes round trip.
+class FakeExecutableEnvironment : public IExecutableEnvironment {
+public:
+    explicit FakeExecutableEnvironment(unsigned spinPerProbe = 0)
+        : m_spinPerProbe(spinPerProbe), m_probes(0) {}
+
+    void SetVariable(const std::string& name, const std::string& value) {
+        m_variables[name] = value;
+    }
+
+    void AddFile(const std::string& path) {
+        m_files.insert(Lower(path));
+    }
+
+    void SetAppPath(const std::string& fileName, const std::string& path) {
+        m_appPaths[fileName] = path;
+    }
+
+    std::string GetVariable(const std::string& name) override {
+        auto it = m_variables.find(name);
+        return it == m_variables.end() ? std::string() : it->second;
+    }
+
+    bool FileExists(const std::string& path) override {
+        Spin();
+        m_probes++;
+        return m_files.count(Lower(path)) != 0;
+    }
+
+    bool QueryAppPath(const std::string& fileName, std::string& path) override {
+        auto it = m_appPaths.find(fileName);
+        if (it == m_appPaths.end()) {
+            return false;
+        }
+        path = it->second;
+        return true;
+    }
+
+    size_t Probes() const {
+        return m_probes;
+    }
+
+private:
+    static std::string Lower(std::string text) {
+        for (char& c : text) {
+            c = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+        }
+        return text;
+    }
+
+    void Spin() const {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerProbe; i++) {
+            counter = counter + 1;
+        }
+    }
+
+    std::map<std::string, std::string> m_variables;
+    std::set<std::string> m_files;
+    std::map<std::string, std::string> m_appPaths;
+    unsigned m_spinPerProbe;
+    size_t m_probes;
+};
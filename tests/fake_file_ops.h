@@ -0,0 +1,123 @@
+#pragma once
+#include "file_ops.h"
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+// In-memory file system. Writes charge a simulated per-write cost, and a
+// write or flush can be made to fail to check that the atomic
+// temp-and-rename path never leaves a truncated config behind. Renames of
+// data that was never flushed are counted.
+class FakeFileOps : public IFileOps {
+public:
+    explicit FakeFileOps(unsigned spinPerWrite = 0)
+        : m_spinPerWrite(spinPerWrite), m_failAfterBytes(std::string::npos), m_failFlushes(false), m_writes(0),
+          m_unflushedReplaces(0) {}
+
+    void SetFile(const std::string& path, const std::string& contents) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_files[path] = contents;
+    }
+
+    std::string GetFile(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_files.find(path);
+        return it == m_files.end() ? std::string() : it->second;
+    }
+
+    // The next writes stop after this many bytes and report failure
+    void FailWritesAfter(size_t bytes) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failAfterBytes = bytes;
+    }
+
+    void FailFlushes(bool fail) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failFlushes = fail;
+    }
+
+    bool HasFile(const std::string& path) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_files.count(path) != 0;
+    }
+
+    size_t Writes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_writes;
+    }
+
+    // ReplaceFile calls whose source was written but not flushed since
+    size_t UnflushedReplaces() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_unflushedReplaces;
+    }
+
+    bool ReadFile(const std::string& path, std::string& contents) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_files.find(path);
+        if (it == m_files.end()) {
+            return false;
+        }
+        contents = it->second;
+        return true;
+    }
+
+    bool WriteFile(const std::string& path, const std::string& contents) override {
+        Spin();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_writes++;
+        m_flushed.erase(path);
+        if (contents.size() > m_failAfterBytes) {
+            m_files[path] = contents.substr(0, m_failAfterBytes);
+            return false;
+        }
+        m_files[path] = contents;
+        return true;
+    }
+
+    bool FlushFile(const std::string& path) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failFlushes || m_files.count(path) == 0) {
+            return false;
+        }
+        m_flushed.insert(path);
+        return true;
+    }
+
+    bool ReplaceFile(const std::string& from, const std::string& to) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_files.find(from);
+        if (it == m_files.end()) {
+            return false;
+        }
+        if (m_flushed.erase(from) == 0) {
+            m_unflushedReplaces++;
+        }
+        m_files[to] = it->second;
+        m_files.erase(from);
+        return true;
+    }
+
+    void RemoveFile(const std::string& path) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_files.erase(path);
+    }
+
+private:
+    void Spin() const {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerWrite; i++) {
+            counter = counter + 1;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::string> m_files;
+    unsigned m_spinPerWrite;
+    size_t m_failAfterBytes;
+    bool m_failFlushes;
+    size_t m_writes;
+    std::set<std::string> m_flushed;  // Written and flushed, not written since
+    size_t m_unflushedReplaces;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "hotkey_registrar.h"
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+// One call a FakeHotkeyRegistrar received
+struct HotkeyCall {
+    bool registers;  // Register, otherwise Unregister
+    int hotkeyId;
+
+    bool operator==(const HotkeyCall& other) const {
+        return registers == other.registers && hotkeyId == other.hotkeyId;
+    }
+};
+
+// In-memory stand-in for RegisterHotKey. Like the OS it refuses a binding
+// that is already taken, and it charges a simulated per-call cost.
+class FakeHotkeyRegistrar : public IHotkeyRegistrar {
+public:
+    explicit FakeHotkeyRegistrar(unsigned spinPerCall = 0)
+        : m_spinPerCall(spinPerCall), m_registerCalls(0), m_unregisterCalls(0), m_recording(false) {}
+
+    // Starts (or restarts) keeping every call in order for Calls. Off by
+    // default so benches can make millions of calls.
+    void RecordCalls() {
+        m_recording = true;
+        m_calls.clear();
+    }
+
+    const std::vector<HotkeyCall>& Calls() const {
+        return m_calls;
+    }
+
+    // Whether hotkeyId is registered, and if so with which binding
+    bool IsRegistered(int hotkeyId, unsigned int modifiers, unsigned int vkCode) const {
+        auto it = m_registered.find(hotkeyId);
+        return it != m_registered.end() && it->second == std::make_pair(modifiers, vkCode);
+    }
+
+    // Another program holding a binding; Register refuses it until Release
+    void Hold(unsigned int modifiers, unsigned int vkCode) {
+        m_held.insert(std::make_pair(modifiers, vkCode));
+    }
+
+    void Release(unsigned int modifiers, unsigned int vkCode) {
+        m_held.erase(std::make_pair(modifiers, vkCode));
+    }
+
+    bool Register(int hotkeyId, unsigned int modifiers, unsigned int vkCode) override {
+        Spin();
+        m_registerCalls++;
+        if (m_recording) {
+            m_calls.push_back(HotkeyCall { true, hotkeyId });
+        }
+        std::pair<unsigned int, unsigned int> binding(modifiers, vkCode);
+        if (m_held.count(binding) != 0) {
+            return false;
+        }
+        for (const auto& entry : m_registered) {
+            if (entry.second == binding || entry.first == hotkeyId) {
+                return false;
+            }
+        }
+        m_registered[hotkeyId] = binding;
+        return true;
+    }
+
+    void Unregister(int hotkeyId) override {
+        Spin();
+        m_unregisterCalls++;
+        if (m_recording) {
+            m_calls.push_back(HotkeyCall { false, hotkeyId });
+        }
+        m_registered.erase(hotkeyId);
+    }
+
+    size_t RegisterCalls() const {
+        return m_registerCalls;
+    }
+
+    size_t UnregisterCalls() const {
+        return m_unregisterCalls;
+    }
+
+    size_t Registered() const {
+        return m_registered.size();
+    }
+
+private:
+    void Spin() const {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerCall; i++) {
+            counter = counter + 1;
+        }
+    }
+
+    std::map<int, std::pair<unsigned int, unsigned int>> m_registered;
+    std::set<std::pair<unsigned int, unsigned int>> m_held;
+    unsigned m_spinPerCall;
+    size_t m_registerCalls;
+    size_t m_unregisterCalls;
+    bool m_recording;
+    std::vector<HotkeyCall> m_calls;
+};
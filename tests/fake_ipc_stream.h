@@ -0,0 +1,55 @@
+#pragma once
+#include "instance_ipc.h"
+#include <algorithm>
+#include <string>
+
+// In-memory stand-in for a pipe or local socket. Each end reads what the
+// other wrote; reading an empty buffer reports end of stream, so a server
+// loop returns once it has answered everything queued. LimitReads makes
+// reads return fewer bytes than asked for, as a pipe may.
+class LoopbackIpcStream : public IIpcStream {
+public:
+    LoopbackIpcStream(std::string& incoming, std::string& outgoing)
+        : m_incoming(incoming), m_outgoing(outgoing), m_readOffset(0), m_readLimit(0) {}
+
+    // At most bytes per Read; 0 for no limit
+    void LimitReads(size_t bytes) {
+        m_readLimit = bytes;
+    }
+
+    bool Read(char* buffer, size_t size, size_t& bytesRead) override {
+        if (m_readOffset >= m_incoming.size()) {
+            m_incoming.clear();
+            m_readOffset = 0;
+            return false;
+        }
+        bytesRead = std::min(size, m_incoming.size() - m_readOffset);
+        if (m_readLimit != 0) {
+            bytesRead = std::min(bytesRead, m_readLimit);
+        }
+        std::copy(m_incoming.begin() + m_readOffset, m_incoming.begin() + m_readOffset + bytesRead, buffer);
+        m_readOffset += bytesRead;
+        return true;
+    }
+
+    bool Write(const char* data, size_t size) override {
+        m_outgoing.append(data, size);
+        return true;
+    }
+
+private:
+    std::string& m_incoming;
+    std::string& m_outgoing;
+    size_t m_readOffset;
+    size_t m_readLimit;
+};
+
+// Both ends of one connection
+struct LoopbackIpcPair {
+    std::string toServer;
+    std::string toClient;
+    LoopbackIpcStream client;
+    LoopbackIpcStream server;
+
+    LoopbackIpcPair() : client(toClient, toServer), server(toServer, toClient) {}
+};
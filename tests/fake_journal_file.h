@@ -0,0 +1,76 @@
+#pragma once
+#include "history_journal.h"
+#include <map>
+#include <string>
+
+// In-memory journal storage. An append can be made to stop part way
+// through, leaving a torn record behind as a crash mid-write would.
+class FakeJournalFile : public IJournalFile {
+public:
+    FakeJournalFile() : m_tearAfterBytes(std::string::npos), m_appends(0), m_replaces(0) {}
+
+    void SetFile(const std::string& path, const std::string& contents) {
+        m_files[path] = contents;
+    }
+
+    std::string GetFile(const std::string& path) const {
+        auto it = m_files.find(path);
+        return it == m_files.end() ? std::string() : it->second;
+    }
+
+    // The next append writes this many bytes and reports failure
+    void TearNextAppend(size_t bytes) {
+        m_tearAfterBytes = bytes;
+    }
+
+    size_t Appends() const {
+        return m_appends;
+    }
+
+    size_t Replaces() const {
+        return m_replaces;
+    }
+
+    bool Map(const std::string& path, std::string_view& contents) override {
+        auto it = m_files.find(path);
+        if (it == m_files.end()) {
+            return false;
+        }
+        contents = it->second;
+        return true;
+    }
+
+    void Unmap() override {}
+
+    bool Append(const std::string& path, std::string_view data) override {
+        m_appends++;
+        if (m_tearAfterBytes < data.size()) {
+            m_files[path].append(data.substr(0, m_tearAfterBytes));
+            m_tearAfterBytes = std::string::npos;
+            return false;
+        }
+        m_files[path].append(data);
+        return true;
+    }
+
+    bool Truncate(const std::string& path, uint64_t size) override {
+        auto it = m_files.find(path);
+        if (it == m_files.end() || size > it->second.size()) {
+            return false;
+        }
+        it->second.resize((size_t)size);
+        return true;
+    }
+
+    bool Replace(const std::string& path, const std::string& contents) override {
+        m_replaces++;
+        m_files[path] = contents;
+        return true;
+    }
+
+private:
+    std::map<std::string, std::string> m_files;
+    size_t m_tearAfterBytes;
+    size_t m_appends;
+    size_t m_replaces;
+};
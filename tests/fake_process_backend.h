@@ -0,0 +1,129 @@
+#pragma once
+#include "standby_pool.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+// In-memory process table. Starting a process sleeps for a configurable
+// time, like a shell's cold start; processes can be crashed from outside.
+// Starts can also be held until released, to line up races with the pool's
+// maintenance thread, or made to fail.
+class FakeProcessBackend : public IProcessBackend {
+public:
+    explicit FakeProcessBackend(std::chrono::microseconds startCost = std::chrono::microseconds(0))
+        : m_startCost(startCost), m_nextProcess(1), m_starts(0), m_reveals(0), m_terminates(0),
+          m_holding(false), m_held(0), m_failures(0) {}
+
+    StandbyProcess StartHidden(const StandbySpec&) override {
+        if (m_startCost.count() > 0) {
+            std::this_thread::sleep_for(m_startCost);
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_held++;
+        m_released.wait(lock, [this] { return !m_holding; });
+        m_held--;
+        if (m_failures > 0) {
+            m_failures--;
+            return 0;
+        }
+        m_starts++;
+        StandbyProcess process = m_nextProcess++;
+        m_running.insert(process);
+        return process;
+    }
+
+    bool IsRunning(StandbyProcess process) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running.count(process) != 0;
+    }
+
+    bool Reveal(StandbyProcess process, const StandbySpec& spec, const std::string& directory) override {
+        std::string command;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running.erase(process) == 0 || !FormatDirectoryHandoff(spec.executable, directory, command)) {
+            return false;
+        }
+        m_reveals++;
+        m_lastHandoff = command;
+        return true;
+    }
+
+    void Terminate(StandbyProcess process) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.erase(process);
+        m_terminates++;
+    }
+
+    void Crash(StandbyProcess process) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running.erase(process);
+    }
+
+    // Starts block until ReleaseStarts
+    void HoldStarts() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_holding = true;
+    }
+
+    void ReleaseStarts() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_holding = false;
+        }
+        m_released.notify_all();
+    }
+
+    // Starts blocked by HoldStarts
+    size_t HeldStarts() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_held;
+    }
+
+    // The next count starts return 0
+    void FailStarts(size_t count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failures = count;
+    }
+
+    size_t Reveals() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reveals;
+    }
+
+    size_t Terminates() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_terminates;
+    }
+
+    std::string LastHandoff() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lastHandoff;
+    }
+
+    size_t Starts() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_starts;
+    }
+
+    size_t Running() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running.size();
+    }
+
+private:
+    std::chrono::microseconds m_startCost;
+    mutable std::mutex m_mutex;
+    std::set<StandbyProcess> m_running;
+    StandbyProcess m_nextProcess;
+    size_t m_starts;
+    size_t m_reveals;
+    size_t m_terminates;
+    std::string m_lastHandoff;
+    std::condition_variable m_released;
+    bool m_holding;
+    size_t m_held;
+    size_t m_failures;
+};
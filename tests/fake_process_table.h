@@ -0,0 +1,50 @@
+#pragma once
+#include "process_image_cache.h"
+#include <map>
+#include <string>
+
+// In-memory window -> process -> image table. Each image query spins for a
+// configurable count, standing in for OpenProcess + QueryFullProcessImageName.
+class FakeProcessTable : public IProcessTable {
+public:
+    explicit FakeProcessTable(unsigned spinPerQuery = 0)
+        : m_spinPerQuery(spinPerQuery), m_imageQueries(0) {}
+
+    void AddWindow(WindowHandle window, uint32_t processId, const std::string& imageName) {
+        m_windows[window] = processId;
+        m_images[processId] = imageName;
+    }
+
+    void RemoveWindow(WindowHandle window) {
+        m_windows.erase(window);
+    }
+
+    uint32_t GetWindowProcessId(WindowHandle window) override {
+        auto it = m_windows.find(window);
+        return it == m_windows.end() ? 0 : it->second;
+    }
+
+    bool GetProcessImageName(uint32_t processId, std::string& imageName) override {
+        m_imageQueries++;
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerQuery; i++) {
+            counter = counter + 1;
+        }
+        auto it = m_images.find(processId);
+        if (it == m_images.end()) {
+            return false;
+        }
+        imageName = it->second;
+        return true;
+    }
+
+    size_t ImageQueries() const {
+        return m_imageQueries;
+    }
+
+private:
+    std::map<WindowHandle, uint32_t> m_windows;
+    std::map<uint32_t, std::string> m_images;
+    unsigned m_spinPerQuery;
+    size_t m_imageQueries;
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include "shell_window_provider.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// In-memory stand-in for IShellWindows. QueryDirectory walks the item list
+// like the COM provider does, charging a simulated per-item cost so the walk
+// scales with the number of open tabs. Windows may hold several tabs, each
+// its own item, as in tabbed Explorer. An optional delay stands in for an
+// Explorer that is busy with a slow network folder, and a tab can be hung
+// until released, as a window stuck in a dialog is.
+class FakeShellWindowProvider : public IShellWindowProvider {
+public:
+    explicit FakeShellWindowProvider(unsigned spinPerItem = 0)
+        : m_spinPerItem(spinPerItem), m_delay(0), m_queries(0), m_hanging(0) {}
+
+    void SetDelay(std::chrono::milliseconds delay) {
+        m_delay = delay;
+    }
+
+    // Queries for the tab block until Release
+    void Hang(WindowHandle tab) {
+        std::lock_guard<std::mutex> lock(m_hangMutex);
+        m_hung.insert(tab);
+    }
+
+    void Release() {
+        {
+            std::lock_guard<std::mutex> lock(m_hangMutex);
+            m_hung.clear();
+        }
+        m_released.notify_all();
+    }
+
+    // Queries currently blocked in a hung tab
+    size_t Hanging() {
+        std::lock_guard<std::mutex> lock(m_hangMutex);
+        return m_hanging;
+    }
+
+    // A window without tabs: its only view is the window itself
+    void AddWindow(WindowHandle window, const std::string& directory) {
+        AddTab(window, window, directory);
+    }
+
+    // A new tab becomes the active one, as in Explorer
+    void AddTab(WindowHandle window, WindowHandle tab, const std::string& directory) {
+        m_items.push_back(Item { window, tab, directory });
+        m_activeTabs[window] = tab;
+    }
+
+    void SelectTab(WindowHandle window, WindowHandle tab) {
+        m_activeTabs[window] = tab;
+    }
+
+    void Navigate(WindowHandle tab, const std::string& directory) {
+        for (Item& item : m_items) {
+            if (item.tab == tab) {
+                item.directory = directory;
+            }
+        }
+    }
+
+    void SetSelection(WindowHandle tab, const std::vector<SelectedItem>& items) {
+        m_selections[tab] = items;
+    }
+
+    WindowHandle GetActiveTab(WindowHandle window) override {
+        auto it = m_activeTabs.find(window);
+        return it == m_activeTabs.end() ? window : it->second;
+    }
+
+    bool QueryDirectory(WindowHandle tab, std::string& directory) override {
+        m_queries++;
+        WaitIfHung(tab);
+        if (m_delay.count() > 0) {
+            std::this_thread::sleep_for(m_delay);
+        }
+        for (const Item& item : m_items) {
+            Spin();
+            if (item.tab == tab) {
+                directory = item.directory;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool QuerySelection(WindowHandle tab, std::vector<SelectedItem>& items) override {
+        m_queries++;
+        WaitIfHung(tab);
+        items.clear();
+        for (const Item& item : m_items) {
+            Spin();
+            if (item.tab == tab) {
+                auto it = m_selections.find(tab);
+                if (it != m_selections.end()) {
+                    items = it->second;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The lookup before tab support: the first item whose top-level window
+    // matches, whichever tab that is
+    bool QueryFirstItemOfWindow(WindowHandle window, std::string& directory) {
+        m_queries++;
+        for (const Item& item : m_items) {
+            Spin();
+            if (item.window == window) {
+                directory = item.directory;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t Queries() const {
+        return m_queries;
+    }
+
+private:
+    struct Item {
+        WindowHandle window;
+        WindowHandle tab;
+        std::string directory;
+    };
+
+    void WaitIfHung(WindowHandle tab) {
+        std::unique_lock<std::mutex> lock(m_hangMutex);
+        m_hanging++;
+        m_released.wait(lock, [this, tab] { return m_hung.count(tab) == 0; });
+        m_hanging--;
+    }
+
+    void Spin() const {
+        volatile unsigned counter = 0;
+        for (unsigned i = 0; i < m_spinPerItem; i++) {
+            counter = counter + 1;
+        }
+    }
+
+    std::vector<Item> m_items;
+    std::map<WindowHandle, WindowHandle> m_activeTabs;
+    std::map<WindowHandle, std::vector<SelectedItem>> m_selections;
+    unsigned m_spinPerItem;
+    std::chrono::milliseconds m_delay;
+    std::atomic<size_t> m_queries;
+    std::mutex m_hangMutex;
+    std::condition_variable m_released;
+    std::set<WindowHandle> m_hung;
+    size_t m_hanging;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include "batch_launch.h"
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records spawns instead of starting processes. Each spawn sleeps for a
+// configurable time, like CreateProcess/ShellExecute for a GUI app, and
+// the most spawns seen running at once is tracked. Spawns in chosen
+// directories fail, as for a missing executable.
+class FakeSpawnBackend : public ISpawnBackend {
+public:
+    explicit FakeSpawnBackend(std::chrono::microseconds spawnCost = std::chrono::microseconds(0))
+        : m_spawnCost(spawnCost), m_running(0), m_maxRunning(0), m_recording(false) {}
+
+    void FailIn(const std::string& directory) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failing.insert(directory);
+    }
+
+    bool Spawn(const SpawnJob& job) override {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running++;
+            m_maxRunning = m_running > m_maxRunning ? m_running : m_maxRunning;
+            m_directories.push_back(job.directory);
+            if (m_recording) {
+                m_events.push_back("+" + job.app->name);
+            }
+        }
+        if (m_spawnCost.count() > 0) {
+            std::this_thread::sleep_for(m_spawnCost);
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running--;
+        if (m_recording) {
+            m_events.push_back("-" + job.app->name);
+        }
+        return m_failing.count(job.directory) == 0;
+    }
+
+    // Starts keeping "+app" when a spawn begins and "-app" when it ends,
+    // for Events. Off by default for the benches.
+    void RecordEvents() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_recording = true;
+        m_events.clear();
+    }
+
+    std::vector<std::string> Events() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_events;
+    }
+
+    size_t Spawns() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_directories.size();
+    }
+
+    size_t MaxRunning() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_maxRunning;
+    }
+
+private:
+    std::chrono::microseconds m_spawnCost;
+    mutable std::mutex m_mutex;
+    size_t m_running;
+    size_t m_maxRunning;
+    std::vector<std::string> m_directories;
+    std::set<std::string> m_failing;
+    std::vector<std::string> m_events;
+    bool m_recording;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Tiny self-registering unit test harness, the counterpart of bench.h. A
+// failed CHECK records the failure and the test goes on; a failed REQUIRE
+// also ends the test, for checks later lines depend on.
+struct TestCase {
+    const char* name;
+    void (*body)();
+};
+
+std::vector<TestCase>& TestRegistry();
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*body)());
+};
+
+#define TEST(fn) \
+    static void fn(); \
+    static TestRegistrar fn##_registrar(#fn, fn); \
+    static void fn()
+
+void ReportTestFailure(const char* file, int line, const std::string& message);
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            ReportTestFailure(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+        } \
+    } while (0)
+
+#define REQUIRE(condition) \
+    do { \
+        if (!(condition)) { \
+            ReportTestFailure(__FILE__, __LINE__, "REQUIRE(" #condition ")"); \
+            return; \
+        } \
+    } while (0)
+
+// For values that can be written to a stream; prints both sides on failure
+#define CHECK_EQ(expected, actual) \
+    do { \
+        const auto& expectedValue = (expected); \
+        const auto& actualValue = (actual); \
+        if (!(expectedValue == actualValue)) { \
+            std::ostringstream message; \
+            message << "CHECK_EQ(" #expected ", " #actual "): expected " << expectedValue << ", got " << actualValue; \
+            ReportTestFailure(__FILE__, __LINE__, message.str()); \
+        } \
+    } while (0)
+
+// For results another thread delivers: polls until condition holds, false
+// if it still does not after a second
+template <typename Condition>
+bool WaitFor(Condition condition) {
+    std::chrono::steady_clock::time_point giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= giveUp) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
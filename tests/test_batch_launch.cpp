@@ -0,0 +1,217 @@
+#include "test.h"
+#include "batch_launch.h"
+#include "fake_spawn_backend.h"
+#include <algorithm>
+
+namespace {
+
+AppConfig MakeApp(const std::string& name, SelectionMode selection, const std::string& args) {
+    AppConfig app;
+    app.name = name;
+    app.executable = name + ".exe";
+    app.selection = selection;
+    app.args = args;
+    app.argsTemplate = ArgTemplate::Compile(args);
+    return app;
+}
+
+ArgValues InFolder(const std::string& directory) {
+    ArgValues values;
+    values.dir = directory;
+    return values;
+}
+
+SelectedItem Folder(const std::string& path) {
+    return SelectedItem(path, true);
+}
+
+SelectedItem File(const std::string& path) {
+    return SelectedItem(path, false);
+}
+
+std::vector<SpawnJob> JobsIn(const AppConfig& app, const std::vector<std::string>& directories) {
+    std::vector<SpawnJob> jobs;
+    for (const std::string& directory : directories) {
+        jobs.push_back(SpawnJob(&app, directory, ""));
+    }
+    return jobs;
+}
+
+GroupMember Member(const std::string& app, int stage) {
+    GroupMember member;
+    member.app = app;
+    member.stage = stage;
+    return member;
+}
+
+// Position of event in events, or events.size()
+size_t IndexOf(const std::vector<std::string>& events, const std::string& event) {
+    return (size_t)(std::find(events.begin(), events.end(), event) - events.begin());
+}
+
+} // namespace
+
+TEST(ExpandSelectionPerFolderSkipsFilesAndDuplicates) {
+    AppConfig app = MakeApp("Terminal", SelectionMode::PerFolder, "-d {dir}");
+    std::vector<SelectedItem> selection = { Folder("C:\\src"), File("C:\\notes.txt"), Folder("C:\\My Dir"),
+        Folder("c:\\SRC") };
+
+    size_t skipped = 99;
+    std::vector<SpawnJob> jobs = ExpandSelection(app, InFolder("C:\\"), selection, 8, &skipped);
+    REQUIRE(jobs.size() == 2);
+    CHECK_EQ("C:\\src", jobs[0].directory);
+    CHECK_EQ("-d C:\\src", jobs[0].args);
+    CHECK_EQ("C:\\My Dir", jobs[1].directory);
+    CHECK_EQ("-d \"C:\\My Dir\"", jobs[1].args);
+    CHECK(jobs[1].app == &app);
+    CHECK_EQ((size_t)0, skipped);
+}
+
+TEST(ExpandSelectionPerFolderCapsFanOut) {
+    AppConfig app = MakeApp("Terminal", SelectionMode::PerFolder, "");
+    std::vector<SelectedItem> selection = { Folder("C:\\a"), Folder("C:\\b"), Folder("C:\\c"), Folder("C:\\d") };
+
+    size_t skipped = 0;
+    std::vector<SpawnJob> jobs = ExpandSelection(app, InFolder("C:\\"), selection, 2, &skipped);
+    REQUIRE(jobs.size() == 2);
+    CHECK_EQ("C:\\a", jobs[0].directory);
+    CHECK_EQ("C:\\b", jobs[1].directory);
+    CHECK_EQ((size_t)2, skipped);
+}
+
+TEST(ExpandSelectionAllItemsQuotesPathsAfterArgs) {
+    AppConfig app = MakeApp("Editor", SelectionMode::AllItems, "--reuse {item}");
+    std::vector<SelectedItem> selection = { File("C:\\src\\a.txt"), Folder("C:\\src\\my docs"), File("") };
+
+    size_t skipped = 0;
+    std::vector<SpawnJob> jobs = ExpandSelection(app, InFolder("C:\\src"), selection, 8, &skipped);
+    REQUIRE(jobs.size() == 1);
+    CHECK_EQ("C:\\src", jobs[0].directory);
+    CHECK_EQ("--reuse C:\\src\\a.txt C:\\src\\a.txt \"C:\\src\\my docs\"", jobs[0].args);
+    CHECK_EQ((size_t)1, skipped);
+}
+
+TEST(ExpandSelectionAllItemsStopsAtCommandLineLimit) {
+    AppConfig app = MakeApp("Editor", SelectionMode::AllItems, "");
+    std::vector<SelectedItem> selection = { File("C:\\a.txt"), File("C:\\" + std::string(kMaxBatchArgsLength, 'x')),
+        File("C:\\b.txt") };
+
+    size_t skipped = 0;
+    std::vector<SpawnJob> jobs = ExpandSelection(app, InFolder("C:\\"), selection, 8, &skipped);
+    REQUIRE(jobs.size() == 1);
+    CHECK_EQ("C:\\a.txt C:\\b.txt", jobs[0].args);
+    CHECK_EQ((size_t)1, skipped);
+}
+
+TEST(ExpandSelectionLaunchesOnceWhenNothingApplies) {
+    std::vector<SelectedItem> files = { File("C:\\a.txt") };
+    CHECK(ExpandSelection(MakeApp("Terminal", SelectionMode::None, ""), InFolder("C:\\"), files, 8).empty());
+    CHECK(ExpandSelection(MakeApp("Terminal", SelectionMode::PerFolder, ""), InFolder("C:\\"), files, 8).empty());
+    CHECK(ExpandSelection(MakeApp("Editor", SelectionMode::AllItems, ""), InFolder("C:\\"), {}, 8).empty());
+}
+
+TEST(SpawnSchedulerRunsBatchSideBySide) {
+    FakeSpawnBackend backend(std::chrono::milliseconds(20));
+    SpawnScheduler scheduler(backend, 3);
+    scheduler.Start();
+    AppConfig app = MakeApp("Terminal", SelectionMode::PerFolder, "");
+    std::vector<SpawnJob> jobs = JobsIn(app, { "C:\\a", "C:\\b", "C:\\c", "C:\\d", "C:\\e", "C:\\f" });
+    backend.FailIn("C:\\c");
+
+    CHECK_EQ((size_t)5, scheduler.Run(jobs));
+    CHECK_EQ((size_t)6, backend.Spawns());
+    CHECK(backend.MaxRunning() > 1);
+    CHECK(backend.MaxRunning() <= 4);
+
+    SpawnScheduler::Stats stats = scheduler.GetStats();
+    CHECK_EQ((uint64_t)1, stats.batches);
+    CHECK_EQ((uint64_t)6, stats.spawns);
+    CHECK_EQ((uint64_t)1, stats.failures);
+    scheduler.Stop();
+}
+
+TEST(SpawnSchedulerRunsOneByOneWhenStopped) {
+    FakeSpawnBackend backend(std::chrono::milliseconds(2));
+    SpawnScheduler scheduler(backend, 3);
+    AppConfig app = MakeApp("Terminal", SelectionMode::PerFolder, "");
+
+    CHECK_EQ((size_t)3, scheduler.Run(JobsIn(app, { "C:\\a", "C:\\b", "C:\\c" })));
+    CHECK_EQ((size_t)1, backend.MaxRunning());
+    CHECK_EQ((size_t)0, scheduler.Run(std::vector<SpawnJob>()));
+}
+
+TEST(PlanGroupLaunchGroupsMembersByStage) {
+    GroupMember custom = Member("Editor", 1);
+    custom.args = "--goto {dir}";
+    custom.argsTemplate = ArgTemplate::Compile(custom.args);
+    custom.hasArgs = true;
+
+    AppConfig group = MakeApp("Workspace", SelectionMode::None, "");
+    group.members = { Member("Server", 0), Member("Missing", 0), Member("Watcher", 0), custom,
+        Member("Missing", 2), Member("Browser", 3) };
+    auto config = ConfigSnapshot::Compile({ MakeApp("Browser", SelectionMode::None, "{dir}"),
+        MakeApp("Editor", SelectionMode::None, "-n"), MakeApp("Server", SelectionMode::None, ""),
+        MakeApp("Watcher", SelectionMode::None, ""), group }, Settings());
+
+    // Unknown members drop out, and so does the stage they leave empty
+    std::vector<std::vector<SpawnJob>> stages = PlanGroupLaunch(*config, *config->FindByName("Workspace"),
+        InFolder("C:\\src"));
+    REQUIRE(stages.size() == 3);
+    REQUIRE(stages[0].size() == 2);
+    CHECK_EQ("Server", stages[0][0].app->name);
+    CHECK_EQ("Watcher", stages[0][1].app->name);
+    REQUIRE(stages[1].size() == 1);
+    CHECK_EQ("--goto C:\\src", stages[1][0].args);
+    REQUIRE(stages[2].size() == 1);
+    CHECK_EQ("Browser", stages[2][0].app->name);
+    CHECK_EQ("C:\\src", stages[2][0].args);
+    CHECK_EQ("C:\\src", stages[2][0].directory);
+}
+
+TEST(SpawnSchedulerRunInOrderFinishesEachStageFirst) {
+    FakeSpawnBackend backend(std::chrono::milliseconds(10));
+    backend.RecordEvents();
+    SpawnScheduler scheduler(backend, 3);
+    scheduler.Start();
+
+    AppConfig server = MakeApp("Server", SelectionMode::None, "");
+    AppConfig watcher = MakeApp("Watcher", SelectionMode::None, "");
+    AppConfig editor = MakeApp("Editor", SelectionMode::None, "");
+    AppConfig browser = MakeApp("Browser", SelectionMode::None, "");
+    std::vector<std::vector<SpawnJob>> stages = {
+        { SpawnJob(&server, "C:\\src", ""), SpawnJob(&watcher, "C:\\src", "") },
+        { SpawnJob(&editor, "C:\\src", "") },
+        { SpawnJob(&browser, "C:\\src", "") },
+    };
+
+    CHECK_EQ((size_t)4, scheduler.RunInOrder(stages));
+    std::vector<std::string> events = backend.Events();
+    REQUIRE(events.size() == 8);
+    CHECK(IndexOf(events, "-Server") < IndexOf(events, "+Editor"));
+    CHECK(IndexOf(events, "-Watcher") < IndexOf(events, "+Editor"));
+    CHECK(IndexOf(events, "-Editor") < IndexOf(events, "+Browser"));
+
+    // Members of one stage start together
+    CHECK(IndexOf(events, "+Watcher") < IndexOf(events, "-Server"));
+    CHECK(IndexOf(events, "+Server") < IndexOf(events, "-Watcher"));
+    scheduler.Stop();
+}
+
+TEST(SpawnSchedulerRunInOrderGoesOnAfterFailedStage) {
+    FakeSpawnBackend backend;
+    backend.RecordEvents();
+    backend.FailIn("C:\\missing");
+    SpawnScheduler scheduler(backend, 2);
+    scheduler.Start();
+
+    AppConfig server = MakeApp("Server", SelectionMode::None, "");
+    AppConfig browser = MakeApp("Browser", SelectionMode::None, "");
+    std::vector<std::vector<SpawnJob>> stages = {
+        { SpawnJob(&server, "C:\\missing", "") },
+        { SpawnJob(&browser, "C:\\src", "") },
+    };
+
+    CHECK_EQ((size_t)1, scheduler.RunInOrder(stages));
+    CHECK(backend.Events() == std::vector<std::string>({ "+Server", "-Server", "+Browser", "-Browser" }));
+    scheduler.Stop();
+}
@@ -0,0 +1,119 @@
+#include "test.h"
+#include "arg_template.h"
+#include "command_line.h"
+#include <random>
+
+namespace {
+
+// Characters that matter to the quoting rules, plus plain ones
+const char kAlphabet[] = { 'a', 'Z', '.', ' ', '\t', '"', '\\', '\\', '{', '}', '\n' };
+
+std::string RandomText(std::mt19937& random, size_t maxLength) {
+    std::uniform_int_distribution<size_t> length(0, maxLength);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) - 1);
+    std::string text(length(random), ' ');
+    for (char& c : text) {
+        c = kAlphabet[pick(random)];
+    }
+    return text;
+}
+
+std::string Join(const std::vector<std::string>& argv) {
+    std::string commandLine;
+    for (const std::string& argument : argv) {
+        if (!commandLine.empty()) {
+            commandLine += ' ';
+        }
+        commandLine += QuoteArgument(argument);
+    }
+    return commandLine;
+}
+
+// Arguments between brackets, so empty ones and blanks show on failure
+std::string Describe(const std::vector<std::string>& argv) {
+    std::string text;
+    for (const std::string& argument : argv) {
+        text += "[" + argument + "]";
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(SplitCommandLineFollowsCommandLineToArgvW) {
+    CHECK(SplitCommandLine("") == std::vector<std::string>());
+    CHECK(SplitCommandLine(" \t ") == std::vector<std::string>());
+    CHECK(SplitCommandLine("a  b\tc") == std::vector<std::string>({ "a", "b", "c" }));
+    CHECK(SplitCommandLine("\"a b\" \"\"") == std::vector<std::string>({ "a b", "" }));
+    CHECK(SplitCommandLine("x\"a b\"y") == std::vector<std::string>({ "xa by" }));
+    CHECK(SplitCommandLine("a\\\\b c\\") == std::vector<std::string>({ "a\\\\b", "c\\" }));
+    CHECK(SplitCommandLine("a\\\\\"b c\"") == std::vector<std::string>({ "a\\b c" }));
+    CHECK(SplitCommandLine("a\\\\\\\"b") == std::vector<std::string>({ "a\\\"b" }));
+    CHECK(SplitCommandLine("\"a\"\"b\"") == std::vector<std::string>({ "a\"b" }));
+    CHECK(SplitCommandLine("\"unterminated arg") == std::vector<std::string>({ "unterminated arg" }));
+}
+
+TEST(QuoteArgumentKeepsTrailingBackslashes) {
+    CHECK_EQ("\"C:\\My Dir\\\\\"", QuoteArgument("C:\\My Dir\\"));
+    CHECK_EQ("C:\\src\\", QuoteArgument("C:\\src\\"));
+    CHECK_EQ("\"\"", QuoteArgument(""));
+    CHECK_EQ("\"say \\\"hi\\\"\"", QuoteArgument("say \"hi\""));
+    CHECK(SplitCommandLine(QuoteArgument("C:\\My Dir\\")) == std::vector<std::string>({ "C:\\My Dir\\" }));
+}
+
+TEST(SplitOfQuotedArgumentsRoundTrips) {
+    std::mt19937 random(20240611);
+    std::uniform_int_distribution<size_t> count(0, 5);
+    for (int round = 0; round < 20000; round++) {
+        std::vector<std::string> argv(count(random));
+        for (std::string& argument : argv) {
+            argument = RandomText(random, 10);
+        }
+
+        std::vector<std::string> split = SplitCommandLine(Join(argv));
+        if (split != argv) {
+            CHECK_EQ(Describe(argv), Describe(split));
+            return;
+        }
+    }
+}
+
+TEST(AppendQuotedContentRoundTripsInsideQuotes) {
+    std::mt19937 random(7);
+    for (int round = 0; round < 5000; round++) {
+        std::string path = RandomText(random, 10);
+
+        // --cwd="<path>", as a terminal's own quoted option
+        std::string commandLine = "--cwd=\"";
+        AppendQuotedContent(commandLine, path, true);
+        commandLine += "\" next";
+        std::vector<std::string> expected = { "--cwd=" + path, "next" };
+
+        std::vector<std::string> split = SplitCommandLine(commandLine);
+        if (split != expected) {
+            CHECK_EQ(Describe(expected), Describe(split));
+            return;
+        }
+    }
+}
+
+TEST(ArgTemplateExpansionRoundTrips) {
+    ArgTemplate compiled = ArgTemplate::Compile("--title {title} -d {dir}\\ \"{{literal}}\" --item={item}");
+    REQUIRE(compiled.HasPlaceholders());
+
+    std::mt19937 random(99);
+    for (int round = 0; round < 5000; round++) {
+        ArgValues values;
+        values.dir = RandomText(random, 10);
+        values.item = RandomText(random, 10);
+        values.title = RandomText(random, 10);
+
+        std::vector<std::string> expected = { "--title", values.title, "-d", values.dir + "\\", "{literal}",
+            "--item=" + values.item };
+        std::vector<std::string> split = SplitCommandLine(compiled.Expand(values));
+        if (split != expected) {
+            CHECK_EQ(Describe(expected), Describe(split));
+            return;
+        }
+    }
+}
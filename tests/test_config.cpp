@@ -0,0 +1,196 @@
+#include "test.h"
+#include "config.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+
+AppConfig MakeApp(const std::string& name, int hotkeyId) {
+    AppConfig app;
+    app.name = name;
+    app.executable = name + ".exe";
+    app.hotkeyId = hotkeyId;
+    app.vkCode = 'A' + (unsigned)hotkeyId;
+    return app;
+}
+
+AppConfig MakeVariant(const std::string& name, const std::string& image, const std::string& args) {
+    AppConfig app = MakeApp(name, 0);
+    app.contextImage = image;
+    app.args = args;
+    return app;
+}
+
+} // namespace
+
+TEST(ConfigSnapshotSortsAppsByName) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Terminal", 1), MakeApp("Editor", 2), MakeApp("Browser", 3) },
+        Settings());
+    REQUIRE(config->Apps().size() == 3);
+    CHECK_EQ("Browser", config->Apps()[0].name);
+    CHECK_EQ("Editor", config->Apps()[1].name);
+    CHECK_EQ("Terminal", config->Apps()[2].name);
+}
+
+TEST(ConfigSnapshotFindsAppsByHotkeyMenuIndexAndName) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Terminal", 1), MakeApp("Editor", 5) }, Settings());
+
+    const AppConfig* byHotkey = config->FindByHotkey(5);
+    REQUIRE(byHotkey != nullptr);
+    CHECK_EQ("Editor", byHotkey->name);
+    CHECK(config->FindByHotkey(2) == nullptr);
+    CHECK(config->FindByHotkey(0) == nullptr);
+    CHECK(config->FindByHotkey(-1) == nullptr);
+    CHECK(config->FindByHotkey(1000) == nullptr);
+
+    CHECK(config->FindByMenuIndex(0) == &config->Apps()[0]);
+    CHECK(config->FindByMenuIndex(2) == nullptr);
+    CHECK(config->FindByMenuIndex(-1) == nullptr);
+
+    CHECK(config->FindByName("Terminal") == &config->Apps()[1]);
+    CHECK(config->FindByName("terminal") == nullptr);
+    CHECK(config->FindByName("") == nullptr);
+}
+
+TEST(ConfigSnapshotKeepsLastDuplicate) {
+    AppConfig first = MakeApp("Terminal", 1);
+    first.executable = "cmd.exe";
+    AppConfig second = MakeApp("Terminal", 2);
+    second.executable = "wt.exe";
+    auto config = ConfigSnapshot::Compile({ first, MakeApp("Editor", 3), second }, Settings());
+
+    REQUIRE(config->Apps().size() == 2);
+    const AppConfig* app = config->FindByName("Terminal");
+    REQUIRE(app != nullptr);
+    CHECK_EQ("wt.exe", app->executable);
+    CHECK(config->FindByHotkey(2) == app);
+    CHECK(config->FindByHotkey(1) == nullptr);
+}
+
+TEST(ConfigSnapshotSelectsContextVariants) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Terminal", 1), MakeApp("Editor", 2) }, Settings(),
+        { MakeVariant("Terminal", "code.exe", "first"), MakeVariant("Terminal", "code.exe", "last"),
+          MakeVariant("Unknown", "code.exe", "dropped") });
+
+    const AppConfig* terminal = config->FindByName("Terminal");
+    const AppConfig* editor = config->FindByName("Editor");
+    REQUIRE(terminal != nullptr && editor != nullptr);
+    CHECK(config->HasContexts(*terminal));
+    CHECK(!config->HasContexts(*editor));
+
+    const AppConfig* variant = config->SelectContext(*terminal, "code.exe");
+    REQUIRE(variant != terminal);
+    CHECK_EQ("last", variant->args);
+    CHECK(config->SelectContext(*terminal, "notepad.exe") == terminal);
+    CHECK(config->SelectContext(*terminal, "") == terminal);
+    CHECK(config->SelectContext(*editor, "code.exe") == editor);
+}
+
+TEST(ConfigSnapshotWithAppEnabledCopies) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Editor", 1), MakeApp("Terminal", 2) }, Settings());
+    auto disabled = config->WithAppEnabled(1, false);
+
+    CHECK(config->Apps()[1].enabled);
+    CHECK(!disabled->Apps()[1].enabled);
+    CHECK(disabled->Apps()[0].enabled);
+    CHECK(disabled->FindByHotkey(2) == &disabled->Apps()[1]);
+
+    // Out of range leaves every app as it was
+    auto unchanged = config->WithAppEnabled(7, false);
+    CHECK(unchanged->Apps()[0].enabled && unchanged->Apps()[1].enabled);
+}
+
+TEST(ConfigSnapshotWithHotkeyIdsRebuildsIndex) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Editor", 1), MakeApp("Terminal", 2) }, Settings());
+    auto renumbered = config->WithHotkeyIds({ 9, 4 });
+
+    CHECK_EQ(9, renumbered->Apps()[0].hotkeyId);
+    CHECK_EQ(4, renumbered->Apps()[1].hotkeyId);
+    CHECK(renumbered->FindByHotkey(9) == &renumbered->Apps()[0]);
+    CHECK(renumbered->FindByHotkey(4) == &renumbered->Apps()[1]);
+    CHECK(renumbered->FindByHotkey(1) == nullptr);
+    CHECK(renumbered->FindByHotkey(2) == nullptr);
+
+    // The original is untouched
+    CHECK(config->FindByHotkey(1) == &config->Apps()[0]);
+}
+
+TEST(ConfigSnapshotWithHotkeyIdsRenumbersVariants) {
+    AppConfig variant = MakeVariant("Terminal", "code.exe", "-NoExit");
+    variant.hotkeyId = 2;
+    auto config = ConfigSnapshot::Compile({ MakeApp("Editor", 1), MakeApp("Terminal", 2) }, Settings(), { variant });
+    auto renumbered = config->WithHotkeyIds({ 9, 4 });
+
+    // A press from the variant coalesces with one of its app
+    const AppConfig& terminal = renumbered->Apps()[1];
+    const AppConfig* selected = renumbered->SelectContext(terminal, "code.exe");
+    REQUIRE(selected != &terminal);
+    CHECK_EQ("-NoExit", selected->args);
+    CHECK_EQ(4, selected->hotkeyId);
+    CHECK_EQ(2, config->SelectContext(config->Apps()[1], "code.exe")->hotkeyId);
+}
+
+TEST(ConfigSnapshotIgnoresAppsOfOtherSnapshots) {
+    auto config = ConfigSnapshot::Compile({ MakeApp("Editor", 1), MakeApp("Terminal", 2) }, Settings(),
+        { MakeVariant("Terminal", "code.exe", "-NoExit") });
+    auto other = ConfigSnapshot::Compile({ MakeApp("Editor", 1), MakeApp("Terminal", 2) }, Settings());
+
+    // Neither snapshot treats the other's entries as its own
+    const AppConfig& foreign = other->Apps()[1];
+    CHECK(!config->HasContexts(foreign));
+    CHECK(config->SelectContext(foreign, "code.exe") == &foreign);
+    CHECK(config->HasContexts(config->Apps()[1]));
+
+    AppConfig local = MakeApp("Terminal", 2);
+    CHECK(!config->HasContexts(local));
+    CHECK(config->SelectContext(local, "code.exe") == &local);
+
+    auto empty = ConfigSnapshot::Compile({}, Settings());
+    CHECK(!empty->HasContexts(config->Apps()[1]));
+}
+
+TEST(ConfigStorePublishesAndLoads) {
+    ConfigStore store;
+    CHECK(store.Current() == nullptr);
+
+    auto first = ConfigSnapshot::Compile({ MakeApp("Editor", 1) }, Settings());
+    store.Publish(first);
+    CHECK(store.Current() == first);
+
+    // A reader's reference outlives the publish that replaces it
+    std::shared_ptr<const ConfigSnapshot> held = store.Current();
+    store.Publish(ConfigSnapshot::Compile({ MakeApp("Terminal", 1) }, Settings()));
+    first.reset();
+    REQUIRE(held != nullptr);
+    CHECK_EQ("Editor", held->Apps()[0].name);
+    CHECK_EQ("Terminal", store.Current()->Apps()[0].name);
+}
+
+TEST(ConfigStoreReadersSeeWholeSnapshots) {
+    ConfigStore store;
+    store.Publish(ConfigSnapshot::Compile({ MakeApp("App0", 1) }, Settings()));
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> torn(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&store, &stop, &torn] {
+            while (!stop.load()) {
+                std::shared_ptr<const ConfigSnapshot> config = store.Current();
+                const AppConfig* app = config->FindByHotkey(1);
+                if (app == nullptr || app->executable != app->name + ".exe") {
+                    torn++;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= 2000; i++) {
+        store.Publish(ConfigSnapshot::Compile({ MakeApp("App" + std::to_string(i), 1) }, Settings()));
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK_EQ((size_t)0, torn.load());
+    CHECK_EQ("App2000", store.Current()->Apps()[0].name);
+}
@@ -0,0 +1,142 @@
+#include "test.h"
+#include "config_diff.h"
+#include "fake_hotkey_registrar.h"
+
+namespace {
+
+AppConfig MakeApp(const std::string& name, unsigned int vkCode) {
+    AppConfig app;
+    app.name = name;
+    app.executable = name + ".exe";
+    app.modifiers = kModifierControl | kModifierAlt;
+    app.vkCode = vkCode;
+    return app;
+}
+
+// "U1 R2": the calls in order, U for Unregister and R for Register
+std::string Describe(const std::vector<HotkeyCall>& calls) {
+    std::string text;
+    for (const HotkeyCall& call : calls) {
+        text += text.empty() ? "" : " ";
+        text += (call.registers ? "R" : "U") + std::to_string(call.hotkeyId);
+    }
+    return text;
+}
+
+// Diffs against previous, applies the plan and returns the new snapshot.
+// The registrar records only this reload's calls.
+std::shared_ptr<const ConfigSnapshot> Reload(FakeHotkeyRegistrar& registrar, const ConfigSnapshot* previous,
+    std::vector<AppConfig> apps, std::vector<const AppConfig*>* failed = nullptr) {
+    ConfigDiff diff = DiffConfig(previous, ConfigSnapshot::Compile(std::move(apps), Settings()));
+    registrar.RecordCalls();
+    std::vector<const AppConfig*> refused = ApplyHotkeyPlan(diff.hotkeys, registrar);
+    if (failed != nullptr) {
+        *failed = refused;
+    }
+    return diff.config;
+}
+
+} // namespace
+
+TEST(DiffConfigRegistersEverythingInitially) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Terminal", 'T'), MakeApp("Editor", 'E') });
+
+    CHECK_EQ("R1 R2", Describe(registrar.Calls()));
+    CHECK_EQ(1, config->FindByName("Editor")->hotkeyId);
+    CHECK_EQ(2, config->FindByName("Terminal")->hotkeyId);
+}
+
+TEST(DiffConfigUnchangedReloadMakesNoCalls) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+
+    AppConfig edited = MakeApp("Terminal", 'T');
+    edited.args = "--new-tab";
+    auto next = Reload(registrar, config.get(), { MakeApp("Editor", 'E'), edited });
+    CHECK_EQ("", Describe(registrar.Calls()));
+    CHECK_EQ(2, next->FindByName("Terminal")->hotkeyId);
+}
+
+TEST(DiffConfigRenameUnregistersBeforeRegistering) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+
+    // Same binding under a new name: the old registration must go first or
+    // the new one is refused as taken
+    std::vector<const AppConfig*> failed;
+    auto next = Reload(registrar, config.get(), { MakeApp("Editor", 'E'), MakeApp("Console", 'T') }, &failed);
+    CHECK_EQ("U2 R2", Describe(registrar.Calls()));
+    CHECK(failed.empty());
+    CHECK_EQ(2, next->FindByName("Console")->hotkeyId);
+    CHECK(registrar.IsRegistered(2, kModifierControl | kModifierAlt, 'T'));
+    CHECK_EQ((size_t)2, registrar.Registered());
+}
+
+TEST(DiffConfigEnableToggleTouchesOnlyThatApp) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+
+    AppConfig disabled = MakeApp("Editor", 'E');
+    disabled.enabled = false;
+    auto off = Reload(registrar, config.get(), { disabled, MakeApp("Terminal", 'T') });
+    CHECK_EQ("U1", Describe(registrar.Calls()));
+    CHECK_EQ((size_t)1, registrar.Registered());
+
+    auto on = Reload(registrar, off.get(), { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+    CHECK_EQ("R1", Describe(registrar.Calls()));
+    CHECK(registrar.IsRegistered(1, kModifierControl | kModifierAlt, 'E'));
+
+    // The tray toggle goes through the same diff
+    auto toggled = DiffConfig(on.get(), on->WithAppEnabled(1, false));
+    registrar.RecordCalls();
+    ApplyHotkeyPlan(toggled.hotkeys, registrar);
+    CHECK_EQ("U2", Describe(registrar.Calls()));
+}
+
+TEST(DiffConfigHotkeySwapUnregistersBothFirst) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+
+    std::vector<const AppConfig*> failed;
+    Reload(registrar, config.get(), { MakeApp("Editor", 'T'), MakeApp("Terminal", 'E') }, &failed);
+    CHECK_EQ("U1 U2 R1 R2", Describe(registrar.Calls()));
+    CHECK(failed.empty());
+    CHECK(registrar.IsRegistered(1, kModifierControl | kModifierAlt, 'T'));
+    CHECK(registrar.IsRegistered(2, kModifierControl | kModifierAlt, 'E'));
+}
+
+TEST(DiffConfigNewAppTakesLowestFreeId) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("A", 'A'), MakeApp("B", 'B'), MakeApp("C", 'C') });
+
+    // B goes away and frees id 2 for the newcomer; A and C keep theirs
+    auto next = Reload(registrar, config.get(), { MakeApp("A", 'A'), MakeApp("C", 'C'), MakeApp("D", 'D') });
+    CHECK_EQ("U2 R2", Describe(registrar.Calls()));
+    CHECK_EQ(1, next->FindByName("A")->hotkeyId);
+    CHECK_EQ(3, next->FindByName("C")->hotkeyId);
+    CHECK_EQ(2, next->FindByName("D")->hotkeyId);
+}
+
+TEST(DiffConfigLeavesSequencesAndMissingHotkeysUnregistered) {
+    FakeHotkeyRegistrar registrar;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') });
+
+    AppConfig sequence = MakeApp("Terminal", 'T');
+    sequence.sequence = { KeyStroke(kModifierControl | kModifierAlt, 'T'), KeyStroke(0, 'P') };
+    AppConfig noHotkey = MakeApp("Notes", 0);
+    Reload(registrar, config.get(), { MakeApp("Editor", 'E'), sequence, noHotkey });
+    CHECK_EQ("U2", Describe(registrar.Calls()));
+    CHECK_EQ((size_t)1, registrar.Registered());
+}
+
+TEST(ApplyHotkeyPlanReturnsRefusedApps) {
+    FakeHotkeyRegistrar registrar;
+    registrar.Hold(kModifierControl | kModifierAlt, 'T');
+
+    std::vector<const AppConfig*> failed;
+    auto config = Reload(registrar, nullptr, { MakeApp("Editor", 'E'), MakeApp("Terminal", 'T') }, &failed);
+    REQUIRE(failed.size() == 1);
+    CHECK(failed[0] == config->FindByName("Terminal"));
+    CHECK_EQ((size_t)1, registrar.Registered());
+}
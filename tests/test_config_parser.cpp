@@ -0,0 +1,189 @@
+#include "test.h"
+#include "config_parser.h"
+#include <random>
+
+namespace {
+
+// A file using every section, the seed of the mutation loop
+const char kCorpus[] =
+    "; launcher.ini\r\n"
+    "[Settings]\n"
+    "checkMouseHover=true\n"
+    "priorityWhenBothAvailable=focus\n"
+    "resolveTimeoutMs=500\n"
+    "sequenceTimeoutMs=1500\n"
+    "maxFanOut=8\n"
+    "contextProviders=explorer,terminal\n"
+    "paletteHotkey=Ctrl+Alt+Space\n"
+    "\n"
+    "[Apps]\n"
+    "Terminal=wt.exe|false|-d {dir}|Ctrl+Alt+T|true|perFolder\n"
+    "Editor=code.exe|false|--reuse {item}|Ctrl+Alt+E|true|allItems\n"
+    "Layout=layout.exe|false||Ctrl+Alt+L, P\n"
+    "Admin=cmd.exe|true|/k|Win+F12|false\n"
+    "\n"
+    "[Contexts]\n"
+    "Terminal@code.exe=|false|-NoExit\n"
+    "\n"
+    "[Groups]\n"
+    "Dev=Terminal, Editor(--new-window .)|Ctrl+Alt+D\n"
+    "Web=Terminal > Editor|Ctrl+Alt+W|true\n";
+
+// Bytes that mean something to the parser, and some that should not
+const char kMutationBytes[] = "=|[]@,;>(){}+ \t\r\n0aZ\xff\x80";
+
+// Length of each line of text, as the parser splits them
+std::vector<size_t> LineLengths(const std::string& text) {
+    std::vector<size_t> lengths(1, 0);
+    for (char c : text) {
+        if (c == '\n') {
+            lengths.push_back(0);
+        }
+        else {
+            lengths.back()++;
+        }
+    }
+    return lengths;
+}
+
+std::string Mutate(std::mt19937& random, std::string text) {
+    std::uniform_int_distribution<int> edits(1, 8);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kMutationBytes) - 2);
+    for (int count = edits(random); count > 0 && !text.empty(); count--) {
+        size_t at = std::uniform_int_distribution<size_t>(0, text.size() - 1)(random);
+        switch (random() % 5) {
+        case 0:
+            text[at] = kMutationBytes[pick(random)];
+            break;
+        case 1:
+            text.insert(at, 1, kMutationBytes[pick(random)]);
+            break;
+        case 2:
+            text.erase(at, std::uniform_int_distribution<size_t>(1, 16)(random));
+            break;
+        case 3: {
+            // Repeat a stretch elsewhere, as a pasted line would
+            size_t length = std::uniform_int_distribution<size_t>(1, 48)(random);
+            std::string copy = text.substr(at, length);
+            text.insert(std::uniform_int_distribution<size_t>(0, text.size())(random), copy);
+            break;
+        }
+        default:
+            text.resize(at);
+            break;
+        }
+    }
+    return text;
+}
+
+// The diagnostics ParseConfig reports for text, as "line:column message"
+std::vector<std::string> Diagnose(const std::string& text) {
+    std::vector<std::string> lines;
+    for (const ConfigDiagnostic& diagnostic : ParseConfig(text, ParseHotkeyUsLayout).diagnostics) {
+        lines.push_back(std::to_string(diagnostic.line) + ":" + std::to_string(diagnostic.column) + " " +
+            diagnostic.message);
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST(ParseConfigAcceptsCorpusWithoutDiagnostics) {
+    ConfigParseResult result = ParseConfig(kCorpus, ParseHotkeyUsLayout);
+    REQUIRE(result.config != nullptr);
+    CHECK(Diagnose(kCorpus).empty());
+    CHECK_EQ((size_t)6, result.config->Apps().size());
+    CHECK_EQ(8, result.config->GetSettings().maxFanOut);
+}
+
+TEST(ParseConfigReportsUnknownSectionAndKey) {
+    std::vector<std::string> diagnostics = Diagnose(
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T\n"
+        "  [Plugins]\n"
+        "name=value\n"
+        "[Settings]\n"
+        "  colour = blue\n");
+    REQUIRE(diagnostics.size() == 2);
+    CHECK_EQ("3:4 unknown section [Plugins]", diagnostics[0]);
+    CHECK_EQ("6:3 unknown setting 'colour'", diagnostics[1]);
+}
+
+TEST(ParseConfigReportsMalformedLines) {
+    std::vector<std::string> diagnostics = Diagnose(
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T\n"
+        "\n"
+        "just some words\n"
+        "=wt.exe|false||Ctrl+Alt+W\n"
+        "Editor=code.exe|false\n"
+        "Browser=|false||Ctrl+Alt+B\n");
+    REQUIRE(diagnostics.size() == 4);
+    CHECK_EQ("4:1 expected key=value, a [section] header or a comment", diagnostics[0]);
+    CHECK_EQ("5:1 missing app name before '='", diagnostics[1]);
+    CHECK_EQ("6:8 expected executable|runAsAdmin|args|hotkey[|enabled[|options]] for 'Editor'", diagnostics[2]);
+    CHECK_EQ("7:9 missing executable for 'Browser'", diagnostics[3]);
+}
+
+TEST(ParseConfigReportsBadHotkeys) {
+    std::vector<std::string> diagnostics = Diagnose(
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+Bogus\n"
+        "Editor=code.exe|false|||true\n"
+        "Layout=layout.exe|false||P, Q\n"
+        "Notes=notepad.exe|false||Ctrl+Alt+N|maybe\n");
+    REQUIRE(diagnostics.size() == 4);
+    CHECK_EQ("2:24 invalid hotkey 'Ctrl+Alt+Bogus'; 'Terminal' is loaded without a hotkey", diagnostics[0]);
+    CHECK_EQ(0u, diagnostics[1].find("3:24 missing hotkey"));
+    CHECK_EQ(0u, diagnostics[2].find("4:26 a hotkey sequence must start with"));
+    CHECK_EQ("5:37 expected true or false for enabled", diagnostics[3]);
+}
+
+TEST(ParseConfigReportsOutOfRangeNumbers) {
+    std::vector<std::string> diagnostics = Diagnose(
+        "[Settings]\n"
+        "resolveTimeoutMs=60001\n"
+        "maxFanOut=0\n"
+        "maxFanOut=65\n"
+        "maxFanOut=99999999999999999999\n"
+        "sequenceTimeoutMs=-5\n"
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T\n");
+    REQUIRE(diagnostics.size() == 5);
+    CHECK_EQ("2:18 resolveTimeoutMs must be a number of milliseconds from 0 to 60000", diagnostics[0]);
+    CHECK_EQ("3:11 maxFanOut must be a number from 1 to 64", diagnostics[1]);
+    CHECK_EQ("4:11 maxFanOut must be a number from 1 to 64", diagnostics[2]);
+    CHECK_EQ("5:11 maxFanOut must be a number from 1 to 64", diagnostics[3]);
+    CHECK_EQ(0u, diagnostics[4].find("6:19 sequenceTimeoutMs must be"));
+
+    // Rejected values fall back to the defaults
+    ConfigParseResult result = ParseConfig("[Settings]\nmaxFanOut=65\n[Apps]\nT=wt.exe|false||Ctrl+Alt+T\n",
+        ParseHotkeyUsLayout);
+    REQUIRE(result.config != nullptr);
+    CHECK_EQ(Settings().maxFanOut, result.config->GetSettings().maxFanOut);
+}
+
+TEST(ParseConfigSurvivesMutatedInput) {
+    std::mt19937 random(4242);
+    const std::string corpus = kCorpus;
+    for (int round = 0; round < 20000; round++) {
+        // Every fourth round starts from a file cut short
+        std::string seed = round % 4 == 0 ? corpus.substr(0, round % corpus.size()) : corpus;
+        std::string text = Mutate(random, seed);
+        ConfigParseResult result = ParseConfig(text, ParseHotkeyUsLayout);
+
+        std::vector<size_t> lengths = LineLengths(text);
+        for (const ConfigDiagnostic& diagnostic : result.diagnostics) {
+            bool inside = diagnostic.line >= 1 && (size_t)diagnostic.line <= lengths.size() && diagnostic.column >= 1 &&
+                (size_t)diagnostic.column <= lengths[diagnostic.line - 1] + 1;
+            if (!inside) {
+                CHECK_EQ("", FormatDiagnostic(diagnostic) + " is outside the input:\n" + text);
+                return;
+            }
+        }
+        if (result.config != nullptr && result.config->Apps().empty()) {
+            CHECK_EQ("", "a snapshot without apps for:\n" + text);
+            return;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#include "test.h"
+#include "config_writer.h"
+
+namespace {
+
+// Toggles name in text and returns the file as it would be written back
+std::string Toggle(const std::string& text, const std::string& name, bool enabled, bool* found = nullptr) {
+    IniDocument document(text);
+    bool changed = SetAppEnabled(document, name, enabled);
+    if (found != nullptr) {
+        *found = changed;
+    }
+    return document.Text();
+}
+
+} // namespace
+
+TEST(IniDocumentRoundTripsUntouchedFile) {
+    const std::string files[] = {
+        "; launcher.ini\n\n[Apps]\n  Terminal = wt.exe|false||Ctrl+Alt+T   ; main\n\n\n",
+        "\xEF\xBB\xBF[Apps]\r\nTerminal=wt.exe|false||Ctrl+Alt+T\r\n",
+        "[Apps]\nTerminal=wt.exe|false||Ctrl+Alt+T",
+        "",
+        "\n",
+    };
+    for (const std::string& text : files) {
+        CHECK_EQ(text, IniDocument(text).Text());
+    }
+}
+
+TEST(SetAppEnabledChangesOnlyTheEnabledField) {
+    const std::string text =
+        "; Apps I use every day\n"
+        "\n"
+        "[Apps]\n"
+        "  # indented comment\n"
+        "Terminal = wt.exe | false | -d {dir} | Ctrl+Alt+T | true | perFolder\n"
+        "\n"
+        "Editor=code.exe|false||Ctrl+Alt+E\n"
+        "\t\n"
+        "; trailing comment\n";
+
+    CHECK_EQ(
+        "; Apps I use every day\n"
+        "\n"
+        "[Apps]\n"
+        "  # indented comment\n"
+        "Terminal = wt.exe | false | -d {dir} | Ctrl+Alt+T | false | perFolder\n"
+        "\n"
+        "Editor=code.exe|false||Ctrl+Alt+E\n"
+        "\t\n"
+        "; trailing comment\n",
+        Toggle(text, "Terminal", false));
+
+    // Toggling back restores the file byte for byte
+    CHECK_EQ(text, Toggle(Toggle(text, "Terminal", false), "Terminal", true));
+}
+
+TEST(SetAppEnabledAppendsMissingEnabledField) {
+    CHECK_EQ("[Apps]\nEditor=code.exe|false||Ctrl+Alt+E|false\n",
+        Toggle("[Apps]\nEditor=code.exe|false||Ctrl+Alt+E\n", "Editor", false));
+
+    // A trailing '|' is an empty enabled field, filled in place
+    CHECK_EQ("[Apps]\nEditor=code.exe|false||Ctrl+Alt+E|false\n",
+        Toggle("[Apps]\nEditor=code.exe|false||Ctrl+Alt+E|\n", "Editor", false));
+
+    // Too few fields to be a valid entry: left for the parser to report
+    bool found = true;
+    CHECK_EQ("[Apps]\nEditor=code.exe|false\n", Toggle("[Apps]\nEditor=code.exe|false\n", "Editor", false, &found));
+    CHECK(!found);
+}
+
+TEST(SetAppEnabledKeepsCrlfBomAndMissingFinalNewline) {
+    CHECK_EQ("\xEF\xBB\xBF; tray edits\r\n[Apps]\r\nTerminal=wt.exe|false||Ctrl+Alt+T|false\r\n",
+        Toggle("\xEF\xBB\xBF; tray edits\r\n[Apps]\r\nTerminal=wt.exe|false||Ctrl+Alt+T|true\r\n", "Terminal", false));
+
+    CHECK_EQ("[Apps]\nTerminal=wt.exe|false||Ctrl+Alt+T|true",
+        Toggle("[Apps]\nTerminal=wt.exe|false||Ctrl+Alt+T|false", "Terminal", true));
+
+    CHECK_EQ("[Apps]\r\nTerminal=wt.exe|false||Ctrl+Alt+T|true",
+        Toggle("[Apps]\r\nTerminal=wt.exe|false||Ctrl+Alt+T", "Terminal", true));
+}
+
+TEST(SetAppEnabledIgnoresUnknownNames) {
+    const std::string text = "[Apps]\nTerminal=wt.exe|false||Ctrl+Alt+T\n[Settings]\nEditor=1\n";
+    bool found = true;
+    CHECK_EQ(text, Toggle(text, "Editor", false, &found));
+    CHECK(!found);
+    CHECK_EQ(text, Toggle(text, "terminal", false, &found));
+    CHECK(!found);
+}
+
+TEST(SetAppEnabledEditsLastDefinitionAndLeavesGroupsAlone) {
+    const std::string text =
+        "[Apps]\n"
+        "Terminal=old.exe|false||Ctrl+Alt+T|true\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T|true\n"
+        "\n"
+        "[Groups]\n"
+        "Dev=Terminal, Editor(--new-window .)|Ctrl+Alt+D|true\n"
+        "Web=Server > Terminal|Ctrl+Alt+W\n";
+
+    // The parser uses the last definition, so that is the one edited
+    CHECK_EQ(
+        "[Apps]\n"
+        "Terminal=old.exe|false||Ctrl+Alt+T|true\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T|false\n"
+        "\n"
+        "[Groups]\n"
+        "Dev=Terminal, Editor(--new-window .)|Ctrl+Alt+D|true\n"
+        "Web=Server > Terminal|Ctrl+Alt+W\n",
+        Toggle(text, "Terminal", false));
+
+    // Groups have their enabled field third
+    CHECK_EQ(
+        "[Apps]\n"
+        "Terminal=old.exe|false||Ctrl+Alt+T|true\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T|true\n"
+        "\n"
+        "[Groups]\n"
+        "Dev=Terminal, Editor(--new-window .)|Ctrl+Alt+D|true\n"
+        "Web=Server > Terminal|Ctrl+Alt+W|false\n",
+        Toggle(text, "Web", false));
+}
@@ -0,0 +1,127 @@
+#include "test.h"
+#include "context_provider.h"
+#include "fake_context_provider.h"
+#include "fake_process_table.h"
+
+namespace {
+
+const WindowHandle kTerminal = 0x1000;
+const WindowHandle kSecondTab = 0x1100;  // Another window of the same terminal process
+const WindowHandle kEditor = 0x2000;
+
+const std::vector<std::string> kOrder = { "terminal", "editor" };
+
+std::chrono::steady_clock::time_point In(int milliseconds) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+}
+
+struct Desktop {
+    FakeProcessTable processes;
+    FakeContextProvider terminal;
+    FakeContextProvider editor;
+    ContextProviderRegistry providers;
+
+    explicit Desktop(int terminalTtlMs, int budgetMs = 0)
+        : providers(processes, []() { return std::string("C:\\Users\\me"); }) {
+        processes.AddWindow(kTerminal, 10, "WindowsTerminal.exe");
+        processes.AddWindow(kSecondTab, 10, "WindowsTerminal.exe");
+        processes.AddWindow(kEditor, 20, "Code.exe");
+        terminal.AddWindow(kTerminal, "C:\\src");
+        terminal.AddWindow(kSecondTab, "C:\\other");
+        editor.AddWindow(kEditor, "D:\\notes");
+        providers.Add("terminal", terminal, ContextProviderOptions(budgetMs, terminalTtlMs));
+        providers.Add("editor", editor, ContextProviderOptions());
+    }
+
+    std::string Resolve(WindowHandle window) {
+        return providers.GetDirectory(providers.Claim(window, kOrder), In(1000));
+    }
+};
+
+} // namespace
+
+TEST(ContextProviderClaimFollowsOrder) {
+    Desktop desktop(0);
+    // Both claim the editor window; the order decides
+    desktop.terminal.AddWindow(kEditor, "C:\\terminal-view");
+
+    CHECK(desktop.providers.Claim(kEditor, kOrder) == ContextClaim(0, kEditor));
+    CHECK(desktop.providers.Claim(kEditor, { "unknown", "editor", "terminal" }) == ContextClaim(1, kEditor));
+    CHECK(desktop.providers.Claim(0x9000, kOrder) == ContextClaim());
+    CHECK(desktop.providers.Claim(kNoWindow, kOrder) == ContextClaim());
+}
+
+TEST(ContextProviderCachesByProcessWithinTtl) {
+    Desktop desktop(60000);
+    CHECK_EQ("C:\\src", desktop.Resolve(kTerminal));
+
+    // Same process: the cached answer is reused, even for another window
+    CHECK_EQ("C:\\src", desktop.Resolve(kSecondTab));
+    CHECK_EQ((size_t)1, desktop.terminal.DirectoryQueries());
+
+    // Other providers keep their own entries
+    CHECK_EQ("D:\\notes", desktop.Resolve(kEditor));
+    CHECK_EQ((size_t)1, desktop.editor.DirectoryQueries());
+
+    ContextProviderRegistry::Stats stats = desktop.providers.GetStats();
+    CHECK_EQ((uint64_t)3, stats.queries);
+    CHECK_EQ((uint64_t)1, stats.cacheHits);
+}
+
+TEST(ContextProviderCacheExpiresAfterTtl) {
+    Desktop desktop(30);
+    CHECK_EQ("C:\\src", desktop.Resolve(kTerminal));
+    desktop.terminal.SetDirectory(kTerminal, "C:\\src\\app");
+    CHECK_EQ("C:\\src", desktop.Resolve(kTerminal));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ("C:\\src\\app", desktop.Resolve(kTerminal));
+    CHECK_EQ((size_t)2, desktop.terminal.DirectoryQueries());
+}
+
+TEST(ContextProviderInvalidateDropsCachedResults) {
+    Desktop desktop(60000);
+    CHECK_EQ("C:\\src", desktop.Resolve(kTerminal));
+    desktop.terminal.SetDirectory(kTerminal, "C:\\src\\app");
+
+    desktop.providers.Invalidate();
+    CHECK_EQ("C:\\src\\app", desktop.Resolve(kTerminal));
+    CHECK_EQ((size_t)2, desktop.terminal.DirectoryQueries());
+}
+
+TEST(ContextProviderDoesNotCacheWithoutTtlOrAnswer) {
+    Desktop uncached(0);
+    uncached.Resolve(kTerminal);
+    uncached.Resolve(kTerminal);
+    CHECK_EQ((size_t)2, uncached.terminal.DirectoryQueries());
+
+    // Empty answers are asked again, as are windows without a process
+    Desktop desktop(60000);
+    desktop.terminal.SetDirectory(kTerminal, "");
+    CHECK_EQ("", desktop.Resolve(kTerminal));
+    desktop.terminal.SetDirectory(kTerminal, "C:\\src");
+    CHECK_EQ("C:\\src", desktop.Resolve(kTerminal));
+
+    desktop.processes.RemoveWindow(kSecondTab);
+    desktop.Resolve(kSecondTab);
+    desktop.Resolve(kSecondTab);
+    CHECK_EQ((size_t)4, desktop.terminal.DirectoryQueries());
+}
+
+TEST(ContextProviderBudgetCapsSlowProvider) {
+    Desktop desktop(60000, 30);
+    desktop.terminal.SetDelay(kTerminal, std::chrono::milliseconds(2000));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK_EQ("", desktop.Resolve(kTerminal));
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000));
+}
+
+TEST(FindPathInTitleCutsAtSeparators) {
+    CHECK_EQ("C:\\src\\app\\main.cpp", FindPathInTitle("main.cpp (C:\\src\\app\\main.cpp) - Editor"));
+    CHECK_EQ("C:\\Program Files (x86)\\Tool", FindPathInTitle("C:\\Program Files (x86)\\Tool - Explorer"));
+    CHECK_EQ("\\\\nas\\share\\dir", FindPathInTitle("[\\\\nas\\share\\dir] Terminal"));
+    CHECK_EQ("C:\\notes.txt", FindPathInTitle("C:\\notes.txt... "));
+    CHECK_EQ("", FindPathInTitle("Untitled - Notepad"));
+    CHECK_EQ("", FindPathInTitle("AC:\\not-a-path"));
+}
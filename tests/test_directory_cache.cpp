@@ -0,0 +1,115 @@
+#include "test.h"
+#include "directory_cache.h"
+#include "directory_resolver.h"
+#include "fake_shell_windows.h"
+
+namespace {
+
+const WindowHandle kExplorer = 0x1000;
+const WindowHandle kFirstTab = 0x1001;
+const WindowHandle kSecondTab = 0x1002;
+
+std::chrono::steady_clock::time_point In(int milliseconds) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+}
+
+} // namespace
+
+TEST(DirectoryCacheQueriesOnceThenHits) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "C:\\src");
+    DirectoryCache cache(provider);
+
+    std::string directory;
+    CHECK(cache.Lookup(kExplorer, directory));
+    CHECK_EQ("C:\\src", directory);
+    CHECK(cache.Lookup(kExplorer, directory));
+    CHECK_EQ((size_t)1, provider.Queries());
+
+    DirectoryCache::Stats stats = cache.GetStats();
+    CHECK_EQ((uint64_t)1, stats.hits);
+    CHECK_EQ((uint64_t)1, stats.misses);
+}
+
+TEST(DirectoryCacheRemembersVirtualFoldersAndCountsFailures) {
+    FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "");
+    DirectoryCache cache(provider);
+
+    // This PC has no path, and is not asked about again
+    std::string directory;
+    CHECK(!cache.Lookup(kExplorer, directory));
+    CHECK(!cache.Lookup(kExplorer, directory));
+    CHECK_EQ((size_t)1, provider.Queries());
+
+    CHECK(!cache.Lookup(0x9000, directory));
+    CHECK_EQ((uint64_t)1, cache.GetStats().providerFailures);
+}
+
+TEST(DirectoryCacheKeepsNavigationOverOlderQueryResult) {
+    FakeShellWindowProvider provider;
+    DirectoryCache cache(provider);
+
+    // The query started before the navigation and finished after it
+    cache.OnNavigated(kExplorer, "C:\\new");
+    cache.OnResolved(kExplorer, "C:\\old");
+
+    std::string directory;
+    CHECK(cache.Find(kExplorer, directory));
+    CHECK_EQ("C:\\new", directory);
+}
+
+TEST(DirectoryCacheInvalidateKeepsLastKnownButRevokeDoesNot) {
+    FakeShellWindowProvider provider;
+    DirectoryCache cache(provider);
+    cache.OnNavigated(kExplorer, "C:\\src");
+
+    std::string directory;
+    cache.Invalidate(kExplorer);
+    CHECK(!cache.Find(kExplorer, directory));
+    CHECK(cache.FindLastKnown(kExplorer, directory));
+    CHECK_EQ("C:\\src", directory);
+
+    // A handle that is registered again may belong to another window
+    cache.OnWindowRegistered(kExplorer);
+    CHECK(!cache.FindLastKnown(kExplorer, directory));
+
+    cache.OnNavigated(kExplorer, "C:\\src");
+    cache.OnWindowRevoked(kExplorer);
+    CHECK(!cache.Find(kExplorer, directory));
+    CHECK(!cache.FindLastKnown(kExplorer, directory));
+    CHECK_EQ((size_t)0, cache.Size());
+}
+
+TEST(DirectoryCacheEntriesArePerTab) {
+    FakeShellWindowProvider provider;
+    provider.AddTab(kExplorer, kFirstTab, "C:\\src");
+    provider.AddTab(kExplorer, kSecondTab, "D:\\downloads");
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache);
+
+    // The newest tab is the visible one
+    std::string directory;
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("D:\\downloads", directory);
+
+    provider.SelectTab(kExplorer, kFirstTab);
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("C:\\src", directory);
+    CHECK_EQ((size_t)2, provider.Queries());
+
+    // Switching back needs no event and no query
+    provider.SelectTab(kExplorer, kSecondTab);
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("D:\\downloads", directory);
+    CHECK_EQ((size_t)2, provider.Queries());
+
+    // A navigation in one tab leaves the other alone
+    cache.OnNavigated(kFirstTab, "C:\\src\\app");
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("D:\\downloads", directory);
+    provider.SelectTab(kExplorer, kFirstTab);
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("C:\\src\\app", directory);
+    CHECK_EQ((size_t)2, provider.Queries());
+}
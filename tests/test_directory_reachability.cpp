@@ -0,0 +1,137 @@
+#include "test.h"
+#include "directory_reachability.h"
+#include "fake_directory_probe.h"
+
+namespace {
+
+const char kShare[] = "\\\\nas\\projects\\";
+const char kShareDirectory[] = "\\\\nas\\projects\\app";
+
+std::chrono::steady_clock::time_point In(int milliseconds) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+}
+
+long long MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Network {
+    FakeDirectoryProbe probe;
+    DirectoryReachability reachability;
+
+    Network(std::chrono::milliseconds offlineDelay, std::chrono::milliseconds reachableTtl,
+        std::chrono::milliseconds unreachableTtl = std::chrono::milliseconds(60000))
+        : probe(offlineDelay), reachability(probe, reachableTtl, unreachableTtl) {
+        probe.AddDirectory("C:\\src");
+        probe.AddDirectory(kShareDirectory);
+    }
+};
+
+} // namespace
+
+TEST(GetShareRootHandlesDrivesAndUncPaths) {
+    CHECK_EQ("Z:\\", GetShareRoot("Z:\\work\\app"));
+    CHECK_EQ("\\\\nas\\projects\\", GetShareRoot("\\\\nas\\projects\\app\\src"));
+    CHECK_EQ("\\\\nas\\projects\\", GetShareRoot("\\\\nas\\projects"));
+    CHECK_EQ("\\\\nas\\projects\\", GetShareRoot("\\\\?\\UNC\\nas\\projects\\app"));
+    CHECK_EQ("", GetShareRoot("\\\\nas"));
+    CHECK_EQ("", GetShareRoot("relative\\path"));
+}
+
+TEST(DirectoryReachabilityChecksLocalDirectoriesInPlace) {
+    Network network(std::chrono::milliseconds(0), std::chrono::milliseconds(60000));
+    network.reachability.Start();
+
+    CHECK(network.reachability.IsUsable("C:\\src", In(1000)));
+    CHECK(!network.reachability.IsUsable("C:\\missing", In(1000)));
+    CHECK(!network.reachability.IsUsable("", In(1000)));
+
+    DirectoryReachability::Stats stats = network.reachability.GetStats();
+    CHECK_EQ((uint64_t)0, stats.shareChecks);
+    CHECK_EQ((uint64_t)0, stats.directoryChecks);
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityCachesReachableShareWithinTtl) {
+    Network network(std::chrono::milliseconds(0), std::chrono::milliseconds(60000));
+    network.reachability.Start();
+
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK(!network.reachability.IsUsable("\\\\NAS\\Projects\\missing", In(1000)));
+
+    DirectoryReachability::Stats stats = network.reachability.GetStats();
+    CHECK_EQ((uint64_t)1, stats.shareChecks);
+    CHECK_EQ((uint64_t)3, stats.directoryChecks);
+    CHECK_EQ((uint64_t)2, stats.cacheHits);
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityRefreshesShareAfterTtl) {
+    Network network(std::chrono::milliseconds(0), std::chrono::milliseconds(30));
+    network.reachability.Start();
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+
+    // A stale answer is used while the refresh runs
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK(WaitFor([&network] { return network.reachability.GetStats().shareChecks == 2; }));
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityOfflineShareCostsOneDeadline) {
+    Network network(std::chrono::milliseconds(100), std::chrono::milliseconds(60000));
+    network.probe.SetOffline(kShare, true);
+    network.reachability.Start();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(!network.reachability.IsUsable(kShareDirectory, In(20)));
+    CHECK(MillisecondsSince(start) < 90);
+    CHECK_EQ((uint64_t)1, network.reachability.GetStats().timeouts);
+
+    // Once the check has failed, presses within the TTL answer at once
+    REQUIRE(WaitFor([&network] { return network.reachability.GetStats().shareChecks == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    start = std::chrono::steady_clock::now();
+    CHECK(!network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK(MillisecondsSince(start) < 50);
+    CHECK_EQ((uint64_t)1, network.reachability.GetStats().cacheHits);
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityBoundsDirectoryCheckOnDroppedShare) {
+    Network network(std::chrono::milliseconds(300), std::chrono::milliseconds(60000));
+    network.reachability.Start();
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+
+    // Still cached as reachable, but the directory check would block
+    network.probe.SetOffline(kShare, true);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(!network.reachability.IsUsable(kShareDirectory, In(30)));
+    long long elapsed = MillisecondsSince(start);
+    CHECK(elapsed >= 20 && elapsed < 250);
+    CHECK_EQ((uint64_t)1, network.reachability.GetStats().timeouts);
+
+    // The timeout expired the share's state, so the next press refreshes it
+    CHECK(!network.reachability.IsUsable(kShareDirectory, In(30)));
+    CHECK(WaitFor([&network] { return network.reachability.GetStats().shareChecks == 2; }));
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityInvalidateForgetsShares) {
+    Network network(std::chrono::milliseconds(0), std::chrono::milliseconds(60000));
+    network.reachability.Start();
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+
+    network.reachability.Invalidate();
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK_EQ((uint64_t)2, network.reachability.GetStats().shareChecks);
+    network.reachability.Stop();
+}
+
+TEST(DirectoryReachabilityChecksInlineWhenStopped) {
+    Network network(std::chrono::milliseconds(0), std::chrono::milliseconds(60000));
+    CHECK(network.reachability.IsUsable(kShareDirectory, In(1000)));
+    CHECK_EQ((size_t)2, network.probe.Checks());
+    CHECK_EQ((uint64_t)0, network.reachability.GetStats().shareChecks);
+}
@@ -0,0 +1,181 @@
+#include "test.h"
+#include "directory_resolver.h"
+#include "fake_shell_windows.h"
+
+namespace {
+
+const WindowHandle kExplorer = 0x1000;
+const WindowHandle kOther = 0x2000;
+
+std::chrono::steady_clock::time_point In(int milliseconds) {
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+}
+
+long long MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Explorer {
+    FakeShellWindowProvider provider;
+    DirectoryCache cache;
+
+    Explorer() : cache(provider) {
+        provider.AddWindow(kExplorer, "C:\\src");
+        provider.AddWindow(kOther, "D:\\downloads");
+    }
+};
+
+} // namespace
+
+TEST(DirectoryResolverResolvesColdMissAndCachesIt) {
+    Explorer explorer;
+    DirectoryResolver resolver(explorer.provider, explorer.cache);
+    resolver.Start();
+
+    std::string directory;
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ("C:\\src", directory);
+    CHECK(resolver.Resolve(kExplorer, In(1000), directory));
+    CHECK_EQ((size_t)1, explorer.provider.Queries());
+    CHECK_EQ((uint64_t)1, resolver.GetStats().queries);
+    resolver.Stop();
+}
+
+TEST(DirectoryResolverTimeoutFallsBackToLastKnown) {
+    Explorer explorer;
+    explorer.cache.OnNavigated(kExplorer, "C:\\old");
+    explorer.cache.Invalidate(kExplorer);
+    explorer.provider.Hang(kExplorer);
+    DirectoryResolver resolver(explorer.provider, explorer.cache);
+    resolver.Start();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string directory;
+    CHECK(resolver.Resolve(kExplorer, In(50), directory));
+    CHECK_EQ("C:\\old", directory);
+    long long elapsed = MillisecondsSince(start);
+    CHECK(elapsed >= 40 && elapsed < 1000);
+
+    // The late answer still reaches the cache for the next press
+    explorer.provider.Release();
+    CHECK(WaitFor([&resolver] { return resolver.GetStats().lateResults == 1; }));
+    CHECK(explorer.cache.Find(kExplorer, directory));
+    CHECK_EQ("C:\\src", directory);
+
+    DirectoryResolver::Stats stats = resolver.GetStats();
+    CHECK_EQ((uint64_t)1, stats.timeouts);
+    CHECK_EQ((uint64_t)1, stats.fallbacks);
+    resolver.Stop();
+}
+
+TEST(DirectoryResolverCoalescesQueriesForOneTab) {
+    Explorer explorer;
+    explorer.provider.Hang(kExplorer);
+    DirectoryResolver resolver(explorer.provider, explorer.cache);
+    resolver.Start();
+
+    bool firstFound = false;
+    std::string firstDirectory;
+    std::thread first([&] { firstFound = resolver.Resolve(kExplorer, In(2000), firstDirectory); });
+    REQUIRE(WaitFor([&explorer] { return explorer.provider.Hanging() == 1; }));
+
+    // A second press on the hung tab waits on the same query
+    std::string directory;
+    CHECK(!resolver.Resolve(kExplorer, In(30), directory));
+    explorer.provider.Release();
+    first.join();
+
+    CHECK(firstFound);
+    CHECK_EQ("C:\\src", firstDirectory);
+    CHECK_EQ((size_t)1, explorer.provider.Queries());
+    DirectoryResolver::Stats stats = resolver.GetStats();
+    CHECK_EQ((uint64_t)1, stats.queries);
+    CHECK_EQ((uint64_t)1, stats.coalesced);
+    resolver.Stop();
+}
+
+TEST(DirectoryResolverDropsQueriesPastTheirDeadline) {
+    Explorer explorer;
+    explorer.provider.Hang(kExplorer);
+    DirectoryResolver resolver(explorer.provider, explorer.cache, 1);
+    resolver.Start();
+
+    // The only helper is stuck, so the second query waits in the queue
+    // until its caller has given up
+    std::string directory;
+    CHECK(!resolver.Resolve(kExplorer, In(30), directory));
+    CHECK(!resolver.Resolve(kOther, In(30), directory));
+    explorer.provider.Release();
+
+    CHECK(WaitFor([&resolver] { return resolver.GetStats().dropped == 1; }));
+    CHECK_EQ((size_t)1, explorer.provider.Queries());
+    CHECK(!explorer.cache.Find(kOther, directory));
+    resolver.Stop();
+}
+
+TEST(DirectoryResolverHungTabDoesNotBlockOthers) {
+    Explorer explorer;
+    explorer.provider.Hang(kExplorer);
+    DirectoryResolver resolver(explorer.provider, explorer.cache);
+    resolver.Start();
+
+    std::string directory;
+    CHECK(!resolver.Resolve(kExplorer, In(30), directory));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK(resolver.Resolve(kOther, In(2000), directory));
+    CHECK_EQ("D:\\downloads", directory);
+    CHECK(MillisecondsSince(start) < 1000);
+
+    explorer.provider.Release();
+    resolver.Stop();
+    CHECK_EQ((uint64_t)0, resolver.GetStats().abandoned);
+}
+
+TEST(DirectoryResolverStopAbandonsStuckHelper) {
+    // The abandoned helper goes on using the provider after the test ends
+    static FakeShellWindowProvider provider;
+    provider.AddWindow(kExplorer, "C:\\src");
+    provider.AddWindow(kOther, "D:\\downloads");
+    provider.Hang(kExplorer);
+    DirectoryCache cache(provider);
+    DirectoryResolver resolver(provider, cache, 3, std::chrono::milliseconds(100));
+    resolver.Start();
+
+    std::string directory;
+    CHECK(!resolver.Resolve(kExplorer, In(30), directory));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    resolver.Stop();
+    CHECK(MillisecondsSince(start) < 1000);
+    CHECK_EQ((uint64_t)1, resolver.GetStats().abandoned);
+
+    // A restart gets fresh helpers
+    resolver.Start();
+    CHECK(resolver.Resolve(kOther, In(1000), directory));
+    CHECK_EQ("D:\\downloads", directory);
+    resolver.Stop();
+
+    // Once released, the stuck helper drops its result instead of caching it
+    provider.Release();
+    CHECK(WaitFor([] { return provider.Hanging() == 0; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!cache.Find(kExplorer, directory));
+}
+
+TEST(DirectoryResolverReadsSelectionOnHelper) {
+    Explorer explorer;
+    explorer.provider.SetSelection(kExplorer, { SelectedItem("C:\\src\\a.txt", false) });
+    DirectoryResolver resolver(explorer.provider, explorer.cache);
+    resolver.Start();
+
+    std::vector<SelectedItem> items;
+    CHECK(resolver.ResolveSelection(kExplorer, In(1000), items));
+    REQUIRE(items.size() == 1);
+    CHECK_EQ("C:\\src\\a.txt", items[0].path);
+
+    explorer.provider.Hang(kExplorer);
+    CHECK(!resolver.ResolveSelection(kExplorer, In(30), items));
+    CHECK(items.empty());
+    explorer.provider.Release();
+    resolver.Stop();
+}
@@ -0,0 +1,162 @@
+#include "test.h"
+#include "executable_resolver.h"
+#include "fake_executable_environment.h"
+
+namespace {
+
+struct Machine {
+    FakeExecutableEnvironment environment;
+    ExecutableResolver resolver;
+
+    Machine() : resolver(environment) {
+        environment.SetVariable("PATH", "C:\\Windows\\system32;\"C:\\Program Files\\Tools\";;C:\\Users\\me\\bin\\");
+        environment.SetVariable("PATHEXT", ".COM;.EXE;.BAT;.CMD");
+    }
+
+    // Resolved path, or "" when the target is left to ShellExecute
+    std::string Resolve(const std::string& target) {
+        std::string path = "unchanged";
+        bool found = resolver.Resolve(target, path);
+        CHECK(found == !path.empty());
+        return path;
+    }
+};
+
+} // namespace
+
+TEST(IsDirectlySpawnableAcceptsOnlyBinaries) {
+    CHECK(IsDirectlySpawnable("C:\\Windows\\notepad.exe"));
+    CHECK(IsDirectlySpawnable("C:\\tools\\MORE.COM"));
+    CHECK(!IsDirectlySpawnable("C:\\tools\\build.bat"));
+    CHECK(!IsDirectlySpawnable("C:\\tools\\build.CMD"));
+    CHECK(!IsDirectlySpawnable("C:\\notes.txt"));
+    CHECK(!IsDirectlySpawnable("C:\\dir.exe\\app"));
+    CHECK(!IsDirectlySpawnable("ms-settings:display"));
+    CHECK(!IsDirectlySpawnable(""));
+}
+
+TEST(ExecutableResolverSearchesPathInOrder) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Program Files\\Tools\\git.exe");
+    machine.environment.AddFile("C:\\Users\\me\\bin\\git.exe");
+    machine.environment.AddFile("C:\\Users\\me\\bin\\rg.exe");
+
+    // The first PATH directory with the file wins; quoted and trailing
+    // backslash entries are joined like the others
+    CHECK_EQ("C:\\Program Files\\Tools\\git.exe", machine.Resolve("git.exe"));
+    CHECK_EQ("C:\\Users\\me\\bin\\rg.exe", machine.Resolve("rg.exe"));
+    CHECK_EQ("", machine.Resolve("missing.exe"));
+}
+
+TEST(ExecutableResolverCompletesBareNameFromPathExt) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Windows\\system32\\more.com");
+    machine.environment.AddFile("C:\\Windows\\system32\\more.exe");
+    machine.environment.AddFile("C:\\Users\\me\\bin\\code.EXE");
+
+    // PATHEXT order decides between extensions in one directory
+    CHECK_EQ("C:\\Windows\\system32\\more.COM", machine.Resolve("more"));
+    CHECK_EQ("C:\\Users\\me\\bin\\code.EXE", machine.Resolve("code"));
+
+    // Without PATHEXT, cmd.exe's default list is used
+    Machine bare;
+    bare.environment.SetVariable("PATHEXT", "");
+    bare.environment.AddFile("C:\\Users\\me\\bin\\code.exe");
+    CHECK_EQ("C:\\Users\\me\\bin\\code.EXE", bare.Resolve("code"));
+
+    // A name with an extension is also tried with PATHEXT appended
+    machine.environment.AddFile("C:\\Users\\me\\bin\\app.v2.exe");
+    CHECK_EQ("C:\\Users\\me\\bin\\app.v2.EXE", machine.Resolve("app.v2"));
+}
+
+TEST(ExecutableResolverFallsBackToAppPaths) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Program Files\\Mozilla Firefox\\firefox.exe");
+    machine.environment.SetAppPath("firefox.exe", "\"C:\\Program Files\\Mozilla Firefox\\firefox.exe\"");
+    machine.environment.SetAppPath("gone.exe", "C:\\Program Files\\Gone\\gone.exe");
+
+    CHECK_EQ("C:\\Program Files\\Mozilla Firefox\\firefox.exe", machine.Resolve("firefox"));
+    CHECK_EQ("C:\\Program Files\\Mozilla Firefox\\firefox.exe", machine.Resolve("firefox.exe"));
+
+    // A registration whose file is gone does not resolve
+    CHECK_EQ("", machine.Resolve("gone"));
+
+    // PATH comes first
+    machine.environment.AddFile("C:\\Users\\me\\bin\\firefox.exe");
+    machine.resolver.Invalidate();
+    CHECK_EQ("C:\\Users\\me\\bin\\firefox.exe", machine.Resolve("firefox.exe"));
+}
+
+TEST(ExecutableResolverLeavesScriptsAndUrisToShell) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Users\\me\\bin\\build.cmd");
+    machine.environment.AddFile("C:\\Users\\me\\bin\\deploy.bat");
+    machine.environment.AddFile("C:\\Users\\me\\notes.txt");
+
+    CHECK_EQ("", machine.Resolve("build"));
+    CHECK_EQ("", machine.Resolve("deploy.bat"));
+    CHECK_EQ("", machine.Resolve("C:\\Users\\me\\notes.txt"));
+    size_t probes = machine.environment.Probes();
+
+    // URIs are not looked for on disk at all
+    CHECK_EQ("", machine.Resolve("ms-settings:display"));
+    CHECK_EQ("", machine.Resolve("https://example.com/"));
+    CHECK_EQ("", machine.Resolve(""));
+    CHECK_EQ(probes, machine.environment.Probes());
+}
+
+TEST(ExecutableResolverTakesExplicitPathsAsGiven) {
+    Machine machine;
+    machine.environment.AddFile("D:\\portable\\tool.exe");
+    machine.environment.AddFile("C:\\Users\\me\\bin\\tool.exe");
+
+    CHECK_EQ("D:\\portable\\tool.exe", machine.Resolve("D:\\portable\\tool.exe"));
+    CHECK_EQ("D:\\portable\\tool.EXE", machine.Resolve("\"D:\\portable\\tool\""));
+    CHECK_EQ("", machine.Resolve("D:\\elsewhere\\tool.exe"));
+
+    // A long path has a colon too, but is no URI
+    machine.environment.AddFile("\\\\?\\D:\\portable\\tool.exe");
+    CHECK_EQ("\\\\?\\D:\\portable\\tool.exe", machine.Resolve("\\\\?\\D:\\portable\\tool.exe"));
+}
+
+TEST(ExecutableResolverCachesHitsAndMisses) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Users\\me\\bin\\rg.exe");
+
+    CHECK_EQ("C:\\Users\\me\\bin\\rg.exe", machine.Resolve("rg.exe"));
+    CHECK_EQ("", machine.Resolve("fd"));
+    size_t probes = machine.environment.Probes();
+
+    // Cached without case, misses included
+    CHECK_EQ("C:\\Users\\me\\bin\\rg.exe", machine.Resolve("RG.EXE"));
+    CHECK_EQ("", machine.Resolve("fd"));
+    CHECK_EQ(probes, machine.environment.Probes());
+
+    ExecutableResolver::Stats stats = machine.resolver.GetStats();
+    CHECK_EQ((uint64_t)2, stats.hits);
+    CHECK_EQ((uint64_t)2, stats.misses);
+
+    // A file that appears later is not seen until the cache is dropped
+    machine.environment.AddFile("C:\\Users\\me\\bin\\fd.exe");
+    CHECK_EQ("", machine.Resolve("fd"));
+}
+
+TEST(ExecutableResolverInvalidateAndForgetDropEntries) {
+    Machine machine;
+    machine.environment.AddFile("C:\\Users\\me\\bin\\fd.exe");
+    CHECK_EQ("", machine.Resolve("rg"));
+    CHECK_EQ("C:\\Users\\me\\bin\\fd.EXE", machine.Resolve("fd"));
+
+    machine.environment.AddFile("C:\\Users\\me\\bin\\rg.exe");
+    machine.resolver.Invalidate();
+    CHECK_EQ("C:\\Users\\me\\bin\\rg.EXE", machine.Resolve("rg"));
+    CHECK_EQ("C:\\Users\\me\\bin\\fd.EXE", machine.Resolve("fd"));
+    CHECK_EQ((uint64_t)1, machine.resolver.GetStats().invalidations);
+
+    // Forget drops one entry, whatever its case
+    machine.environment.SetVariable("PATH", "C:\\Windows\\system32");
+    machine.resolver.Forget("RG");
+    CHECK_EQ("", machine.Resolve("rg"));
+    CHECK_EQ("C:\\Users\\me\\bin\\fd.EXE", machine.Resolve("fd"));
+    CHECK_EQ((uint64_t)5, machine.resolver.GetStats().misses);
+}
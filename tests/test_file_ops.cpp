@@ -0,0 +1,70 @@
+#include "test.h"
+#include "config_persister.h"
+#include "fake_file_ops.h"
+#include "file_ops.h"
+#include <filesystem>
+
+TEST(WriteFileAtomicallyFlushesBeforeReplacing) {
+    FakeFileOps files;
+    files.SetFile("launcher.ini", "old");
+
+    CHECK(WriteFileAtomically(files, "launcher.ini", "new"));
+    CHECK_EQ("new", files.GetFile("launcher.ini"));
+    CHECK(!files.HasFile("launcher.ini.tmp"));
+    CHECK_EQ((size_t)0, files.UnflushedReplaces());
+}
+
+TEST(WriteFileAtomicallyKeepsOldFileWhenFlushFails) {
+    FakeFileOps files;
+    files.SetFile("launcher.ini", "old");
+    files.FailFlushes(true);
+
+    CHECK(!WriteFileAtomically(files, "launcher.ini", "new"));
+    CHECK_EQ("old", files.GetFile("launcher.ini"));
+    CHECK(!files.HasFile("launcher.ini.tmp"));
+}
+
+TEST(WriteFileAtomicallyKeepsOldFileWhenWriteDies) {
+    FakeFileOps files;
+    files.SetFile("launcher.ini", "old contents");
+    files.FailWritesAfter(3);
+
+    CHECK(!WriteFileAtomically(files, "launcher.ini", "new contents"));
+    CHECK_EQ("old contents", files.GetFile("launcher.ini"));
+    CHECK(!files.HasFile("launcher.ini.tmp"));
+}
+
+TEST(ConfigPersisterWritesFlushedFiles) {
+    FakeFileOps files;
+    files.SetFile("launcher.ini", "; kept\n[Settings]\ncheckMouseHover=true\n");
+
+    ConfigPersister persister(files, std::chrono::milliseconds(0));
+    persister.Start("launcher.ini", nullptr);
+    persister.Enqueue([](IniDocument& document) {
+        document.SetValue("Settings", "checkMouseHover", "false");
+    });
+    persister.Flush();
+    persister.Stop();
+
+    CHECK_EQ("; kept\n[Settings]\ncheckMouseHover=false\n", files.GetFile("launcher.ini"));
+    CHECK_EQ((size_t)0, files.UnflushedReplaces());
+}
+
+TEST(StdFileOpsWritesFlushesAndReplaces) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "launcher_tests_file_ops";
+    std::filesystem::create_directories(directory);
+    std::string path = (directory / "launcher.ini").string();
+
+    StdFileOps files;
+    CHECK(!files.FlushFile((directory / "missing").string()));
+    CHECK(WriteFileAtomically(files, path, "first"));
+    CHECK(WriteFileAtomically(files, path, "second"));
+
+    std::string contents;
+    CHECK(files.ReadFile(path, contents));
+    CHECK_EQ("second", contents);
+    CHECK(!std::filesystem::exists(path + ".tmp"));
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
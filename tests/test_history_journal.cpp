@@ -0,0 +1,202 @@
+#include "test.h"
+#include "history_journal.h"
+#include "fake_journal_file.h"
+
+namespace {
+
+const char kPath[] = "C:\\Users\\me\\AppData\\Local\\launcher\\history.bin";
+const int64_t kNow = 1700000000;
+
+// uses of app in directory per the table, 0 if it has no such entry
+uint32_t UsesOf(const FrecencyTable& table, const std::string& app, const std::string& directory) {
+    for (const FrecencyEntry& entry : table.Snapshot()) {
+        if (entry.app == app && entry.directory == directory) {
+            return entry.uses;
+        }
+    }
+    return 0;
+}
+
+std::string Journal(const std::vector<std::string>& records) {
+    std::string contents = EncodeHistoryHeader();
+    for (const std::string& record : records) {
+        contents += record;
+    }
+    return contents;
+}
+
+} // namespace
+
+TEST(HistoryJournalReplaysRecordedUses) {
+    FakeJournalFile file;
+    FrecencyTable table;
+    HistoryJournal journal(file, table);
+    REQUIRE(journal.Open(kPath));
+    CHECK_EQ(EncodeHistoryHeader(), file.GetFile(kPath));
+
+    journal.Record("Terminal", "C:\\src", kNow);
+    journal.Record("Terminal", "C:\\src", kNow + 60);
+    journal.Record("Editor", "D:\\notes", kNow + 120);
+    CHECK_EQ((uint64_t)3, journal.GetStats().appended);
+    CHECK_EQ((uint64_t)file.GetFile(kPath).size(), journal.FileSize());
+
+    FrecencyTable restored;
+    HistoryReplay replay = ReplayHistoryJournal(file.GetFile(kPath), restored);
+    CHECK(replay.headerValid);
+    CHECK_EQ(file.GetFile(kPath).size(), replay.validBytes);
+    CHECK_EQ(kHistoryHeaderSize, replay.entryBytes);
+    CHECK_EQ((size_t)3, replay.uses);
+    CHECK_EQ((uint32_t)2, UsesOf(restored, "Terminal", "C:\\src"));
+    CHECK_EQ((uint32_t)1, UsesOf(restored, "Editor", "D:\\notes"));
+    CHECK_EQ(table.Size(), restored.Size());
+}
+
+TEST(HistoryJournalStopsAtRecordFailingItsCrc) {
+    std::string first = EncodeHistoryUse("Terminal", "C:\\src", kNow);
+    std::string second = EncodeHistoryUse("Editor", "D:\\notes", kNow);
+    std::string third = EncodeHistoryUse("Browser", "C:\\web", kNow);
+    std::string contents = Journal({ first, second, third });
+
+    // One flipped bit in the second record's directory
+    contents[kHistoryHeaderSize + first.size() + second.size() - 1] ^= 0x01;
+
+    FrecencyTable table;
+    HistoryReplay replay = ReplayHistoryJournal(contents, table);
+    CHECK(replay.headerValid);
+    CHECK_EQ((size_t)1, replay.uses);
+    CHECK_EQ(kHistoryHeaderSize + first.size(), replay.validBytes);
+    CHECK_EQ((uint32_t)0, UsesOf(table, "Browser", "C:\\web"));
+
+    // Open cuts the file back to the last good record and appends after it
+    FakeJournalFile file;
+    file.SetFile(kPath, contents);
+    FrecencyTable opened;
+    HistoryJournal journal(file, opened);
+    REQUIRE(journal.Open(kPath));
+    CHECK_EQ(Journal({ first }), file.GetFile(kPath));
+    CHECK_EQ((uint64_t)1, journal.GetStats().repairs);
+
+    journal.Record("Editor", "D:\\notes", kNow + 60);
+    CHECK_EQ(Journal({ first, EncodeHistoryUse("Editor", "D:\\notes", kNow + 60) }), file.GetFile(kPath));
+}
+
+TEST(HistoryJournalStopsAtMalformedRecord) {
+    std::string first = EncodeHistoryUse("Terminal", "C:\\src", kNow);
+    std::string huge(8, '\0');
+    huge[0] = (char)0xFF;
+    huge[1] = (char)0xFF;
+    huge[2] = (char)0xFF;
+
+    FrecencyTable table;
+    CHECK_EQ(kHistoryHeaderSize + first.size(), ReplayHistoryJournal(Journal({ first, huge }), table).validBytes);
+    CHECK_EQ(kHistoryHeaderSize + first.size(), ReplayHistoryJournal(Journal({ first, std::string(8, '\0') }), table).validBytes);
+
+    // Names too long for the format are not journaled at all
+    CHECK(EncodeHistoryUse(std::string(65536, 'a'), "C:\\src", kNow).empty());
+    CHECK(!EncodeHistoryUse(std::string(65535, 'a'), "C:\\src", kNow).empty());
+}
+
+TEST(HistoryJournalTruncatesTornTail) {
+    std::string first = EncodeHistoryUse("Terminal", "C:\\src", kNow);
+    std::string second = EncodeHistoryUse("Editor", "D:\\notes", kNow);
+
+    // Every cut through the second record leaves only the first
+    for (size_t cut = 1; cut < second.size(); cut++) {
+        FakeJournalFile file;
+        file.SetFile(kPath, Journal({ first, second.substr(0, cut) }));
+        FrecencyTable table;
+        HistoryJournal journal(file, table);
+        REQUIRE(journal.Open(kPath));
+        CHECK_EQ(Journal({ first }), file.GetFile(kPath));
+        CHECK_EQ((uint64_t)1, journal.GetStats().repairs);
+        CHECK_EQ((uint32_t)0, UsesOf(table, "Editor", "D:\\notes"));
+    }
+}
+
+TEST(HistoryJournalCutsOffAppendTornMidWrite) {
+    FakeJournalFile file;
+    FrecencyTable table;
+    HistoryJournal journal(file, table);
+    REQUIRE(journal.Open(kPath));
+    journal.Record("Terminal", "C:\\src", kNow);
+
+    file.TearNextAppend(5);
+    journal.Record("Editor", "D:\\notes", kNow + 60);
+    CHECK_EQ((uint64_t)1, journal.GetStats().failures);
+    CHECK_EQ(Journal({ EncodeHistoryUse("Terminal", "C:\\src", kNow) }), file.GetFile(kPath));
+
+    // The table still has the use, and later records land after the good ones
+    CHECK_EQ((uint32_t)1, UsesOf(table, "Editor", "D:\\notes"));
+    journal.Record("Browser", "C:\\web", kNow + 120);
+    FrecencyTable restored;
+    HistoryReplay replay = ReplayHistoryJournal(file.GetFile(kPath), restored);
+    CHECK_EQ(file.GetFile(kPath).size(), replay.validBytes);
+    CHECK_EQ((size_t)2, replay.uses);
+}
+
+TEST(HistoryJournalStartsOverOnDamagedHeader) {
+    std::string contents = Journal({ EncodeHistoryUse("Terminal", "C:\\src", kNow) });
+    contents[4] = (char)(kHistoryVersion + 1);
+
+    FakeJournalFile file;
+    file.SetFile(kPath, contents);
+    FrecencyTable table;
+    HistoryJournal journal(file, table);
+    CHECK(!journal.Load(kPath));
+    CHECK_EQ((size_t)0, table.Size());
+
+    REQUIRE(journal.Open(kPath));
+    CHECK_EQ(EncodeHistoryHeader(), file.GetFile(kPath));
+    CHECK_EQ((uint64_t)1, journal.GetStats().repairs);
+
+    // A missing file is no repair
+    FakeJournalFile missing;
+    HistoryJournal fresh(missing, table);
+    REQUIRE(fresh.Open(kPath));
+    CHECK_EQ((uint64_t)0, fresh.GetStats().repairs);
+}
+
+TEST(HistoryJournalCompactionKeepsTable) {
+    FakeJournalFile file;
+    FrecencyTable table;
+    HistoryJournal journal(file, table, 512);
+    REQUIRE(journal.Open(kPath));
+    for (int i = 0; i < 40; i++) {
+        journal.Record(i % 2 ? "Terminal" : "Editor", i % 3 ? "C:\\src" : "D:\\notes", kNow + 60 * i);
+    }
+    CHECK(journal.GetStats().compactions > 0);
+    CHECK(journal.FileSize() <= 1024 + EncodeHistoryUse("Terminal", "C:\\src", kNow).size());
+
+    REQUIRE(journal.Compact());
+    std::string compacted = file.GetFile(kPath);
+    FrecencyTable restored;
+    HistoryReplay replay = ReplayHistoryJournal(compacted, restored);
+    CHECK_EQ((size_t)0, replay.uses);
+    CHECK_EQ(table.Size(), replay.entries);
+    CHECK_EQ(compacted.size(), replay.entryBytes);
+
+    std::vector<FrecencyEntry> expected = table.Snapshot();
+    REQUIRE(expected.size() == restored.Size());
+    for (const FrecencyEntry& entry : expected) {
+        CHECK_EQ(entry.uses, UsesOf(restored, entry.app, entry.directory));
+    }
+
+    // Uses after the compacted entries do not count towards entryBytes
+    journal.Record("Terminal", "C:\\src", kNow + 3600);
+    replay = ReplayHistoryJournal(file.GetFile(kPath), restored);
+    CHECK_EQ(compacted.size(), replay.entryBytes);
+    CHECK_EQ(file.GetFile(kPath).size(), replay.validBytes);
+}
+
+TEST(HistoryJournalClearEmptiesTableAndFile) {
+    FakeJournalFile file;
+    FrecencyTable table;
+    HistoryJournal journal(file, table);
+    REQUIRE(journal.Open(kPath));
+    journal.Record("Terminal", "C:\\src", kNow);
+
+    REQUIRE(journal.Clear());
+    CHECK_EQ((size_t)0, table.Size());
+    CHECK_EQ(EncodeHistoryHeader(), file.GetFile(kPath));
+    CHECK_EQ((uint64_t)kHistoryHeaderSize, journal.FileSize());
+}
@@ -0,0 +1,200 @@
+#include "test.h"
+#include "config_parser.h"
+#include "fake_hotkey_registrar.h"
+#include "hotkey_conflicts.h"
+#include <algorithm>
+
+namespace {
+
+const unsigned int kCtrlAlt = kModifierControl | kModifierAlt;
+const unsigned int kVkSpace = 0x20;
+
+AppConfig MakeApp(const std::string& name, unsigned int vkCode) {
+    AppConfig app;
+    app.name = name;
+    app.executable = name + ".exe";
+    app.modifiers = kCtrlAlt;
+    app.vkCode = vkCode;
+    return app;
+}
+
+// One reload as the launcher runs it: diff, retries, registration, status
+struct Reloader {
+    FakeHotkeyRegistrar registrar;
+    HotkeyStatus status;
+    std::shared_ptr<const ConfigSnapshot> config;
+    std::vector<const AppConfig*> failed;
+
+    void Reload(std::vector<AppConfig> apps) {
+        ConfigDiff diff = DiffConfig(config.get(), ConfigSnapshot::Compile(std::move(apps), Settings()));
+        status.AddRetries(*diff.config, diff.hotkeys);
+        registrar.RecordCalls();
+        failed = ApplyHotkeyPlan(diff.hotkeys, registrar);
+        status.Record(diff.hotkeys, failed);
+        config = diff.config;
+    }
+
+    HotkeyState StateOf(const std::string& name) const {
+        return status.StateOf(*config->FindByName(name));
+    }
+};
+
+} // namespace
+
+TEST(HotkeyIndexKeepsFirstOwnerPerBinding) {
+    KeyStroke plain(kCtrlAlt, 'L');
+    std::vector<KeyStroke> sequence = { KeyStroke(kCtrlAlt, 'L'), KeyStroke(0, 'P') };
+    std::vector<KeyStroke> other = { KeyStroke(kCtrlAlt, 'L'), KeyStroke(0, 'T') };
+
+    HotkeyIndex index;
+    CHECK_EQ(-1, index.Add(&plain, 1, 0));
+    CHECK_EQ(-1, index.Add(sequence.data(), sequence.size(), 1));
+    CHECK_EQ(-1, index.Add(other.data(), other.size(), 2));
+    CHECK_EQ(0, index.Add(&plain, 1, 3));
+    CHECK_EQ(1, index.Add(sequence.data(), sequence.size(), 4));
+    CHECK_EQ((size_t)3, index.Size());
+
+    // A sequence's first step is the plain binding, not the sequence
+    CHECK_EQ(0, index.Find(sequence.data(), 1));
+    CHECK_EQ(2, index.Find(other.data(), other.size()));
+    KeyStroke shifted(kCtrlAlt | kModifierShift, 'L');
+    CHECK_EQ(-1, index.Find(&shifted, 1));
+
+    index.Clear();
+    CHECK_EQ(-1, index.Find(&plain, 1));
+    CHECK_EQ((size_t)0, index.Size());
+}
+
+TEST(HotkeyStatusRecordsPartialRegistration) {
+    Reloader launcher;
+    launcher.registrar.Hold(kCtrlAlt, 'E');
+    launcher.Reload({ MakeApp("Terminal", 'T'), MakeApp("Editor", 'E'), MakeApp("Browser", 'B') });
+
+    // The refused hotkey does not stop the others
+    REQUIRE(launcher.failed.size() == 1);
+    CHECK_EQ("Editor", launcher.failed[0]->name);
+    CHECK_EQ((size_t)2, launcher.registrar.Registered());
+    CHECK_EQ((size_t)1, launcher.status.FailedCount());
+    CHECK(launcher.StateOf("Editor") == HotkeyState::Failed);
+    CHECK(launcher.StateOf("Terminal") == HotkeyState::Registered);
+    CHECK(launcher.StateOf("Browser") == HotkeyState::Registered);
+
+    const AppConfig& editor = *launcher.config->FindByName("Editor");
+    CHECK_EQ("Ctrl+Alt+E (in use)", FormatHotkeyStatus(editor, HotkeyState::Failed));
+    CHECK_EQ("- Ctrl+Alt+E for Editor\n", FormatHotkeyFailures(launcher.failed, nullptr, 5));
+}
+
+TEST(HotkeyStatusRetriesFailedHotkeysOnReload) {
+    Reloader launcher;
+    launcher.registrar.Hold(kCtrlAlt, 'E');
+    launcher.Reload({ MakeApp("Terminal", 'T'), MakeApp("Editor", 'E') });
+    int editorId = launcher.config->FindByName("Editor")->hotkeyId;
+
+    // Nothing changed, but the refused hotkey is asked for again
+    launcher.Reload({ MakeApp("Terminal", 'T'), MakeApp("Editor", 'E') });
+    REQUIRE(launcher.registrar.Calls().size() == 1);
+    CHECK(launcher.registrar.Calls()[0] == HotkeyCall({ true, editorId }));
+    CHECK(launcher.StateOf("Editor") == HotkeyState::Failed);
+
+    launcher.registrar.Release(kCtrlAlt, 'E');
+    launcher.Reload({ MakeApp("Terminal", 'T'), MakeApp("Editor", 'E') });
+    CHECK(launcher.failed.empty());
+    CHECK(launcher.registrar.IsRegistered(editorId, kCtrlAlt, 'E'));
+    CHECK(launcher.StateOf("Editor") == HotkeyState::Registered);
+    CHECK_EQ((size_t)0, launcher.status.FailedCount());
+
+    launcher.Reload({ MakeApp("Terminal", 'T'), MakeApp("Editor", 'E') });
+    CHECK(launcher.registrar.Calls().empty());
+}
+
+TEST(HotkeyStatusDoesNotRetryChangedOrDisabledApps) {
+    Reloader launcher;
+    launcher.registrar.Hold(kCtrlAlt, 'E');
+    launcher.registrar.Hold(kCtrlAlt, 'B');
+    launcher.Reload({ MakeApp("Editor", 'E'), MakeApp("Browser", 'B') });
+    CHECK_EQ((size_t)2, launcher.status.FailedCount());
+
+    // A new binding is registered once by the plan, not again as a retry;
+    // a disabled app is not registered at all
+    AppConfig browser = MakeApp("Browser", 'B');
+    browser.enabled = false;
+    launcher.Reload({ MakeApp("Editor", 'R'), browser });
+    int editorId = launcher.config->FindByName("Editor")->hotkeyId;
+    CHECK_EQ((std::ptrdiff_t)1, std::count(launcher.registrar.Calls().begin(), launcher.registrar.Calls().end(),
+        HotkeyCall({ true, editorId })));
+    CHECK(launcher.failed.empty());
+    CHECK(launcher.StateOf("Editor") == HotkeyState::Registered);
+    CHECK(launcher.StateOf("Browser") == HotkeyState::Disabled);
+}
+
+TEST(ParseConfigDisablesLaterDuplicateHotkey) {
+    ConfigParseResult result = ParseConfig(
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T\n"
+        "Editor=code.exe|false||Ctrl+Alt+E\n"
+        "Console=cmd.exe|false||Ctrl+Alt+T\n"
+        "Tasks=taskmgr.exe|false||Ctrl+Alt+E\n",
+        ParseHotkeyUsLayout);
+    REQUIRE(result.config != nullptr);
+    CHECK(result.config->FindByName("Terminal")->enabled);
+    CHECK(result.config->FindByName("Editor")->enabled);
+    CHECK(!result.config->FindByName("Console")->enabled);
+    CHECK(!result.config->FindByName("Tasks")->enabled);
+
+    REQUIRE(result.diagnostics.size() == 2);
+    CHECK_EQ(4, result.diagnostics[0].line);
+    CHECK_EQ("hotkey 'Ctrl+Alt+T' is already used by 'Terminal' on line 2; 'Console' is disabled",
+        result.diagnostics[0].message);
+    CHECK_EQ(5, result.diagnostics[1].line);
+
+    // Only the first owners are registered, so nothing is refused
+    FakeHotkeyRegistrar registrar;
+    ConfigDiff diff = DiffConfig(nullptr, result.config);
+    CHECK_EQ((size_t)2, diff.hotkeys.registerApps.size());
+    CHECK(ApplyHotkeyPlan(diff.hotkeys, registrar).empty());
+}
+
+TEST(ParseConfigIgnoresReplacedAndDisabledEntriesForConflicts) {
+    // The first Terminal is replaced by the later one of the same name, and
+    // a disabled entry holds no binding
+    ConfigParseResult result = ParseConfig(
+        "[Apps]\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+T\n"
+        "Old=old.exe|false||Ctrl+Alt+E|false\n"
+        "Console=cmd.exe|false||Ctrl+Alt+T\n"
+        "Terminal=wt.exe|false||Ctrl+Alt+W\n"
+        "Editor=code.exe|false||Ctrl+Alt+E\n",
+        ParseHotkeyUsLayout);
+    REQUIRE(result.config != nullptr);
+    REQUIRE(result.diagnostics.size() == 1);
+    CHECK_EQ("'Terminal' is defined again; the entry on line 2 is ignored", result.diagnostics[0].message);
+    CHECK(result.config->FindByName("Console")->enabled);
+    CHECK(result.config->FindByName("Editor")->enabled);
+}
+
+TEST(HotkeyStatusStatesOfUnregisteredApps) {
+    HotkeyStatus status;
+    AppConfig none = MakeApp("Notes", 0);
+    AppConfig disabled = MakeApp("Editor", 'E');
+    disabled.enabled = false;
+    AppConfig sequence = MakeApp("Layout", 'L');
+    sequence.sequence = { KeyStroke(kCtrlAlt, 'L'), KeyStroke(0, 'P') };
+
+    CHECK(status.StateOf(none) == HotkeyState::None);
+    CHECK(status.StateOf(disabled) == HotkeyState::Disabled);
+    CHECK(status.StateOf(sequence) == HotkeyState::Sequence);
+    CHECK_EQ("no hotkey", FormatHotkeyStatus(none, HotkeyState::None));
+    CHECK_EQ("Ctrl+Alt+L, P", FormatHotkeyStatus(sequence, HotkeyState::Sequence));
+}
+
+TEST(FormatHotkeyFailuresTruncatesAndListsPaletteLast) {
+    AppConfig terminal = MakeApp("Terminal", 'T');
+    AppConfig editor = MakeApp("Editor", 'E');
+    KeyStroke palette(kCtrlAlt, kVkSpace);
+    std::vector<const AppConfig*> failed = { &terminal, &editor };
+
+    CHECK_EQ("- Ctrl+Alt+T for Terminal\n- Ctrl+Alt+E for Editor\n- Ctrl+Alt+Space for the palette\n",
+        FormatHotkeyFailures(failed, &palette, 5));
+    CHECK_EQ("- Ctrl+Alt+T for Terminal\n- ... and 2 more\n", FormatHotkeyFailures(failed, &palette, 1));
+    CHECK_EQ("", FormatHotkeyFailures({}, nullptr, 5));
+}
@@ -0,0 +1,232 @@
+#include "test.h"
+#include "instance_ipc.h"
+#include "fake_ipc_stream.h"
+
+namespace {
+
+// Records what the dispatcher asked for and answers with its name
+class RecordingCommands : public IInstanceCommands {
+public:
+    IpcResponse Launch(const std::string& appName) override {
+        calls.push_back("launch " + appName);
+        return IpcResponse(true, "launched " + appName);
+    }
+
+    IpcResponse LaunchDefault() override {
+        calls.push_back("launch-default");
+        return IpcResponse(false, "already launching");
+    }
+
+    IpcResponse PrintContext() override {
+        calls.push_back("print-context");
+        return IpcResponse(true, "{}");
+    }
+
+    IpcResponse History(size_t count) override {
+        calls.push_back("history " + std::to_string(count));
+        return IpcResponse(true, "[]");
+    }
+
+    std::vector<std::string> calls;
+};
+
+// A frame header announcing size bytes
+std::string FrameHeader(uint32_t size) {
+    std::string header;
+    for (int i = 0; i < 4; i++) {
+        header += (char)((size >> (8 * i)) & 0xFF);
+    }
+    return header;
+}
+
+// Reads one message from bytes a peer sent, readLimit bytes at a time
+bool ReadFrom(const std::string& bytes, size_t readLimit, std::string& payload) {
+    LoopbackIpcPair pair;
+    pair.toServer = bytes;
+    pair.server.LimitReads(readLimit);
+    return ReadIpcMessage(pair.server, payload);
+}
+
+// The response a dispatcher gives to request
+IpcResponse Dispatch(RecordingCommands& commands, IpcCommand command, const std::string& argument) {
+    return IpcDispatcher(commands).Dispatch(IpcRequest(command, argument));
+}
+
+} // namespace
+
+TEST(IpcRequestsAndResponsesRoundTrip) {
+    LoopbackIpcPair pair;
+    RecordingCommands commands;
+    CHECK(WriteIpcMessage(pair.client, EncodeIpcRequest(IpcRequest(IpcCommand::Launch, "Terminal"))));
+    CHECK(WriteIpcMessage(pair.client, EncodeIpcRequest(IpcRequest(IpcCommand::LaunchDefault, ""))));
+    CHECK(WriteIpcMessage(pair.client, EncodeIpcRequest(IpcRequest(IpcCommand::History, "5"))));
+
+    // Serve answers every queued request, in order, then sees the hang-up
+    IpcDispatcher(commands).Serve(pair.server);
+    REQUIRE(commands.calls.size() == 3);
+    CHECK_EQ("launch Terminal", commands.calls[0]);
+    CHECK_EQ("launch-default", commands.calls[1]);
+    CHECK_EQ("history 5", commands.calls[2]);
+
+    const IpcResponse expected[] = {
+        IpcResponse(true, "launched Terminal"),
+        IpcResponse(false, "already launching"),
+        IpcResponse(true, "[]"),
+    };
+    for (const IpcResponse& want : expected) {
+        std::string payload;
+        IpcResponse response;
+        REQUIRE(ReadIpcMessage(pair.client, payload));
+        REQUIRE(DecodeIpcResponse(payload, response));
+        CHECK_EQ(want.ok, response.ok);
+        CHECK_EQ(want.body, response.body);
+    }
+}
+
+TEST(CallInstanceWritesRequestAndReadsAnswer) {
+    LoopbackIpcPair pair;
+    CHECK(WriteIpcMessage(pair.server, EncodeIpcResponse(IpcResponse(true, "line one\nline two"))));
+
+    IpcResponse response;
+    REQUIRE(CallInstance(pair.client, IpcRequest(IpcCommand::PrintContext, ""), response));
+    CHECK(response.ok);
+    CHECK_EQ("line one\nline two", response.body);
+
+    std::string payload;
+    REQUIRE(ReadIpcMessage(pair.server, payload));
+    CHECK_EQ("print-context\n", payload);
+
+    // No answer queued: the call fails rather than inventing one
+    CHECK(!CallInstance(pair.client, IpcRequest(IpcCommand::PrintContext, ""), response));
+}
+
+TEST(IpcMessagesLargerThanLimitAreRejected) {
+    LoopbackIpcPair pair;
+    std::string payload;
+
+    CHECK(!WriteIpcMessage(pair.client, std::string(kMaxIpcMessage + 1, 'x')));
+    CHECK(pair.toServer.empty());
+    CHECK(WriteIpcMessage(pair.client, std::string(kMaxIpcMessage, 'x')));
+    CHECK(ReadIpcMessage(pair.server, payload));
+    CHECK_EQ((size_t)kMaxIpcMessage, payload.size());
+
+    // A peer announcing more is treated as broken before anything is allocated
+    CHECK(!ReadFrom(FrameHeader(kMaxIpcMessage + 1) + "x", 0, payload));
+    CHECK(!ReadFrom(FrameHeader(0xFFFFFFFF), 0, payload));
+
+    // An empty frame is fine
+    CHECK(ReadFrom(FrameHeader(0), 0, payload));
+    CHECK(payload.empty());
+}
+
+TEST(ReadIpcMessageAssemblesShortReads) {
+    LoopbackIpcPair pair;
+    pair.server.LimitReads(1);
+    CHECK(WriteIpcMessage(pair.client, "history\n12"));
+    CHECK(WriteIpcMessage(pair.client, "launch\nEditor"));
+
+    std::string payload;
+    CHECK(ReadIpcMessage(pair.server, payload));
+    CHECK_EQ("history\n12", payload);
+    CHECK(ReadIpcMessage(pair.server, payload));
+    CHECK_EQ("launch\nEditor", payload);
+
+    // A peer that hangs up inside the header or the payload gives no message
+    CHECK(!ReadFrom(FrameHeader(10).substr(0, 2), 3, payload));
+    CHECK(!ReadFrom(FrameHeader(10) + "launch\n", 3, payload));
+    CHECK(ReadFrom(FrameHeader(10) + "launch\nVim", 3, payload));
+    CHECK_EQ("launch\nVim", payload);
+}
+
+TEST(DecodeIpcRejectsUnknownCommandsAndStatuses) {
+    CHECK(IpcCommand::Unknown == DecodeIpcRequest("reboot\nnow").command);
+    CHECK(IpcCommand::Unknown == DecodeIpcRequest("").command);
+    CHECK(IpcCommand::Unknown == DecodeIpcRequest("Launch\nTerminal").command);
+    CHECK(IpcCommand::Launch == DecodeIpcRequest("launch\nTerminal").command);
+    CHECK_EQ("Terminal\nEditor", DecodeIpcRequest("launch\nTerminal\nEditor").argument);
+    CHECK_EQ("", DecodeIpcRequest("print-context").argument);
+
+    IpcResponse response;
+    CHECK(!DecodeIpcResponse("ok", response));
+    CHECK(!DecodeIpcResponse("maybe\nsomething", response));
+    CHECK(DecodeIpcResponse("error\n", response));
+    CHECK(!response.ok);
+}
+
+TEST(IpcDispatcherAnswersUnknownCommandsWithError) {
+    RecordingCommands commands;
+    IpcDispatcher dispatcher(commands);
+
+    IpcResponse response = dispatcher.Dispatch(DecodeIpcRequest("reboot\nnow"));
+    CHECK(!response.ok);
+    CHECK_EQ("unknown command", response.body);
+
+    response = Dispatch(commands, IpcCommand::Launch, "");
+    CHECK(!response.ok);
+    CHECK_EQ("missing app name", response.body);
+    CHECK(commands.calls.empty());
+}
+
+TEST(IpcDispatcherValidatesHistoryCount) {
+    RecordingCommands commands;
+    CHECK(Dispatch(commands, IpcCommand::History, "").ok);
+    CHECK(Dispatch(commands, IpcCommand::History, "1").ok);
+    CHECK(Dispatch(commands, IpcCommand::History, "007").ok);
+    CHECK(Dispatch(commands, IpcCommand::History, std::to_string(kMaxHistoryCount)).ok);
+    REQUIRE(commands.calls.size() == 4);
+    CHECK_EQ("history " + std::to_string(kDefaultHistoryCount), commands.calls[0]);
+    CHECK_EQ("history 1", commands.calls[1]);
+    CHECK_EQ("history 7", commands.calls[2]);
+    CHECK_EQ("history " + std::to_string(kMaxHistoryCount), commands.calls[3]);
+
+    // Out of range, not a number, or large enough to overflow: refused
+    // without reaching the instance
+    const char* invalid[] = { "0", "101", "-1", "+5", " 5", "5 ", "ten", "1e2", "99999999999999999999999" };
+    for (const char* count : invalid) {
+        IpcResponse response = Dispatch(commands, IpcCommand::History, count);
+        CHECK(!response.ok);
+        CHECK_EQ("history count must be a number from 1 to 100", response.body);
+    }
+    CHECK_EQ((size_t)4, commands.calls.size());
+}
+
+TEST(FormatLaunchContextJsonEscapesDirectory) {
+    CHECK_EQ("{\"directory\": \"C:\\\\Users\\\\me\\\\\\\"quoted\\\"\\u0009tab\", \"hoverWindow\": 12, \"focusWindow\": 0}",
+        FormatLaunchContextJson("C:\\Users\\me\\\"quoted\"\ttab", 12, kNoWindow));
+}
+
+TEST(FormatJsonKeepsUtf8AndReplacesOtherBytes) {
+    // Valid sequences of two, three and four bytes pass through
+    CHECK_EQ("{\"directory\": \"C:\\\\Zo\xC3\xAB\\\\\xE6\x96\x87\xE6\xA1\xA3\\\\\xF0\x9F\x93\x81\", \"hoverWindow\": 0, \"focusWindow\": 0}",
+        FormatLaunchContextJson("C:\\Zo\xC3\xAB\\\xE6\x96\x87\xE6\xA1\xA3\\\xF0\x9F\x93\x81", kNoWindow, kNoWindow));
+
+    // A code page byte, a stray continuation byte, an overlong '/', a
+    // surrogate and a sequence cut short at the end
+    const std::string invalid = "Zo\xEB|\x80|\xC0\xAF|\xED\xA0\x80|\xE6\x96";
+    CHECK_EQ("{\"directory\": \"Zo\\ufffd|\\ufffd|\\ufffd\\ufffd|\\ufffd\\ufffd\\ufffd|\\ufffd\\ufffd\", \"hoverWindow\": 0, \"focusWindow\": 0}",
+        FormatLaunchContextJson(invalid, kNoWindow, kNoWindow));
+}
+
+TEST(FormatHistoryJsonListsEntriesInOrder) {
+    CHECK_EQ("[]", FormatHistoryJson(std::vector<FrecencyEntry>(), 0));
+
+    FrecencyEntry terminal;
+    terminal.app = "Terminal";
+    terminal.directory = "C:\\src\\caf\xE9";
+    terminal.score = 2;
+    terminal.lastUsed = 1000;
+    terminal.uses = 3;
+    FrecencyEntry editor;
+    editor.app = "Editor";
+    editor.directory = "C:\\src";
+    editor.score = 1;
+    editor.lastUsed = 1000;
+    editor.uses = 1;
+
+    CHECK_EQ(
+        "[\n"
+        "  {\"app\": \"Terminal\", \"directory\": \"C:\\\\src\\\\caf\\ufffd\", \"score\": 2.000, \"uses\": 3, \"lastUsed\": 1000},\n"
+        "  {\"app\": \"Editor\", \"directory\": \"C:\\\\src\", \"score\": 1.000, \"uses\": 1, \"lastUsed\": 1000}\n"
+        "]",
+        FormatHistoryJson({ terminal, editor }, 1000));
+}
@@ -0,0 +1,211 @@
+#include "test.h"
+#include "key_sequence.h"
+
+namespace {
+
+const unsigned int kCtrlAlt = kModifierControl | kModifierAlt;
+const unsigned int kVkControl = 0x11;
+const unsigned int kVkEscape = 0x1B;
+const unsigned int kVkG = 0x47;
+const unsigned int kVkL = 0x4C;
+const unsigned int kVkP = 0x50;
+const unsigned int kVkT = 0x54;
+const unsigned int kVkX = 0x58;
+
+SequenceTrie::Binding Bind(int hotkeyId, std::vector<KeyStroke> steps) {
+    return SequenceTrie::Binding { std::move(steps), hotkeyId };
+}
+
+// Events carry their own time, so timeouts need no sleeping
+struct Keyboard {
+    SequenceMatcher matcher;
+    std::chrono::steady_clock::time_point now;
+    int hotkeyId;
+
+    explicit Keyboard(std::shared_ptr<const SequenceTrie> trie)
+        : now(std::chrono::steady_clock::now()), hotkeyId(0) {
+        matcher.SetTrie(std::move(trie));
+    }
+
+    KeyAction Down(unsigned int modifiers, unsigned int vkCode, int afterMs = 10) {
+        now += std::chrono::milliseconds(afterMs);
+        return matcher.OnKey(KeyEvent(vkCode, modifiers, true, now), hotkeyId);
+    }
+
+    KeyAction Up(unsigned int modifiers, unsigned int vkCode) {
+        now += std::chrono::milliseconds(10);
+        return matcher.OnKey(KeyEvent(vkCode, modifiers, false, now), hotkeyId);
+    }
+
+    // Down and up; the action of the key-down
+    KeyAction Press(unsigned int modifiers, unsigned int vkCode, int afterMs = 10) {
+        KeyAction action = Down(modifiers, vkCode, afterMs);
+        int id = hotkeyId;
+        Up(modifiers, vkCode);
+        hotkeyId = id;
+        return action;
+    }
+};
+
+std::shared_ptr<const SequenceTrie> LayoutTrie() {
+    return SequenceTrie::Build({
+        Bind(1, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkP) }),
+        Bind(2, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkT) }),
+        Bind(3, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkG), KeyStroke(0, kVkG) }),
+        Bind(4, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(kModifierControl, kVkP) }),
+    }, std::chrono::milliseconds(500));
+}
+
+} // namespace
+
+TEST(SequenceTrieFindsEdgesInAnyOrder) {
+    std::shared_ptr<const SequenceTrie> trie = LayoutTrie();
+    REQUIRE(!trie->Empty());
+    CHECK_EQ((size_t)7, trie->NodeCount());
+    CHECK_EQ((long long)500, (long long)trie->StepTimeout().count());
+
+    uint32_t lead = trie->Find(kSequenceRoot, KeyStroke(kCtrlAlt, kVkL));
+    REQUIRE(lead != kNoSequenceNode);
+    CHECK_EQ(0, trie->HotkeyIdAt(lead));
+    CHECK_EQ(1, trie->HotkeyIdAt(trie->Find(lead, KeyStroke(0, kVkP))));
+    CHECK_EQ(2, trie->HotkeyIdAt(trie->Find(lead, KeyStroke(0, kVkT))));
+    CHECK_EQ(4, trie->HotkeyIdAt(trie->Find(lead, KeyStroke(kModifierControl, kVkP))));
+    uint32_t g = trie->Find(lead, KeyStroke(0, kVkG));
+    REQUIRE(g != kNoSequenceNode);
+    CHECK_EQ(3, trie->HotkeyIdAt(trie->Find(g, KeyStroke(0, kVkG))));
+
+    CHECK(trie->Find(kSequenceRoot, KeyStroke(0, kVkL)) == kNoSequenceNode);
+    CHECK(trie->Find(lead, KeyStroke(kCtrlAlt, kVkP)) == kNoSequenceNode);
+    CHECK(trie->Find(lead, KeyStroke(0, kVkX)) == kNoSequenceNode);
+}
+
+TEST(SequenceTrieLeavesOutSequencesThatNeverComplete) {
+    std::shared_ptr<const SequenceTrie> trie = SequenceTrie::Build({
+        Bind(1, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkP), KeyStroke(0, kVkP) }),
+        Bind(2, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkP) }),
+        Bind(3, { KeyStroke(kCtrlAlt, kVkL), KeyStroke(0, kVkP) }),
+        Bind(4, {}),
+        Bind(0, { KeyStroke(kCtrlAlt, kVkT) }),
+    }, std::chrono::milliseconds(500));
+
+    // The shorter sequence fires first, and of equal ones the first wins
+    uint32_t lead = trie->Find(kSequenceRoot, KeyStroke(kCtrlAlt, kVkL));
+    uint32_t p = trie->Find(lead, KeyStroke(0, kVkP));
+    CHECK_EQ(2, trie->HotkeyIdAt(p));
+    CHECK(trie->Find(p, KeyStroke(0, kVkP)) == kNoSequenceNode);
+    CHECK(trie->Find(kSequenceRoot, KeyStroke(kCtrlAlt, kVkT)) == kNoSequenceNode);
+    CHECK_EQ((size_t)3, trie->NodeCount());
+
+    CHECK(SequenceTrie::Build({}, std::chrono::milliseconds(500))->Empty());
+}
+
+TEST(SequenceMatcherSwallowsSequenceWithModifiersHeld) {
+    Keyboard keyboard(LayoutTrie());
+
+    CHECK(keyboard.Down(kModifierControl, kVkControl) == KeyAction::Pass);
+    CHECK(keyboard.Press(kCtrlAlt, kVkL) == KeyAction::Swallow);
+    CHECK_EQ(0, keyboard.hotkeyId);
+    CHECK(keyboard.matcher.InSequence());
+
+    // Ctrl+Alt are still down for the second step
+    CHECK(keyboard.Press(kCtrlAlt, kVkP) == KeyAction::Swallow);
+    CHECK_EQ(1, keyboard.hotkeyId);
+    CHECK(!keyboard.matcher.InSequence());
+
+    // A step that names its modifiers is matched exactly
+    keyboard.Press(kCtrlAlt, kVkL);
+    CHECK(keyboard.Press(kModifierControl, kVkP) == KeyAction::Swallow);
+    CHECK_EQ(4, keyboard.hotkeyId);
+
+    keyboard.Press(kCtrlAlt, kVkL);
+    keyboard.Press(0, kVkG);
+    CHECK(keyboard.Press(0, kVkG) == KeyAction::Swallow);
+    CHECK_EQ(3, keyboard.hotkeyId);
+
+    SequenceMatcher::Stats stats = keyboard.matcher.GetStats();
+    CHECK_EQ((uint64_t)3, stats.sequences);
+    CHECK_EQ((uint64_t)3, stats.matches);
+    CHECK_EQ((uint64_t)0, stats.cancels);
+}
+
+TEST(SequenceMatcherSwallowsRepeatsAndKeyUpOfSwallowedKeys) {
+    Keyboard keyboard(LayoutTrie());
+
+    CHECK(keyboard.Down(kCtrlAlt, kVkL) == KeyAction::Swallow);
+    CHECK(keyboard.Down(kCtrlAlt, kVkL, 30) == KeyAction::Swallow);
+    CHECK(keyboard.Down(kCtrlAlt, kVkL, 30) == KeyAction::Swallow);
+    CHECK(keyboard.matcher.InSequence());
+    CHECK(keyboard.Up(kCtrlAlt, kVkL) == KeyAction::Swallow);
+
+    // Keys that were passed have their key-up passed too
+    CHECK(keyboard.Up(0, kVkX) == KeyAction::Pass);
+    CHECK(keyboard.Press(0, kVkT) == KeyAction::Swallow);
+    CHECK_EQ(2, keyboard.hotkeyId);
+    CHECK_EQ((uint64_t)1, keyboard.matcher.GetStats().sequences);
+}
+
+TEST(SequenceMatcherStartsOverOnKeyThatFitsNoSequence) {
+    Keyboard keyboard(LayoutTrie());
+
+    CHECK(keyboard.Press(0, kVkX) == KeyAction::Pass);
+    CHECK(keyboard.Press(0, kVkP) == KeyAction::Pass);
+
+    keyboard.Press(kCtrlAlt, kVkL);
+    CHECK(keyboard.Press(0, kVkX) == KeyAction::Pass);
+    CHECK(!keyboard.matcher.InSequence());
+    CHECK(keyboard.Press(0, kVkP) == KeyAction::Pass);
+
+    // The breaking key may start the next sequence
+    keyboard.Press(kCtrlAlt, kVkL);
+    CHECK(keyboard.Press(0, kVkG) == KeyAction::Swallow);
+    CHECK(keyboard.Press(kCtrlAlt, kVkL) == KeyAction::Swallow);
+    CHECK(keyboard.matcher.InSequence());
+    CHECK(keyboard.Press(0, kVkT) == KeyAction::Swallow);
+    CHECK_EQ(2, keyboard.hotkeyId);
+    CHECK_EQ((uint64_t)2, keyboard.matcher.GetStats().cancels);
+}
+
+TEST(SequenceMatcherEscapeCancelsAndIsSwallowed) {
+    Keyboard keyboard(LayoutTrie());
+    CHECK(keyboard.Press(0, kVkEscape) == KeyAction::Pass);
+
+    keyboard.Press(kCtrlAlt, kVkL);
+    CHECK(keyboard.Down(0, kVkEscape) == KeyAction::Swallow);
+    CHECK(!keyboard.matcher.InSequence());
+    CHECK(keyboard.Up(0, kVkEscape) == KeyAction::Swallow);
+    CHECK(keyboard.Press(0, kVkP) == KeyAction::Pass);
+    CHECK_EQ(0, keyboard.hotkeyId);
+    CHECK_EQ((uint64_t)1, keyboard.matcher.GetStats().cancels);
+}
+
+TEST(SequenceMatcherTimesOutBetweenSteps) {
+    Keyboard keyboard(LayoutTrie());
+
+    keyboard.Press(kCtrlAlt, kVkL);
+    CHECK(keyboard.Press(0, kVkG, 490) == KeyAction::Swallow);
+    CHECK(keyboard.matcher.InSequence());
+
+    // The timeout counts from the last step, not the first
+    CHECK(keyboard.Press(0, kVkG, 510) == KeyAction::Pass);
+    CHECK_EQ(0, keyboard.hotkeyId);
+    CHECK(!keyboard.matcher.InSequence());
+
+    SequenceMatcher::Stats stats = keyboard.matcher.GetStats();
+    CHECK_EQ((uint64_t)1, stats.timeouts);
+    CHECK_EQ((uint64_t)0, stats.matches);
+}
+
+TEST(SequenceMatcherPassesEverythingWithoutTrie) {
+    Keyboard keyboard(nullptr);
+    CHECK(keyboard.Press(kCtrlAlt, kVkL) == KeyAction::Pass);
+
+    // A new trie starts over
+    keyboard.matcher.SetTrie(LayoutTrie());
+    keyboard.Press(kCtrlAlt, kVkL);
+    keyboard.matcher.SetTrie(LayoutTrie());
+    CHECK(!keyboard.matcher.InSequence());
+    CHECK(keyboard.Press(0, kVkP) == KeyAction::Pass);
+
+    keyboard.matcher.SetTrie(SequenceTrie::Build({}, std::chrono::milliseconds(500)));
+    CHECK(keyboard.Press(kCtrlAlt, kVkL) == KeyAction::Pass);
+}
@@ -0,0 +1,43 @@
+#include "test.h"
+#include "latency_stats.h"
+
+TEST(LatencyHistogramPercentilesStayWithinBucket) {
+    LatencyHistogram histogram;
+    for (uint64_t micros = 1; micros <= 1000; micros++) {
+        histogram.Record(micros);
+    }
+    CHECK_EQ((uint64_t)1000, histogram.Count());
+    CHECK_EQ((uint64_t)1000, histogram.Max());
+
+    // Log-linear buckets are within 25% of the true value
+    uint64_t p50 = histogram.Percentile(50);
+    CHECK(p50 >= 500 && p50 <= 625);
+    CHECK(histogram.Percentile(100) >= 1000);
+    CHECK_EQ((uint64_t)7, LatencyHistogram::BucketUpperBound(LatencyHistogram::BucketOf(7)));
+}
+
+TEST(LaunchTraceKeepsTemporaryAppName) {
+    LatencyRecorder recorder;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    {
+        LaunchTrace trace(&recorder, std::string("Terminal"), start);
+        // The temporary is gone by now; the trace must not refer to it
+        trace.Mark(LaunchStage::Resolve);
+        trace.RecordSince(LaunchStage::Total, start);
+    }
+
+    size_t apps = 0;
+    recorder.ForEachApp([&apps](const std::string& app, const LatencyHistogram* stages) {
+        apps++;
+        CHECK_EQ("Terminal", app);
+        CHECK_EQ((uint64_t)1, stages[(size_t)LaunchStage::Resolve].Count());
+        CHECK_EQ((uint64_t)1, stages[(size_t)LaunchStage::Total].Count());
+    });
+    CHECK_EQ((size_t)1, apps);
+}
+
+TEST(LaunchTraceWithoutRecorderRecordsNothing) {
+    LaunchTrace trace(nullptr, std::string(), std::chrono::steady_clock::now());
+    trace.Mark(LaunchStage::Spawn);
+    trace.RecordSince(LaunchStage::Total, std::chrono::steady_clock::now());
+}
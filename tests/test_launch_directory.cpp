@@ -0,0 +1,135 @@
+#include "test.h"
+#include "fake_context_provider.h"
+#include "fake_directory_probe.h"
+#include "fake_process_table.h"
+#include "launch_directory.h"
+
+namespace {
+
+const WindowHandle kHoverExplorer = 0x1000;
+const WindowHandle kFocusExplorer = 0x2000;
+const WindowHandle kHoverListView = 0x1001;
+const WindowHandle kEditor = 0x3000;
+
+const char kHome[] = "C:\\Users\\me";
+
+// Explorer windows only; the editor is claimed by nobody
+struct Desktop {
+    FakeProcessTable processes;
+    FakeContextProvider explorer;
+    ContextProviderRegistry providers;
+    FakeDirectoryProbe directories;
+    DirectoryReachability reachability;
+
+    explicit Desktop(std::chrono::milliseconds offlineDelay = std::chrono::milliseconds(0))
+        : providers(processes, []() { return std::string(kHome); }), directories(offlineDelay),
+          reachability(directories, std::chrono::seconds(30), std::chrono::seconds(10)) {
+        explorer.AddWindow(kHoverExplorer, "C:\\src\\project");
+        explorer.AddWindow(kFocusExplorer, "D:\\downloads");
+        directories.AddDirectory("C:\\src\\project");
+        directories.AddDirectory("D:\\downloads");
+        explorer.AddChild(kHoverListView, kHoverExplorer);
+        providers.Add("explorer", explorer, ContextProviderOptions());
+        explorer.RecordQueries();
+    }
+
+    std::string Resolve(const Settings& settings, WindowHandle hover, WindowHandle focus,
+        ContextClaim* source = nullptr) {
+        LaunchTrace trace(nullptr, std::string(), std::chrono::steady_clock::now());
+        return GetLaunchDirectory(settings, hover, focus, providers, reachability, trace, source);
+    }
+};
+
+long long MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return (long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+TEST(LaunchDirectoryHoverWinsAndFocusIsNotQueried) {
+    Desktop desktop;
+    ContextClaim source;
+    CHECK_EQ("C:\\src\\project", desktop.Resolve(Settings(), kHoverListView, kFocusExplorer, &source));
+    CHECK(desktop.explorer.Queried() == std::vector<WindowHandle>({ kHoverExplorer }));
+    CHECK(source == ContextClaim(0, kHoverExplorer));
+}
+
+TEST(LaunchDirectoryFocusPriority) {
+    Desktop desktop;
+    Settings settings;
+    settings.priorityWhenBothAvailable = DirectoryPriority::Focus;
+    CHECK_EQ("D:\\downloads", desktop.Resolve(settings, kHoverExplorer, kFocusExplorer));
+    CHECK(desktop.explorer.Queried() == std::vector<WindowHandle>({ kFocusExplorer }));
+}
+
+TEST(LaunchDirectoryDisabledCandidatesAreSkipped) {
+    Desktop desktop;
+    Settings settings;
+    settings.checkMouseHover = false;
+    CHECK_EQ("D:\\downloads", desktop.Resolve(settings, kHoverExplorer, kFocusExplorer));
+
+    settings.checkFocusedWindow = false;
+    CHECK_EQ(kHome, desktop.Resolve(settings, kHoverExplorer, kFocusExplorer));
+    CHECK(desktop.explorer.Queried() == std::vector<WindowHandle>({ kFocusExplorer }));
+}
+
+TEST(LaunchDirectoryFallsThroughWhenFirstHasNoFolder) {
+    Desktop desktop;
+    // A virtual folder without a path
+    desktop.explorer.SetDirectory(kHoverExplorer, "");
+    CHECK_EQ("D:\\downloads", desktop.Resolve(Settings(), kHoverExplorer, kFocusExplorer));
+    CHECK(desktop.explorer.Queried() == std::vector<WindowHandle>({ kHoverExplorer, kFocusExplorer }));
+}
+
+TEST(LaunchDirectoryFallsThroughWhenFirstFolderIsGone) {
+    Desktop desktop;
+    desktop.explorer.SetDirectory(kHoverExplorer, "C:\\deleted");
+    CHECK_EQ("D:\\downloads", desktop.Resolve(Settings(), kHoverExplorer, kFocusExplorer));
+}
+
+TEST(LaunchDirectoryResolvesSharedWindowOnce) {
+    Desktop desktop;
+    desktop.explorer.SetDirectory(kHoverExplorer, "");
+
+    // Hovering over a child of the focused window: one query, then home
+    ContextClaim source(0, kFocusExplorer);
+    CHECK_EQ(kHome, desktop.Resolve(Settings(), kHoverListView, kHoverExplorer, &source));
+    CHECK_EQ((size_t)1, desktop.explorer.Queried().size());
+    CHECK(source == ContextClaim());
+}
+
+TEST(LaunchDirectoryUnclaimedWindowsUseHome) {
+    Desktop desktop;
+    CHECK_EQ(kHome, desktop.Resolve(Settings(), kEditor, kNoWindow));
+    CHECK(desktop.explorer.Queried().empty());
+}
+
+TEST(LaunchDirectoryHungHoverFallsThroughAtDeadline) {
+    Desktop desktop;
+    desktop.explorer.SetDelay(kHoverExplorer, std::chrono::seconds(10));
+    Settings settings;
+    settings.resolveTimeoutMs = 50;
+
+    // The hung window gives up at the press deadline and the focused one,
+    // a cache hit, still answers
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK_EQ("D:\\downloads", desktop.Resolve(settings, kHoverExplorer, kFocusExplorer));
+    long long elapsed = MillisecondsSince(start);
+    CHECK(elapsed >= 40 && elapsed < 1000);
+    CHECK(desktop.explorer.Queried() == std::vector<WindowHandle>({ kHoverExplorer, kFocusExplorer }));
+}
+
+TEST(LaunchDirectoryOfflineShareFallsThroughAtDeadline) {
+    Desktop desktop(std::chrono::milliseconds(800));
+    desktop.explorer.SetDirectory(kHoverExplorer, "\\\\nas\\projects\\app");
+    desktop.directories.AddDirectory("\\\\nas\\projects\\app");
+    desktop.directories.SetOffline("\\\\nas\\projects\\", true);
+    desktop.reachability.Start();
+    Settings settings;
+    settings.resolveTimeoutMs = 100;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CHECK_EQ("D:\\downloads", desktop.Resolve(settings, kHoverExplorer, kFocusExplorer));
+    CHECK(MillisecondsSince(start) < 600);
+    CHECK_EQ((uint64_t)1, desktop.reachability.GetStats().timeouts);
+}
@@ -0,0 +1,168 @@
+#include "test.h"
+#include "launch_queue.h"
+#include "fake_spawn_backend.h"
+#include <atomic>
+
+namespace {
+
+// Hands each launch to a FakeSpawnBackend as one spawn in the request's
+// directory, and counts the worker threads
+class SpawningLaunchBackend : public ILaunchBackend {
+public:
+    explicit SpawningLaunchBackend(FakeSpawnBackend& spawner) : m_spawner(spawner), m_workers(0), m_stopped(0) {}
+
+    void OnWorkerStarted() override {
+        m_workers++;
+    }
+
+    void OnWorkerStopped() override {
+        m_stopped++;
+    }
+
+    void Launch(const LaunchRequest& request) override {
+        m_spawner.Spawn(SpawnJob(request.app, request.directory, ""));
+    }
+
+    int Workers() const {
+        return m_workers;
+    }
+
+    int Stopped() const {
+        return m_stopped;
+    }
+
+private:
+    FakeSpawnBackend& m_spawner;
+    std::atomic<int> m_workers;
+    std::atomic<int> m_stopped;
+};
+
+std::chrono::steady_clock::time_point At(std::chrono::steady_clock::time_point start, int milliseconds) {
+    return start + std::chrono::milliseconds(milliseconds);
+}
+
+struct Launcher {
+    FakeSpawnBackend spawner;
+    SpawningLaunchBackend backend;
+    LaunchQueue queue;
+    std::shared_ptr<const ConfigSnapshot> config;
+    std::chrono::steady_clock::time_point start;
+
+    explicit Launcher(std::chrono::microseconds spawnCost = std::chrono::microseconds(0))
+        : spawner(spawnCost), backend(spawner), queue(backend, 2), start(std::chrono::steady_clock::now()) {
+        AppConfig terminal;
+        terminal.name = "Terminal";
+        terminal.executable = "wt.exe";
+        AppConfig editor;
+        editor.name = "Editor";
+        editor.executable = "code.exe";
+        config = ConfigSnapshot::Compile({ terminal, editor }, Settings());
+    }
+
+    // A press of the hotkey with id key, at milliseconds after start
+    bool Press(int key, int milliseconds) {
+        LaunchRequest request;
+        request.key = key;
+        request.config = config;
+        request.app = &config->Apps()[key % 2];
+        request.directory = "C:\\src";
+        request.pressedAt = At(start, milliseconds);
+        return queue.Enqueue(request);
+    }
+};
+
+} // namespace
+
+TEST(LaunchCoalescerDropsAutoRepeatOfHeldKey) {
+    LaunchCoalescer coalescer(std::chrono::milliseconds(300));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    CHECK(coalescer.Accept(1, start));
+    CHECK(!coalescer.Accept(1, At(start, 30)));
+
+    // Every repeat extends the window, so a key held for a second is one press
+    for (int ms = 60; ms <= 1000; ms += 30) {
+        CHECK(!coalescer.Accept(1, At(start, ms)));
+    }
+    CHECK(coalescer.Accept(1, At(start, 1300)));
+
+    // Keys are independent
+    CHECK(coalescer.Accept(2, At(start, 1310)));
+    CHECK(!coalescer.Accept(2, At(start, 1320)));
+
+    coalescer.Reset();
+    CHECK(coalescer.Accept(1, At(start, 1330)));
+}
+
+TEST(LaunchQueueCoalescesRepeatsAndCountsStats) {
+    Launcher launcher;
+    launcher.queue.Start();
+
+    CHECK(launcher.Press(1, 0));
+    CHECK(!launcher.Press(1, 100));
+    CHECK(!launcher.Press(1, 250));
+    CHECK(launcher.Press(2, 260));
+    launcher.queue.WaitIdle();
+    CHECK_EQ((size_t)2, launcher.spawner.Spawns());
+
+    LaunchQueue::Stats stats = launcher.queue.GetStats();
+    CHECK_EQ((uint64_t)2, stats.enqueued);
+    CHECK_EQ((uint64_t)2, stats.coalesced);
+    CHECK_EQ((uint64_t)2, stats.launched);
+    launcher.queue.Stop();
+    CHECK_EQ(2, launcher.backend.Workers());
+    CHECK_EQ(2, launcher.backend.Stopped());
+}
+
+TEST(LaunchQueueRejectsKeyAlreadyPending) {
+    Launcher launcher;
+
+    // Not started, so the first press waits in the queue
+    CHECK(launcher.Press(1, 0));
+    CHECK(!launcher.Press(1, 1000));
+    CHECK(launcher.Press(2, 1000));
+
+    // Nothing can drain the queue yet, so this returns at once
+    launcher.queue.WaitIdle();
+    CHECK_EQ((size_t)0, launcher.spawner.Spawns());
+
+    launcher.queue.Start();
+    launcher.queue.WaitIdle();
+    CHECK_EQ((size_t)2, launcher.spawner.Spawns());
+
+    // Once it has run, the key may be pressed again
+    CHECK(launcher.Press(1, 2000));
+    launcher.queue.Stop();
+    CHECK_EQ((size_t)3, launcher.spawner.Spawns());
+    CHECK_EQ((uint64_t)1, launcher.queue.GetStats().coalesced);
+}
+
+TEST(LaunchQueueStopDrainsQueuedThenRejects) {
+    Launcher launcher(std::chrono::milliseconds(20));
+    launcher.queue.Start();
+    for (int key = 1; key <= 5; key++) {
+        CHECK(launcher.Press(key, 0));
+    }
+
+    // Stop returns only after every queued launch ran
+    launcher.queue.Stop();
+    CHECK_EQ((size_t)5, launcher.spawner.Spawns());
+    CHECK_EQ((uint64_t)5, launcher.queue.GetStats().launched);
+    CHECK(launcher.spawner.MaxRunning() <= 2);
+
+    CHECK(!launcher.Press(6, 5000));
+    CHECK_EQ((uint64_t)1, launcher.queue.GetStats().coalesced);
+    launcher.queue.WaitIdle();
+}
+
+TEST(LaunchQueueWaitIdleWaitsForRunningLaunch) {
+    Launcher launcher(std::chrono::milliseconds(50));
+    launcher.queue.Start();
+    CHECK(launcher.Press(1, 0));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    launcher.queue.WaitIdle();
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(30));
+    CHECK_EQ((uint64_t)1, launcher.queue.GetStats().launched);
+    launcher.queue.Stop();
+}
@@ -0,0 +1,50 @@
+#include "test.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+size_t g_failures = 0;
+
+} // namespace
+
+std::vector<TestCase>& TestRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+TestRegistrar::TestRegistrar(const char* name, void (*body)()) {
+    TestRegistry().push_back({ name, body });
+}
+
+void ReportTestFailure(const char* file, int line, const std::string& message) {
+    std::printf("  %s:%d: %s\n", file, line, message.c_str());
+    g_failures++;
+}
+
+// Usage: launcher_tests [name-filter]. Exits non-zero if any test failed.
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    size_t run = 0;
+    size_t failed = 0;
+    for (const TestCase& test : TestRegistry()) {
+        if (filter != nullptr && std::strstr(test.name, filter) == nullptr) {
+            continue;
+        }
+        size_t failuresBefore = g_failures;
+        test.body();
+        run++;
+        if (g_failures != failuresBefore) {
+            failed++;
+            std::printf("FAILED %s\n", test.name);
+        }
+        else {
+            std::printf("ok     %s\n", test.name);
+        }
+        std::fflush(stdout);
+    }
+
+    std::printf("\n%zu tests, %zu failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+#include "test.h"
+#include "palette.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const int64_t kNow = 1700000000;
+
+// FuzzyIndex::Match spelled out one byte at a time, with no index, masks or
+// block loads: the letters' leftmost complete match, moved to its latest
+// start, scored with the same weights
+bool ReferenceMatch(const std::string& candidate, const std::string& query, int& score) {
+    score = 0;
+    std::string text;
+    std::vector<bool> wordStart;
+    auto KindOf = [](char c) {
+        return std::string(" \\/-_.:").find(c) != std::string::npos ? 1 : c >= 'a' && c <= 'z' ? 2 :
+            c >= 'A' && c <= 'Z' ? 3 : c >= '0' && c <= '9' ? 4 : 0;
+    };
+    int previous = 1;
+    for (char c : candidate) {
+        int kind = KindOf(c);
+        wordStart.push_back(previous == 1 || (previous == 2 && kind == 3) || (previous != 4 && kind == 4));
+        text += kind == 3 ? (char)(c - 'A' + 'a') : c;
+        previous = kind;
+    }
+
+    size_t end = 0;
+    for (char c : query) {
+        while (end < text.size() && text[end] != c) {
+            end++;
+        }
+        if (end == text.size()) {
+            return false;
+        }
+        end++;
+    }
+    if (query.empty()) {
+        return true;
+    }
+
+    // The latest start whose letters still fit before end
+    size_t start = end;
+    for (size_t k = query.size(); k > 0; k--) {
+        do {
+            start--;
+        } while (text[start] != query[k - 1]);
+    }
+
+    size_t position = start;
+    size_t last = start;
+    for (size_t k = 0; k < query.size(); k++) {
+        while (text[position] != query[k]) {
+            position++;
+        }
+        int bonus = wordStart[position] ? 8 : 0;
+        if (k == 0) {
+            bonus *= 2;
+        }
+        else if (position == last + 1) {
+            bonus = std::max(bonus, 4);
+        }
+        else {
+            score -= 3 + (int)(position - last - 2);
+        }
+        score += 16 + bonus;
+        last = position++;
+    }
+    return true;
+}
+
+// Everything query matches among items, ranked as the palette ranks, by
+// matching each item afresh
+std::vector<std::pair<size_t, int>> RescanAll(const std::vector<PaletteItem>& items, const std::string& query) {
+    FuzzyIndex index;
+    for (const PaletteItem& item : items) {
+        index.Add(item.text);
+    }
+    FuzzyPattern pattern(query);
+    std::vector<std::pair<size_t, int>> matches;
+    for (size_t i = 0; i < items.size(); i++) {
+        int score = 0;
+        if (index.Match(pattern, i, score)) {
+            matches.push_back(std::make_pair(i, score + items[i].boost));
+        }
+    }
+    std::sort(matches.begin(), matches.end(), [&items](const std::pair<size_t, int>& a, const std::pair<size_t, int>& b) {
+        if (a.second != b.second) {
+            return a.second > b.second;
+        }
+        size_t lengthA = items[a.first].text.size();
+        size_t lengthB = items[b.first].text.size();
+        return lengthA != lengthB ? lengthA < lengthB : a.first < b.first;
+    });
+    return matches;
+}
+
+std::vector<std::pair<size_t, int>> ToPairs(const std::vector<PaletteMatch>& matches) {
+    std::vector<std::pair<size_t, int>> pairs;
+    for (const PaletteMatch& match : matches) {
+        pairs.push_back(std::make_pair(match.item, match.rank));
+    }
+    return pairs;
+}
+
+PaletteItem Item(const std::string& text, int boost = 0) {
+    PaletteItem item;
+    item.app = text;
+    item.text = text;
+    item.boost = boost;
+    return item;
+}
+
+// The entry for app in directory, or one with no uses
+FrecencyEntry EntryOf(const FrecencyTable& table, const std::string& app, const std::string& directory) {
+    for (const FrecencyEntry& entry : table.Snapshot()) {
+        if (entry.app == app && entry.directory == directory) {
+            return entry;
+        }
+    }
+    return FrecencyEntry();
+}
+
+} // namespace
+
+TEST(FuzzyIndexMatchesAtBlockEdgeOfLastCandidate) {
+    // Each text is the last one added, so what follows it is padding; the
+    // letters sit on either side of the 16-byte blocks a search loads
+    for (size_t length = 1; length <= 48; length++) {
+        for (size_t at : { (size_t)0, length / 2, length - 1 }) {
+            std::string text(length, 'x');
+            text[at] = 'q';
+            FuzzyIndex index;
+            index.Add("offset");
+            index.Add(text);
+
+            int score = 0;
+            CHECK(index.Match(FuzzyPattern("q"), 1, score));
+            CHECK(index.Match(FuzzyPattern("xq"), 1, score) == (at > 0));
+            CHECK(index.Match(FuzzyPattern("qx"), 1, score) == (at + 1 < length));
+            CHECK(!index.Match(FuzzyPattern("qq"), 1, score));
+        }
+    }
+}
+
+TEST(FuzzyIndexIgnoresLettersOfNextCandidate) {
+    // A block loaded near the end of "bax" also holds the "b" after it, and
+    // one near the end of the third text the "c" of the last; the padding
+    // is only past the last text
+    FuzzyIndex index;
+    index.Add("bax");
+    index.Add("b");
+    index.Add("b" + std::string(14, 'a') + "ca");
+    index.Add("c");
+
+    int score = 0;
+    CHECK(!index.Match(FuzzyPattern("ab"), 0, score));
+    CHECK(index.Match(FuzzyPattern("ba"), 0, score));
+    CHECK(!index.Match(FuzzyPattern("cc"), 2, score));
+    CHECK(!index.Match(FuzzyPattern("cb"), 2, score));
+    CHECK(index.Match(FuzzyPattern("ca"), 2, score));
+    CHECK(index.Match(FuzzyPattern("bc"), 2, score));
+}
+
+TEST(FuzzyIndexAgreesWithByteByByteMatch) {
+    // Short words over few letters, so most queries match somewhere and
+    // many only just fail; both matcher builds must give these results
+    std::mt19937 random(77);
+    const char alphabet[] = "abcAB -_x1";
+    FuzzyIndex index;
+    std::vector<std::string> texts;
+    for (int i = 0; i < 400; i++) {
+        std::string text;
+        size_t length = random() % 40;
+        for (size_t j = 0; j < length; j++) {
+            text += alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+        texts.push_back(text);
+        index.Add(text);
+    }
+
+    const char* const queries[] = { "a", "b", "ab", "ba", "abc", "cab", "a1", "x1b", "aaaa", "bcbc", "abcabc" };
+    for (const char* query : queries) {
+        FuzzyPattern pattern(query);
+        for (size_t i = 0; i < texts.size(); i++) {
+            int score = 0;
+            int expected = 0;
+            bool matched = index.Match(pattern, i, score);
+            CHECK_EQ(ReferenceMatch(texts[i], query, expected), matched);
+            if (matched) {
+                CHECK_EQ(expected, score);
+            }
+        }
+    }
+}
+
+TEST(FuzzyIndexScoresWordStartsAndRuns) {
+    FuzzyIndex index;
+    index.Add("PowerShell");
+    index.Add("caps");
+    index.Add("axxab");
+    int score = 0;
+
+    // "p" starts the text, "s" starts the second word past a gap of four
+    CHECK(index.Match(FuzzyPattern("ps"), 0, score));
+    CHECK_EQ(16 + 16 + 16 + 8 - 3 - 3, score);
+
+    // Neither letter starts a word, but they are a run
+    CHECK(index.Match(FuzzyPattern("ps"), 1, score));
+    CHECK_EQ(16 + 16 + 4, score);
+
+    CHECK(index.Match(FuzzyPattern("pow"), 0, score));
+    CHECK_EQ(32 + 20 + 20, score);
+
+    // The shortest window is scored, not the first "a"
+    CHECK(index.Match(FuzzyPattern("ab"), 2, score));
+    CHECK_EQ(16 + 20, score);
+
+    PaletteSearch search;
+    search.SetItems({ Item("caps"), Item("PowerShell"), Item("Photoshop") });
+    const std::vector<PaletteMatch>& results = search.Query("ps", 10);
+    REQUIRE(results.size() == 3);
+    CHECK_EQ((size_t)1, results[0].item);
+    CHECK_EQ((size_t)0, results[2].item);
+}
+
+TEST(FuzzyPatternIsNarrowedByLongerQueries) {
+    CHECK(FuzzyPattern("").IsNarrowedBy(FuzzyPattern("ps")));
+    CHECK(FuzzyPattern("ps").IsNarrowedBy(FuzzyPattern("pws")));
+    CHECK(FuzzyPattern("ps").IsNarrowedBy(FuzzyPattern("P S")));
+    CHECK(!FuzzyPattern("ps").IsNarrowedBy(FuzzyPattern("sp")));
+    CHECK(!FuzzyPattern("ps").IsNarrowedBy(FuzzyPattern("p")));
+}
+
+TEST(PaletteNarrowingMatchesFullRescan) {
+    std::mt19937 random(9);
+    const char* const words[] = { "PowerShell", "src", "Projects", "launcher", "caps", "Release", "ps1", "docs" };
+    std::vector<PaletteItem> items;
+    for (int i = 0; i < 300; i++) {
+        std::string text = words[random() % 8];
+        text += "  C:\\";
+        text += words[random() % 8];
+        text += "\\";
+        text += words[random() % 8];
+        items.push_back(Item(text, (int)(random() % 20)));
+    }
+    PaletteSearch search;
+    search.SetItems(items);
+
+    // Typing, deleting and retyping, with spaces and case changes
+    const char* const keystrokes[] = { "p", "ps", "psr", "psrc", "psr", "ps", "PS l", "ps la", "psd", "", "d",
+        "do", "dox", "do", "rel", "Rele", "s", "src", "srcx", "" };
+    for (const char* query : keystrokes) {
+        CHECK_EQ(true, RescanAll(items, query) == ToPairs(search.Query(query, items.size())));
+    }
+    PaletteSearch::Stats stats = search.GetStats();
+    CHECK_EQ((uint64_t)20, stats.queries);
+    CHECK(stats.narrowed >= 10);
+
+    // A limit shows the best of the same list
+    search.Query("", items.size());
+    std::vector<std::pair<size_t, int>> all = RescanAll(items, "ps");
+    all.resize(std::min(all.size(), (size_t)5));
+    CHECK_EQ(true, all == ToPairs(search.Query("ps", 5)));
+}
+
+TEST(FrecencyDecaysByHalfLifeAndIgnoresClockSetBack) {
+    FrecencyEntry entry;
+    entry.score = 4;
+    entry.lastUsed = kNow;
+    CHECK_EQ(4.0, FrecencyAt(entry, kNow));
+    CHECK_EQ(2.0, FrecencyAt(entry, kNow + kFrecencyHalfLifeSeconds));
+    CHECK_EQ(1.0, FrecencyAt(entry, kNow + 2 * kFrecencyHalfLifeSeconds));
+    CHECK_EQ(4.0, FrecencyAt(entry, kNow - kFrecencyHalfLifeSeconds));
+
+    FrecencyTable table;
+    table.Record("Terminal", "C:\\src", kNow);
+    table.Record("Terminal", "C:\\src", kNow + kFrecencyHalfLifeSeconds);
+    FrecencyEntry recorded = EntryOf(table, "Terminal", "C:\\src");
+    CHECK_EQ(1.5, recorded.score);
+    CHECK_EQ((uint32_t)2, recorded.uses);
+
+    // A use recorded under a clock set back counts in full, but does not
+    // move lastUsed back, so later decay starts from the newest use
+    table.Record("Terminal", "C:\\src", kNow);
+    recorded = EntryOf(table, "Terminal", "C:\\src");
+    CHECK_EQ(2.5, recorded.score);
+    CHECK_EQ(kNow + kFrecencyHalfLifeSeconds, recorded.lastUsed);
+    CHECK_EQ((uint32_t)3, EntryOf(table, "Terminal", "").uses);
+
+    // Recent directories rank by their decayed score; app-only entries are left out
+    table.Record("Editor", "D:\\notes", kNow + 3 * kFrecencyHalfLifeSeconds);
+    std::vector<FrecencyEntry> ranked = RankRecentDirectories(table.Snapshot(), kNow + 3 * kFrecencyHalfLifeSeconds, 10);
+    REQUIRE(ranked.size() == 2);
+    CHECK_EQ("Editor", ranked[0].app);
+    CHECK_EQ("Terminal", ranked[1].app);
+}
+
+TEST(FrecencyPruneKeepsHighestRankedWithConsistentIndex) {
+    // The smallest table: 11 apps recorded 11 down to 1 times, so the
+    // eleventh prunes the table to its best nine
+    FrecencyTable table(10);
+    for (int app = 0; app <= 10; app++) {
+        for (int use = app; use <= 10; use++) {
+            table.Record("App" + std::to_string(app), "", kNow);
+        }
+    }
+    std::vector<FrecencyEntry> entries = table.Snapshot();
+    REQUIRE(entries.size() == 9);
+    for (size_t i = 0; i < entries.size(); i++) {
+        CHECK_EQ("App" + std::to_string(i), entries[i].app);
+        CHECK_EQ((uint32_t)(11 - i), entries[i].uses);
+    }
+
+    // Survivors are found again under their keys, not added twice
+    for (size_t i = 0; i < entries.size(); i++) {
+        table.Record(entries[i].app, "", kNow);
+    }
+    CHECK_EQ((size_t)9, table.Size());
+    CHECK_EQ((uint32_t)12, EntryOf(table, "App0", "").uses);
+    CHECK_EQ((uint32_t)4, EntryOf(table, "App8", "").uses);
+
+    // A pruned key starts over
+    table.Record("App10", "", kNow);
+    CHECK_EQ((uint32_t)1, EntryOf(table, "App10", "").uses);
+    FrecencyEntry restored = EntryOf(table, "App3", "");
+    restored.uses = 99;
+    table.Restore(restored);
+    CHECK_EQ((size_t)10, table.Size());
+    CHECK_EQ((uint32_t)99, EntryOf(table, "App3", "").uses);
+
+    // Past capacity again: the newest use, worth least, goes first
+    table.Record("Late", "", kNow);
+    CHECK_EQ((size_t)9, table.Size());
+    CHECK_EQ((uint32_t)0, EntryOf(table, "Late", "").uses);
+    CHECK_EQ((uint32_t)0, EntryOf(table, "App10", "").uses);
+    CHECK_EQ((uint32_t)12, EntryOf(table, "App0", "").uses);
+}
@@ -0,0 +1,79 @@
+#include "test.h"
+#include "fake_process_table.h"
+#include "process_image_cache.h"
+
+namespace {
+
+const WindowHandle kEditor = 0x1000;
+const WindowHandle kTerminal = 0x2000;
+
+} // namespace
+
+TEST(ProcessImageCacheLowercasesAndCachesImage) {
+    FakeProcessTable table;
+    table.AddWindow(kEditor, 10, "Code.EXE");
+    ProcessImageCache cache(table);
+
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+    CHECK_EQ((size_t)1, table.ImageQueries());
+
+    ProcessImageCache::Stats stats = cache.GetStats();
+    CHECK_EQ((uint64_t)1, stats.hits);
+    CHECK_EQ((uint64_t)1, stats.misses);
+}
+
+TEST(ProcessImageCacheDestroyedWindowIsQueriedAgain) {
+    FakeProcessTable table;
+    table.AddWindow(kEditor, 10, "Code.exe");
+    ProcessImageCache cache(table);
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+
+    // The handle is recycled for a window of another process
+    cache.OnWindowDestroyed(kEditor);
+    table.AddWindow(kEditor, 20, "WindowsTerminal.exe");
+    CHECK_EQ("windowsterminal.exe", cache.Lookup(kEditor));
+    CHECK_EQ((size_t)2, table.ImageQueries());
+}
+
+TEST(ProcessImageCacheWithoutDestroyKeepsStaleImage) {
+    FakeProcessTable table;
+    table.AddWindow(kEditor, 10, "Code.exe");
+    ProcessImageCache cache(table);
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+
+    // Only the destroy notification invalidates an entry
+    table.AddWindow(kEditor, 20, "WindowsTerminal.exe");
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+}
+
+TEST(ProcessImageCacheDoesNotCacheFailures) {
+    FakeProcessTable table;
+    ProcessImageCache cache(table);
+
+    CHECK_EQ("", cache.Lookup(kEditor));
+    CHECK_EQ("", cache.Lookup(kNoWindow));
+    CHECK_EQ((size_t)0, cache.Size());
+
+    // The window appears later, e.g. access was denied at first
+    table.AddWindow(kEditor, 10, "Code.exe");
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+    CHECK_EQ((size_t)1, cache.Size());
+}
+
+TEST(ProcessImageCacheClearDropsEveryEntry) {
+    FakeProcessTable table;
+    table.AddWindow(kEditor, 10, "Code.exe");
+    table.AddWindow(kTerminal, 20, "WindowsTerminal.exe");
+    ProcessImageCache cache(table);
+    cache.Lookup(kEditor);
+    cache.Lookup(kTerminal);
+    CHECK_EQ((size_t)2, cache.Size());
+
+    cache.OnWindowDestroyed(kTerminal);
+    CHECK_EQ((size_t)1, cache.Size());
+    cache.Clear();
+    CHECK_EQ((size_t)0, cache.Size());
+    CHECK_EQ("code.exe", cache.Lookup(kEditor));
+    CHECK_EQ((size_t)3, table.ImageQueries());
+}
@@ -0,0 +1,176 @@
+#include "test.h"
+#include "fake_process_backend.h"
+#include "standby_pool.h"
+
+namespace {
+
+const std::chrono::milliseconds kLongTime(60000);
+
+StandbySpec PowerShell(const std::string& args = "-NoLogo") {
+    return StandbySpec { "PowerShell", "pwsh.exe", args };
+}
+
+StandbySpec Cmd() {
+    return StandbySpec { "Cmd", "C:\\Windows\\System32\\cmd.exe", "" };
+}
+
+} // namespace
+
+TEST(StandbyPoolHandsOutStandbyAndStartsReplacement) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 1; }));
+
+    CHECK(pool.TryActivate("PowerShell", "C:\\it's here"));
+    CHECK_EQ("Set-Location -LiteralPath 'C:\\it''s here'; Clear-Host", backend.LastHandoff());
+    CHECK(WaitFor([&backend, &pool] { return backend.Starts() == 2 && pool.ReadyCount() == 1; }));
+
+    pool.Stop();
+    CHECK_EQ((size_t)0, backend.Running());
+    StandbyPool::Stats stats = pool.GetStats();
+    CHECK_EQ((uint64_t)2, stats.started);
+    CHECK_EQ((uint64_t)1, stats.handedOut);
+}
+
+TEST(StandbyPoolMissesWithoutReadyStandby) {
+    FakeProcessBackend backend;
+    backend.HoldStarts();
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&backend] { return backend.HeldStarts() == 1; }));
+
+    CHECK(!pool.TryActivate("PowerShell", "C:\\src"));
+    CHECK(!pool.TryActivate("Unknown", "C:\\src"));
+    CHECK_EQ((uint64_t)2, pool.GetStats().misses);
+
+    backend.ReleaseStarts();
+    pool.Stop();
+}
+
+TEST(StandbyPoolRetireDuringStartDiscardsStaleProcess) {
+    FakeProcessBackend backend;
+    backend.HoldStarts();
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&backend] { return backend.HeldStarts() == 1; }));
+
+    // The start under way belongs to the old generation
+    pool.RetireAll();
+    backend.ReleaseStarts();
+    REQUIRE(WaitFor([&backend, &pool] { return backend.Starts() == 2 && pool.ReadyCount() == 1; }));
+    CHECK(WaitFor([&backend] { return backend.Terminates() == 1; }));
+    CHECK(!backend.IsRunning(1));
+    CHECK(backend.IsRunning(2));
+
+    CHECK(pool.TryActivate("PowerShell", "C:\\src"));
+    pool.Stop();
+}
+
+TEST(StandbyPoolConfigureDuringStartDiscardsChangedSpec) {
+    FakeProcessBackend backend;
+    backend.HoldStarts();
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&backend] { return backend.HeldStarts() == 1; }));
+
+    pool.Configure({ PowerShell("-NoProfile") });
+    backend.ReleaseStarts();
+    REQUIRE(WaitFor([&backend, &pool] { return backend.Starts() == 2 && pool.ReadyCount() == 1; }));
+    CHECK(WaitFor([&backend] { return backend.Terminates() == 1; }));
+    CHECK(!backend.IsRunning(1));
+
+    // Removed while it was starting: nothing takes its place
+    backend.HoldStarts();
+    pool.RetireAll();
+    REQUIRE(WaitFor([&backend] { return backend.HeldStarts() == 1; }));
+    pool.Configure({});
+    backend.ReleaseStarts();
+    CHECK(WaitFor([&backend] { return backend.Running() == 0; }));
+    CHECK_EQ((size_t)0, pool.ReadyCount());
+    pool.Stop();
+}
+
+TEST(StandbyPoolConfigureKeepsUnchangedStandbys) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 1; }));
+
+    pool.Configure({ PowerShell(), Cmd() });
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 2; }));
+    CHECK_EQ((size_t)2, backend.Starts());
+    CHECK(backend.IsRunning(1));
+
+    pool.Configure({ Cmd() });
+    CHECK(WaitFor([&backend] { return !backend.IsRunning(1); }));
+    CHECK(!pool.TryActivate("PowerShell", "C:\\src"));
+    CHECK(pool.TryActivate("Cmd", "C:\\src"));
+    CHECK_EQ("cd /d \"C:\\src\" & cls", backend.LastHandoff());
+    pool.Stop();
+}
+
+TEST(StandbyPoolReplacesCrashedAndExpiredStandbys) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, kLongTime, std::chrono::milliseconds(5), kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 1; }));
+
+    backend.Crash(1);
+    CHECK(WaitFor([&backend, &pool] { return backend.Starts() == 2 && pool.ReadyCount() == 1; }));
+    CHECK_EQ((uint64_t)1, pool.GetStats().crashed);
+    pool.Stop();
+
+    FakeProcessBackend agingBackend;
+    StandbyPool agingPool(agingBackend, std::chrono::milliseconds(20), std::chrono::milliseconds(5), kLongTime);
+    agingPool.Configure({ PowerShell() });
+    agingPool.Start();
+    CHECK(WaitFor([&agingPool] { return agingPool.GetStats().expired >= 1; }));
+    CHECK(WaitFor([&agingPool] { return agingPool.ReadyCount() == 1; }));
+    CHECK(!agingBackend.IsRunning(1));
+    agingPool.Stop();
+}
+
+TEST(StandbyPoolRetriesFailedStartAfterDelay) {
+    FakeProcessBackend backend;
+    backend.FailStarts(1);
+    StandbyPool pool(backend, kLongTime, std::chrono::milliseconds(5), std::chrono::milliseconds(50));
+    pool.Configure({ PowerShell() });
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.Start();
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 1; }));
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(45));
+    CHECK_EQ((uint64_t)1, pool.GetStats().startFailures);
+    pool.Stop();
+}
+
+TEST(StandbyPoolFailedRevealTerminatesStandby) {
+    FakeProcessBackend backend;
+    StandbyPool pool(backend, kLongTime, kLongTime, kLongTime);
+    pool.Configure({ PowerShell() });
+    pool.Start();
+    REQUIRE(WaitFor([&pool] { return pool.ReadyCount() == 1; }));
+
+    // Died between health checks
+    backend.Crash(1);
+    CHECK(!pool.TryActivate("PowerShell", "C:\\src"));
+    CHECK_EQ((size_t)0, backend.Reveals());
+    CHECK_EQ((uint64_t)1, pool.GetStats().misses);
+    pool.Stop();
+}
+
+TEST(StandbySpecsOnlyForSupportedShells) {
+    CHECK(IsPrewarmSupported("C:\\Program Files\\PowerShell\\7\\PWSH.EXE"));
+    CHECK(IsPrewarmSupported("cmd"));
+    CHECK(!IsPrewarmSupported("wt.exe"));
+
+    std::string command;
+    CHECK(!FormatDirectoryHandoff("code.exe", "C:\\src", command));
+}
@@ -0,0 +1,183 @@
+#include "test.h"
+#include "startup_profile.h"
+
+namespace {
+
+typedef PhaseTimer::Clock Clock;
+
+Clock::duration Ms(int milliseconds) {
+    return std::chrono::milliseconds(milliseconds);
+}
+
+// Components that log "+name" when they start and "-name" when they stop.
+// events is declared first, since the components' destructor stops what is
+// still running.
+struct Recorder {
+    std::vector<std::string> events;
+    LazyComponents components;
+
+    int Add(const std::string& name, const std::vector<int>& dependencies, bool* startSucceeds = nullptr) {
+        return components.Add(name,
+            [this, name, startSucceeds]() {
+                if (startSucceeds != nullptr && !*startSucceeds) {
+                    events.push_back("!" + name);
+                    return false;
+                }
+                events.push_back("+" + name);
+                return true;
+            },
+            [this, name]() { events.push_back("-" + name); }, dependencies);
+    }
+};
+
+} // namespace
+
+TEST(PhaseTimerMarksConsecutivePhases) {
+    Clock::time_point start = Clock::now();
+    PhaseTimer timer(start);
+    timer.Mark("config", start + Ms(10));
+    timer.Mark("window", start + Ms(25));
+    timer.Mark("hotkeys", start + Ms(30));
+
+    REQUIRE(timer.Phases().size() == 3);
+    CHECK(timer.Phases()[0].elapsed == Ms(10));
+    CHECK(timer.Phases()[1].elapsed == Ms(15));
+    CHECK(timer.Phases()[2].elapsed == Ms(5));
+    CHECK(timer.Total() == Ms(30));
+
+    CHECK_EQ(-1, timer.PhaseAt(start - Ms(1)));
+    CHECK_EQ(0, timer.PhaseAt(start));
+    CHECK_EQ(0, timer.PhaseAt(start + Ms(9)));
+    CHECK_EQ(1, timer.PhaseAt(start + Ms(10)));
+    CHECK_EQ(2, timer.PhaseAt(start + Ms(29)));
+    CHECK_EQ(-1, timer.PhaseAt(start + Ms(30)));
+}
+
+TEST(PhaseTimerLeadInsComeFirstAndShiftPhaseAt) {
+    Clock::time_point start = Clock::now();
+    PhaseTimer timer(start);
+    timer.Mark("config", start + Ms(10));
+    timer.AddLeadIn("process creation", Ms(40));
+    timer.Mark("window", start + Ms(25));
+    timer.AddLeadIn("loader", Ms(3));
+
+    REQUIRE(timer.Phases().size() == 4);
+    CHECK_EQ("process creation", timer.Phases()[0].name);
+    CHECK_EQ("loader", timer.Phases()[1].name);
+    CHECK_EQ("config", timer.Phases()[2].name);
+    CHECK_EQ("window", timer.Phases()[3].name);
+    CHECK(timer.Total() == Ms(68));
+
+    // Lead-ins happened before start, so no time falls in them, and the
+    // index returned is into Phases
+    CHECK_EQ(-1, timer.PhaseAt(start - Ms(20)));
+    CHECK_EQ(2, timer.PhaseAt(start + Ms(5)));
+    CHECK_EQ(3, timer.PhaseAt(start + Ms(20)));
+    CHECK_EQ(-1, timer.PhaseAt(start + Ms(25)));
+}
+
+TEST(LazyComponentsStartDependenciesFirstAndOnce) {
+    Recorder recorder;
+    int com = recorder.Add("com", {});
+    int shell = recorder.Add("shell windows", { com });
+    int hook = recorder.Add("keyboard hook", {});
+    int palette = recorder.Add("palette", { shell, hook, com });
+
+    CHECK(recorder.components.Ensure(palette));
+    CHECK(recorder.events == std::vector<std::string>({ "+com", "+shell windows", "+keyboard hook", "+palette" }));
+    CHECK(recorder.components.IsStarted(com));
+    CHECK(recorder.components.IsStarted(palette));
+
+    CHECK(recorder.components.Ensure(shell));
+    CHECK(recorder.components.Ensure(palette));
+    CHECK_EQ((size_t)4, recorder.events.size());
+
+    REQUIRE(recorder.components.Starts().size() == 4);
+    CHECK_EQ(com, recorder.components.Starts()[0].id);
+    CHECK_EQ(palette, recorder.components.Starts()[3].id);
+    CHECK_EQ("palette", recorder.components.Name(palette));
+
+    // Unknown ids and dependencies that are not earlier ids are refused
+    CHECK(!recorder.components.Ensure(-1));
+    CHECK(!recorder.components.Ensure(99));
+    int late = recorder.Add("late", { 99, -1 });
+    CHECK(recorder.components.Ensure(late));
+}
+
+TEST(LazyComponentsFailedStartLeavesComponentUnstarted) {
+    Recorder recorder;
+    bool comStarts = false;
+    int com = recorder.Add("com", {}, &comStarts);
+    int shell = recorder.Add("shell windows", { com });
+
+    CHECK(!recorder.components.Ensure(shell));
+    CHECK(!recorder.components.IsStarted(com));
+    CHECK(!recorder.components.IsStarted(shell));
+    CHECK(recorder.components.Starts().empty());
+    CHECK(recorder.events == std::vector<std::string>({ "!com" }));
+
+    // The next Ensure tries again
+    comStarts = true;
+    CHECK(recorder.components.Ensure(shell));
+    CHECK(recorder.events == std::vector<std::string>({ "!com", "+com", "+shell windows" }));
+
+    // Nothing that failed is stopped
+    recorder.components.Shutdown();
+    CHECK(recorder.events == std::vector<std::string>({ "!com", "+com", "+shell windows", "-shell windows", "-com" }));
+}
+
+TEST(LazyComponentsShutdownStopsInReverseStartOrder) {
+    Recorder recorder;
+    int hook = recorder.Add("keyboard hook", {});
+    int com = recorder.Add("com", {});
+    int shell = recorder.Add("shell windows", { com });
+    recorder.components.Add("unused", nullptr, nullptr, {});
+
+    // Start order, not id order, decides the stop order
+    CHECK(recorder.components.Ensure(shell));
+    CHECK(recorder.components.Ensure(hook));
+    recorder.components.Shutdown();
+    CHECK(recorder.events == std::vector<std::string>({ "+com", "+shell windows", "+keyboard hook",
+        "-keyboard hook", "-shell windows", "-com" }));
+    CHECK(!recorder.components.IsStarted(com));
+    CHECK(recorder.components.Starts().empty());
+
+    // Components can start again after a shutdown, and stop once
+    CHECK(recorder.components.Ensure(com));
+    recorder.components.Shutdown();
+    recorder.components.Shutdown();
+    CHECK_EQ((size_t)8, recorder.events.size());
+    CHECK_EQ("-com", recorder.events.back());
+}
+
+TEST(LazyComponentsDestructorShutsDown) {
+    std::vector<std::string> stopped;
+    {
+        LazyComponents components;
+        int com = components.Add("com", nullptr, [&stopped]() { stopped.push_back("com"); }, {});
+        int shell = components.Add("shell windows", nullptr, [&stopped]() { stopped.push_back("shell windows"); },
+            { com });
+        REQUIRE(components.Ensure(shell));
+    }
+    CHECK(stopped == std::vector<std::string>({ "shell windows", "com" }));
+}
+
+TEST(FormatStartupProfileNamesPhaseOfEachStart) {
+    Clock::time_point start = Clock::now();
+    PhaseTimer timer(start - Ms(20));
+    timer.AddLeadIn("process creation", Ms(5));
+    timer.Mark("config", start - Ms(10));
+    timer.Mark("window", Clock::now() + Ms(60000));
+
+    LazyComponents components;
+    int com = components.Add("com", nullptr, nullptr, {});
+    REQUIRE(components.Ensure(com));
+
+    std::string report = FormatStartupProfile(timer, components);
+    CHECK(report.find("process creation") != std::string::npos);
+    CHECK(report.find("total") != std::string::npos);
+    CHECK(report.find("started on first use") != std::string::npos);
+    size_t line = report.find("com ");
+    REQUIRE(line != std::string::npos);
+    CHECK(report.find("window\n", line) != std::string::npos);
+}
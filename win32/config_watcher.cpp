@@ -0,0 +1,124 @@
+#include "config_watcher.h"
+#include <shlwapi.h>
+
+namespace {
+
+std::wstring Widen(const std::string& text) {
+    int length = MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0);
+    std::wstring wide(length, L'\0');
+    if (length > 0) {
+        MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), &wide[0], length);
+    }
+    return wide;
+}
+
+} // namespace
+
+DirectoryChangeWatcher::DirectoryChangeWatcher()
+    : m_directory(INVALID_HANDLE_VALUE), m_stopEvent(NULL) {}
+
+DirectoryChangeWatcher::~DirectoryChangeWatcher() {
+    Stop();
+}
+
+bool DirectoryChangeWatcher::Start(const std::string& path, std::function<void()> onChanged) {
+    Stop();
+
+    std::wstring widePath = Widen(path);
+    size_t slash = widePath.find_last_of(L"\\/");
+    if (slash == std::wstring::npos) {
+        return false;
+    }
+    std::wstring directory = widePath.substr(0, slash);
+    m_fileName = widePath.substr(slash + 1);
+    m_onChanged = onChanged;
+
+    m_directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (m_directory == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    m_stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (m_stopEvent == NULL) {
+        CloseHandle(m_directory);
+        m_directory = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    m_thread = std::thread(&DirectoryChangeWatcher::Run, this);
+    return true;
+}
+
+void DirectoryChangeWatcher::Stop() {
+    if (m_thread.joinable()) {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+    }
+    if (m_directory != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_directory);
+        m_directory = INVALID_HANDLE_VALUE;
+    }
+    if (m_stopEvent != NULL) {
+        CloseHandle(m_stopEvent);
+        m_stopEvent = NULL;
+    }
+}
+
+bool DirectoryChangeWatcher::IsWatchedFile(const FILE_NOTIFY_INFORMATION& info) const {
+    std::wstring name(info.FileName, info.FileNameLength / sizeof(WCHAR));
+    return StrCmpIW(name.c_str(), m_fileName.c_str()) == 0;
+}
+
+void DirectoryChangeWatcher::Run() {
+    // DWORD-aligned, as ReadDirectoryChangesW requires
+    DWORD buffer[2048];
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (overlapped.hEvent == NULL) {
+        return;
+    }
+
+    const DWORD filter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+    HANDLE events[2] = { m_stopEvent, overlapped.hEvent };
+
+    for (;;) {
+        ResetEvent(overlapped.hEvent);
+        if (!ReadDirectoryChangesW(m_directory, buffer, sizeof(buffer), FALSE, filter, NULL, &overlapped, NULL)) {
+            break;
+        }
+
+        if (WaitForMultipleObjects(2, events, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+            CancelIoEx(m_directory, &overlapped);
+            WaitForSingleObject(overlapped.hEvent, INFINITE);
+            break;
+        }
+
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(m_directory, &overlapped, &bytes, FALSE)) {
+            break;
+        }
+
+        // Zero bytes means the buffer overflowed and the details were lost
+        bool changed = (bytes == 0);
+        const BYTE* cursor = reinterpret_cast<const BYTE*>(buffer);
+        while (!changed && bytes > 0) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+            if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME &&
+                IsWatchedFile(*info)) {
+                changed = true;
+            }
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            cursor += info->NextEntryOffset;
+        }
+
+        if (changed) {
+            m_onChanged();
+        }
+    }
+
+    CloseHandle(overlapped.hEvent);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <functional>
+#include <string>
+#include <thread>
+#include "file_watcher.h"
+
+// Watches one file through ReadDirectoryChangesW on its folder. Editors
+// often save by writing a temp file and renaming it over the original, so
+// renames onto the watched name count as changes too.
+class DirectoryChangeWatcher : public IFileWatcher {
+public:
+    DirectoryChangeWatcher();
+    ~DirectoryChangeWatcher();
+
+    bool Start(const std::string& path, std::function<void()> onChanged) override;
+    void Stop() override;
+
+private:
+    void Run();
+    bool IsWatchedFile(const FILE_NOTIFY_INFORMATION& info) const;
+
+    std::wstring m_fileName;
+    std::function<void()> m_onChanged;
+    HANDLE m_directory;
+    HANDLE m_stopEvent;
+    std::thread m_thread;
+};
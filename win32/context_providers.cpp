@@ -0,0 +1,293 @@
+#include "context_providers.h"
+#include "shell_windows.h"
+#include <shlobj.h>
+#include <tlhelp32.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Function to get the relevant File Explorer window
+HWND GetFileExplorerWindow(HWND hwnd) {
+    char className[256];
+    while (hwnd != NULL) {
+        GetClassName(hwnd, className, sizeof(className));
+        if (strcmp(className, "CabinetWClass") == 0 ||
+            strcmp(className, "SysTreeView32") == 0) {
+            return hwnd;
+        }
+        hwnd = GetParent(hwnd);
+    }
+    return NULL;
+}
+
+// Top-level window and its class, or NULL for a stale handle
+HWND GetRootWindow(WindowHandle window, char* className, int classNameSize) {
+    HWND hwnd = ToHwnd(window);
+    if (hwnd == NULL || !IsWindow(hwnd)) {
+        return NULL;
+    }
+    HWND root = GetAncestor(hwnd, GA_ROOT);
+    if (root == NULL || GetClassName(root, className, classNameSize) == 0) {
+        return NULL;
+    }
+    return root;
+}
+
+bool EqualsIgnoreCase(const char* a, const char* b) {
+    return _stricmp(a, b) == 0;
+}
+
+bool IsShellImage(const char* image) {
+    return EqualsIgnoreCase(image, "cmd.exe") || EqualsIgnoreCase(image, "powershell.exe") ||
+        EqualsIgnoreCase(image, "pwsh.exe");
+}
+
+// Most recently started shell whose parent is processId (a Windows
+// Terminal window hosts its tabs' shells as children), or 0
+uint32_t FindNewestShellChild(uint32_t processId) {
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+
+    uint32_t newest = 0;
+    ULONGLONG newestTime = 0;
+    PROCESSENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL more = Process32First(snapshot, &entry); more; more = Process32Next(snapshot, &entry)) {
+        if (entry.th32ParentProcessID != processId || !IsShellImage(entry.szExeFile)) {
+            continue;
+        }
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ProcessID);
+        if (process == NULL) {
+            continue;
+        }
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+            ULONGLONG time = ((ULONGLONG)created.dwHighDateTime << 32) | created.dwLowDateTime;
+            if (time >= newestTime) {
+                newestTime = time;
+                newest = entry.th32ProcessID;
+            }
+        }
+        CloseHandle(process);
+    }
+    CloseHandle(snapshot);
+    return newest;
+}
+
+// Layout of the parts of PROCESS_BASIC_INFORMATION, the PEB and
+// RTL_USER_PROCESS_PARAMETERS that lead to the current directory
+struct BasicInformation {
+    PVOID reserved1;
+    PVOID pebBaseAddress;
+    PVOID reserved2[2];
+    ULONG_PTR uniqueProcessId;
+    PVOID reserved3;
+};
+
+struct RemoteUnicodeString {
+    USHORT length;
+    USHORT maximumLength;
+    PWSTR buffer;
+};
+
+#ifdef _WIN64
+const size_t kPebProcessParametersOffset = 0x20;
+const size_t kCurrentDirectoryOffset = 0x38;
+#else
+const size_t kPebProcessParametersOffset = 0x10;
+const size_t kCurrentDirectoryOffset = 0x24;
+#endif
+
+typedef LONG (NTAPI* NtQueryInformationProcessFn)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+
+// Function to read another process's current directory
+bool ReadProcessCurrentDirectory(uint32_t processId, std::string& directory) {
+    static NtQueryInformationProcessFn queryInformation = (NtQueryInformationProcessFn)GetProcAddress(
+        GetModuleHandle("ntdll.dll"), "NtQueryInformationProcess");
+    if (queryInformation == NULL) {
+        return false;
+    }
+
+    HANDLE process = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_VM_READ, FALSE, processId);
+    if (process == NULL) {
+        return false;
+    }
+
+    // The offsets above only hold when both processes have the same bitness
+    BOOL selfWow64 = FALSE;
+    BOOL targetWow64 = FALSE;
+    bool found = false;
+    BasicInformation info;
+    PVOID parameters = NULL;
+    RemoteUnicodeString dosPath;
+    if (IsWow64Process(GetCurrentProcess(), &selfWow64) && IsWow64Process(process, &targetWow64) &&
+        selfWow64 == targetWow64 &&
+        queryInformation(process, 0, &info, sizeof(info), NULL) >= 0 &&
+        ReadProcessMemory(process, (const char*)info.pebBaseAddress + kPebProcessParametersOffset,
+            &parameters, sizeof(parameters), NULL) &&
+        ReadProcessMemory(process, (const char*)parameters + kCurrentDirectoryOffset,
+            &dosPath, sizeof(dosPath), NULL) &&
+        dosPath.length > 0 && dosPath.length <= MAX_PATH * sizeof(WCHAR)) {
+        WCHAR path[MAX_PATH + 1];
+        if (ReadProcessMemory(process, dosPath.buffer, path, dosPath.length, NULL)) {
+            int length = dosPath.length / sizeof(WCHAR);
+            // "C:\src\" -> "C:\src", but "C:\" stays
+            if (length > 3 && path[length - 1] == L'\\') {
+                length--;
+            }
+            char narrow[MAX_PATH * 2];
+            int written = WideCharToMultiByte(CP_ACP, 0, path, length, narrow, sizeof(narrow), NULL, NULL);
+            if (written > 0) {
+                directory.assign(narrow, written);
+                found = true;
+            }
+        }
+    }
+    CloseHandle(process);
+    return found;
+}
+
+// Editors that can put the open file's path in their title
+bool IsEditorImage(const std::string& image) {
+    return image == "code.exe" || image == "code - insiders.exe" || image == "notepad++.exe" ||
+        image == "sublime_text.exe" || image == "gvim.exe" || image == "devenv.exe";
+}
+
+bool IsDirectory(const std::string& path) {
+    DWORD attributes = GetFileAttributes(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
+
+} // namespace
+
+std::string GetUserHomeDirectory() {
+    char path[MAX_PATH];
+    if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_PROFILE, NULL, 0, path))) {
+        return std::string(path);
+    }
+    return "";
+}
+
+ExplorerContextProvider::ExplorerContextProvider(DirectoryResolver& resolver)
+    : m_resolver(resolver) {
+}
+
+WindowHandle ExplorerContextProvider::Claim(WindowHandle window) {
+    HWND hwnd = ToHwnd(window);
+    if (hwnd == NULL || !IsWindow(hwnd)) {
+        return kNoWindow;
+    }
+    return ToWindowHandle(GetFileExplorerWindow(hwnd));
+}
+
+std::string ExplorerContextProvider::GetDirectory(WindowHandle window, uint32_t,
+    std::chrono::steady_clock::time_point deadline) {
+    // Hash lookup; the IShellWindows walk only runs on a cold miss
+    std::string directory;
+    m_resolver.Resolve(window, deadline, directory);
+    return directory;
+}
+
+bool ExplorerContextProvider::GetSelection(WindowHandle window, std::chrono::steady_clock::time_point deadline,
+    std::vector<SelectedItem>& items) {
+    return m_resolver.ResolveSelection(window, deadline, items);
+}
+
+WindowHandle TerminalContextProvider::Claim(WindowHandle window) {
+    char className[256];
+    HWND root = GetRootWindow(window, className, sizeof(className));
+    if (root != NULL && (strcmp(className, "ConsoleWindowClass") == 0 ||
+        strcmp(className, "CASCADIA_HOSTING_WINDOW_CLASS") == 0)) {
+        return ToWindowHandle(root);
+    }
+    return kNoWindow;
+}
+
+std::string TerminalContextProvider::GetDirectory(WindowHandle window, uint32_t processId,
+    std::chrono::steady_clock::time_point deadline) {
+    // A console window reports the shell that owns it; Windows Terminal
+    // reports itself, with the shells as its children
+    char className[256];
+    GetClassName(ToHwnd(window), className, sizeof(className));
+    uint32_t shellId = processId;
+    if (strcmp(className, "CASCADIA_HOSTING_WINDOW_CLASS") == 0) {
+        shellId = FindNewestShellChild(processId);
+    }
+
+    std::string directory;
+    if (shellId == 0 || std::chrono::steady_clock::now() >= deadline ||
+        !ReadProcessCurrentDirectory(shellId, directory) || !IsDirectory(directory)) {
+        return "";
+    }
+    return directory;
+}
+
+EditorContextProvider::EditorContextProvider(ProcessImageCache& images)
+    : m_images(images) {
+}
+
+WindowHandle EditorContextProvider::Claim(WindowHandle window) {
+    char className[256];
+    HWND root = GetRootWindow(window, className, sizeof(className));
+    if (root != NULL && IsEditorImage(m_images.Lookup(ToWindowHandle(root)))) {
+        return ToWindowHandle(root);
+    }
+    return kNoWindow;
+}
+
+std::string EditorContextProvider::GetDirectory(WindowHandle window, uint32_t,
+    std::chrono::steady_clock::time_point deadline) {
+    // WM_GETTEXT goes to the editor's UI thread, so a hung editor costs at
+    // most the remaining budget
+    std::chrono::steady_clock::duration remaining = deadline - std::chrono::steady_clock::now();
+    long long remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count();
+    if (remainingMs <= 0) {
+        return "";
+    }
+    UINT timeoutMs = (UINT)std::min<long long>(remainingMs, 10000);
+
+    char title[1024];
+    DWORD_PTR copied = 0;
+    if (!SendMessageTimeout(ToHwnd(window), WM_GETTEXT, sizeof(title), (LPARAM)title,
+        SMTO_ABORTIFHUNG | SMTO_BLOCK, timeoutMs, &copied) || copied == 0) {
+        return "";
+    }
+
+    std::string path = FindPathInTitle(std::string(title, (size_t)copied));
+    if (path.empty() || IsDirectory(path)) {
+        return path;
+    }
+    // Usually a file: use its folder
+    size_t slash = path.find_last_of('\\');
+    if (slash == std::string::npos) {
+        return "";
+    }
+    std::string parent = path.substr(0, slash == 2 ? 3 : slash);
+    return IsDirectory(parent) ? parent : std::string();
+}
+
+WindowHandle DesktopContextProvider::Claim(WindowHandle window) {
+    char className[256];
+    HWND root = GetRootWindow(window, className, sizeof(className));
+    if (root == NULL) {
+        return kNoWindow;
+    }
+    // The icons live under Progman, or under a WorkerW once the wallpaper
+    // slideshow has split them off
+    if (strcmp(className, "Progman") == 0 ||
+        (strcmp(className, "WorkerW") == 0 && FindWindowEx(root, NULL, "SHELLDLL_DefView", NULL) != NULL)) {
+        return ToWindowHandle(root);
+    }
+    return kNoWindow;
+}
+
+std::string DesktopContextProvider::GetDirectory(WindowHandle, uint32_t, std::chrono::steady_clock::time_point) {
+    char path[MAX_PATH];
+    if (SUCCEEDED(SHGetFolderPath(NULL, CSIDL_DESKTOPDIRECTORY, NULL, 0, path))) {
+        return std::string(path);
+    }
+    return "";
+}
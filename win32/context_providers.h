@@ -0,0 +1,58 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include "context_provider.h"
+#include "directory_resolver.h"
+
+// Function to get the user's home directory
+std::string GetUserHomeDirectory();
+
+// Explorer windows recognised by class name, directories served from the
+// DirectoryCache through the deadline-bounded resolver
+class ExplorerContextProvider : public IContextProvider {
+public:
+    explicit ExplorerContextProvider(DirectoryResolver& resolver);
+
+    WindowHandle Claim(WindowHandle window) override;
+    std::string GetDirectory(WindowHandle window, uint32_t processId,
+        std::chrono::steady_clock::time_point deadline) override;
+    bool GetSelection(WindowHandle window, std::chrono::steady_clock::time_point deadline,
+        std::vector<SelectedItem>& items) override;
+
+private:
+    DirectoryResolver& m_resolver;
+};
+
+// Console windows and Windows Terminal. The directory is the shell's
+// current directory, read from its process parameters; for Windows
+// Terminal that is the most recently started shell in the window.
+class TerminalContextProvider : public IContextProvider {
+public:
+    WindowHandle Claim(WindowHandle window) override;
+    std::string GetDirectory(WindowHandle window, uint32_t processId,
+        std::chrono::steady_clock::time_point deadline) override;
+};
+
+// Editors whose title can show the open file's full path (Notepad++,
+// Sublime Text, VS Code with window.title set to ${activeEditorLong}, ...)
+class EditorContextProvider : public IContextProvider {
+public:
+    explicit EditorContextProvider(ProcessImageCache& images);
+
+    WindowHandle Claim(WindowHandle window) override;
+    std::string GetDirectory(WindowHandle window, uint32_t processId,
+        std::chrono::steady_clock::time_point deadline) override;
+
+private:
+    ProcessImageCache& m_images;
+};
+
+// The desktop itself launches in the Desktop folder
+class DesktopContextProvider : public IContextProvider {
+public:
+    WindowHandle Claim(WindowHandle window) override;
+    std::string GetDirectory(WindowHandle window, uint32_t processId,
+        std::chrono::steady_clock::time_point deadline) override;
+};
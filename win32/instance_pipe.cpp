@@ -0,0 +1,248 @@
+#include "instance_pipe.h"
+#include <objbase.h>
+#include <vector>
+
+namespace {
+
+const DWORD kPipeBufferSize = 4096;
+const DWORD kServerIoTimeoutMs = 5000;
+
+// Overlapped I/O on a pipe handle, abandoned when the timeout passes or the
+// stop event, if any, fires
+class OverlappedPipeStream : public IIpcStream {
+public:
+    OverlappedPipeStream(HANDLE pipe, HANDLE stopEvent, DWORD timeoutMs)
+        : m_pipe(pipe), m_stopEvent(stopEvent), m_timeoutMs(timeoutMs) {
+        m_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    }
+
+    ~OverlappedPipeStream() {
+        if (m_overlapped.hEvent != NULL) {
+            CloseHandle(m_overlapped.hEvent);
+        }
+    }
+
+    bool Read(char* buffer, size_t size, size_t& bytesRead) override {
+        DWORD transferred = 0;
+        ResetEvent(m_overlapped.hEvent);
+        BOOL done = ReadFile(m_pipe, buffer, (DWORD)size, NULL, &m_overlapped);
+        // ERROR_MORE_DATA only applies to message-mode pipes; this one is bytes
+        if (!Complete(done, transferred)) {
+            return false;
+        }
+        bytesRead = transferred;
+        return true;
+    }
+
+    bool Write(const char* data, size_t size) override {
+        DWORD transferred = 0;
+        ResetEvent(m_overlapped.hEvent);
+        BOOL done = WriteFile(m_pipe, data, (DWORD)size, NULL, &m_overlapped);
+        return Complete(done, transferred) && transferred == size;
+    }
+
+private:
+    bool Complete(BOOL done, DWORD& transferred) {
+        if (m_overlapped.hEvent == NULL) {
+            return false;
+        }
+        if (!done && GetLastError() != ERROR_IO_PENDING) {
+            return false;
+        }
+
+        HANDLE events[2] = { m_overlapped.hEvent, m_stopEvent };
+        DWORD eventCount = m_stopEvent != NULL ? 2 : 1;
+        if (WaitForMultipleObjects(eventCount, events, FALSE, m_timeoutMs) != WAIT_OBJECT_0) {
+            CancelIoEx(m_pipe, &m_overlapped);
+            GetOverlappedResult(m_pipe, &m_overlapped, &transferred, TRUE);
+            return false;
+        }
+        return GetOverlappedResult(m_pipe, &m_overlapped, &transferred, FALSE) != FALSE;
+    }
+
+    HANDLE m_pipe;
+    HANDLE m_stopEvent;
+    DWORD m_timeoutMs;
+    OVERLAPPED m_overlapped = {};
+};
+
+// Security attributes whose DACL lets only the current user in. Without
+// them the pipe gets the default DACL, which also admits other accounts
+// (LocalSystem, Administrators, and read access for Everyone). Buffers are
+// DWORDs so the token user and the ACL are suitably aligned.
+class CurrentUserOnlySecurity {
+public:
+    CurrentUserOnlySecurity() : m_valid(false) {
+        m_attributes.nLength = sizeof(m_attributes);
+        m_attributes.lpSecurityDescriptor = &m_descriptor;
+        m_attributes.bInheritHandle = FALSE;
+
+        HANDLE token = NULL;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) {
+            return;
+        }
+        DWORD size = 0;
+        GetTokenInformation(token, TokenUser, NULL, 0, &size);
+        m_tokenUser.resize(size / sizeof(DWORD) + 1);
+        bool found = size != 0 && GetTokenInformation(token, TokenUser, m_tokenUser.data(), size, &size);
+        CloseHandle(token);
+        if (!found) {
+            return;
+        }
+
+        PSID user = reinterpret_cast<TOKEN_USER*>(m_tokenUser.data())->User.Sid;
+        DWORD aclSize = sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) - sizeof(DWORD) + GetLengthSid(user);
+        m_acl.resize(aclSize / sizeof(DWORD) + 1);
+        PACL acl = reinterpret_cast<PACL>(m_acl.data());
+        m_valid = InitializeAcl(acl, aclSize, ACL_REVISION) &&
+            AddAccessAllowedAce(acl, ACL_REVISION, GENERIC_ALL, user) &&
+            InitializeSecurityDescriptor(&m_descriptor, SECURITY_DESCRIPTOR_REVISION) &&
+            SetSecurityDescriptorDacl(&m_descriptor, TRUE, acl, FALSE);
+    }
+
+    CurrentUserOnlySecurity(const CurrentUserOnlySecurity&) = delete;
+    CurrentUserOnlySecurity& operator=(const CurrentUserOnlySecurity&) = delete;
+
+    // Null if the DACL could not be built
+    SECURITY_ATTRIBUTES* Get() {
+        return m_valid ? &m_attributes : nullptr;
+    }
+
+private:
+    std::vector<DWORD> m_tokenUser;
+    std::vector<DWORD> m_acl;
+    SECURITY_DESCRIPTOR m_descriptor = {};
+    SECURITY_ATTRIBUTES m_attributes = {};
+    bool m_valid;
+};
+
+} // namespace
+
+std::string GetInstancePipeName() {
+    DWORD sessionId = 0;
+    ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+
+    char userName[257] = "";
+    DWORD length = sizeof(userName);
+    if (!GetUserName(userName, &length)) {
+        userName[0] = '\0';
+    }
+
+    return "\\\\.\\pipe\\ContextLauncher." + std::to_string(sessionId) + "." + userName;
+}
+
+InstancePipeServer::InstancePipeServer(IInstanceCommands& commands)
+    : m_dispatcher(commands), m_stopEvent(NULL) {
+}
+
+InstancePipeServer::~InstancePipeServer() {
+    Stop();
+}
+
+bool InstancePipeServer::Start() {
+    Stop();
+
+    m_pipeName = GetInstancePipeName();
+    m_stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (m_stopEvent == NULL) {
+        return false;
+    }
+
+    m_thread = std::thread(&InstancePipeServer::Run, this);
+    return true;
+}
+
+void InstancePipeServer::Stop() {
+    if (m_thread.joinable()) {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+    }
+    if (m_stopEvent != NULL) {
+        CloseHandle(m_stopEvent);
+        m_stopEvent = NULL;
+    }
+}
+
+void InstancePipeServer::Run() {
+    // Launch and PrintContext may fall back to COM on this thread
+    CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+
+    // Only the current user may open the pipe. It is created once, as the
+    // first instance of its name, and reused for every client: if another
+    // process took the name first, creation fails instead of joining its
+    // pipe, and no gap between clients lets one slip in.
+    CurrentUserOnlySecurity security;
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    if (security.Get() != nullptr) {
+        pipe = CreateNamedPipe(m_pipeName.c_str(),
+            PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+            1, kPipeBufferSize, kPipeBufferSize, 0, security.Get());
+    }
+
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    HANDLE events[2] = { m_stopEvent, overlapped.hEvent };
+
+    while (pipe != INVALID_HANDLE_VALUE && overlapped.hEvent != NULL &&
+        WaitForSingleObject(m_stopEvent, 0) != WAIT_OBJECT_0) {
+        ResetEvent(overlapped.hEvent);
+        bool connected = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+        if (!connected) {
+            DWORD error = GetLastError();
+            if (error == ERROR_PIPE_CONNECTED) {
+                connected = true;
+            }
+            else if (error == ERROR_IO_PENDING) {
+                if (WaitForMultipleObjects(2, events, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+                    DWORD unused = 0;
+                    connected = GetOverlappedResult(pipe, &overlapped, &unused, FALSE) != FALSE;
+                }
+                else {
+                    CancelIoEx(pipe, &overlapped);
+                    DWORD unused = 0;
+                    GetOverlappedResult(pipe, &overlapped, &unused, TRUE);
+                }
+            }
+        }
+
+        if (connected) {
+            OverlappedPipeStream stream(pipe, m_stopEvent, kServerIoTimeoutMs);
+            m_dispatcher.Serve(stream);
+            FlushFileBuffers(pipe);
+        }
+        // Also clears a client that hung up before it was served
+        DisconnectNamedPipe(pipe);
+    }
+
+    if (pipe != INVALID_HANDLE_VALUE) {
+        CloseHandle(pipe);
+    }
+    if (overlapped.hEvent != NULL) {
+        CloseHandle(overlapped.hEvent);
+    }
+    CoUninitialize();
+}
+
+InstanceCallResult CallRunningInstance(const IpcRequest& request, IpcResponse& response,
+    DWORD connectTimeoutMs, DWORD replyTimeoutMs) {
+    std::string pipeName = GetInstancePipeName();
+
+    HANDLE pipe = CreateFile(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+    if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY) {
+        // Another client is being served; the instance takes one at a time
+        if (WaitNamedPipe(pipeName.c_str(), connectTimeoutMs)) {
+            pipe = CreateFile(pipeName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+        }
+    }
+    if (pipe == INVALID_HANDLE_VALUE) {
+        return InstanceCallResult::NotRunning;
+    }
+
+    // Once connected, the request may reach the instance even if the write
+    // reports failure, so from here on nothing short of an answer is retried
+    OverlappedPipeStream stream(pipe, NULL, replyTimeoutMs);
+    bool answered = CallInstance(stream, request, response);
+    CloseHandle(pipe);
+    return answered ? InstanceCallResult::Answered : InstanceCallResult::NoReply;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include <thread>
+#include "instance_ipc.h"
+
+// Named pipe for the current user's session, e.g.
+// \\.\pipe\ContextLauncher.1.alice
+std::string GetInstancePipeName();
+
+// Accepts one local client of the current user at a time on its own thread
+// and serves it with an IpcDispatcher. Reads time out so a stuck client
+// cannot wedge the server.
+class InstancePipeServer {
+public:
+    explicit InstancePipeServer(IInstanceCommands& commands);
+    ~InstancePipeServer();
+
+    bool Start();
+    void Stop();
+
+private:
+    void Run();
+
+    IpcDispatcher m_dispatcher;
+    std::string m_pipeName;
+    HANDLE m_stopEvent;
+    std::thread m_thread;
+};
+
+enum class InstanceCallResult {
+    NotRunning,  // No instance accepted the connection; nothing was sent
+    NoReply,     // Connected, but no answer came back; the request may have run
+    Answered
+};
+
+// Sends one request to the running instance. connectTimeoutMs bounds the
+// wait for a busy pipe, replyTimeoutMs each read and write after that.
+InstanceCallResult CallRunningInstance(const IpcRequest& request, IpcResponse& response,
+    DWORD connectTimeoutMs, DWORD replyTimeoutMs);
@@ -0,0 +1,123 @@
+#include "journal_file.h"
+
+namespace {
+
+bool WriteAll(HANDLE file, const char* data, size_t size) {
+    while (size > 0) {
+        DWORD chunk = size > 0x10000000 ? 0x10000000 : (DWORD)size;
+        DWORD written = 0;
+        if (!WriteFile(file, data, chunk, &written, NULL) || written == 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+} // namespace
+
+MappedJournalFile::MappedJournalFile()
+    : m_mapFile(INVALID_HANDLE_VALUE), m_mapping(NULL), m_view(nullptr), m_append(INVALID_HANDLE_VALUE) {
+}
+
+MappedJournalFile::~MappedJournalFile() {
+    Unmap();
+    CloseAppendHandle();
+}
+
+bool MappedJournalFile::Map(const std::string& path, std::string_view& contents) {
+    Unmap();
+    m_mapFile = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_mapFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_mapFile, &size)) {
+        Unmap();
+        return false;
+    }
+
+    // An empty file cannot be mapped, and has nothing to read anyway
+    contents = std::string_view();
+    if (size.QuadPart == 0) {
+        return true;
+    }
+    m_mapping = CreateFileMapping(m_mapFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    m_view = m_mapping != NULL ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (m_view == nullptr) {
+        Unmap();
+        return false;
+    }
+    contents = std::string_view(static_cast<const char*>(m_view), (size_t)size.QuadPart);
+    return true;
+}
+
+void MappedJournalFile::Unmap() {
+    if (m_view != nullptr) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping != NULL) {
+        CloseHandle(m_mapping);
+        m_mapping = NULL;
+    }
+    if (m_mapFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_mapFile);
+        m_mapFile = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool MappedJournalFile::Append(const std::string& path, std::string_view data) {
+    if (m_append == INVALID_HANDLE_VALUE || m_appendPath != path) {
+        CloseAppendHandle();
+        m_append = CreateFile(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_append == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        m_appendPath = path;
+    }
+    return WriteAll(m_append, data.data(), data.size());
+}
+
+bool MappedJournalFile::Truncate(const std::string& path, uint64_t size) {
+    Unmap();
+    CloseAppendHandle();
+    HANDLE file = CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)size;
+    bool truncated = SetFilePointerEx(file, position, NULL, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    return truncated;
+}
+
+bool MappedJournalFile::Replace(const std::string& path, const std::string& contents) {
+    Unmap();
+    CloseAppendHandle();
+    std::string temporary = path + ".tmp";
+    HANDLE file = CreateFile(temporary.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // Flushed before the rename, so a crash leaves the old or the new file
+    bool written = WriteAll(file, contents.data(), contents.size()) && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!written || !MoveFileEx(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFile(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+void MappedJournalFile::CloseAppendHandle() {
+    if (m_append != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_append);
+        m_append = INVALID_HANDLE_VALUE;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include "history_journal.h"
+
+// Reads map the file, so replaying the journal at startup needs no copy of
+// it. Appends go through one handle kept open between launches; rewrites
+// close it first and go through a temporary file and MoveFileEx.
+class MappedJournalFile : public IJournalFile {
+public:
+    MappedJournalFile();
+    ~MappedJournalFile();
+
+    bool Map(const std::string& path, std::string_view& contents) override;
+    void Unmap() override;
+    bool Append(const std::string& path, std::string_view data) override;
+    bool Truncate(const std::string& path, uint64_t size) override;
+    bool Replace(const std::string& path, const std::string& contents) override;
+
+private:
+    void CloseAppendHandle();
+
+    HANDLE m_mapFile;
+    HANDLE m_mapping;
+    const void* m_view;
+    HANDLE m_append;
+    std::string m_appendPath;
+};
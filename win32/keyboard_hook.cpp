@@ -0,0 +1,157 @@
+#include "keyboard_hook.h"
+
+namespace {
+
+// Thread message telling the hook thread a new trie is pending
+const UINT WM_SEQUENCE_TRIE_CHANGED = WM_APP + 1;
+
+// Unassigned virtual key, sent to mask a swallowed Alt or Win combination
+const WORD kVkMask = 0xE8;
+
+unsigned int GetHeldModifiers() {
+    unsigned int modifiers = 0;
+    if (GetAsyncKeyState(VK_CONTROL) & 0x8000) modifiers |= kModifierControl;
+    if (GetAsyncKeyState(VK_MENU) & 0x8000) modifiers |= kModifierAlt;
+    if (GetAsyncKeyState(VK_SHIFT) & 0x8000) modifiers |= kModifierShift;
+    if ((GetAsyncKeyState(VK_LWIN) | GetAsyncKeyState(VK_RWIN)) & 0x8000) modifiers |= kModifierWin;
+    return modifiers;
+}
+
+// Releasing Alt or Win on its own opens the menu bar or the Start menu.
+// Once the key between press and release is swallowed, that is what the
+// system sees, so another key is slipped in between.
+void MaskModifierRelease() {
+    INPUT inputs[2] = {};
+    inputs[0].type = INPUT_KEYBOARD;
+    inputs[0].ki.wVk = kVkMask;
+    inputs[1] = inputs[0];
+    inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+    SendInput(2, inputs, sizeof(INPUT));
+}
+
+} // namespace
+
+SequenceKeyboardHook* SequenceKeyboardHook::s_instance = nullptr;
+
+SequenceKeyboardHook::SequenceKeyboardHook()
+    : m_target(NULL), m_hook(NULL), m_threadId(0), m_hasPending(false) {
+}
+
+SequenceKeyboardHook::~SequenceKeyboardHook() {
+    Stop();
+}
+
+bool SequenceKeyboardHook::Start(HWND target) {
+    Stop();
+    m_target = target;
+    s_instance = this;
+
+    // Thread messages are only queued once the thread has a message queue
+    HANDLE ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (ready == NULL) {
+        return false;
+    }
+    m_thread = std::thread(&SequenceKeyboardHook::Run, this, ready);
+    WaitForSingleObject(ready, INFINITE);
+    CloseHandle(ready);
+    return true;
+}
+
+void SequenceKeyboardHook::Stop() {
+    if (m_thread.joinable()) {
+        PostThreadMessage(m_threadId, WM_QUIT, 0, 0);
+        m_thread.join();
+    }
+    m_threadId = 0;
+    s_instance = nullptr;
+}
+
+void SequenceKeyboardHook::SetTrie(std::shared_ptr<const SequenceTrie> trie) {
+    DWORD threadId = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = std::move(trie);
+        m_hasPending = true;
+        threadId = m_threadId;
+    }
+    if (threadId != 0) {
+        PostThreadMessage(threadId, WM_SEQUENCE_TRIE_CHANGED, 0, 0);
+    }
+}
+
+void SequenceKeyboardHook::Run(HANDLE ready) {
+    // Windows drops a low-level hook that keeps input waiting past
+    // LowLevelHooksTimeout; this thread must win the CPU whenever a key arrives
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+    MSG msg;
+    PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_threadId = GetCurrentThreadId();
+    }
+    SetEvent(ready);
+
+    ApplyPendingTrie();
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        if (msg.message == WM_SEQUENCE_TRIE_CHANGED) {
+            ApplyPendingTrie();
+        }
+    }
+
+    if (m_hook != NULL) {
+        UnhookWindowsHookEx(m_hook);
+        m_hook = NULL;
+    }
+}
+
+void SequenceKeyboardHook::ApplyPendingTrie() {
+    std::shared_ptr<const SequenceTrie> trie;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasPending) {
+            return;
+        }
+        trie = m_pending;
+        m_hasPending = false;
+    }
+
+    bool needed = trie && !trie->Empty();
+    m_matcher.SetTrie(std::move(trie));
+    if (needed && m_hook == NULL) {
+        m_hook = SetWindowsHookEx(WH_KEYBOARD_LL, &SequenceKeyboardHook::OnKeyboardEvent, GetModuleHandle(NULL), 0);
+    }
+    else if (!needed && m_hook != NULL) {
+        UnhookWindowsHookEx(m_hook);
+        m_hook = NULL;
+    }
+}
+
+LRESULT CALLBACK SequenceKeyboardHook::OnKeyboardEvent(int code, WPARAM wParam, LPARAM lParam) {
+    SequenceKeyboardHook* hook = s_instance;
+    const KBDLLHOOKSTRUCT* info = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+
+    // Synthesized input, our own mask key included, is not typing
+    if (code != HC_ACTION || hook == nullptr || (info->flags & LLKHF_INJECTED) != 0) {
+        return CallNextHookEx(NULL, code, wParam, lParam);
+    }
+
+    // Modifiers are asked of the system rather than tracked, so a key-up
+    // lost to the secure desktop (Ctrl+Alt+Del) cannot leave one stuck
+    bool down = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+    unsigned int modifiers = down ? GetHeldModifiers() : 0;
+    KeyEvent event(info->vkCode, modifiers, down, std::chrono::steady_clock::now());
+
+    int hotkeyId = 0;
+    if (hook->m_matcher.OnKey(event, hotkeyId) == KeyAction::Pass) {
+        return CallNextHookEx(NULL, code, wParam, lParam);
+    }
+
+    if (down && (modifiers & (kModifierAlt | kModifierWin)) != 0) {
+        MaskModifierRelease();
+    }
+    if (hotkeyId != 0) {
+        PostMessage(hook->m_target, WM_HOTKEY, (WPARAM)hotkeyId, 0);
+    }
+    return 1;
+}
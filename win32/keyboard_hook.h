@@ -0,0 +1,45 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "key_sequence.h"
+
+// Matches hotkey sequences in a WH_KEYBOARD_LL hook. The hook runs on a
+// thread of its own, so a busy launcher window (a message box, a reload)
+// never holds up keyboard input for the whole desktop, and it is installed
+// only while the trie has sequences. A completed sequence is posted to the
+// target window as WM_HOTKEY with the app's hotkey id, the message
+// RegisterHotKey sends, so dispatch does not tell the two apart.
+class SequenceKeyboardHook {
+public:
+    SequenceKeyboardHook();
+    ~SequenceKeyboardHook();
+
+    bool Start(HWND target);
+    void Stop();
+
+    // May be called from any thread, before or after Start; the hook
+    // thread picks the trie up between key events
+    void SetTrie(std::shared_ptr<const SequenceTrie> trie);
+
+private:
+    static LRESULT CALLBACK OnKeyboardEvent(int code, WPARAM wParam, LPARAM lParam);
+    void Run(HANDLE ready);
+    void ApplyPendingTrie();
+
+    // Low-level hook callbacks carry no context pointer
+    static SequenceKeyboardHook* s_instance;
+
+    HWND m_target;
+    HHOOK m_hook;
+    DWORD m_threadId;
+    std::thread m_thread;
+    SequenceMatcher m_matcher;  // Hook thread only
+
+    std::mutex m_mutex;
+    std::shared_ptr<const SequenceTrie> m_pending;
+    bool m_hasPending;
+};
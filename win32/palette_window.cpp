@@ -0,0 +1,211 @@
+#include "palette_window.h"
+
+namespace {
+
+const char kClassName[] = "LauncherPaletteClass";
+
+const int kWidth = 640;
+const int kEditHeight = 30;
+const int kRowHeight = 22;
+const size_t kRows = 12;
+const int kPadding = 6;
+
+const int kEditId = 1;
+const int kListId = 2;
+
+} // namespace
+
+PaletteWindow::PaletteWindow()
+    : m_window(NULL), m_edit(NULL), m_list(NULL), m_editProc(NULL), m_font(NULL) {
+}
+
+PaletteWindow::~PaletteWindow() {
+    Destroy();
+}
+
+bool PaletteWindow::Create(ChooseCallback onChoose) {
+    m_onChoose = onChoose;
+    HINSTANCE instance = GetModuleHandle(NULL);
+
+    WNDCLASS wc = {};
+    wc.lpfnWndProc = WindowProc;
+    wc.hInstance = instance;
+    wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+    wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+    wc.lpszClassName = kClassName;
+    RegisterClass(&wc);
+
+    int height = kPadding * 3 + kEditHeight + kRowHeight * (int)kRows;
+    m_window = CreateWindowEx(WS_EX_TOOLWINDOW | WS_EX_TOPMOST, kClassName, "Quick Launch", WS_POPUP | WS_BORDER,
+        0, 0, kWidth, height, NULL, NULL, instance, this);
+    if (m_window == NULL) {
+        return false;
+    }
+
+    m_edit = CreateWindowEx(0, "EDIT", "", WS_CHILD | WS_VISIBLE | WS_BORDER | ES_AUTOHSCROLL,
+        kPadding, kPadding, kWidth - kPadding * 2, kEditHeight, m_window, (HMENU)(INT_PTR)kEditId, instance, NULL);
+    m_list = CreateWindowEx(0, "LISTBOX", "", WS_CHILD | WS_VISIBLE | LBS_NOTIFY | LBS_NOINTEGRALHEIGHT,
+        kPadding, kPadding * 2 + kEditHeight, kWidth - kPadding * 2, kRowHeight * (int)kRows,
+        m_window, (HMENU)(INT_PTR)kListId, instance, NULL);
+    if (m_edit == NULL || m_list == NULL) {
+        Destroy();
+        return false;
+    }
+
+    NONCLIENTMETRICS metrics = {};
+    metrics.cbSize = sizeof(metrics);
+    if (SystemParametersInfo(SPI_GETNONCLIENTMETRICS, sizeof(metrics), &metrics, 0)) {
+        metrics.lfMessageFont.lfHeight = -(kRowHeight * 3 / 4);
+        m_font = CreateFontIndirect(&metrics.lfMessageFont);
+        SendMessage(m_edit, WM_SETFONT, (WPARAM)m_font, FALSE);
+        SendMessage(m_list, WM_SETFONT, (WPARAM)m_font, FALSE);
+    }
+    SendMessage(m_list, LB_SETITEMHEIGHT, 0, kRowHeight);
+
+    // Arrow keys, Enter and Escape are handled while typing
+    SetWindowLongPtr(m_edit, GWLP_USERDATA, (LONG_PTR)this);
+    m_editProc = (WNDPROC)SetWindowLongPtr(m_edit, GWLP_WNDPROC, (LONG_PTR)EditProc);
+    return true;
+}
+
+void PaletteWindow::Destroy() {
+    if (m_window != NULL) {
+        DestroyWindow(m_window);
+        m_window = NULL;
+        m_edit = NULL;
+        m_list = NULL;
+    }
+    if (m_font != NULL) {
+        DeleteObject(m_font);
+        m_font = NULL;
+    }
+}
+
+void PaletteWindow::Show(std::vector<PaletteItem> items) {
+    if (m_window == NULL) {
+        return;
+    }
+    m_search.SetItems(std::move(items));
+
+    POINT cursor;
+    GetCursorPos(&cursor);
+    MONITORINFO monitor = {};
+    monitor.cbSize = sizeof(monitor);
+    GetMonitorInfo(MonitorFromPoint(cursor, MONITOR_DEFAULTTONEAREST), &monitor);
+    const RECT& work = monitor.rcWork;
+    RECT bounds;
+    GetWindowRect(m_window, &bounds);
+    int x = work.left + (work.right - work.left - (bounds.right - bounds.left)) / 2;
+    int y = work.top + (work.bottom - work.top) / 5;
+    SetWindowPos(m_window, HWND_TOPMOST, x, y, 0, 0, SWP_NOSIZE | SWP_SHOWWINDOW);
+
+    SetWindowText(m_edit, "");
+    Refresh();
+    SetForegroundWindow(m_window);
+    SetFocus(m_edit);
+}
+
+void PaletteWindow::Hide() {
+    if (m_window != NULL && IsWindowVisible(m_window)) {
+        ShowWindow(m_window, SW_HIDE);
+    }
+}
+
+void PaletteWindow::Refresh() {
+    char query[256];
+    int length = GetWindowText(m_edit, query, sizeof(query));
+    m_shown = m_search.Query(std::string_view(query, length > 0 ? (size_t)length : 0), kRows);
+
+    // One repaint for the whole list instead of one per row
+    SendMessage(m_list, WM_SETREDRAW, FALSE, 0);
+    SendMessage(m_list, LB_RESETCONTENT, 0, 0);
+    for (const PaletteMatch& match : m_shown) {
+        SendMessage(m_list, LB_ADDSTRING, 0, (LPARAM)m_search.Items()[match.item].text.c_str());
+    }
+    if (!m_shown.empty()) {
+        SendMessage(m_list, LB_SETCURSEL, 0, 0);
+    }
+    SendMessage(m_list, WM_SETREDRAW, TRUE, 0);
+    InvalidateRect(m_list, NULL, TRUE);
+}
+
+void PaletteWindow::MoveSelection(int delta) {
+    if (m_shown.empty()) {
+        return;
+    }
+    int count = (int)m_shown.size();
+    int selected = (int)SendMessage(m_list, LB_GETCURSEL, 0, 0);
+    selected = ((selected < 0 ? 0 : selected) + delta + count) % count;
+    SendMessage(m_list, LB_SETCURSEL, selected, 0);
+}
+
+void PaletteWindow::Choose() {
+    int selected = (int)SendMessage(m_list, LB_GETCURSEL, 0, 0);
+    if (selected < 0 || (size_t)selected >= m_shown.size()) {
+        return;
+    }
+    // Hidden first, so the launch is not competing with the palette for focus
+    PaletteItem item = m_search.Items()[m_shown[selected].item];
+    Hide();
+    if (m_onChoose) {
+        m_onChoose(item);
+    }
+}
+
+LRESULT CALLBACK PaletteWindow::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    if (uMsg == WM_NCCREATE) {
+        CREATESTRUCT* create = reinterpret_cast<CREATESTRUCT*>(lParam);
+        SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)create->lpCreateParams);
+    }
+    PaletteWindow* self = reinterpret_cast<PaletteWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    if (self == nullptr) {
+        return DefWindowProc(hwnd, uMsg, wParam, lParam);
+    }
+
+    switch (uMsg) {
+    case WM_COMMAND:
+        if (LOWORD(wParam) == kEditId && HIWORD(wParam) == EN_CHANGE) {
+            self->Refresh();
+        }
+        else if (LOWORD(wParam) == kListId && HIWORD(wParam) == LBN_DBLCLK) {
+            self->Choose();
+        }
+        return 0;
+
+    case WM_ACTIVATE:
+        if (LOWORD(wParam) == WA_INACTIVE) {
+            self->Hide();
+        }
+        return 0;
+
+    case WM_CLOSE:
+        self->Hide();
+        return 0;
+    }
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT CALLBACK PaletteWindow::EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    PaletteWindow* self = reinterpret_cast<PaletteWindow*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    if (uMsg == WM_KEYDOWN) {
+        switch (wParam) {
+        case VK_DOWN:
+            self->MoveSelection(1);
+            return 0;
+        case VK_UP:
+            self->MoveSelection(-1);
+            return 0;
+        case VK_RETURN:
+            self->Choose();
+            return 0;
+        case VK_ESCAPE:
+            self->Hide();
+            return 0;
+        }
+    }
+    // The edit control would beep at these
+    else if (uMsg == WM_CHAR && (wParam == '\r' || wParam == 27)) {
+        return 0;
+    }
+    return CallWindowProc(self->m_editProc, hwnd, uMsg, wParam, lParam);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <functional>
+#include <vector>
+#include "palette.h"
+
+// Quick-launch palette: a search box over apps and recent launches with the
+// best matches listed below it. It lives on the UI thread; each keystroke
+// runs one PaletteSearch query and refills the list, and it hides itself
+// when it loses focus. Up/Down move the selection, Enter launches it and
+// Escape closes.
+class PaletteWindow {
+public:
+    typedef std::function<void(const PaletteItem& item)> ChooseCallback;
+
+    PaletteWindow();
+    ~PaletteWindow();
+
+    bool Create(ChooseCallback onChoose);
+    void Destroy();
+
+    // Empties the search box and shows the palette near the top of the
+    // monitor under the cursor
+    void Show(std::vector<PaletteItem> items);
+    void Hide();
+
+private:
+    static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    static LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    void Refresh();
+    void MoveSelection(int delta);
+    void Choose();
+
+    HWND m_window;
+    HWND m_edit;
+    HWND m_list;
+    WNDPROC m_editProc;
+    HFONT m_font;
+    PaletteSearch m_search;
+    std::vector<PaletteMatch> m_shown;
+    ChooseCallback m_onChoose;
+};
@@ -0,0 +1,566 @@
+#include "shell_windows.h"
+#include "context_providers.h"
+#include <exdispid.h>
+#include <shobjidl.h>
+#include <functional>
+#include <set>
+
+namespace {
+
+std::string Narrow(PCWSTR text) {
+    int length = WideCharToMultiByte(CP_ACP, 0, text, -1, NULL, 0, NULL, NULL);
+    if (length <= 1) {
+        return "";
+    }
+    std::string narrow(length, '\0');
+    WideCharToMultiByte(CP_ACP, 0, text, -1, &narrow[0], length, NULL, NULL);
+    narrow.resize(length - 1);
+    return narrow;
+}
+
+std::wstring Widen(const std::string& text) {
+    int length = MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0);
+    std::wstring wide(length, L'\0');
+    if (length > 0) {
+        MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), &wide[0], length);
+    }
+    return wide;
+}
+
+// IWebBrowserApp -> IFolderView of the active shell view
+bool GetBrowserFolderView(IWebBrowserApp* browser, CComPtr<IFolderView>& spFolderView) {
+    CComPtr<IDispatch> spDispDoc;
+    HRESULT hr = browser->get_Document(&spDispDoc);
+    if (FAILED(hr) || spDispDoc == nullptr) {
+        return false;
+    }
+
+    CComPtr<IServiceProvider> spServiceProvider;
+    hr = spDispDoc->QueryInterface(IID_PPV_ARGS(&spServiceProvider));
+    if (FAILED(hr) || !spServiceProvider) {
+        return false;
+    }
+
+    CComPtr<IShellBrowser> spShellBrowser;
+    hr = spServiceProvider->QueryService(SID_STopLevelBrowser, IID_PPV_ARGS(&spShellBrowser));
+    if (FAILED(hr) || !spShellBrowser) {
+        return false;
+    }
+
+    CComPtr<IShellView> spShellView;
+    hr = spShellBrowser->QueryActiveShellView(&spShellView);
+    if (FAILED(hr) || !spShellView) {
+        return false;
+    }
+
+    hr = spShellView->QueryInterface(IID_PPV_ARGS(&spFolderView));
+    return SUCCEEDED(hr) && spFolderView;
+}
+
+// Walks IShellWindows for the shell browser showing tab
+bool FindTabBrowser(HWND tab, CComPtr<IWebBrowserApp>& browser) {
+    HWND frame = GetAncestor(tab, GA_ROOT);
+    if (frame == NULL) {
+        frame = tab;
+    }
+
+    CComPtr<IShellWindows> spShellWindows;
+    HRESULT hr = spShellWindows.CoCreateInstance(CLSID_ShellWindows);
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    SHANDLE_PTR hwndShell;
+    CComPtr<IDispatch> spdisp;
+
+    for (long i = 0; ; i++) {
+        spdisp.Release();
+
+        hr = spShellWindows->Item(CComVariant(i), &spdisp);
+        if (FAILED(hr)) {
+            break;
+        }
+
+        if (spdisp == nullptr) {
+            break;
+        }
+
+        CComPtr<IWebBrowserApp> spWebBrowserApp;
+        spdisp.QueryInterface(&spWebBrowserApp);
+
+        if (spWebBrowserApp) {
+            spWebBrowserApp->get_HWND(&hwndShell);
+
+            // Tabs of one window share its HWND; only those pay for the tab check
+            if ((HWND)hwndShell == frame && GetBrowserTab(spWebBrowserApp, frame) == tab) {
+                browser = spWebBrowserApp;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+// Minimal IDispatch event sink that forwards each DISPID to a handler
+class ShellWindowEvents::DispatchSink final : public IDispatch {
+public:
+    DispatchSink(REFIID eventsIid, std::function<void(DISPID)> handler)
+        : m_refCount(1), m_eventsIid(eventsIid), m_handler(handler) {}
+
+    void Detach() {
+        m_handler = nullptr;
+    }
+
+    STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override {
+        if (ppv == nullptr) {
+            return E_POINTER;
+        }
+        if (IsEqualIID(riid, IID_IUnknown) || IsEqualIID(riid, IID_IDispatch) || IsEqualIID(riid, m_eventsIid)) {
+            *ppv = static_cast<IDispatch*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) AddRef() override {
+        return InterlockedIncrement(&m_refCount);
+    }
+
+    STDMETHODIMP_(ULONG) Release() override {
+        ULONG count = InterlockedDecrement(&m_refCount);
+        if (count == 0) {
+            delete this;
+        }
+        return count;
+    }
+
+    STDMETHODIMP GetTypeInfoCount(UINT* count) override {
+        *count = 0;
+        return S_OK;
+    }
+
+    STDMETHODIMP GetTypeInfo(UINT, LCID, ITypeInfo**) override {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP GetIDsOfNames(REFIID, LPOLESTR*, UINT, LCID, DISPID*) override {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP Invoke(DISPID dispId, REFIID, LCID, WORD, DISPPARAMS*, VARIANT*, EXCEPINFO*, UINT*) override {
+        // The handler may unadvise this sink - stay alive until it returns
+        AddRef();
+        std::function<void(DISPID)> handler = m_handler;
+        if (handler) {
+            handler(dispId);
+        }
+        Release();
+        return S_OK;
+    }
+
+private:
+    LONG m_refCount;
+    IID m_eventsIid;
+    std::function<void(DISPID)> m_handler;
+};
+
+bool GetBrowserDirectory(IWebBrowserApp* browser, VirtualFolderMap& virtualFolders, std::string& directory) {
+    directory.clear();
+
+    CComPtr<IFolderView> spFolderView;
+    if (!GetBrowserFolderView(browser, spFolderView)) {
+        return false;
+    }
+
+    CComPtr<IPersistFolder2> spPersistFolder2;
+    HRESULT hr = spFolderView->GetFolder(IID_PPV_ARGS(&spPersistFolder2));
+    if (FAILED(hr) || !spPersistFolder2) {
+        return false;
+    }
+
+    LPITEMIDLIST pidl = nullptr;
+    hr = spPersistFolder2->GetCurFolder(&pidl);
+    if (SUCCEEDED(hr) && pidl) {
+        char path[MAX_PATH];
+        PWSTR parsingName = nullptr;
+        if (SHGetPathFromIDList(pidl, path)) {
+            directory = std::string(path);
+        }
+        else if (SUCCEEDED(SHGetNameFromIDList(pidl, SIGDN_DESKTOPABSOLUTEPARSING, &parsingName))) {
+            // This PC, Quick Access, a library: launch in the folder it stands for
+            virtualFolders.Resolve(Narrow(parsingName), directory);
+            CoTaskMemFree(parsingName);
+        }
+        CoTaskMemFree(pidl);
+    }
+    return true;
+}
+
+bool GetBrowserSelection(IWebBrowserApp* browser, std::vector<SelectedItem>& items) {
+    items.clear();
+
+    CComPtr<IFolderView> spFolderView;
+    if (!GetBrowserFolderView(browser, spFolderView)) {
+        return false;
+    }
+
+    // An empty selection fails with no array at all
+    CComPtr<IShellItemArray> spSelection;
+    HRESULT hr = spFolderView->Items(SVGIO_SELECTION | SVGIO_FLAG_VIEWORDER, IID_PPV_ARGS(&spSelection));
+    if (FAILED(hr) || !spSelection) {
+        return true;
+    }
+
+    DWORD count = 0;
+    spSelection->GetCount(&count);
+    for (DWORD i = 0; i < count; i++) {
+        CComPtr<IShellItem> spItem;
+        PWSTR path = nullptr;
+        if (FAILED(spSelection->GetItemAt(i, &spItem)) || FAILED(spItem->GetDisplayName(SIGDN_FILESYSPATH, &path))) {
+            continue;
+        }
+        // Zip files are folders to the shell but files to everyone else
+        SFGAOF attributes = 0;
+        spItem->GetAttributes(SFGAO_FOLDER | SFGAO_STREAM, &attributes);
+        items.push_back(SelectedItem(Narrow(path), (attributes & SFGAO_FOLDER) != 0 && (attributes & SFGAO_STREAM) == 0));
+        CoTaskMemFree(path);
+    }
+    return true;
+}
+
+HWND GetActiveExplorerTab(HWND frame) {
+    HWND tab = FindWindowEx(frame, NULL, "ShellTabWindowClass", NULL);
+    return tab != NULL ? tab : frame;
+}
+
+HWND GetBrowserTab(IWebBrowserApp* browser, HWND frame) {
+    // The tab's shell browser reports the tab window as its own
+    CComPtr<IServiceProvider> spServiceProvider;
+    CComPtr<IShellBrowser> spShellBrowser;
+    HWND tab = NULL;
+    if (SUCCEEDED(browser->QueryInterface(IID_PPV_ARGS(&spServiceProvider))) && spServiceProvider &&
+        SUCCEEDED(spServiceProvider->QueryService(SID_STopLevelBrowser, IID_PPV_ARGS(&spShellBrowser))) &&
+        spShellBrowser && SUCCEEDED(spShellBrowser->GetWindow(&tab)) && tab != NULL && tab != frame) {
+        return tab;
+    }
+    // Explorer without tabs reports the frame; a view that is still being
+    // created is the tab that was just opened, which is the active one
+    return GetActiveExplorerTab(frame);
+}
+
+bool ShellVirtualFolderSource::ResolveVirtualFolder(const std::string& parsingName, std::string& path) {
+    std::wstring name = Widen(parsingName);
+    PWSTR folderPath = nullptr;
+
+    // A library stands for its default save folder
+    CComPtr<IShellLibrary> spLibrary;
+    if (SUCCEEDED(SHLoadLibraryFromParsingName(name.c_str(), STGM_READ, IID_PPV_ARGS(&spLibrary)))) {
+        CComPtr<IShellItem> spFolder;
+        if (SUCCEEDED(spLibrary->GetDefaultSaveFolder(DSFT_DETECT, IID_PPV_ARGS(&spFolder))) &&
+            SUCCEEDED(spFolder->GetDisplayName(SIGDN_FILESYSPATH, &folderPath))) {
+            path = Narrow(folderPath);
+            CoTaskMemFree(folderPath);
+        }
+        return !path.empty();
+    }
+
+    PIDLIST_ABSOLUTE pidl = nullptr;
+    if (FAILED(SHParseDisplayName(name.c_str(), NULL, &pidl, 0, NULL)) || !pidl) {
+        return false;
+    }
+    CComPtr<IKnownFolderManager> spManager;
+    CComPtr<IKnownFolder> spKnownFolder;
+    if (SUCCEEDED(spManager.CoCreateInstance(CLSID_KnownFolderManager)) &&
+        SUCCEEDED(spManager->FindFolderFromIDList(pidl, &spKnownFolder)) &&
+        SUCCEEDED(spKnownFolder->GetPath(0, &folderPath))) {
+        path = Narrow(folderPath);
+        CoTaskMemFree(folderPath);
+    }
+    CoTaskMemFree(pidl);
+    return !path.empty();
+}
+
+std::string ShellVirtualFolderSource::GetHomeDirectory() {
+    return GetUserHomeDirectory();
+}
+
+void ComShellWindowProvider::OnWorkerStarted() {
+    CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+}
+
+void ComShellWindowProvider::OnWorkerStopped() {
+    CoUninitialize();
+}
+
+ComShellWindowProvider::ComShellWindowProvider(VirtualFolderMap& virtualFolders)
+    : m_virtualFolders(virtualFolders) {
+}
+
+WindowHandle ComShellWindowProvider::GetActiveTab(WindowHandle window) {
+    return ToWindowHandle(GetActiveExplorerTab(ToHwnd(window)));
+}
+
+bool ComShellWindowProvider::QueryDirectory(WindowHandle tab, std::string& directory) {
+    CComPtr<IWebBrowserApp> spWebBrowserApp;
+    return FindTabBrowser(ToHwnd(tab), spWebBrowserApp) &&
+        GetBrowserDirectory(spWebBrowserApp, m_virtualFolders, directory);
+}
+
+bool ComShellWindowProvider::QuerySelection(WindowHandle tab, std::vector<SelectedItem>& items) {
+    CComPtr<IWebBrowserApp> spWebBrowserApp;
+    items.clear();
+    return FindTabBrowser(ToHwnd(tab), spWebBrowserApp) && GetBrowserSelection(spWebBrowserApp, items);
+}
+
+ShellWindowEvents::ShellWindowEvents(DirectoryCache& cache, VirtualFolderMap& virtualFolders)
+    : m_cache(cache), m_virtualFolders(virtualFolders), m_threadId(0), m_stopped(NULL), m_windowsCookie(0),
+      m_windowsSink(nullptr) {
+}
+
+ShellWindowEvents::~ShellWindowEvents() {
+    Stop();
+}
+
+bool ShellWindowEvents::Start() {
+    if (m_thread.joinable()) {
+        return true;
+    }
+
+    // Thread messages are only queued once the thread has a message queue
+    HANDLE ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    m_stopped = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (ready == NULL || m_stopped == NULL) {
+        if (ready != NULL) {
+            CloseHandle(ready);
+        }
+        if (m_stopped != NULL) {
+            CloseHandle(m_stopped);
+            m_stopped = NULL;
+        }
+        return false;
+    }
+    m_thread = std::thread(&ShellWindowEvents::Run, this, ready);
+    WaitForSingleObject(ready, INFINITE);
+    CloseHandle(ready);
+    return true;
+}
+
+void ShellWindowEvents::Stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    PostThreadMessage(m_threadId, WM_QUIT, 0, 0);
+    if (WaitForSingleObject(m_stopped, kStopTimeoutMs) == WAIT_OBJECT_0) {
+        m_thread.join();
+        CloseHandle(m_stopped);
+    }
+    else {
+        // Only Explorer can end the call it is stuck in; Stop runs as the
+        // launcher exits, so the thread goes with the process
+        m_thread.detach();
+    }
+    m_stopped = NULL;
+    m_threadId = 0;
+    m_cache.Clear();
+}
+
+void ShellWindowEvents::Run(HANDLE ready) {
+    CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+
+    MSG msg;
+    PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
+    m_threadId = GetCurrentThreadId();
+    SetEvent(ready);
+
+    // Without a subscription the cache simply misses and the resolver
+    // queries each window under its deadline
+    if (Subscribe()) {
+        // COM delivers the events through this loop
+        while (GetMessage(&msg, NULL, 0, 0) > 0) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        Unsubscribe();
+    }
+
+    CoUninitialize();
+    SetEvent(m_stopped);
+}
+
+bool ShellWindowEvents::Subscribe() {
+    HRESULT hr = m_shellWindows.CoCreateInstance(CLSID_ShellWindows);
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    CComPtr<IConnectionPointContainer> spContainer;
+    hr = m_shellWindows.QueryInterface(&spContainer);
+    if (FAILED(hr) || !spContainer) {
+        m_shellWindows.Release();
+        return false;
+    }
+
+    hr = spContainer->FindConnectionPoint(DIID_DShellWindowsEvents, &m_windowsPoint);
+    if (FAILED(hr) || !m_windowsPoint) {
+        m_shellWindows.Release();
+        return false;
+    }
+
+    // WindowRegistered/WindowRevoked only carry a cookie, so resync the browser set
+    m_windowsSink = new DispatchSink(DIID_DShellWindowsEvents, [this](DISPID dispId) {
+        if (dispId == DISPID_WINDOWREGISTERED || dispId == DISPID_WINDOWREVOKED) {
+            Rescan();
+        }
+    });
+
+    hr = m_windowsPoint->Advise(m_windowsSink, &m_windowsCookie);
+    if (FAILED(hr)) {
+        m_windowsSink->Detach();
+        m_windowsSink->Release();
+        m_windowsSink = nullptr;
+        m_windowsPoint.Release();
+        m_shellWindows.Release();
+        return false;
+    }
+
+    Rescan();
+    return true;
+}
+
+void ShellWindowEvents::Unsubscribe() {
+    for (auto& pair : m_browsers) {
+        RemoveBrowser(pair.second);
+    }
+    m_browsers.clear();
+
+    if (m_windowsPoint) {
+        m_windowsPoint->Unadvise(m_windowsCookie);
+        m_windowsPoint.Release();
+    }
+    if (m_windowsSink) {
+        m_windowsSink->Detach();
+        m_windowsSink->Release();
+        m_windowsSink = nullptr;
+    }
+    m_shellWindows.Release();
+}
+
+void ShellWindowEvents::Rescan() {
+    if (!m_shellWindows) {
+        return;
+    }
+
+    long count = 0;
+    if (FAILED(m_shellWindows->get_Count(&count))) {
+        return;
+    }
+
+    std::set<HWND> current;
+    for (long i = 0; i < count; i++) {
+        CComPtr<IDispatch> spdisp;
+        if (FAILED(m_shellWindows->Item(CComVariant(i), &spdisp)) || spdisp == nullptr) {
+            continue;
+        }
+
+        CComPtr<IWebBrowserApp> spWebBrowserApp;
+        spdisp.QueryInterface(&spWebBrowserApp);
+        if (!spWebBrowserApp) {
+            continue;
+        }
+
+        SHANDLE_PTR hwndShell = 0;
+        if (FAILED(spWebBrowserApp->get_HWND(&hwndShell))) {
+            continue;
+        }
+
+        HWND tab = GetBrowserTab(spWebBrowserApp, (HWND)hwndShell);
+        current.insert(tab);
+        if (m_browsers.find(tab) == m_browsers.end()) {
+            AddBrowser(tab, spWebBrowserApp);
+        }
+    }
+
+    // Anything we are still subscribed to but no longer listed was revoked
+    for (auto it = m_browsers.begin(); it != m_browsers.end();) {
+        if (current.count(it->first) == 0) {
+            m_cache.OnWindowRevoked(ToWindowHandle(it->first));
+            RemoveBrowser(it->second);
+            it = m_browsers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+void ShellWindowEvents::AddBrowser(HWND tab, IWebBrowserApp* app) {
+    Browser& browser = m_browsers[tab];
+    browser.app = app;
+
+    CComPtr<IConnectionPointContainer> spContainer;
+    if (SUCCEEDED(app->QueryInterface(IID_PPV_ARGS(&spContainer))) && spContainer &&
+        SUCCEEDED(spContainer->FindConnectionPoint(DIID_DWebBrowserEvents2, &browser.point)) && browser.point) {
+        browser.sink = new DispatchSink(DIID_DWebBrowserEvents2, [this, tab](DISPID dispId) {
+            if (dispId == DISPID_NAVIGATECOMPLETE2) {
+                OnBrowserNavigated(tab);
+            }
+            else if (dispId == DISPID_ONQUIT) {
+                OnBrowserQuit(tab);
+            }
+        });
+        if (FAILED(browser.point->Advise(browser.sink, &browser.cookie))) {
+            browser.sink->Detach();
+            browser.sink->Release();
+            browser.sink = nullptr;
+            browser.point.Release();
+        }
+    }
+
+    m_cache.OnWindowRegistered(ToWindowHandle(tab));
+    OnBrowserNavigated(tab);
+}
+
+void ShellWindowEvents::RemoveBrowser(Browser& browser) {
+    if (browser.point) {
+        browser.point->Unadvise(browser.cookie);
+        browser.point.Release();
+    }
+    if (browser.sink) {
+        browser.sink->Detach();
+        browser.sink->Release();
+        browser.sink = nullptr;
+    }
+    browser.app.Release();
+}
+
+void ShellWindowEvents::OnBrowserNavigated(HWND tab) {
+    auto it = m_browsers.find(tab);
+    if (it == m_browsers.end()) {
+        return;
+    }
+
+    // The old folder is wrong from now on. Until the read below returns, a
+    // press queries the tab under its own deadline instead.
+    m_cache.Invalidate(ToWindowHandle(tab));
+
+    std::string directory;
+    if (GetBrowserDirectory(it->second.app, m_virtualFolders, directory)) {
+        m_cache.OnNavigated(ToWindowHandle(tab), directory);
+    }
+}
+
+void ShellWindowEvents::OnBrowserQuit(HWND tab) {
+    auto it = m_browsers.find(tab);
+    if (it == m_browsers.end()) {
+        return;
+    }
+
+    m_cache.OnWindowRevoked(ToWindowHandle(tab));
+    RemoveBrowser(it->second);
+    m_browsers.erase(it);
+}
@@ -0,0 +1,118 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <shlobj.h>
+#include <exdisp.h>
+#include <ocidl.h>
+#include <atlbase.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "directory_cache.h"
+#include "virtual_folders.h"
+
+inline WindowHandle ToWindowHandle(HWND hwnd) {
+    return reinterpret_cast<WindowHandle>(hwnd);
+}
+
+inline HWND ToHwnd(WindowHandle window) {
+    return reinterpret_cast<HWND>(window);
+}
+
+// Reads the folder a shell browser is showing. Returns false if the view is
+// not ready. Virtual folders are mapped to the real folder they stand for;
+// directory stays empty for those without one (Network, Recycle Bin).
+bool GetBrowserDirectory(IWebBrowserApp* browser, VirtualFolderMap& virtualFolders, std::string& directory);
+
+// Reads the file system items selected in a shell browser, in view order.
+// Returns false if the view is not ready.
+bool GetBrowserSelection(IWebBrowserApp* browser, std::vector<SelectedItem>& items);
+
+// Tab an Explorer frame is showing. In tabbed Explorer each tab is a
+// ShellTabWindowClass child and the first one in z-order is the visible
+// one; a window without one is its own tab.
+HWND GetActiveExplorerTab(HWND frame);
+
+// Tab a shell browser belongs to, in the same terms as GetActiveExplorerTab
+HWND GetBrowserTab(IWebBrowserApp* browser, HWND frame);
+
+// Cold-miss provider: walks IShellWindows until the tab matches
+class ComShellWindowProvider : public IShellWindowProvider {
+public:
+    explicit ComShellWindowProvider(VirtualFolderMap& virtualFolders);
+
+    void OnWorkerStarted() override;
+    void OnWorkerStopped() override;
+    WindowHandle GetActiveTab(WindowHandle window) override;
+    bool QueryDirectory(WindowHandle tab, std::string& directory) override;
+    bool QuerySelection(WindowHandle tab, std::vector<SelectedItem>& items) override;
+
+private:
+    VirtualFolderMap& m_virtualFolders;
+};
+
+// Known folders through IKnownFolderManager, libraries through their default
+// save folder. Called from whichever thread reads the browser, which has
+// COM initialized.
+class ShellVirtualFolderSource : public IVirtualFolderSource {
+public:
+    bool ResolveVirtualFolder(const std::string& parsingName, std::string& path) override;
+    std::string GetHomeDirectory() override;
+};
+
+// Keeps a DirectoryCache current from DShellWindowsEvents and per-tab
+// DWebBrowserEvents2. The sinks live on a thread of their own, with its own
+// STA and message loop: every event costs cross-process calls into
+// Explorer, and a hung Explorer window must not hold up WM_HOTKEY on the
+// launcher's message loop. The cache is all it shares with other threads.
+class ShellWindowEvents {
+public:
+    ShellWindowEvents(DirectoryCache& cache, VirtualFolderMap& virtualFolders);
+    ~ShellWindowEvents();
+
+    // Starts the event thread, which subscribes on its own; the caller
+    // does not wait for Explorer
+    bool Start();
+
+    // Unsubscribes and ends the event thread. A thread stuck in a call
+    // into a hung Explorer is left to process exit after kStopTimeoutMs.
+    void Stop();
+
+private:
+    class DispatchSink;
+
+    struct Browser {
+        CComPtr<IWebBrowserApp> app;
+        CComPtr<IConnectionPoint> point;
+        DWORD cookie;
+        DispatchSink* sink;
+
+        Browser() : cookie(0), sink(nullptr) {}
+    };
+
+    static const DWORD kStopTimeoutMs = 2000;
+
+    // Event thread only, from here down
+    void Run(HANDLE ready);
+    bool Subscribe();
+    void Unsubscribe();
+    void Rescan();
+    void AddBrowser(HWND tab, IWebBrowserApp* app);
+    void RemoveBrowser(Browser& browser);
+    void OnBrowserNavigated(HWND tab);
+    void OnBrowserQuit(HWND tab);
+
+    DirectoryCache& m_cache;
+    VirtualFolderMap& m_virtualFolders;
+    std::thread m_thread;
+    DWORD m_threadId;
+    HANDLE m_stopped;  // Set by the event thread as it ends
+
+    CComPtr<IShellWindows> m_shellWindows;
+    CComPtr<IConnectionPoint> m_windowsPoint;
+    DWORD m_windowsCookie;
+    DispatchSink* m_windowsSink;
+    std::map<HWND, Browser> m_browsers;  // By tab; tabs of one frame share its HWND
+};
@@ -0,0 +1,139 @@
+#include "standby_console.h"
+#include "context_providers.h"
+#include <vector>
+
+namespace {
+
+std::wstring Widen(const std::string& text) {
+    int length = MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), NULL, 0);
+    std::wstring wide(length, L'\0');
+    if (length > 0) {
+        MultiByteToWideChar(CP_ACP, 0, text.c_str(), (int)text.size(), &wide[0], length);
+    }
+    return wide;
+}
+
+void AppendKey(std::vector<INPUT_RECORD>& records, wchar_t c, WORD virtualKey) {
+    INPUT_RECORD record = {};
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = virtualKey;
+    record.Event.KeyEvent.uChar.UnicodeChar = c;
+
+    record.Event.KeyEvent.bKeyDown = TRUE;
+    records.push_back(record);
+    record.Event.KeyEvent.bKeyDown = FALSE;
+    records.push_back(record);
+}
+
+} // namespace
+
+ConsoleStandbyBackend::ConsoleStandbyBackend(ExecutableResolver& resolver)
+    : m_resolver(resolver) {
+}
+
+ConsoleStandbyBackend::~ConsoleStandbyBackend() {
+    for (const auto& entry : m_processes) {
+        CloseHandle(entry.second);
+    }
+}
+
+StandbyProcess ConsoleStandbyBackend::StartHidden(const StandbySpec& spec) {
+    std::string path;
+    if (!m_resolver.Resolve(spec.executable, path)) {
+        return 0;
+    }
+
+    std::string commandLine = "\"" + path + "\"";
+    if (!spec.args.empty()) {
+        commandLine += " " + spec.args;
+    }
+
+    STARTUPINFO startupInfo = {};
+    startupInfo.cb = sizeof(startupInfo);
+    startupInfo.dwFlags = STARTF_USESHOWWINDOW;
+    startupInfo.wShowWindow = SW_HIDE;
+    PROCESS_INFORMATION processInfo = {};
+
+    std::string homeDir = GetUserHomeDirectory();
+    if (!CreateProcess(path.c_str(), &commandLine[0], NULL, NULL, FALSE,
+        CREATE_NEW_CONSOLE | CREATE_DEFAULT_ERROR_MODE, NULL,
+        homeDir.empty() ? NULL : homeDir.c_str(), &startupInfo, &processInfo)) {
+        return 0;
+    }
+    CloseHandle(processInfo.hThread);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_processes[processInfo.dwProcessId] = processInfo.hProcess;
+    return processInfo.dwProcessId;
+}
+
+bool ConsoleStandbyBackend::IsRunning(StandbyProcess process) {
+    // Under the lock, so a concurrent Terminate cannot close the handle first
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_processes.find(process);
+    return it != m_processes.end() && WaitForSingleObject(it->second, 0) == WAIT_TIMEOUT;
+}
+
+bool ConsoleStandbyBackend::Reveal(StandbyProcess process, const StandbySpec& spec, const std::string& directory) {
+    std::string command;
+    if (!IsRunning(process) || !FormatDirectoryHandoff(spec.executable, directory, command)) {
+        return false;
+    }
+
+    std::vector<INPUT_RECORD> records;
+    for (wchar_t c : Widen(command)) {
+        AppendKey(records, c, 0);
+    }
+    AppendKey(records, L'\r', VK_RETURN);
+
+    HWND window = NULL;
+    bool typed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_consoleMutex);
+        if (AttachConsole((DWORD)process)) {
+            HANDLE input = CreateFile("CONIN$", GENERIC_READ | GENERIC_WRITE,
+                FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+            if (input != INVALID_HANDLE_VALUE) {
+                DWORD written = 0;
+                typed = WriteConsoleInputW(input, records.data(), (DWORD)records.size(), &written) &&
+                    written == records.size();
+                CloseHandle(input);
+            }
+            window = GetConsoleWindow();
+            FreeConsole();
+        }
+    }
+    if (!typed || window == NULL) {
+        return false;
+    }
+
+    // The hotkey press gives this process the right to set the foreground
+    ShowWindow(window, SW_SHOWNORMAL);
+    SetForegroundWindow(window);
+
+    HANDLE handle = TakeProcess(process);
+    if (handle != NULL) {
+        CloseHandle(handle);
+    }
+    return true;
+}
+
+void ConsoleStandbyBackend::Terminate(StandbyProcess process) {
+    HANDLE handle = TakeProcess(process);
+    if (handle != NULL) {
+        TerminateProcess(handle, 0);
+        CloseHandle(handle);
+    }
+}
+
+HANDLE ConsoleStandbyBackend::TakeProcess(StandbyProcess process) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_processes.find(process);
+    if (it == m_processes.end()) {
+        return NULL;
+    }
+    HANDLE handle = it->second;
+    m_processes.erase(it);
+    return handle;
+}
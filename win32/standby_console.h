@@ -0,0 +1,34 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include "executable_resolver.h"
+#include "standby_pool.h"
+
+// Standby shells are started in a hidden console in the home directory. On
+// hotkey the launcher attaches to that console, types the directory change
+// into its input buffer and shows the window. Input typed before the shell
+// has finished starting waits in the buffer, so an early hand-off is safe.
+class ConsoleStandbyBackend : public IProcessBackend {
+public:
+    explicit ConsoleStandbyBackend(ExecutableResolver& resolver);
+    ~ConsoleStandbyBackend();
+
+    StandbyProcess StartHidden(const StandbySpec& spec) override;
+    bool IsRunning(StandbyProcess process) override;
+    bool Reveal(StandbyProcess process, const StandbySpec& spec, const std::string& directory) override;
+    void Terminate(StandbyProcess process) override;
+
+private:
+    HANDLE TakeProcess(StandbyProcess process);
+
+    ExecutableResolver& m_resolver;
+    std::mutex m_mutex;
+    std::map<StandbyProcess, HANDLE> m_processes;
+
+    // A process has at most one console attached, so hand-offs take turns
+    std::mutex m_consoleMutex;
+};
@@ -0,0 +1,75 @@
+#include "system_environment.h"
+#include <cstring>
+
+namespace {
+
+const char kSystemEnvironmentKey[] = "SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment";
+const char kUserEnvironmentKey[] = "Environment";
+const char kAppPathsKey[] = "Software\\Microsoft\\Windows\\CurrentVersion\\App Paths\\";
+
+// Reads a REG_SZ or REG_EXPAND_SZ value; RRF_RT_REG_SZ expands the latter
+bool ReadRegistryString(HKEY root, const std::string& subKey, const char* valueName, std::string& value) {
+    DWORD size = 0;
+    const DWORD flags = RRF_RT_REG_SZ;
+    if (RegGetValue(root, subKey.c_str(), valueName, flags, NULL, NULL, &size) != ERROR_SUCCESS || size == 0) {
+        return false;
+    }
+    std::string buffer(size, '\0');
+    if (RegGetValue(root, subKey.c_str(), valueName, flags, NULL, &buffer[0], &size) != ERROR_SUCCESS) {
+        return false;
+    }
+    buffer.resize(strnlen(buffer.c_str(), buffer.size()));
+    value = buffer;
+    return true;
+}
+
+std::string GetProcessVariable(const std::string& name) {
+    DWORD size = GetEnvironmentVariable(name.c_str(), NULL, 0);
+    if (size == 0) {
+        return "";
+    }
+    std::string value(size, '\0');
+    size = GetEnvironmentVariable(name.c_str(), &value[0], size);
+    value.resize(size);
+    return value;
+}
+
+} // namespace
+
+std::string SystemExecutableEnvironment::GetVariable(const std::string& name) {
+    if (_stricmp(name.c_str(), "PATH") == 0) {
+        // Same composition Explorer uses for new processes: system, then user
+        std::string systemPath;
+        std::string userPath;
+        bool hasSystem = ReadRegistryString(HKEY_LOCAL_MACHINE, kSystemEnvironmentKey, "Path", systemPath);
+        bool hasUser = ReadRegistryString(HKEY_CURRENT_USER, kUserEnvironmentKey, "Path", userPath);
+        if (hasSystem || hasUser) {
+            return systemPath + (hasSystem && hasUser ? ";" : "") + userPath;
+        }
+    }
+    return GetProcessVariable(name);
+}
+
+bool SystemExecutableEnvironment::FileExists(const std::string& path) {
+    DWORD attributes = GetFileAttributes(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+}
+
+bool SystemExecutableEnvironment::QueryAppPath(const std::string& fileName, std::string& path) {
+    std::string subKey = kAppPathsKey + fileName;
+    return ReadRegistryString(HKEY_CURRENT_USER, subKey, NULL, path) ||
+        ReadRegistryString(HKEY_LOCAL_MACHINE, subKey, NULL, path);
+}
+
+bool SystemDirectoryProbe::IsNetworkPath(const std::string& path) {
+    std::string root = GetShareRoot(path);
+    if (root.empty()) {
+        return false;
+    }
+    return root[0] == '\\' || GetDriveType(root.c_str()) == DRIVE_REMOTE;
+}
+
+bool SystemDirectoryProbe::DirectoryExists(const std::string& path) {
+    DWORD attributes = GetFileAttributes(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
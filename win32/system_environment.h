@@ -0,0 +1,27 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include "directory_reachability.h"
+#include "executable_environment.h"
+
+// The live environment, file system and App Paths registry. PATH is rebuilt
+// from the registry on each call, because the launcher's own environment
+// block is a copy taken at startup and does not see later changes; the
+// resolver's cache keeps this off the launch path.
+class SystemExecutableEnvironment : public IExecutableEnvironment {
+public:
+    std::string GetVariable(const std::string& name) override;
+    bool FileExists(const std::string& path) override;
+    bool QueryAppPath(const std::string& fileName, std::string& path) override;
+};
+
+// Drive types come from the mount table and do not touch the network;
+// GetFileAttributes does, and is what DirectoryReachability keeps off the
+// launch path.
+class SystemDirectoryProbe : public IDirectoryProbe {
+public:
+    bool IsNetworkPath(const std::string& path) override;
+    bool DirectoryExists(const std::string& path) override;
+};
@@ -0,0 +1,64 @@
+#include "window_process_table.h"
+#include "shell_windows.h"
+
+ProcessImageCache* WindowDestroyHook::s_cache = nullptr;
+
+uint32_t SystemProcessTable::GetWindowProcessId(WindowHandle window) {
+    DWORD processId = 0;
+    if (GetWindowThreadProcessId(ToHwnd(window), &processId) == 0) {
+        return 0;
+    }
+    return processId;
+}
+
+bool SystemProcessTable::GetProcessImageName(uint32_t processId, std::string& imageName) {
+    // Limited access is enough for the image path, even for elevated processes
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+    if (process == NULL) {
+        return false;
+    }
+
+    char path[MAX_PATH];
+    DWORD length = MAX_PATH;
+    bool found = QueryFullProcessImageName(process, 0, path, &length) != FALSE;
+    CloseHandle(process);
+    if (!found) {
+        return false;
+    }
+
+    std::string fullPath(path, length);
+    size_t slash = fullPath.find_last_of("\\/");
+    imageName = fullPath.substr(slash == std::string::npos ? 0 : slash + 1);
+    return true;
+}
+
+WindowDestroyHook::WindowDestroyHook()
+    : m_hook(NULL) {
+}
+
+WindowDestroyHook::~WindowDestroyHook() {
+    Stop();
+}
+
+bool WindowDestroyHook::Start(ProcessImageCache& cache) {
+    Stop();
+    s_cache = &cache;
+    m_hook = SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_DESTROY, NULL, &WindowDestroyHook::OnEvent,
+        0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    return m_hook != NULL;
+}
+
+void WindowDestroyHook::Stop() {
+    if (m_hook != NULL) {
+        UnhookWinEvent(m_hook);
+        m_hook = NULL;
+    }
+    s_cache = nullptr;
+}
+
+void CALLBACK WindowDestroyHook::OnEvent(HWINEVENTHOOK, DWORD, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+    // Only the window itself, not its caret, scroll bars and so on
+    if (s_cache != nullptr && hwnd != NULL && idObject == OBJID_WINDOW && idChild == CHILDID_SELF) {
+        s_cache->OnWindowDestroyed(ToWindowHandle(hwnd));
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <string>
+#include "process_image_cache.h"
+
+// Live window and process queries
+class SystemProcessTable : public IProcessTable {
+public:
+    uint32_t GetWindowProcessId(WindowHandle window) override;
+    bool GetProcessImageName(uint32_t processId, std::string& imageName) override;
+};
+
+// Drops ProcessImageCache entries as windows are destroyed, through an
+// out-of-context WinEvent hook. Callbacks arrive on the message loop of the
+// thread that called Start().
+class WindowDestroyHook {
+public:
+    WindowDestroyHook();
+    ~WindowDestroyHook();
+
+    bool Start(ProcessImageCache& cache);
+    void Stop();
+
+private:
+    static void CALLBACK OnEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild,
+        DWORD eventThread, DWORD eventTime);
+
+    // WinEvent callbacks carry no context pointer
+    static ProcessImageCache* s_cache;
+    HWINEVENTHOOK m_hook;
+};